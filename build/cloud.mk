@@ -6,8 +6,13 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/TrafficQueue.cpp \
+	$(SRC)/Cloud/Shard.cpp \
+	$(SRC)/Cloud/ShardSet.cpp \
+	$(SRC)/Cloud/Journal.cpp \
+	$(SRC)/Cloud/Database.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC IO OS GEO MATH UTIL THREAD
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
@@ -20,6 +25,13 @@ CLOUD_TO_KML_SOURCES = \
 CLOUD_TO_KML_DEPENDS = ASYNC IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-to-kml,CLOUD_TO_KML))
 
+CLOUD_LOAD_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Client.cpp \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/LoadGenerator.cpp
+CLOUD_LOAD_DEPENDS = LIBNET OS GEO MATH UTIL
+$(eval $(call link-program,xcsoar-cloud-load,CLOUD_LOAD))
+
 ifeq ($(TARGET),UNIX)
-OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN)
+OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN) $(CLOUD_LOAD_BIN)
 endif
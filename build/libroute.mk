@@ -3,6 +3,7 @@ ROUTE_SRC_DIR = $(SRC)/Engine/Route
 ROUTE_SOURCES = \
 	$(ROUTE_SRC_DIR)/Config.cpp \
 	$(ROUTE_SRC_DIR)/RoutePlanner.cpp \
+	$(ROUTE_SRC_DIR)/RouteLinkCache.cpp \
 	$(ROUTE_SRC_DIR)/AirspaceRoute.cpp \
 	$(ROUTE_SRC_DIR)/TerrainRoute.cpp \
 	$(ROUTE_SRC_DIR)/RouteLink.cpp \
@@ -13,6 +13,7 @@ TASK_SOURCES = \
 	$(TASK_SRC_DIR)/Ordered/FinishConstraints.cpp \
 	$(TASK_SRC_DIR)/Ordered/Settings.cpp \
 	$(TASK_SRC_DIR)/Ordered/OrderedTask.cpp \
+	$(TASK_SRC_DIR)/Ordered/TargetSearchState.cpp \
 	$(TASK_SRC_DIR)/Ordered/TaskAdvance.cpp \
 	$(TASK_SRC_DIR)/Ordered/SmartTaskAdvance.cpp \
 	$(TASK_SRC_DIR)/Ordered/Points/IntermediatePoint.cpp \
@@ -55,6 +56,7 @@ TASK_SOURCES = \
 	$(TASK_SRC_DIR)/PathSolvers/TaskDijkstra.cpp \
 	$(TASK_SRC_DIR)/PathSolvers/TaskDijkstraMin.cpp \
 	$(TASK_SRC_DIR)/PathSolvers/TaskDijkstraMax.cpp \
+	$(TASK_SRC_DIR)/PathSolvers/TaskDistanceSolver.cpp \
 	$(TASK_SRC_DIR)/PathSolvers/IsolineCrossingFinder.cpp \
 	$(TASK_SRC_DIR)/Solvers/TaskMacCready.cpp \
 	$(TASK_SRC_DIR)/Solvers/TaskMacCreadyTravelled.cpp \
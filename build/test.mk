@@ -94,20 +94,30 @@ TEST_NAMES = \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM TestProfile \
 	TestAllocatedGrid \
+	TestJobScheduler \
+	TestTimeline \
+	TestAsyncLogWriter \
+	TestCloudJournal \
+	TestTerrainShading \
+	TestTerrainIntersection \
+	TestTopographyPack TestProjectedShapeCache \
 	TestRadixTree TestGeoBounds TestGeoClip \
+	TestPolygonArrays \
 	TestLogger TestGRecord TestDriver TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
 	TestColorRamp TestGeoPoint TestDiffFilter \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
-	TestMacCready TestOrderedTask TestAATPoint \
+	TestMacCready TestOrderedTask TestAATPoint TestTaskDistanceSolver \
 	TestPlanes \
 	TestTaskPoint \
 	TestTaskWaypoint \
 	TestTeamCode \
 	TestZeroFinder \
 	TestAirspaceParser \
+	TestAirspaceCache \
+	TestAirspaceIntrusions \
 	TestMETARParser \
 	TestIGCParser \
 	TestByteOrder \
@@ -197,6 +207,30 @@ TEST_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 TEST_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
 $(eval $(call link-program,TestAirspaceParser,TEST_AIRSPACE_PARSER))
 
+TEST_AIRSPACE_CACHE_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceCache.cpp
+TEST_AIRSPACE_CACHE_LDADD = $(FAKE_LIBS)
+TEST_AIRSPACE_CACHE_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceCache,TEST_AIRSPACE_CACHE))
+
+TEST_AIRSPACE_INTRUSIONS_SOURCES = \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceIntrusions.cpp
+TEST_AIRSPACE_INTRUSIONS_DEPENDS = AIRSPACE THREAD GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceIntrusions,TEST_AIRSPACE_INTRUSIONS))
+
 TEST_DATE_TIME_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestDateTime.cpp
@@ -250,6 +284,12 @@ TEST_AAT_POINT_OBJS = $(call SRC_TO_OBJ,$(TEST_AAT_POINT_SOURCES))
 TEST_AAT_POINT_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH UTIL
 $(eval $(call link-program,TestAATPoint,TEST_AAT_POINT))
 
+TEST_TASK_DISTANCE_SOLVER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskDistanceSolver.cpp
+TEST_TASK_DISTANCE_SOLVER_DEPENDS = TASK GEO MATH UTIL
+$(eval $(call link-program,TestTaskDistanceSolver,TEST_TASK_DISTANCE_SOLVER))
+
 TEST_PLANES_SOURCES = \
 	$(SRC)/Polar/Parser.cpp \
 	$(SRC)/Plane/PlaneFileGlue.cpp \
@@ -302,7 +342,7 @@ TEST_REACH_SOURCES = \
 	$(TEST_SRC_DIR)/Printing.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_reach.cpp
-TEST_REACH_DEPENDS = TERRAIN IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
+TEST_REACH_DEPENDS = TERRAIN IO ZZIP THREAD OS ROUTE GLIDE GEO MATH UTIL
 $(eval $(call link-program,test_reach,TEST_REACH))
 
 TEST_ROUTE_SOURCES = \
@@ -410,6 +450,12 @@ TEST_GEO_CLIP_SOURCES = \
 TEST_GEO_CLIP_DEPENDS = GEO MATH
 $(eval $(call link-program,TestGeoClip,TEST_GEO_CLIP))
 
+TEST_POLYGON_ARRAYS_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPolygonArrays.cpp
+TEST_POLYGON_ARRAYS_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPolygonArrays,TEST_POLYGON_ARRAYS))
+
 TEST_CLIMB_AV_CALC_SOURCES = \
 	$(SRC)/Computer/ClimbAverageCalculator.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -604,6 +650,80 @@ TEST_ALLOCATED_GRID_SOURCES = \
 TEST_ALLOCATED_GRID_DEPENDS = UTIL
 $(eval $(call link-program,TestAllocatedGrid,TEST_ALLOCATED_GRID))
 
+TEST_JOB_SCHEDULER_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestJobScheduler.cpp
+TEST_JOB_SCHEDULER_DEPENDS = THREAD OS UTIL
+$(eval $(call link-program,TestJobScheduler,TEST_JOB_SCHEDULER))
+
+TEST_TIMELINE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTimeline.cpp
+TEST_TIMELINE_DEPENDS = THREAD UTIL
+$(eval $(call link-program,TestTimeline,TEST_TIMELINE))
+
+TEST_ASYNC_LOG_WRITER_SOURCES = \
+	$(SRC)/Logger/AsyncLogWriter.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAsyncLogWriter.cpp
+TEST_ASYNC_LOG_WRITER_DEPENDS = IO OS THREAD UTIL
+$(eval $(call link-program,TestAsyncLogWriter,TEST_ASYNC_LOG_WRITER))
+
+TEST_CLOUD_JOURNAL_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Journal.cpp \
+	$(SRC)/Cloud/Database.cpp \
+	$(SRC)/IO/Async/AsioThread.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudJournal.cpp
+TEST_CLOUD_JOURNAL_DEPENDS = IO OS GEO MATH UTIL THREAD
+$(eval $(call link-program,TestCloudJournal,TEST_CLOUD_JOURNAL))
+
+TEST_TERRAIN_SHADING_SOURCES = \
+	$(SRC)/Terrain/ShadingKernels.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTerrainShading.cpp
+$(eval $(call link-program,TestTerrainShading,TEST_TERRAIN_SHADING))
+
+TEST_TERRAIN_INTERSECTION_SOURCES = \
+	$(TEST_SRC_DIR)/ReferenceIntersection.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTerrainIntersection.cpp
+TEST_TERRAIN_INTERSECTION_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,TestTerrainIntersection,TEST_TERRAIN_INTERSECTION))
+
+TEST_TOPOGRAPHY_PACK_SOURCES = \
+	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/TopographyConfig.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
+	$(SRC)/Topography/TopographyPackWriter.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTopographyPack.cpp
+ifeq ($(OPENGL),y)
+TEST_TOPOGRAPHY_PACK_SOURCES += \
+	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp
+endif
+TEST_TOPOGRAPHY_PACK_DEPENDS = GEO MATH THREAD IO OS UTIL SHAPELIB ZZIP
+TEST_TOPOGRAPHY_PACK_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestTopographyPack,TEST_TOPOGRAPHY_PACK))
+
+TEST_PROJECTED_SHAPE_CACHE_SOURCES = \
+	$(SRC)/Topography/ProjectedShapeCache.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestProjectedShapeCache.cpp
+TEST_PROJECTED_SHAPE_CACHE_DEPENDS = GEO MATH
+TEST_PROJECTED_SHAPE_CACHE_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestProjectedShapeCache,TEST_PROJECTED_SHAPE_CACHE))
+
 TEST_RADIX_TREE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestRadixTree.cpp
@@ -621,11 +741,12 @@ TEST_LOGGER_SOURCES = \
 	$(SRC)/Logger/GRecord.cpp \
 	$(SRC)/Logger/LoggerEPE.cpp \
 	$(SRC)/Logger/MD5.cpp \
+	$(SRC)/Logger/AsyncLogWriter.cpp \
 	$(SRC)/Version.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestLogger.cpp
-TEST_LOGGER_DEPENDS = IO OS GEO MATH UTIL
+TEST_LOGGER_DEPENDS = IO OS GEO MATH THREAD UTIL
 $(eval $(call link-program,TestLogger,TEST_LOGGER))
 
 TEST_GRECORD_SOURCES = \
@@ -687,6 +808,7 @@ TEST_WAY_POINT_FILE_SOURCES = \
 	$(SRC)/Waypoint/WaypointReaderFS.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
 	$(SRC)/Waypoint/WaypointReaderCompeGPS.cpp \
+	$(SRC)/Waypoint/ParallelWaypointReader.cpp \
 	$(SRC)/Waypoint/Factory.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(SRC)/RadioFrequency.cpp \
@@ -731,6 +853,9 @@ DEBUG_PROGRAM_NAMES = \
 	FlightPath \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkTaskDistanceSolver \
+	BenchmarkIGCParser \
+	BenchmarkAirspaces BenchmarkAirspaceIntrusions \
 	DumpTextFile DumpTextZip DumpTextInflate WriteTextFile RunTextWriter \
 	DumpHexColor \
 	RunXMLParser \
@@ -740,10 +865,13 @@ DEBUG_PROGRAM_NAMES = \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
 	KeyCodeDumper \
-	LoadTopography LoadTerrain \
-	RunHeightMatrix \
+	LoadTopography ConvertTopography \
+	LoadTerrain BenchmarkTerrainLoader \
+	BenchmarkTerrainIntersection \
+	RunHeightMatrix BenchmarkTerrainShading \
 	RunInputParser \
-	RunWaypointParser RunAirspaceParser \
+	RunWaypointParser BenchmarkWaypointParser RunAirspaceParser \
+	BenchmarkJobScheduler \
 	RunFlightParser \
 	EnumeratePorts \
 	ReadPort RunPortHandler LogPort \
@@ -835,6 +963,7 @@ DEBUG_REPLAY_SOURCES = \
 	$(SRC)/Device/Util/NMEAReader.cpp \
 	$(SRC)/Device/Config.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCMappedReader.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Units/Descriptor.cpp \
 	$(SRC)/Units/System.cpp \
@@ -904,6 +1033,18 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_TASK_DISTANCE_SOLVER_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkTaskDistanceSolver.cpp
+BENCHMARK_TASK_DISTANCE_SOLVER_DEPENDS = TASK GEO MATH IO OS UTIL
+$(eval $(call link-program,BenchmarkTaskDistanceSolver,BENCHMARK_TASK_DISTANCE_SOLVER))
+
+BENCHMARK_IGC_PARSER_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCMappedReader.cpp \
+	$(TEST_SRC_DIR)/BenchmarkIGCParser.cpp
+BENCHMARK_IGC_PARSER_DEPENDS = IO OS MATH UTIL
+$(eval $(call link-program,BenchmarkIGCParser,BENCHMARK_IGC_PARSER))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1116,7 +1257,9 @@ $(eval $(call link-program,KeyCodeDumper,KEY_CODE_DUMPER))
 LOAD_TOPOGRAPHY_SOURCES = \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
-	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Topography/TopographyConfig.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
+	$(SRC)/Topography/TopographyPackWriter.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
 	$(SRC)/Operation/Operation.cpp \
@@ -1125,10 +1268,24 @@ ifeq ($(OPENGL),y)
 LOAD_TOPOGRAPHY_SOURCES += \
 	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp
 endif
-LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO UTIL SHAPELIB ZZIP
+LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO OS UTIL SHAPELIB ZZIP
 LOAD_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
+CONVERT_TOPOGRAPHY_SOURCES = \
+	$(SRC)/Topography/TopographyConfig.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
+	$(SRC)/Topography/TopographyPackWriter.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/ConvertTopography.cpp
+ifeq ($(OPENGL),y)
+CONVERT_TOPOGRAPHY_SOURCES += \
+	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp
+endif
+CONVERT_TOPOGRAPHY_DEPENDS = GEO MATH IO OS UTIL SHAPELIB ZZIP
+CONVERT_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,ConvertTopography,CONVERT_TOPOGRAPHY))
+
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Operation/Operation.cpp \
 	$(TEST_SRC_DIR)/LoadTerrain.cpp
@@ -1136,6 +1293,21 @@ LOAD_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
 LOAD_TERRAIN_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
+BENCHMARK_TERRAIN_LOADER_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainLoader.cpp
+BENCHMARK_TERRAIN_LOADER_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_LOADER_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainLoader,BENCHMARK_TERRAIN_LOADER))
+
+BENCHMARK_TERRAIN_INTERSECTION_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/ReferenceIntersection.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainIntersection.cpp
+BENCHMARK_TERRAIN_INTERSECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_INTERSECTION_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainIntersection,BENCHMARK_TERRAIN_INTERSECTION))
+
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -1145,6 +1317,15 @@ RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
 RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
+BENCHMARK_TERRAIN_SHADING_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainShading.cpp
+BENCHMARK_TERRAIN_SHADING_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_SHADING_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainShading,BENCHMARK_TERRAIN_SHADING))
+
 RUN_INPUT_PARSER_SOURCES = \
 	$(SRC)/Input/InputKeys.cpp \
 	$(SRC)/Input/InputConfig.cpp \
@@ -1178,6 +1359,34 @@ RUN_WAY_POINT_PARSER_LDADD = $(FAKE_LIBS)
 RUN_WAY_POINT_PARSER_DEPENDS = WAYPOINT IO OS THREAD ZZIP GEO MATH UTIL
 $(eval $(call link-program,RunWaypointParser,RUN_WAY_POINT_PARSER))
 
+BENCHMARK_WAY_POINT_PARSER_SOURCES = \
+	$(SRC)/Waypoint/WaypointFileType.cpp \
+	$(SRC)/Waypoint/WaypointReaderBase.cpp \
+	$(SRC)/Waypoint/WaypointReader.cpp \
+	$(SRC)/Waypoint/WaypointReaderWinPilot.cpp \
+	$(SRC)/Waypoint/WaypointReaderFS.cpp \
+	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
+	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
+	$(SRC)/Waypoint/WaypointReaderZander.cpp \
+	$(SRC)/Waypoint/WaypointReaderCompeGPS.cpp \
+	$(SRC)/Waypoint/ParallelWaypointReader.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypointParser.cpp
+BENCHMARK_WAY_POINT_PARSER_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAY_POINT_PARSER_DEPENDS = WAYPOINT IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypointParser,BENCHMARK_WAY_POINT_PARSER))
+
+BENCHMARK_JOB_SCHEDULER_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkJobScheduler.cpp
+BENCHMARK_JOB_SCHEDULER_DEPENDS = THREAD OS UTIL
+$(eval $(call link-program,BenchmarkJobScheduler,BENCHMARK_JOB_SCHEDULER))
+
 NEAREST_WAYPOINTS_SOURCES = \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
@@ -1220,6 +1429,33 @@ RUN_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 RUN_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
 $(eval $(call link-program,RunAirspaceParser,RUN_AIRSPACE_PARSER))
 
+BENCHMARK_AIRSPACES_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/Task/Stats/TaskStats.cpp \
+	$(SRC)/Engine/Task/Stats/CommonStats.cpp \
+	$(SRC)/Engine/Task/Stats/ElementStat.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaces.cpp
+BENCHMARK_AIRSPACES_LDADD = $(FAKE_LIBS)
+BENCHMARK_AIRSPACES_DEPENDS = IO OS AIRSPACE GLIDE ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaces,BENCHMARK_AIRSPACES))
+
+BENCHMARK_AIRSPACE_INTRUSIONS_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceIntrusions.cpp
+BENCHMARK_AIRSPACE_INTRUSIONS_LDADD = $(DEBUG_REPLAY_LDADD)
+BENCHMARK_AIRSPACE_INTRUSIONS_DEPENDS = IO OS AIRSPACE THREAD ZZIP GEO MATH UTIL TIME
+$(eval $(call link-program,BenchmarkAirspaceIntrusions,BENCHMARK_AIRSPACE_INTRUSIONS))
+
 ENUMERATE_PORTS_SOURCES = \
 	$(TEST_SRC_DIR)/EnumeratePorts.cpp
 ENUMERATE_PORTS_DEPENDS = PORT
@@ -1544,10 +1780,11 @@ RUN_IGC_WRITER_SOURCES = \
 	$(SRC)/Logger/GRecord.cpp \
 	$(SRC)/Logger/LoggerEPE.cpp \
 	$(SRC)/Logger/MD5.cpp \
+	$(SRC)/Logger/AsyncLogWriter.cpp \
 	$(SRC)/Operation/Operation.cpp \
 	$(TEST_SRC_DIR)/RunIGCWriter.cpp
 RUN_IGC_WRITER_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_IGC_WRITER_DEPENDS = GEO MATH UTIL TIME
+RUN_IGC_WRITER_DEPENDS = IO OS THREAD GEO MATH UTIL TIME
 $(eval $(call link-program,RunIGCWriter,RUN_IGC_WRITER))
 
 RUN_FLIGHT_LOGGER_SOURCES = \
@@ -1664,7 +1901,7 @@ RUN_OLC_SOURCES = \
 	$(TEST_SRC_DIR)/ContestPrinting.cpp \
 	$(TEST_SRC_DIR)/RunOLCAnalysis.cpp
 RUN_OLC_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_OLC_DEPENDS = CONTEST UTIL GEO MATH TIME
+RUN_OLC_DEPENDS = CONTEST THREAD OS UTIL GEO MATH TIME
 $(eval $(call link-program,RunOLCAnalysis,RUN_OLC))
 
 RUN_WAVE_COMPUTER_SOURCES = \
@@ -1858,9 +2095,12 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/Thread.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
+	$(SRC)/Topography/ProjectedShapeCache.cpp \
 	$(SRC)/Topography/TopographyRenderer.cpp \
 	$(SRC)/Topography/TopographyGlue.cpp \
-	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Topography/TopographyConfig.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
+	$(SRC)/Topography/TopographyPackWriter.cpp \
 	$(SRC)/Topography/CachedTopographyRenderer.cpp \
 	$(SRC)/Units/Units.cpp \
 	$(SRC)/Units/Settings.cpp \
@@ -1886,6 +2126,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Waypoint/LastUsed.cpp \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/ParallelWaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
@@ -2338,6 +2579,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
@@ -2485,6 +2727,7 @@ RUN_TASK_EDITOR_DIALOG_SOURCES = \
 	$(SRC)/Formatter/Units.cpp \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/ParallelWaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
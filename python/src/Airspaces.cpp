@@ -29,12 +29,14 @@
 #include "PythonConverters.hpp"
 
 #include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceIntrusions.hpp"
 #include "Engine/Airspace/AirspacePolygon.hpp"
 #include "Engine/Airspace/AbstractAirspace.hpp"
 #include "Engine/Airspace/AirspaceClass.hpp"
 #include "Engine/Airspace/AirspaceAltitude.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
 #include "NMEA/Aircraft.hpp"
+#include "Thread/JobScheduler.hpp"
 #include "Util/tstring.hpp"
 #include "Util/Macros.hpp"
 
@@ -217,8 +219,8 @@ PyObject* xcsoar_Airspaces_findIntrusions(Pyxcsoar_Airspaces *self, PyObject *ar
     return nullptr;
   }
 
-  PyObject *py_result = PyDict_New();
-  Airspaces::AirspaceVector last_airspaces;
+  std::vector<AircraftState> fixes;
+  std::vector<BrokenDateTime> times;
 
   while (replay->Next()) {
     const MoreData &basic = replay->Basic();
@@ -227,50 +229,59 @@ PyObject* xcsoar_Airspaces_findIntrusions(Pyxcsoar_Airspaces *self, PyObject *ar
         !basic.NavAltitudeAvailable())
       continue;
 
-    const auto range =
-      self->airspace_database->QueryInside(ToAircraftState(basic,
-                                                           replay->Calculated()));
-    Airspaces::AirspaceVector airspaces(range.begin(), range.end());
-    for (auto it = airspaces.begin(); it != airspaces.end(); it++) {
-      PyObject *py_name = PyString_FromString((*it).GetAirspace().GetName());
-      PyObject *py_airspace = nullptr,
-               *py_period = nullptr;
+    fixes.push_back(ToAircraftState(basic, replay->Calculated()));
+    times.push_back(basic.date_time_utc);
+  }
+
+  delete replay;
+
+  AirspaceIntrusionList intrusions;
+
+  Py_BEGIN_ALLOW_THREADS
+  intrusions = FindAirspaceIntrusions(*self->airspace_database,
+                                      fixes.data(), fixes.size(),
+                                      [](unsigned n,
+                                         const std::function<void(unsigned)> &f){
+                                        GetJobScheduler().ParallelFor(n, f);
+                                      });
+  Py_END_ALLOW_THREADS
+
+  PyObject *py_result = PyDict_New();
+
+  VisitAirspaceIntrusions(intrusions, [&](unsigned fix,
+                                          const AirspaceIntrusion &intrusion){
+    PyObject *py_name = PyString_FromString(intrusion.airspace->GetName());
+    PyObject *py_airspace = nullptr,
+             *py_period = nullptr;
+
+    if (PyDict_Contains(py_result, py_name) == 0) {
+      // this is the first fix inside this airspace
+      py_airspace = PyList_New(0);
+      PyDict_SetItem(py_result, py_name, py_airspace);
 
-      if (PyDict_Contains(py_result, py_name) == 0) {
-        // this is the first fix inside this airspace
-        py_airspace = PyList_New(0);
-        PyDict_SetItem(py_result, py_name, py_airspace);
+      py_period = PyList_New(0);
+      PyList_Append(py_airspace, py_period);
+      Py_DECREF(py_period);
 
+    } else {
+      // this airspace was hit some time before...
+      py_airspace = PyDict_GetItem(py_result, py_name);
+
+      // check if the last fix was already inside this airspace
+      if (fix == intrusion.begin) {
+        // create a new period
         py_period = PyList_New(0);
         PyList_Append(py_airspace, py_period);
         Py_DECREF(py_period);
-
       } else {
-        // this airspace was hit some time before...
-        py_airspace = PyDict_GetItem(py_result, py_name);
-
-        // check if the last fix was already inside this airspace
-        auto in_last = std::find(last_airspaces.begin(), last_airspaces.end(), *it);
-
-        if (in_last == last_airspaces.end()) {
-          // create a new period
-          py_period = PyList_New(0);
-          PyList_Append(py_airspace, py_period);
-          Py_DECREF(py_period);
-        } else {
-          py_period = PyList_GET_ITEM(py_airspace, PyList_GET_SIZE(py_airspace) - 1);
-        }
+        py_period = PyList_GET_ITEM(py_airspace, PyList_GET_SIZE(py_airspace) - 1);
       }
-
-      PyList_Append(py_period, Py_BuildValue("{s:N,s:N}",
-        "time", Python::BrokenDateTimeToPy(basic.date_time_utc),
-        "location", Python::WriteLonLat(basic.location)));
     }
 
-    last_airspaces = std::move(airspaces);
-  }
-
-  delete replay;
+    PyList_Append(py_period, Py_BuildValue("{s:N,s:N}",
+      "time", Python::BrokenDateTimeToPy(times[fix]),
+      "location", Python::WriteLonLat(fixes[fix].location)));
+  });
 
   return py_result;
 }
@@ -28,6 +28,7 @@
 #include "Flight.hpp"
 #include "Airspaces.hpp"
 #include "Util.hpp"
+#include "Thread/JobScheduler.hpp"
 
 
 PyMethodDef xcsoar_methods[] = {
@@ -47,6 +48,9 @@ initxcsoar() {
 
   PyDateTime_IMPORT;
 
+  InitialiseJobScheduler();
+  Py_AtExit(DeinitialiseJobScheduler);
+
   if (!Flight_init(m))
     return;
 
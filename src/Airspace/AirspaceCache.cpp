@@ -0,0 +1,378 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <cmath>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static constexpr TCHAR airspace_cache_name[] = _T("airspace");
+
+static constexpr uint32_t AIRSPACE_CACHE_MAGIC = 0x5a8e3c41;
+
+/**
+ * Increment this whenever the file format or the layout of one of
+ * the structs below changes.
+ */
+static constexpr uint32_t AIRSPACE_CACHE_VERSION = 1;
+
+/**
+ * Sanity limits which protect against corrupt cache files.
+ */
+static constexpr uint32_t MAX_STRING_LENGTH = 4096;
+static constexpr uint32_t MAX_POINTS = 1000000;
+
+struct CacheHeader {
+  uint32_t magic, version;
+
+  /**
+   * sizeof(TCHAR) of the program which wrote the file.
+   */
+  uint32_t char_size;
+
+  uint32_t n_sources, n_airspaces;
+
+  /**
+   * The bounds of the TaskProjection which was used to project the
+   * airspace borders.
+   */
+  GeoBounds bounds;
+};
+
+/**
+ * Followed by the path.
+ */
+struct CacheSource {
+  uint64_t size, mtime;
+  uint32_t path_length;
+};
+
+/**
+ * Followed by the name, the radio frequency and the border points.
+ */
+struct CacheAirspace {
+  AbstractAirspace::Shape shape;
+  AirspaceClass type;
+  AirspaceActivity days;
+
+  uint32_t name_length, radio_length, n_points;
+
+  AirspaceAltitude base, top;
+
+  FlatBoundingBox box;
+
+  /**
+   * Only used by circles.
+   */
+  GeoPoint center;
+  double radius;
+};
+
+struct CachePoint {
+  GeoPoint location;
+  FlatGeoPoint flat;
+};
+
+template<typename T>
+static bool
+Read(FILE *file, T &value)
+{
+  return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+template<typename T>
+static bool
+Write(FILE *file, const T &value)
+{
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool
+ReadString(FILE *file, uint32_t length, tstring &value)
+{
+  if (length > MAX_STRING_LENGTH)
+    return false;
+
+  value.resize(length);
+  return length == 0 ||
+    fread(&value[0], sizeof(TCHAR), length, file) == length;
+}
+
+static bool
+WriteString(FILE *file, const tstring &value)
+{
+  return value.empty() ||
+    fwrite(value.data(), sizeof(TCHAR), value.length(), file) == value.length();
+}
+
+static bool
+CheckSource(FILE *file, Path path)
+{
+  CacheSource source;
+  tstring cached_path;
+  return Read(file, source) &&
+    ReadString(file, source.path_length, cached_path) &&
+    cached_path == path.c_str() &&
+    source.size == File::GetSize(path) &&
+    source.mtime == File::GetLastModification(path);
+}
+
+gcc_pure
+static bool
+IsValid(const AirspaceAltitude &altitude)
+{
+  switch (altitude.reference) {
+  case AltitudeReference::NONE:
+  case AltitudeReference::AGL:
+  case AltitudeReference::MSL:
+  case AltitudeReference::STD:
+    break;
+
+  default:
+    return false;
+  }
+
+  return std::isfinite(altitude.altitude) &&
+    std::isfinite(altitude.flight_level) &&
+    std::isfinite(altitude.altitude_above_terrain);
+}
+
+/**
+ * Check the fields which are used as table indices or in
+ * calculations, because the file may be corrupt or may have been
+ * written by a different build.  The #AirspaceActivity bit mask has
+ * no invalid values.
+ */
+gcc_pure
+static bool
+IsValid(const CacheAirspace &a)
+{
+  return unsigned(a.type) < unsigned(AIRSPACECLASSCOUNT) &&
+    IsValid(a.base) && IsValid(a.top) &&
+    std::isfinite(a.radius) && a.radius >= 0;
+}
+
+static AbstractAirspace *
+LoadAirspace(FILE *file, std::vector<CachePoint> &points,
+             FlatBoundingBox &box)
+{
+  CacheAirspace a;
+  tstring name, radio;
+  if (!Read(file, a) || !IsValid(a) ||
+      !ReadString(file, a.name_length, name) ||
+      !ReadString(file, a.radio_length, radio) ||
+      a.n_points < 3 || a.n_points > MAX_POINTS)
+    return nullptr;
+
+  points.resize(a.n_points);
+  if (fread(points.data(), sizeof(points.front()), points.size(),
+            file) != points.size())
+    return nullptr;
+
+  SearchPointVector border;
+  border.reserve(points.size());
+  for (const auto &i : points)
+    border.emplace_back(i.location, i.flat);
+
+  AbstractAirspace *airspace;
+  switch (a.shape) {
+  case AbstractAirspace::Shape::CIRCLE:
+    airspace = new AirspaceCircle(a.center, a.radius, std::move(border));
+    break;
+
+  case AbstractAirspace::Shape::POLYGON:
+    airspace = new AirspacePolygon(std::move(border));
+    break;
+
+  default:
+    return nullptr;
+  }
+
+  airspace->SetProperties(std::move(name), a.type, a.base, a.top);
+  airspace->SetRadio(radio);
+  airspace->SetDays(a.days);
+
+  box = a.box;
+  return airspace;
+}
+
+static bool
+LoadAirspaces(FILE *file, const AirspaceSources &sources,
+              TaskProjection &projection,
+              Airspaces::AirspaceVector &items)
+{
+  CacheHeader header;
+  if (!Read(file, header) ||
+      header.magic != AIRSPACE_CACHE_MAGIC ||
+      header.version != AIRSPACE_CACHE_VERSION ||
+      header.char_size != sizeof(TCHAR) ||
+      header.n_sources != sources.size())
+    return false;
+
+  for (const auto &source : sources)
+    if (!CheckSource(file, source))
+      return false;
+
+  projection = TaskProjection(header.bounds);
+
+  std::vector<CachePoint> points;
+  for (uint32_t i = 0; i < header.n_airspaces; ++i) {
+    FlatBoundingBox box;
+    AbstractAirspace *airspace = LoadAirspace(file, points, box);
+    if (airspace == nullptr)
+      return false;
+
+    items.emplace_back(*airspace, box);
+  }
+
+  return true;
+}
+
+bool
+LoadAirspaceCache(FileCache &cache, const AirspaceSources &sources,
+                  Airspaces &airspaces)
+{
+  assert(!sources.empty());
+
+  FILE *file = cache.Load(airspace_cache_name, sources.front());
+  if (file == nullptr)
+    return false;
+
+  TaskProjection projection;
+  Airspaces::AirspaceVector items;
+  const bool success = LoadAirspaces(file, sources, projection, items);
+  fclose(file);
+
+  if (!success) {
+    for (auto &i : items)
+      i.Destroy();
+
+    cache.Flush(airspace_cache_name);
+    return false;
+  }
+
+  airspaces.Restore(projection, std::move(items));
+  return true;
+}
+
+static bool
+SaveAirspace(FILE *file, const Airspace &item)
+{
+  const AbstractAirspace &airspace = item.GetAirspace();
+  const SearchPointVector &border = airspace.GetPoints();
+
+  CacheAirspace a;
+  a.shape = airspace.GetShape();
+  a.type = airspace.GetType();
+  a.days = airspace.GetDays();
+  a.name_length = _tcslen(airspace.GetName());
+  a.radio_length = airspace.GetRadioText().length();
+  a.n_points = border.size();
+  a.base = airspace.GetBase();
+  a.top = airspace.GetTop();
+  a.box = item;
+
+  if (a.shape == AbstractAirspace::Shape::CIRCLE) {
+    const AirspaceCircle &circle = (const AirspaceCircle &)airspace;
+    a.center = circle.GetCenter();
+    a.radius = circle.GetRadius();
+  } else {
+    a.center = GeoPoint::Invalid();
+    a.radius = 0;
+  }
+
+  if (!Write(file, a) ||
+      fwrite(airspace.GetName(), sizeof(TCHAR), a.name_length,
+             file) != a.name_length ||
+      !WriteString(file, airspace.GetRadioText()))
+    return false;
+
+  for (const auto &i : border) {
+    CachePoint p;
+    p.location = i.GetLocation();
+    p.flat = i.GetFlatLocation();
+    if (!Write(file, p))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+SaveAirspaces(FILE *file, const AirspaceSources &sources,
+              const Airspaces &airspaces)
+{
+  CacheHeader header;
+  header.magic = AIRSPACE_CACHE_MAGIC;
+  header.version = AIRSPACE_CACHE_VERSION;
+  header.char_size = sizeof(TCHAR);
+  header.n_sources = sources.size();
+  header.n_airspaces = airspaces.GetSize();
+  header.bounds = airspaces.GetProjection().GetBounds();
+
+  if (!Write(file, header))
+    return false;
+
+  for (const auto &path : sources) {
+    CacheSource source;
+    source.size = File::GetSize(path);
+    source.mtime = File::GetLastModification(path);
+    source.path_length = _tcslen(path.c_str());
+    if (!Write(file, source) ||
+        fwrite(path.c_str(), sizeof(TCHAR), source.path_length,
+               file) != source.path_length)
+      return false;
+  }
+
+  for (const auto &i : airspaces.QueryAll())
+    if (!SaveAirspace(file, i))
+      return false;
+
+  return true;
+}
+
+bool
+SaveAirspaceCache(FileCache &cache, const AirspaceSources &sources,
+                  const Airspaces &airspaces)
+{
+  assert(!sources.empty());
+
+  FILE *file = cache.Save(airspace_cache_name, sources.front());
+  if (file == nullptr)
+    return false;
+
+  if (!SaveAirspaces(file, sources, airspaces)) {
+    cache.Cancel(airspace_cache_name, file);
+    return false;
+  }
+
+  return cache.Commit(airspace_cache_name, file);
+}
@@ -0,0 +1,61 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include "OS/Path.hpp"
+
+#include <vector>
+
+class FileCache;
+class Airspaces;
+
+/**
+ * The files which were parsed into an #Airspaces instance.  The cache
+ * is only used if all of them are unchanged.
+ */
+typedef std::vector<AllocatedPath> AirspaceSources;
+
+/**
+ * Load the airspaces from the binary cache, including their projected
+ * borders and envelopes.  This is much faster than parsing the
+ * source files.
+ *
+ * @param airspaces an empty instance
+ * @return true on success, false if the cache is missing, outdated
+ * or corrupt (the #Airspaces instance remains empty then)
+ */
+bool
+LoadAirspaceCache(FileCache &cache, const AirspaceSources &sources,
+                  Airspaces &airspaces);
+
+/**
+ * Save the airspaces (after Airspaces::Optimise()) to the binary
+ * cache.
+ */
+bool
+SaveAirspaceCache(FileCache &cache, const AirspaceSources &sources,
+                  const Airspaces &airspaces);
+
+#endif
@@ -23,17 +23,20 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
 #include "Language/Language.hpp"
 #include "LogFile.hpp"
 #include "OS/Path.hpp"
+#include "OS/Clock.hpp"
 #include "IO/FileLineReader.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "IO/MapFile.hpp"
 #include "Profile/Profile.hpp"
+#include "OS/FileUtil.hpp"
 
 #include <string.h>
 
@@ -74,15 +77,9 @@ try {
   return false;
 }
 
-void
-ReadAirspace(Airspaces &airspaces,
-             RasterTerrain *terrain,
-             const AtmosphericPressure &press,
-             OperationEnvironment &operation)
+static bool
+ParseAirspaceFiles(Airspaces &airspaces, OperationEnvironment &operation)
 {
-  LogFormat("ReadAirspace");
-  operation.SetText(_("Loading Airspace File..."));
-
   bool airspace_ok = false;
 
   AirspaceParser parser(airspaces);
@@ -101,8 +98,67 @@ ReadAirspace(Airspaces &airspaces,
     airspace_ok |= ParseAirspaceFile(parser, archive->get(), "airspace.txt",
                                      operation);
 
+  return airspace_ok;
+}
+
+/**
+ * Collect the paths of all files which ParseAirspaceFiles() reads.
+ * The map file is included because it may contain airspaces.
+ */
+static AirspaceSources
+GetAirspaceSources()
+{
+  AirspaceSources sources;
+
+  auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
+  if (!path.IsNull())
+    sources.emplace_back(std::move(path));
+
+  path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
+  if (!path.IsNull())
+    sources.emplace_back(std::move(path));
+
+  path = Profile::GetPath(ProfileKeys::MapFile);
+  if (!path.IsNull() && File::Exists(path))
+    sources.emplace_back(std::move(path));
+
+  return sources;
+}
+
+void
+ReadAirspace(Airspaces &airspaces,
+             FileCache *cache,
+             RasterTerrain *terrain,
+             const AtmosphericPressure &press,
+             OperationEnvironment &operation)
+{
+  LogFormat("ReadAirspace");
+  operation.SetText(_("Loading Airspace File..."));
+
+  const unsigned start_time = MonotonicClockMS();
+
+  bool airspace_ok = false;
+
+  const AirspaceSources sources = GetAirspaceSources();
+  if (cache != nullptr && !sources.empty() &&
+      LoadAirspaceCache(*cache, sources, airspaces)) {
+    airspace_ok = true;
+    LogFormat("Loaded %u airspaces from the cache in %u ms",
+              airspaces.GetSize(), MonotonicClockMS() - start_time);
+  } else {
+    airspace_ok = ParseAirspaceFiles(airspaces, operation);
+    if (airspace_ok) {
+      airspaces.Optimise();
+      LogFormat("Parsed %u airspaces in %u ms",
+                airspaces.GetSize(), MonotonicClockMS() - start_time);
+
+      if (cache != nullptr && !sources.empty() &&
+          !SaveAirspaceCache(*cache, sources, airspaces))
+        LogFormat("Failed to save the airspace cache");
+    }
+  }
+
   if (airspace_ok) {
-    airspaces.Optimise();
     airspaces.SetFlightLevels(press);
 
     if (terrain != NULL)
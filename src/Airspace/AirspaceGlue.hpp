@@ -24,6 +24,7 @@ Copyright_License {
 #ifndef XCSOAR_AIRSPACE_GLUE_HPP
 #define XCSOAR_AIRSPACE_GLUE_HPP
 
+class FileCache;
 class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
@@ -31,9 +32,13 @@ class OperationEnvironment;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then the parsed airspaces are loaded
+ * from (or saved to) this cache
  */
 void
 ReadAirspace(Airspaces &airspaces,
+             FileCache *cache,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
              OperationEnvironment &operation);
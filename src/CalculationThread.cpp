@@ -27,6 +27,7 @@ Copyright_License {
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "Components.hpp"
 #include "Hardware/CPU.hpp"
+#include "Thread/Timeline.hpp"
 
 /**
  * Constructor of the CalculationThread class
@@ -58,6 +59,8 @@ CalculationThread::SetScreenDistanceMeters(double new_value)
 void
 CalculationThread::Tick()
 {
+  const ScopeTimelineSpan timeline("CalculationThread::Tick");
+
 #ifdef HAVE_CPU_FREQUENCY
   const ScopeLockCPU cpu;
 #endif
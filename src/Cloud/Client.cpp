@@ -28,6 +28,8 @@ Copyright_License {
 #include "Tracking/SkyLines/Assemble.hpp"
 #include "Tracking/SkyLines/Import.hpp"
 
+#include <boost/version.hpp>
+
 CloudClientContainer::CloudClientContainer()
   :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)) {}
 
@@ -61,8 +63,9 @@ CloudClientContainer::Make(const boost::asio::ip::udp::endpoint &endpoint,
   auto result = key_set.insert_check(key, key_set.hash_function(),
                                      key_set.key_eq(), hint);
   if (result.second) {
-    auto client = std::make_shared<CloudClient>(endpoint, key, next_id++,
+    auto client = std::make_shared<CloudClient>(endpoint, key, next_id,
                                                 location, altitude);
+    next_id += id_step;
     Insert(*client);
     return *client;
   } else {
@@ -108,6 +111,23 @@ CloudClientContainer::Insert(CloudClient &client)
   rtree.insert(client.shared_from_this());
 }
 
+void
+CloudClientContainer::Restore(const CloudClient &src)
+{
+  CloudClient *client = Find(src.key);
+  if (client == nullptr) {
+    auto ptr = std::make_shared<CloudClient>(src);
+    Insert(*ptr);
+    client = ptr.get();
+  } else
+    Refresh(*client, src.endpoint, src.location, src.altitude);
+
+  client->stamp = src.stamp;
+
+  if (src.id >= next_id)
+    next_id = src.id + 1;
+}
+
 void
 CloudClientContainer::Remove(CloudClient &client)
 {
@@ -142,7 +162,13 @@ operator<<(Serialiser &s, const boost::asio::ip::udp::endpoint &endpoint)
 inline Deserialiser &
 operator>>(Deserialiser &s, boost::asio::ip::udp::endpoint &endpoint)
 {
+#if BOOST_VERSION >= 106600
+  /* address::from_string() is deprecated and unavailable with
+     BOOST_NO_IOSTREAM */
+  endpoint.address(boost::asio::ip::make_address(s.ReadString()));
+#else
   endpoint.address(boost::asio::ip::address::from_string(s.ReadString()));
+#endif
   endpoint.port(s.Read16());
   return s;
 }
@@ -196,9 +222,10 @@ CloudClientContainer::Save(Serialiser &s) const
 {
   s.Write32(next_id);
 
-  for (const auto &client : list) {
+  /* oldest first, because Load() inserts each client at the front */
+  for (auto i = list.rbegin(), end = list.rend(); i != end; ++i) {
     s.Write8(1);
-    client.Save(s);
+    i->Save(s);
   }
 
   s.Write8(0);
@@ -204,6 +204,13 @@ class CloudClientContainer {
    */
   unsigned next_id = 1;
 
+  /**
+   * The difference between two consecutive public ids assigned by
+   * this container.  This is larger than 1 if several containers
+   * share the id space, see SetIdSequence().
+   */
+  unsigned id_step = 1;
+
   static constexpr size_t N_KEY_BUCKETS = 65521;
   typename KeySet::bucket_type key_buckets[N_KEY_BUCKETS];
 
@@ -217,6 +224,20 @@ public:
     return list.empty();
   }
 
+  unsigned GetNextId() const {
+    return next_id;
+  }
+
+  /**
+   * Configure the public ids assigned to new clients: the first one
+   * is #first, and each following id is #step larger.  This allows
+   * several containers to assign ids without conflicts.
+   */
+  void SetIdSequence(unsigned first, unsigned step) {
+    next_id = first;
+    id_step = step;
+  }
+
   /**
    * For iteration over the list of all clients in unspecified order.
    * The iterators get invalidated by all modifying calls.
@@ -251,6 +272,13 @@ public:
 
   void Insert(CloudClient &client);
 
+  /**
+   * Insert a copy of the given client (e.g. loaded from a journal),
+   * or replace the state of the existing client with the same key.
+   * The client becomes the most recent one.
+   */
+  void Restore(const CloudClient &client);
+
   /**
    * Remove a #CloudClient and its data.  Be careful - the given reference
    * is invalidated, unless the caller holds another #CloudClientPtr.
@@ -259,6 +287,18 @@ public:
 
   void Expire(std::chrono::steady_clock::time_point before);
 
+  /**
+   * Like Expire(), but invoke the given function for each client
+   * before it gets removed.
+   */
+  template<typename F>
+  void Expire(std::chrono::steady_clock::time_point before, F &&f) {
+    while (!list.empty() && list.back().stamp < before) {
+      f(list.back());
+      Remove(list.back());
+    }
+  }
+
   typedef Tree::const_query_iterator query_iterator;
   typedef boost::iterator_range<query_iterator> query_iterator_range;
 
@@ -33,7 +33,7 @@ using std::cerr;
 using std::endl;
 
 static constexpr uint32_t CLOUD_MAGIC = 0x5753f60f;
-static constexpr uint32_t CLOUD_VERSION = 1;
+static constexpr uint32_t CLOUD_VERSION = 2;
 
 void
 CloudData::DumpClients()
@@ -50,29 +50,36 @@ CloudData::DumpClients()
 }
 
 void
-CloudData::Save(Serialiser &s) const
+CloudData::Save(Serialiser &s, uint64_t generation) const
 {
   s.Write32(CLOUD_MAGIC);
   s.Write32(CLOUD_VERSION);
+  s.Write64(generation);
   clients.Save(s);
   s.Write8(1);
   thermals.Save(s);
   s.Write8(0);
 }
 
-void
+uint64_t
 CloudData::Load(Deserialiser &s)
 {
   if (s.Read32() != CLOUD_MAGIC)
     throw std::runtime_error("Bad magic");
 
-  if (s.Read32() != CLOUD_VERSION)
+  /* version 1 had no journal */
+  const uint32_t version = s.Read32();
+  if (version != 1 && version != CLOUD_VERSION)
     throw std::runtime_error("Bad version");
 
+  const uint64_t generation = version >= 2 ? s.Read64() : 0;
+
   clients.Load(s);
 
   if (s.Read8() != 0) {
     thermals.Load(s);
     s.Read8();
   }
+
+  return generation;
 }
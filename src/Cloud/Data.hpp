@@ -27,6 +27,8 @@ Copyright_License {
 #include "Client.hpp"
 #include "Thermal.hpp"
 
+#include <stdint.h>
+
 class Serialiser;
 class Deserialiser;
 
@@ -36,8 +38,16 @@ struct CloudData {
 
   void DumpClients();
 
-  void Save(Serialiser &s) const;
-  void Load(Deserialiser &s);
+  /**
+   * @param generation the generation of the first journal which is
+   * not contained in this snapshot (see #CloudJournal)
+   */
+  void Save(Serialiser &s, uint64_t generation=0) const;
+
+  /**
+   * @return the journal generation passed to Save()
+   */
+  uint64_t Load(Deserialiser &s);
 };
 
 #endif
@@ -0,0 +1,256 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Database.hpp"
+#include "Data.hpp"
+#include "Serialiser.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/FileReader.hxx"
+#include "OS/FileUtil.hpp"
+#include "Util/PrintException.hxx"
+
+#include <string>
+#include <iostream>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+/**
+ * Compact the journal when it has grown beyond this size [bytes].
+ */
+static constexpr uint64_t MAX_JOURNAL_SIZE = 64 * 1024 * 1024;
+
+/**
+ * Compact the journal at least this often.
+ */
+static constexpr std::chrono::steady_clock::duration COMPACTION_INTERVAL =
+  std::chrono::minutes(10);
+
+/**
+ * Load the snapshot, if it exists.
+ *
+ * @return the snapshot's generation
+ */
+static uint64_t
+LoadSnapshot(Path path, CloudData &data)
+{
+  if (!File::Exists(path))
+    return 0;
+
+  FileReader fr(path);
+  Deserialiser s(fr);
+  return data.Load(s);
+}
+
+static void
+SaveSnapshot(Path path, const CloudData &data, uint64_t generation)
+{
+  FileOutputStream fos(path);
+
+  {
+    Serialiser s(fos);
+    data.Save(s, generation);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+/**
+ * Replay the journal, if it exists.
+ *
+ * @return the journal's generation, or 0 if it does not exist
+ */
+static uint64_t
+ReplayJournal(Path path, CloudData &data, uint64_t min_generation)
+{
+  return File::Exists(path)
+    ? CloudJournal::Replay(path, data, min_generation)
+    : 0;
+}
+
+/**
+ * Move a file which could not be loaded out of the way, so it can be
+ * inspected and recovered manually.  Refuses to overwrite an older
+ * copy.
+ */
+static void
+MoveAside(Path path)
+{
+  if (!File::Exists(path))
+    return;
+
+  const auto corrupt_path = path + ".corrupt";
+  if (File::Exists(corrupt_path))
+    throw std::runtime_error(std::string(corrupt_path.c_str()) +
+                             " already exists");
+
+  if (!File::Rename(path, corrupt_path))
+    throw std::runtime_error(std::string("Failed to rename ") +
+                             path.c_str());
+
+  cerr << "Moved " << path.c_str() << " to "
+       << corrupt_path.c_str() << endl;
+}
+
+CloudDatabase::CloudDatabase(Path _path)
+  :path(_path),
+   journal_path(path + ".journal"),
+   old_journal_path(path + ".journal.old"),
+   compacting(false)
+{
+}
+
+CloudDatabase::~CloudDatabase()
+{
+  if (journal.IsOpen())
+    compact_thread.Stop();
+}
+
+void
+CloudDatabase::Open(CloudData &data)
+{
+  uint64_t max_generation = 0;
+
+  try {
+    max_generation = LoadSnapshot(path, data);
+    const uint64_t snapshot_generation = max_generation;
+
+    max_generation = std::max(max_generation,
+                              ReplayJournal(old_journal_path, data,
+                                            snapshot_generation));
+    max_generation = std::max(max_generation,
+                              ReplayJournal(journal_path, data,
+                                            snapshot_generation));
+  } catch (const std::runtime_error &e) {
+    cerr << "Failed to load database" << endl;
+    PrintException(e);
+
+    /* the new snapshot will contain only what has been loaded so
+       far; keep the original files instead of deleting them below */
+    MoveAside(path);
+    MoveAside(old_journal_path);
+    MoveAside(journal_path);
+  }
+
+  /* start with a fresh snapshot, so the journals can be deleted */
+  generation = max_generation + 1;
+  SaveSnapshot(path, data, generation);
+  File::Delete(old_journal_path);
+  File::Delete(journal_path);
+
+  journal.Open(journal_path, generation);
+  last_compaction = std::chrono::steady_clock::now();
+
+  if (!compact_thread.Start()) {
+    journal.Close();
+    throw std::runtime_error("Failed to start thread");
+  }
+}
+
+void
+CloudDatabase::Flush()
+{
+  journal.Flush();
+
+  if (journal.GetSize() >= MAX_JOURNAL_SIZE ||
+      std::chrono::steady_clock::now() >= last_compaction + COMPACTION_INTERVAL)
+    StartCompaction();
+}
+
+void
+CloudDatabase::Rotate()
+{
+  journal.Close();
+
+  if (!File::Replace(journal_path, old_journal_path))
+    throw std::runtime_error("Failed to rename journal");
+
+  ++generation;
+  journal.Open(journal_path, generation);
+}
+
+void
+CloudDatabase::Compact(uint64_t snapshot_generation) const
+{
+  std::unique_ptr<CloudData> data(new CloudData());
+  const uint64_t old_generation = LoadSnapshot(path, *data);
+  ReplayJournal(old_journal_path, *data, old_generation);
+
+  SaveSnapshot(path, *data, snapshot_generation);
+  File::Delete(old_journal_path);
+}
+
+void
+CloudDatabase::StartCompaction()
+{
+  if (compacting)
+    return;
+
+  last_compaction = std::chrono::steady_clock::now();
+
+  /* if the previous compaction has failed, retry it before rotating
+     again */
+  if (!File::Exists(old_journal_path))
+    Rotate();
+
+  /* the new snapshot contains everything before the current
+     journal */
+  const uint64_t snapshot_generation = generation;
+
+  compacting = true;
+  compact_thread.Get().post([this, snapshot_generation](){
+      try {
+        Compact(snapshot_generation);
+      } catch (const std::runtime_error &e) {
+        /* the old journal is kept, and will be merged by the next
+           compaction */
+        PrintException(e);
+      }
+
+      compacting = false;
+    });
+}
+
+void
+CloudDatabase::Close()
+{
+  if (!journal.IsOpen())
+    return;
+
+  /* wait for the running compaction to finish */
+  compact_thread.Stop();
+
+  journal.Close();
+
+  cout << "Saving data to " << path.c_str() << endl;
+
+  if (File::Exists(old_journal_path))
+    Compact(generation);
+
+  if (!File::Replace(journal_path, old_journal_path))
+    throw std::runtime_error("Failed to rename journal");
+
+  Compact(generation + 1);
+}
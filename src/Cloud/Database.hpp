@@ -0,0 +1,121 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_DATABASE_HPP
+#define XCSOAR_CLOUD_DATABASE_HPP
+
+#include "Journal.hpp"
+#include "IO/Async/AsioThread.hpp"
+#include "OS/Path.hpp"
+
+#include <chrono>
+#include <atomic>
+
+struct CloudData;
+
+/**
+ * The persistent storage of the cloud server.  It consists of a
+ * snapshot (written by CloudData::Save()) and a #CloudJournal with
+ * all changes since then.  Compaction (i.e. merging the journal into
+ * a new snapshot) runs in a separate thread, and does not need access
+ * to the live data: it loads the previous snapshot, replays the
+ * journal and saves the result.
+ *
+ * Files: the snapshot at the configured path, the current journal
+ * with the suffix ".journal", and the journal being compacted with
+ * the suffix ".journal.old".
+ */
+class CloudDatabase {
+  const AllocatedPath path, journal_path, old_journal_path;
+
+  CloudJournal journal;
+
+  /**
+   * The generation of the current journal.
+   */
+  uint64_t generation = 0;
+
+  std::chrono::steady_clock::time_point last_compaction;
+
+  /**
+   * Is a compaction running in #compact_thread?
+   */
+  std::atomic<bool> compacting;
+
+  AsioThread compact_thread;
+
+public:
+  explicit CloudDatabase(Path _path);
+  ~CloudDatabase();
+
+  CloudJournal &GetJournal() {
+    return journal;
+  }
+
+  /**
+   * Load the snapshot and the journals, compact them and open a new
+   * journal.  Must be called before any other method.
+   *
+   * If loading fails, the files are renamed with the suffix
+   * ".corrupt", and the server starts with the data which could be
+   * loaded.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void Open(CloudData &data);
+
+  /**
+   * Write the pending journal records, and start a compaction if the
+   * journal has become too large or too old.  Call this once per
+   * second.
+   */
+  void Flush();
+
+  /**
+   * Start compacting the current journal in the background.  Does
+   * nothing if a compaction is already running.
+   */
+  void StartCompaction();
+
+  /**
+   * Merge everything into the snapshot and close the journal.
+   */
+  void Close();
+
+private:
+  /**
+   * Move the current journal to #old_journal_path and open a new
+   * one.
+   */
+  void Rotate();
+
+  /**
+   * Merge #old_journal_path into the snapshot.
+   *
+   * @param snapshot_generation the generation of the first journal
+   * not contained in the new snapshot
+   */
+  void Compact(uint64_t snapshot_generation) const;
+};
+
+#endif
@@ -0,0 +1,195 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Journal.hpp"
+#include "Data.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/FileReader.hxx"
+#include "OS/Path.hpp"
+
+#include <assert.h>
+
+static constexpr uint32_t JOURNAL_MAGIC = 0x5753f610;
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+enum class JournalRecord : uint8_t {
+  CLIENT = 1,
+  REMOVE_CLIENT = 2,
+  THERMAL = 3,
+};
+
+void
+CloudJournal::Buffer::Write(const void *p, size_t length)
+{
+  const uint8_t *src = (const uint8_t *)p;
+  data.insert(data.end(), src, src + length);
+}
+
+CloudJournal::CloudJournal()
+  :serialiser(buffer), size(0)
+{
+}
+
+CloudJournal::~CloudJournal()
+{
+}
+
+void
+CloudJournal::Open(Path path, uint64_t generation)
+{
+  assert(!IsOpen());
+
+  file.reset(new FileOutputStream(path,
+                                  FileOutputStream::Mode::CREATE_VISIBLE));
+
+  Buffer header;
+  {
+    Serialiser s(header);
+    s.Write32(JOURNAL_MAGIC);
+    s.Write32(JOURNAL_VERSION);
+    s.Write64(generation);
+    s.Flush();
+  }
+
+  file->Write(header.data.data(), header.data.size());
+  size = header.data.size();
+}
+
+void
+CloudJournal::Close()
+{
+  if (!IsOpen())
+    return;
+
+  Flush();
+  file->Commit();
+  file.reset();
+}
+
+void
+CloudJournal::Flush()
+{
+  assert(IsOpen());
+
+  std::vector<uint8_t> data;
+
+  {
+    const ScopeLock protect(mutex);
+    serialiser.Flush();
+    data.swap(buffer.data);
+  }
+
+  if (data.empty())
+    return;
+
+  file->Write(data.data(), data.size());
+  size += data.size();
+}
+
+void
+CloudJournal::AddClient(const CloudClient &client)
+{
+  const ScopeLock protect(mutex);
+  serialiser.Write8(uint8_t(JournalRecord::CLIENT));
+  client.Save(serialiser);
+}
+
+void
+CloudJournal::RemoveClient(uint64_t key)
+{
+  const ScopeLock protect(mutex);
+  serialiser.Write8(uint8_t(JournalRecord::REMOVE_CLIENT));
+  serialiser.Write64(key);
+}
+
+void
+CloudJournal::AddThermal(const CloudThermal &thermal)
+{
+  const ScopeLock protect(mutex);
+  serialiser.Write8(uint8_t(JournalRecord::THERMAL));
+  thermal.Save(serialiser);
+}
+
+/**
+ * Read and apply one record.
+ *
+ * @return false if the end of the journal has been reached
+ */
+static bool
+ReplayRecord(Deserialiser &s, CloudData &data)
+{
+  uint8_t type;
+
+  try {
+    type = s.Read8();
+  } catch (const std::runtime_error &) {
+    /* end of file */
+    return false;
+  }
+
+  try {
+    switch (JournalRecord(type)) {
+    case JournalRecord::CLIENT:
+      data.clients.Restore(CloudClient::Load(s));
+      return true;
+
+    case JournalRecord::REMOVE_CLIENT:
+      {
+        auto *client = data.clients.Find(s.Read64());
+        if (client != nullptr)
+          data.clients.Remove(*client);
+      }
+      return true;
+
+    case JournalRecord::THERMAL:
+      data.thermals.Restore(CloudThermal::Load(s));
+      return true;
+    }
+  } catch (const std::runtime_error &) {
+    /* the last record was truncated by a crash */
+    return false;
+  }
+
+  throw std::runtime_error("Malformed journal");
+}
+
+uint64_t
+CloudJournal::Replay(Path path, CloudData &data, uint64_t min_generation)
+{
+  FileReader fr(path);
+  Deserialiser s(fr);
+
+  if (s.Read32() != JOURNAL_MAGIC)
+    throw std::runtime_error("Bad journal magic");
+
+  if (s.Read32() != JOURNAL_VERSION)
+    throw std::runtime_error("Bad journal version");
+
+  const uint64_t generation = s.Read64();
+  if (generation < min_generation)
+    return generation;
+
+  while (ReplayRecord(s, data)) {}
+
+  return generation;
+}
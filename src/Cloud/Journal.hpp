@@ -0,0 +1,144 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_JOURNAL_HPP
+#define XCSOAR_CLOUD_JOURNAL_HPP
+
+#include "Serialiser.hpp"
+#include "IO/OutputStream.hxx"
+#include "Thread/Mutex.hpp"
+
+#include <vector>
+#include <memory>
+
+#include <stdint.h>
+
+class Path;
+class FileOutputStream;
+struct CloudClient;
+struct CloudThermal;
+struct CloudData;
+
+/**
+ * An append-only log of changes to the cloud server's data.  The
+ * shards add records while they modify their data; the records are
+ * collected in memory and written to the file by Flush(), which is
+ * supposed to be called periodically.
+ *
+ * Each journal file has a generation number; a snapshot written by
+ * CloudData::Save() contains all journals with a smaller generation.
+ */
+class CloudJournal {
+  /**
+   * An #OutputStream which appends to a memory buffer.
+   */
+  class Buffer final : public OutputStream {
+  public:
+    std::vector<uint8_t> data;
+
+    /* virtual methods from class OutputStream */
+    void Write(const void *data, size_t size) override;
+  };
+
+  /**
+   * Protects #buffer and #serialiser.
+   */
+  Mutex mutex;
+
+  Buffer buffer;
+  Serialiser serialiser;
+
+  /**
+   * The file which is currently being appended to.  Only accessed by
+   * the thread calling Open(), Flush() and Close().
+   */
+  std::unique_ptr<FileOutputStream> file;
+
+  uint64_t size;
+
+public:
+  CloudJournal();
+  ~CloudJournal();
+
+  /**
+   * Create a new journal file.  Records which have been added before
+   * will be written to it, too.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void Open(Path path, uint64_t generation);
+
+  /**
+   * Flush and close the journal file.
+   */
+  void Close();
+
+  bool IsOpen() const {
+    return file != nullptr;
+  }
+
+  /**
+   * Returns the number of bytes written to the current file.
+   */
+  uint64_t GetSize() const {
+    return size;
+  }
+
+  /**
+   * Write all pending records to the file.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void Flush();
+
+  /**
+   * Record the new state of a client.  Thread-safe.
+   */
+  void AddClient(const CloudClient &client);
+
+  /**
+   * Record the removal of a client.  Thread-safe.
+   */
+  void RemoveClient(uint64_t key);
+
+  /**
+   * Record a new thermal.  Thread-safe.
+   */
+  void AddThermal(const CloudThermal &thermal);
+
+  /**
+   * Apply the records of a journal file to the data.  A truncated
+   * record at the end (after a crash) is ignored.
+   *
+   * Throws std::runtime_error if the file cannot be opened or is
+   * malformed.
+   *
+   * @param min_generation ignore the file if its generation is
+   * smaller than this, because the snapshot contains it already
+   * @return the generation of the file
+   */
+  static uint64_t Replay(Path path, CloudData &data,
+                         uint64_t min_generation);
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program simulates many SkyLines tracking clients flying in
+ * the same area, to measure the throughput and the latency of the
+ * cloud server.  Each simulated client requests traffic and then
+ * submits fixes at a fixed rate; the server forwards each fix to the
+ * other clients within range.
+ *
+ * The altitude of each fix is a sequence number which the server
+ * echoes back in the traffic responses; this allows measuring the
+ * delay between sending a fix and receiving it as traffic.  Note that
+ * the responses to traffic requests contain older fixes, which show
+ * up in the tail of the latency distribution.
+ */
+
+#include "Tracking/SkyLines/Client.hpp"
+#include "Tracking/SkyLines/Handler.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "Util/NumberParser.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * The number of sockets shared by the simulated clients.  The server
+ * identifies clients by their key, so many of them can share one
+ * socket; using several sockets distributes the load among the
+ * server threads.
+ */
+static constexpr unsigned N_SOCKETS = 16;
+
+/**
+ * The fix sequence number is transmitted as altitude, which is a
+ * signed 16 bit integer.
+ */
+static constexpr unsigned N_SEQUENCE = 30000;
+
+static constexpr std::chrono::milliseconds TICK(10);
+
+/* renew the traffic request well before it expires on the server */
+static constexpr std::chrono::seconds TRAFFIC_REQUEST_INTERVAL(60);
+
+struct Pilot {
+  uint64_t key;
+  GeoPoint location;
+  Angle track;
+
+  /**
+   * When was the last traffic request sent?
+   */
+  Clock::time_point traffic_request;
+};
+
+class LoadGenerator final : SkyLinesTracking::Handler {
+  boost::asio::steady_timer timer;
+
+  std::vector<std::unique_ptr<SkyLinesTracking::Client>> sockets;
+
+  std::vector<Pilot> pilots;
+
+  const unsigned fixes_per_second;
+  const Clock::duration duration;
+
+  Clock::time_point start;
+
+  /**
+   * The time each sequence number was sent.
+   */
+  std::vector<Clock::time_point> send_times;
+
+  uint64_t n_sent = 0, n_received = 0;
+
+  /**
+   * All measured latencies [us].
+   */
+  std::vector<unsigned> latencies;
+
+  std::mt19937 random;
+
+public:
+  LoadGenerator(boost::asio::io_service &io_service,
+                boost::asio::ip::udp::endpoint endpoint,
+                unsigned n_pilots, unsigned _fixes_per_second,
+                Clock::duration _duration)
+    :timer(io_service),
+     fixes_per_second(_fixes_per_second), duration(_duration),
+     send_times(N_SEQUENCE) {
+    for (unsigned i = 0; i < N_SOCKETS; ++i) {
+      sockets.emplace_back(new SkyLinesTracking::Client(io_service, this));
+      if (!sockets.back()->Open(endpoint))
+        throw std::runtime_error("Failed to open socket");
+    }
+
+    /* spread the pilots over an area of about 300 km, which covers
+       several server shards */
+    std::uniform_real_distribution<double> lat(45.5, 48.5), lon(8., 12.);
+    std::uniform_real_distribution<double> track(0, 360);
+    for (unsigned i = 0; i < n_pilots; ++i)
+      pilots.push_back({0x10000 + i,
+            GeoPoint(Angle::Degrees(lon(random)),
+                     Angle::Degrees(lat(random))),
+            Angle::Degrees(track(random)),
+            Clock::time_point()});
+  }
+
+  void Start() {
+    start = Clock::now();
+    ScheduleTick();
+  }
+
+  void PrintReport() const;
+
+private:
+  SkyLinesTracking::Client &GetSocket(unsigned pilot) {
+    return *sockets[pilot % N_SOCKETS];
+  }
+
+  void SendFix(unsigned i) {
+    Pilot &pilot = pilots[i];
+
+    /* fly along a circle at about 100 km/h */
+    pilot.track += Angle::Degrees(3);
+    pilot.location = GeoVector(28, pilot.track).EndPoint(pilot.location);
+
+    const auto now = Clock::now();
+    const unsigned sequence = n_sent++ % N_SEQUENCE;
+    send_times[sequence] = now;
+
+    using SkyLinesTracking::FixPacket;
+    GetSocket(i).SendPacket(SkyLinesTracking::MakeFix(pilot.key,
+                                                      FixPacket::FLAG_LOCATION |
+                                                      FixPacket::FLAG_ALTITUDE,
+                                                      0, pilot.location,
+                                                      pilot.track, 28, 28,
+                                                      sequence, 0, 0));
+
+    /* the server ignores traffic requests from unknown clients, so
+       the first one is sent after the first fix; sending them along
+       with the fixes avoids flooding the server's socket buffer */
+    if (now - pilot.traffic_request >= TRAFFIC_REQUEST_INTERVAL) {
+      GetSocket(i).SendPacket(SkyLinesTracking::MakeTrafficRequest(pilot.key,
+                                                                   false, false,
+                                                                   true));
+      pilot.traffic_request = now;
+    }
+  }
+
+  void ScheduleTick() {
+    timer.expires_from_now(TICK);
+    timer.async_wait(std::bind(&LoadGenerator::OnTick, this,
+                               std::placeholders::_1));
+  }
+
+  void OnTick(const boost::system::error_code &ec);
+
+  /* virtual methods from class SkyLinesTracking::Handler */
+  void OnTraffic(uint32_t pilot_id, unsigned time_of_day_ms,
+                 const ::GeoPoint &location, int altitude) override;
+
+  void OnSkyLinesError(const std::exception &e) override {
+    fprintf(stderr, "Error: %s\n", e.what());
+    timer.get_io_service().stop();
+  }
+};
+
+void
+LoadGenerator::OnTick(const boost::system::error_code &ec)
+{
+  if (ec)
+    return;
+
+  const auto now = Clock::now();
+  const auto elapsed = now - start;
+
+  if (elapsed >= duration) {
+    /* wait a moment for the last responses */
+    timer.expires_from_now(std::chrono::seconds(1));
+    timer.async_wait([this](const boost::system::error_code &ec){
+        if (!ec)
+          timer.get_io_service().stop();
+      });
+    return;
+  }
+
+  /* catch up with the configured rate */
+  const uint64_t due = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count())
+    * fixes_per_second / 1000;
+  while (n_sent < due)
+    SendFix(n_sent % pilots.size());
+
+  ScheduleTick();
+}
+
+void
+LoadGenerator::OnTraffic(uint32_t pilot_id, unsigned time_of_day_ms,
+                         const ::GeoPoint &location, int altitude)
+{
+  if (altitude < 0 || unsigned(altitude) >= N_SEQUENCE)
+    return;
+
+  /* ignore stale clients loaded from the server's database */
+  const auto send_time = send_times[altitude];
+  if (send_time == Clock::time_point())
+    return;
+
+  ++n_received;
+
+  const auto latency = Clock::now() - send_time;
+  latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+static double
+Percentile(std::vector<unsigned> &v, double p)
+{
+  if (v.empty())
+    return 0;
+
+  auto i = v.begin() + std::min(v.size() - 1, size_t(v.size() * p));
+  std::nth_element(v.begin(), i, v.end());
+  return *i / 1000.;
+}
+
+void
+LoadGenerator::PrintReport() const
+{
+  const double seconds =
+    std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() / 1000.;
+
+  std::vector<unsigned> v(latencies);
+
+  printf("clients=%u sockets=%u duration=%.1fs\n",
+         unsigned(pilots.size()), N_SOCKETS, seconds);
+  printf("fixes sent=%llu (%.0f/s)\n",
+         (unsigned long long)n_sent, n_sent / seconds);
+  printf("traffic received=%llu (%.0f/s, fan-out %.1f)\n",
+         (unsigned long long)n_received, n_received / seconds,
+         n_sent > 0 ? double(n_received) / n_sent : 0.);
+  printf("fan-out latency p50=%.3fms p99=%.3fms max=%.3fms\n",
+         Percentile(v, 0.5), Percentile(v, 0.99),
+         v.empty() ? 0. : *std::max_element(v.begin(), v.end()) / 1000.);
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[HOST] [CLIENTS] [SECONDS] [FIXES_PER_SECOND]");
+  const char *host = args.IsEmpty() ? "127.0.0.1" : args.GetNext();
+  const unsigned n_pilots = args.IsEmpty()
+    ? 2000 : ParseUnsigned(args.GetNext());
+  const unsigned seconds = args.IsEmpty()
+    ? 10 : ParseUnsigned(args.GetNext());
+  const unsigned fixes_per_second = args.IsEmpty()
+    ? 2000 : ParseUnsigned(args.GetNext());
+  args.ExpectEnd();
+
+  if (n_pilots == 0 || seconds == 0)
+    args.UsageError();
+
+  const boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::address::from_string(host),
+                                                SkyLinesTracking::Client::GetDefaultPort());
+
+  boost::asio::io_service io_service;
+
+  LoadGenerator generator(io_service, endpoint, n_pilots, fixes_per_second,
+                          std::chrono::seconds(seconds));
+  generator.Start();
+
+  io_service.run();
+
+  generator.PrintReport();
+  return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+  fprintf(stderr, "%s\n", e.what());
+  return EXIT_FAILURE;
+}
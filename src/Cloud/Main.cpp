@@ -21,15 +21,12 @@ Copyright_License {
 }
 */
 
+#include "ShardSet.hpp"
+#include "Database.hpp"
 #include "Data.hpp"
-#include "Dump.hpp"
-#include "Sender.hpp"
-#include "Serialiser.hpp"
 #include "Tracking/SkyLines/Server.hpp"
-#include "Tracking/SkyLines/Protocol.hpp"
-#include "OS/ByteOrder.hpp"
-#include "IO/FileOutputStream.hxx"
-#include "IO/FileReader.hxx"
+#include "Thread/ThreadPool.hpp"
+#include "Util/NumberParser.hpp"
 #include "Util/PrintException.hxx"
 #include "Compiler.h"
 
@@ -39,133 +36,129 @@ Copyright_License {
 
 #include <boost/asio/steady_timer.hpp>
 
-#include <array>
 #include <iostream>
-#include <iomanip>
-
-// TODO: review these settings
-static constexpr double TRAFFIC_RANGE = 50000;
-static constexpr double THERMAL_RANGE = 50000;
-
-static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
-static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
-
-static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
 
 using std::cout;
 using std::cerr;
 using std::endl;
 
+/**
+ * The main thread of the cloud server: it writes the database journal
+ * periodically and handles signals, while the #CloudShardSet threads
+ * handle the clients.
+ */
 class CloudServer final
-  : public SkyLinesTracking::Server,
 #ifdef __linux__
-    SignalListener,
+  : SignalListener
 #endif
-    CloudData
 {
-  const AllocatedPath db_path;
+  CloudDatabase database;
 
-  boost::asio::steady_timer save_timer, expire_timer;
+  CloudShardSet shards;
+
+  boost::asio::steady_timer flush_timer, statistics_timer;
+
+  /**
+   * The send counters at the time of the last PrintStatistics()
+   * call.
+   */
+  std::chrono::steady_clock::time_point statistics_time;
+  uint64_t statistics_packets = 0, statistics_calls = 0;
 
 public:
-  CloudServer(AllocatedPath &&_db_path, boost::asio::io_service &io_service,
-              boost::asio::ip::udp::endpoint endpoint)
-    :SkyLinesTracking::Server(io_service, endpoint),
+  CloudServer(Path db_path, boost::asio::io_service &io_service,
+              boost::asio::ip::udp::endpoint endpoint,
+              unsigned n_threads)
+    :
 #ifdef __linux__
     SignalListener(io_service),
 #endif
-    db_path(std::move(_db_path)),
-    save_timer(io_service),
-    expire_timer(io_service)
+    database(db_path),
+    shards(io_service, database.GetJournal(), endpoint, n_threads),
+    flush_timer(io_service), statistics_timer(io_service)
   {
 #ifdef __linux__
     SignalListener::Create(SIGTERM, SIGINT, SIGHUP, SIGUSR1);
 #endif
 
-    ScheduleSave();
+    statistics_time = std::chrono::steady_clock::now();
+    ScheduleFlush();
+    ScheduleStatistics();
   }
 
-  using SkyLinesTracking::Server::get_io_service;
+  unsigned GetThreadCount() const {
+    return shards.size();
+  }
 
+  void Start() {
+    shards.Start();
+  }
+
+  void Stop() {
+    shards.Stop();
+  }
+
+  /**
+   * Load the database and open its journal.
+   */
   void Load();
-  void Save();
+
+  /**
+   * Merge the journal into the database snapshot.  Call after Stop().
+   */
+  void Close() {
+    database.Close();
+  }
+
+  /**
+   * Print the rate of datagrams sent and system calls made since the
+   * last call.
+   */
+  void PrintStatistics();
 
 private:
-  void ScheduleSave() {
-    save_timer.expires_from_now(std::chrono::minutes(1));
-    save_timer.async_wait([this](const boost::system::error_code &ec){
+  /**
+   * Write the journal once per second; this is the maximum amount of
+   * data lost when the server crashes.
+   */
+  void ScheduleFlush() {
+    flush_timer.expires_from_now(std::chrono::seconds(1));
+    flush_timer.async_wait([this](const boost::system::error_code &ec){
         if (ec)
           return;
 
-        Save();
-        ScheduleSave();
+        database.Flush();
+        ScheduleFlush();
       });
   }
 
-  void ScheduleExpire() {
-    expire_timer.expires_from_now(std::chrono::minutes(5));
-    expire_timer.async_wait([this](const boost::system::error_code &ec){
+  void ScheduleStatistics() {
+    statistics_timer.expires_from_now(std::chrono::minutes(1));
+    statistics_timer.async_wait([this](const boost::system::error_code &ec){
         if (ec)
           return;
 
-        clients.Expire(expire_timer.expires_at() - std::chrono::minutes(10));
-        if (!clients.empty())
-          ScheduleExpire();
+        PrintStatistics();
+        ScheduleStatistics();
       });
   }
 
 protected:
-  /* virtual methods from class SkyLinesTracking::Server */
-  void OnFix(const Client &client,
-             std::chrono::milliseconds time_of_day,
-             const ::GeoPoint &location, int altitude) override;
-
-  void OnTrafficRequest(const Client &client,
-                        bool near) override;
-
-  void OnWaveSubmit(const Client &client,
-                    std::chrono::milliseconds time_of_day,
-                    const ::GeoPoint &a, const ::GeoPoint &b,
-                    int bottom_altitude,
-                    int top_altitude,
-                    double lift) override;
-
-  void OnThermalSubmit(const Client &client,
-                       std::chrono::milliseconds time_of_day,
-                       const ::GeoPoint &bottom_location,
-                       int bottom_altitude,
-                       const ::GeoPoint &top_location,
-                       int top_altitude,
-                       double lift) override;
-
-  void OnThermalRequest(const Client &client) override;
-
-  void OnSendError(const boost::asio::ip::udp::endpoint &endpoint,
-                   std::exception &&e) override {
-    cerr << "Failed to send to " << endpoint
-         << ": " << e.what()
-         << endl;
-  }
-
-  void OnError(std::exception &&e) override {
-    cerr << e.what() << endl;
-    get_io_service().stop();
-  }
-
 #ifdef __linux__
   /* virtual methods from class SignalListener */
   void OnSignal(int signo) override {
     switch (signo) {
     case SIGHUP:
-      Save();
+      database.StartCompaction();
       break;
 
     case SIGUSR1:
-      DumpClients();
+      shards.DumpClients();
+      PrintStatistics();
       break;
 
     default:
-      get_io_service().stop();
+      flush_timer.get_io_service().stop();
       break;
     }
   }
@@ -173,258 +166,72 @@ protected:
 };
 
 void
-CloudServer::OnFix(const Client &c,
-                   std::chrono::milliseconds time_of_day,
-                   const ::GeoPoint &location, int altitude)
+CloudServer::Load()
 {
-  (void)time_of_day; // TODO: use this parameter
-
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
-
-    client = &clients.Make(c.endpoint, c.key, location, altitude);
-
-    cout << "FIX\t"
-         << client->endpoint << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
-
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.endpoint);
-  }
-
-  /* send this new traffic location to all interested clients
-     immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_traffic)
-      /* not interested (anymore) */
-      continue;
-
-    TrafficResponseSender s(*this, {i->endpoint, i->key});
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
-    s.Flush();
-  }
+  std::unique_ptr<CloudData> data(new CloudData());
+  database.Open(*data);
+  shards.Load(*data);
 }
 
 void
-CloudServer::OnTrafficRequest(const Client &c, bool near)
+CloudServer::PrintStatistics()
 {
-  if (!near)
-    /* "near" is the only selection flag we know */
-    return;
-
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
   const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
-  const auto min_stamp = now - MAX_TRAFFIC_AGE;
-
-  TrafficResponseSender s(*this, c);
-
-  unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
-
-    if (traffic->stamp < min_stamp)
-      /* don't send stale traffic, it's probably not there anymore */
-      continue;
-
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
-
-    if (++n > 64)
-      break;
-  }
-
-  s.Flush();
-}
-
-void
-CloudServer::OnWaveSubmit(const Client &c,
-                          std::chrono::milliseconds time_of_day,
-                          const ::GeoPoint &a, const ::GeoPoint &b,
-                          int bottom_altitude,
-                          int top_altitude,
-                          double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
+  const double seconds =
+    std::chrono::duration_cast<std::chrono::duration<double>>(now - statistics_time).count();
+  if (seconds <= 0)
     return;
 
-  cout << "WAVE\t"
-       << client->endpoint << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-}
+  uint64_t packets, calls;
+  shards.GetSendStatistics(packets, calls);
 
-void
-CloudServer::OnThermalSubmit(const Client &c,
-                             std::chrono::milliseconds time_of_day,
-                             const ::GeoPoint &bottom_location,
-                             int bottom_altitude,
-                             const ::GeoPoint &top_location,
-                             int top_altitude,
-                             double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
-
-  cout << "THERMAL\t"
-       << client->endpoint << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
+  cout << "STATS\t"
+       << unsigned((packets - statistics_packets) / seconds) << " packets/s\t"
+       << unsigned((calls - statistics_calls) / seconds) << " syscalls/s"
        << endl;
 
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
-
-  /* send this new thermal to all interested clients immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_thermals)
-      /* not interested (anymore) */
-      continue;
-
-    ThermalResponseSender s(*this, {i->endpoint, i->key});
-    s.Add(thermal.Pack());
-    s.Flush();
-  }
-}
-
-void
-CloudServer::OnThermalRequest(const Client &c)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_thermals = now + REQUEST_EXPIRY;
-
-  const auto min_time = now - MAX_THERMAL_AGE;
-
-  ThermalResponseSender s(*this, c);
-
-  unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (thermal->time < min_time)
-      /* don't send old thermals, they're useless */
-      continue;
-
-    s.Add(thermal->Pack());
-
-    if (++n > 256)
-      break;
-  }
-
-  s.Flush();
-}
-
-void
-CloudServer::Load()
-{
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
-}
-
-void
-CloudServer::Save()
-{
-  cout << "Saving data to " << db_path.c_str() << endl;
-
-  FileOutputStream fos(db_path);
-
-  {
-    Serialiser s(fos);
-    CloudData::Save(s);
-    s.Flush();
-  }
-
-  fos.Commit();
+  statistics_time = now;
+  statistics_packets = packets;
+  statistics_calls = calls;
 }
 
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 3) {
+    cerr << "Usage: " << argv[0] << " DBPATH [THREADS]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  unsigned n_threads = GetProcessorCount();
+  if (argc > 2) {
+    char *endptr;
+    n_threads = ParseUnsigned(argv[2], &endptr);
+    if (endptr == argv[2] || *endptr != 0 || n_threads == 0) {
+      cerr << "Invalid number of threads: " << argv[2] << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   boost::asio::io_service io_service;
 
   const boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::udp::v4(),
-                                                CloudServer::GetDefaultPort());
+                                                SkyLinesTracking::Server::GetDefaultPort());
 
-  CloudServer server(db_path, io_service, endpoint);
+  CloudServer server(db_path, io_service, endpoint, n_threads);
 
-  try {
-    server.Load();
-  } catch (const std::runtime_error &e) {
-    cerr << "Failed to load database" << endl;
-    PrintException(e);
-  }
+  server.Load();
+
+  cout << "Running " << server.GetThreadCount() << " threads" << endl;
 
+  server.Start();
   io_service.run();
+  server.Stop();
 
-  server.Save();
+  server.PrintStatistics();
+  server.Close();
 
   return EXIT_SUCCESS;
 } catch (const std::exception &exception) {
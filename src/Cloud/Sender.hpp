@@ -27,11 +27,20 @@ Copyright_License {
 #include "Tracking/SkyLines/Server.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "OS/ByteOrder.hpp"
+#include "Compiler.h"
 
 #include <boost/asio/ip/udp.hpp>
 
 struct GeoPoint;
 
+/**
+ * Encode one traffic record in wire format.
+ */
+gcc_pure
+SkyLinesTracking::TrafficResponsePacket::Traffic
+MakeTraffic(uint32_t pilot_id, uint32_t time,
+            GeoPoint location, int altitude);
+
 class TrafficResponseSender {
   SkyLinesTracking::Server &server;
   const boost::asio::ip::udp::endpoint &endpoint;
@@ -60,8 +69,11 @@ public:
     data.header.reserved3 = 0;
   }
 
+  void Add(const SkyLinesTracking::TrafficResponsePacket::Traffic &traffic);
+
   void Add(uint32_t pilot_id, uint32_t time,
            GeoPoint location, int altitude);
+
   void Flush();
 };
 
@@ -0,0 +1,588 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Shard.hpp"
+#include "ShardSet.hpp"
+#include "Dump.hpp"
+#include "Sender.hpp"
+#include "Journal.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+// TODO: review these settings
+static constexpr double TRAFFIC_RANGE = 50000;
+static constexpr double THERMAL_RANGE = 50000;
+
+static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
+static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
+
+static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
+
+/**
+ * How long are fixes pushed to clients delayed to coalesce them with
+ * other fixes?
+ */
+static constexpr std::chrono::steady_clock::duration TRAFFIC_DELAY = std::chrono::milliseconds(250);
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+/**
+ * Print a log line.  The line is formatted into a buffer first, to
+ * avoid mixing it with lines printed by other shards.
+ */
+static void
+Log(const std::ostringstream &os)
+{
+  cout << os.str() << endl;
+}
+
+template<typename F>
+static void
+ForEachShard(uint32_t mask, F &&f)
+{
+  for (unsigned i = 0; mask != 0; ++i, mask >>= 1)
+    if (mask & 1)
+      f(i);
+}
+
+CloudShard::CloudShard(CloudShardSet &_set, unsigned _index,
+                       boost::asio::io_service &io_service,
+                       boost::asio::ip::udp::endpoint endpoint,
+                       bool reuse_port)
+  :SkyLinesTracking::Server(io_service, endpoint, reuse_port),
+   set(_set), index(_index),
+   expire_timer(io_service),
+   traffic_queue(*this, TRAFFIC_DELAY)
+{
+}
+
+void
+CloudShard::Start()
+{
+  if (!data.clients.empty())
+    ScheduleExpire();
+}
+
+void
+CloudShard::ScheduleExpire()
+{
+  expire_timer.expires_from_now(std::chrono::minutes(5));
+  expire_timer.async_wait([this](const boost::system::error_code &ec){
+      if (ec)
+        return;
+
+      const ScopeLock protect(mutex);
+      data.clients.Expire(expire_timer.expires_at() - std::chrono::minutes(10),
+                          [this](const CloudClient &client){
+                            set.GetJournal().RemoveClient(client.key);
+                            set.ReleaseClient(client.key, index);
+                          });
+      if (!data.clients.empty())
+        ScheduleExpire();
+    });
+}
+
+template<typename F>
+inline void
+CloudShard::RunIn(unsigned shard, F &&f)
+{
+  if (shard == index)
+    f();
+  else
+    set[shard].Post(std::forward<F>(f));
+}
+
+void
+CloudShard::Adopt(CloudClientPtr client)
+{
+  {
+    const ScopeLock protect(mutex);
+
+    const bool was_empty = data.clients.empty();
+    data.clients.Insert(*client);
+    if (was_empty)
+      ScheduleExpire();
+  }
+
+  PublishFix(client->key, client->id, client->location, client->altitude);
+}
+
+void
+CloudShard::Migrate(CloudClient &client, unsigned target)
+{
+  auto ptr = client.shared_from_this();
+  data.clients.Remove(client);
+
+  /* queue the Adopt() call before updating the directory: requests
+     about this client which are routed to the new owner can only be
+     posted after the directory has been updated, and are therefore
+     queued after the Adopt() call; requests which still arrive here
+     are forwarded by HandleFix() */
+  CloudShard &shard = set[target];
+  shard.Post([&shard, ptr](){
+      shard.Adopt(ptr);
+    });
+
+  set.MoveClient(ptr->key, target);
+}
+
+void
+CloudShard::PublishFix(uint64_t key, unsigned id,
+                       const ::GeoPoint &location, int altitude)
+{
+  ForEachShard(set.GetShardsWithinRange(location, TRAFFIC_RANGE),
+               [&](unsigned i){
+                 CloudShard &shard = set[i];
+                 RunIn(i, [&shard, key, id, location, altitude](){
+                     shard.SendFix(key, id, location, altitude);
+                   });
+               });
+}
+
+void
+CloudShard::SendFix(uint64_t client_key, unsigned id,
+                    const ::GeoPoint &location, int altitude)
+{
+  /* encode the record only once for all receivers */
+  const auto traffic = MakeTraffic(id, 0, //TODO: time?
+                                   location, altitude);
+
+  const ScopeLock protect(mutex);
+
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &i : data.clients.QueryWithinRange(location,
+                                                     TRAFFIC_RANGE)) {
+    if (i->key == client_key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (now > i->wants_traffic)
+      /* not interested (anymore) */
+      continue;
+
+    traffic_queue.Add({i->endpoint, i->key}, traffic);
+  }
+}
+
+void
+CloudShard::HandleFix(const Client &c,
+                      const ::GeoPoint &location, int altitude)
+{
+  unsigned id;
+
+  {
+    const ScopeLock protect(mutex);
+
+    CloudClient *client = data.clients.Find(c.key);
+
+    if (!location.IsValid()) {
+      if (client != nullptr) {
+        data.clients.Refresh(*client, c.endpoint);
+        set.GetJournal().AddClient(*client);
+      }
+
+      return;
+    }
+
+    if (client == nullptr) {
+      const unsigned owner = set.ClaimClient(c.key, index);
+      if (owner != index) {
+        /* another shard has claimed this client in the meantime */
+        CloudShard &shard = set[owner];
+        shard.Post([&shard, c, location, altitude](){
+            shard.HandleFix(c, location, altitude);
+          });
+        return;
+      }
+
+      const bool was_empty = data.clients.empty();
+      client = &data.clients.Make(c.endpoint, c.key, location, altitude);
+      if (was_empty)
+        ScheduleExpire();
+    } else
+      data.clients.Refresh(*client, c.endpoint, location, altitude);
+
+    set.GetJournal().AddClient(*client);
+
+    std::ostringstream os;
+    os << "FIX\t"
+       << client->endpoint << '\t'
+       << std::hex << client->key << std::dec << '\t'
+       << client->id << '\t'
+       << client->location << '\t'
+       << client->altitude << 'm';
+    Log(os);
+
+    const unsigned target = set.GetShardIndex(location);
+    if (target != index) {
+      /* the new owner will publish the fix */
+      Migrate(*client, target);
+      return;
+    }
+
+    id = client->id;
+  }
+
+  PublishFix(c.key, id, location, altitude);
+}
+
+void
+CloudShard::OnFix(const Client &c,
+                  std::chrono::milliseconds time_of_day,
+                  const ::GeoPoint &location, int altitude)
+{
+  (void)time_of_day; // TODO: use this parameter
+
+  unsigned owner = set.LookupClient(c.key);
+  if (owner == CloudShardSet::NO_SHARD) {
+    if (!location.IsValid())
+      return;
+
+    /* claim the new client right now, so requests following this
+       fix are routed to the same shard */
+    owner = set.ClaimClient(c.key, set.GetShardIndex(location));
+  }
+
+  CloudShard &shard = set[owner];
+  RunIn(owner, [&shard, c, location, altitude](){
+      shard.HandleFix(c, location, altitude);
+    });
+}
+
+void
+CloudShard::SendTraffic(const Client &c, const ::GeoPoint &location)
+{
+  const ScopeLock protect(mutex);
+
+  const auto min_stamp = std::chrono::steady_clock::now() - MAX_TRAFFIC_AGE;
+
+  TrafficResponseSender s(*this, c);
+
+  unsigned n = 0;
+  for (const auto &traffic : data.clients.QueryWithinRange(location,
+                                                           TRAFFIC_RANGE)) {
+    if (traffic->key == c.key)
+      continue;
+
+    if (traffic->stamp < min_stamp)
+      /* don't send stale traffic, it's probably not there anymore */
+      continue;
+
+    s.Add(traffic->id, 0, //TODO: time?
+          traffic->location, traffic->altitude);
+
+    if (++n > 64)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudShard::HandleTrafficRequest(const Client &c)
+{
+  ::GeoPoint location;
+
+  {
+    const ScopeLock protect(mutex);
+
+    auto *client = data.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't send our data to clients who didn't sent anything to
+         us yet */
+      return;
+
+    client->wants_traffic = std::chrono::steady_clock::now() + REQUEST_EXPIRY;
+    location = client->location;
+  }
+
+  /* each shard sends its own traffic packet */
+  ForEachShard(set.GetShardsWithinRange(location, TRAFFIC_RANGE),
+               [&](unsigned i){
+                 CloudShard &shard = set[i];
+                 RunIn(i, [&shard, c, location](){
+                     shard.SendTraffic(c, location);
+                   });
+               });
+}
+
+void
+CloudShard::OnTrafficRequest(const Client &c, bool near)
+{
+  if (!near)
+    /* "near" is the only selection flag we know */
+    return;
+
+  const unsigned owner = set.LookupClient(c.key);
+  if (owner == CloudShardSet::NO_SHARD)
+    return;
+
+  CloudShard &shard = set[owner];
+  RunIn(owner, [&shard, c](){
+      shard.HandleTrafficRequest(c);
+    });
+}
+
+void
+CloudShard::HandleWaveSubmit(const Client &c,
+                             const ::GeoPoint &a, const ::GeoPoint &b,
+                             int bottom_altitude, int top_altitude,
+                             double lift)
+{
+  const ScopeLock protect(mutex);
+
+  auto *client = data.clients.Find(c.key);
+  if (client == nullptr)
+    /* we don't trust the client if he didn't sent anything to us
+       yet */
+    return;
+
+  std::ostringstream os;
+  os << "WAVE\t"
+     << client->endpoint << '\t'
+     << std::hex << client->key << std::dec << '\t'
+     << client->id << '\t'
+     << a << '\t'
+     << b << '\t'
+     << bottom_altitude << '-' << top_altitude << "m\t"
+     << lift << "m/s";
+  Log(os);
+}
+
+void
+CloudShard::OnWaveSubmit(const Client &c,
+                         std::chrono::milliseconds time_of_day,
+                         const ::GeoPoint &a, const ::GeoPoint &b,
+                         int bottom_altitude,
+                         int top_altitude,
+                         double lift)
+{
+  const unsigned owner = set.LookupClient(c.key);
+  if (owner == CloudShardSet::NO_SHARD)
+    return;
+
+  CloudShard &shard = set[owner];
+  RunIn(owner, [&shard, c, a, b, bottom_altitude, top_altitude, lift](){
+      shard.HandleWaveSubmit(c, a, b, bottom_altitude, top_altitude, lift);
+    });
+}
+
+void
+CloudShard::SendThermal(uint64_t client_key, const ::GeoPoint &location,
+                        const SkyLinesTracking::Thermal &thermal)
+{
+  const ScopeLock protect(mutex);
+
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &i : data.clients.QueryWithinRange(location,
+                                                     THERMAL_RANGE)) {
+    if (i->key == client_key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (now > i->wants_thermals)
+      /* not interested (anymore) */
+      continue;
+
+    ThermalResponseSender s(*this, {i->endpoint, i->key});
+    s.Add(thermal);
+    s.Flush();
+  }
+}
+
+void
+CloudShard::StoreThermal(uint64_t client_key,
+                         const AGeoPoint &bottom, const AGeoPoint &top,
+                         double lift)
+{
+  SkyLinesTracking::Thermal packed;
+
+  {
+    const ScopeLock protect(mutex);
+    const auto &thermal = data.thermals.Make(client_key, bottom, top, lift);
+    set.GetJournal().AddThermal(thermal);
+    packed = thermal.Pack();
+  }
+
+  /* send this new thermal to all interested clients immediately */
+  const ::GeoPoint location = bottom;
+  ForEachShard(set.GetShardsWithinRange(location, THERMAL_RANGE),
+               [&](unsigned i){
+                 CloudShard &shard = set[i];
+                 RunIn(i, [&shard, client_key, location, packed](){
+                     shard.SendThermal(client_key, location, packed);
+                   });
+               });
+}
+
+void
+CloudShard::HandleThermalSubmit(const Client &c,
+                                const AGeoPoint &bottom, const AGeoPoint &top,
+                                double lift)
+{
+  {
+    const ScopeLock protect(mutex);
+
+    auto *client = data.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't trust the client if he didn't sent anything to us
+         yet */
+      return;
+
+    const ::GeoPoint &top_location = top;
+
+    std::ostringstream os;
+    os << "THERMAL\t"
+       << client->endpoint << '\t'
+       << std::hex << client->key << std::dec << '\t'
+       << client->id << '\t'
+       << top_location << '\t'
+       << bottom.altitude << '-' << top.altitude << "m\t"
+       << lift << "m/s";
+    Log(os);
+  }
+
+  /* thermals are stored by the shard owning their top location */
+  const uint64_t key = c.key;
+  const unsigned i = set.GetShardIndex(top);
+  CloudShard &shard = set[i];
+  RunIn(i, [&shard, key, bottom, top, lift](){
+      shard.StoreThermal(key, bottom, top, lift);
+    });
+}
+
+void
+CloudShard::OnThermalSubmit(const Client &c,
+                            std::chrono::milliseconds time_of_day,
+                            const ::GeoPoint &bottom_location,
+                            int bottom_altitude,
+                            const ::GeoPoint &top_location,
+                            int top_altitude,
+                            double lift)
+{
+  const unsigned owner = set.LookupClient(c.key);
+  if (owner == CloudShardSet::NO_SHARD)
+    return;
+
+  const AGeoPoint bottom(bottom_location, bottom_altitude);
+  const AGeoPoint top(top_location, top_altitude);
+
+  CloudShard &shard = set[owner];
+  RunIn(owner, [&shard, c, bottom, top, lift](){
+      shard.HandleThermalSubmit(c, bottom, top, lift);
+    });
+}
+
+void
+CloudShard::SendThermals(const Client &c, const ::GeoPoint &location)
+{
+  const ScopeLock protect(mutex);
+
+  const auto min_time = std::chrono::steady_clock::now() - MAX_THERMAL_AGE;
+
+  ThermalResponseSender s(*this, c);
+
+  unsigned n = 0;
+  for (const auto &thermal : data.thermals.QueryWithinRange(location,
+                                                            THERMAL_RANGE)) {
+    if (thermal->client_key == c.key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (thermal->time < min_time)
+      /* don't send old thermals, they're useless */
+      continue;
+
+    s.Add(thermal->Pack());
+
+    if (++n > 256)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudShard::HandleThermalRequest(const Client &c)
+{
+  ::GeoPoint location;
+
+  {
+    const ScopeLock protect(mutex);
+
+    auto *client = data.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't send our data to clients who didn't sent anything to
+         us yet */
+      return;
+
+    client->wants_thermals = std::chrono::steady_clock::now() + REQUEST_EXPIRY;
+    location = client->location;
+  }
+
+  /* each shard sends its own thermal packet */
+  ForEachShard(set.GetShardsWithinRange(location, THERMAL_RANGE),
+               [&](unsigned i){
+                 CloudShard &shard = set[i];
+                 RunIn(i, [&shard, c, location](){
+                     shard.SendThermals(c, location);
+                   });
+               });
+}
+
+void
+CloudShard::OnThermalRequest(const Client &c)
+{
+  const unsigned owner = set.LookupClient(c.key);
+  if (owner == CloudShardSet::NO_SHARD)
+    return;
+
+  CloudShard &shard = set[owner];
+  RunIn(owner, [&shard, c](){
+      shard.HandleThermalRequest(c);
+    });
+}
+
+void
+CloudShard::OnSendError(const boost::asio::ip::udp::endpoint &endpoint,
+                        std::exception &&e)
+{
+  std::ostringstream os;
+  os << "Failed to send to " << endpoint
+     << ": " << e.what();
+  cerr << os.str() << endl;
+}
+
+void
+CloudShard::OnError(std::exception &&e)
+{
+  set.OnError(std::move(e));
+}
@@ -0,0 +1,212 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_SHARD_HPP
+#define XCSOAR_CLOUD_SHARD_HPP
+
+#include "Data.hpp"
+#include "TrafficQueue.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+class CloudShardSet;
+
+/**
+ * One shard of the cloud server.  It owns the clients and thermals
+ * located in its part of the world (see
+ * CloudShardSet::GetShardIndex()), and all of its methods run in the
+ * thread of its io_service.
+ *
+ * Each shard receives datagrams on its own socket; requests about a
+ * client owned by another shard are forwarded to that shard, and
+ * queries which reach into the area of other shards are forwarded to
+ * them as well.
+ */
+class CloudShard final : public SkyLinesTracking::Server {
+  CloudShardSet &set;
+
+  const unsigned index;
+
+  boost::asio::steady_timer expire_timer;
+
+  /**
+   * Coalesces the traffic pushed to this shard's clients.
+   */
+  TrafficQueue traffic_queue;
+
+  /**
+   * Protects #data.  Only this shard's thread modifies it, but the
+   * main thread reads it while dumping clients.
+   */
+  mutable Mutex mutex;
+
+  CloudData data;
+
+public:
+  CloudShard(CloudShardSet &_set, unsigned _index,
+             boost::asio::io_service &io_service,
+             boost::asio::ip::udp::endpoint endpoint,
+             bool reuse_port);
+
+  unsigned GetIndex() const {
+    return index;
+  }
+
+  Mutex &GetMutex() const {
+    return mutex;
+  }
+
+  /**
+   * Caller must lock the mutex.
+   */
+  CloudData &GetData() {
+    return data;
+  }
+
+  /**
+   * Caller must lock the mutex.
+   */
+  const CloudData &GetData() const {
+    return data;
+  }
+
+  /**
+   * Run the given function in this shard's thread.
+   */
+  template<typename F>
+  void Post(F &&f) {
+    get_io_service().post(std::forward<F>(f));
+  }
+
+  /**
+   * Start expiring clients loaded from the database.  Call this
+   * before the thread is started.
+   */
+  void Start();
+
+private:
+  void ScheduleExpire();
+
+  /**
+   * Insert a client which has been migrated from another shard.
+   */
+  void Adopt(CloudClientPtr client);
+
+  /**
+   * Move a client to another shard, because it has left the area of
+   * this one.
+   */
+  void Migrate(CloudClient &client, unsigned target);
+
+  /**
+   * Send a client's new location to all interested clients within
+   * range, including those owned by other shards.  Caller must not
+   * lock the mutex.
+   */
+  void PublishFix(uint64_t key, unsigned id,
+                  const ::GeoPoint &location, int altitude);
+
+  void HandleFix(const Client &c, const ::GeoPoint &location, int altitude);
+  void HandleTrafficRequest(const Client &c);
+  void HandleWaveSubmit(const Client &c,
+                        const ::GeoPoint &a, const ::GeoPoint &b,
+                        int bottom_altitude, int top_altitude,
+                        double lift);
+  void HandleThermalSubmit(const Client &c,
+                           const AGeoPoint &bottom, const AGeoPoint &top,
+                           double lift);
+  void HandleThermalRequest(const Client &c);
+
+  void StoreThermal(uint64_t client_key,
+                    const AGeoPoint &bottom, const AGeoPoint &top,
+                    double lift);
+
+  /**
+   * Queue a fix for this shard's clients within range which want
+   * traffic.
+   */
+  void SendFix(uint64_t client_key, unsigned id,
+               const ::GeoPoint &location, int altitude);
+
+  /**
+   * Send this shard's traffic within range of the given location to
+   * the client.
+   */
+  void SendTraffic(const Client &c, const ::GeoPoint &location);
+
+  /**
+   * Send a thermal to this shard's clients within range which want
+   * thermals.
+   */
+  void SendThermal(uint64_t client_key, const ::GeoPoint &location,
+                   const SkyLinesTracking::Thermal &thermal);
+
+  /**
+   * Send this shard's thermals within range of the given location to
+   * the client.
+   */
+  void SendThermals(const Client &c, const ::GeoPoint &location);
+
+  /**
+   * Run the function in the given shard: directly if it is this
+   * one, or else by posting it to the shard's thread.
+   */
+  template<typename F>
+  void RunIn(unsigned shard, F &&f);
+
+protected:
+  /* virtual methods from class SkyLinesTracking::Server */
+  void OnFix(const Client &client,
+             std::chrono::milliseconds time_of_day,
+             const ::GeoPoint &location, int altitude) override;
+
+  void OnTrafficRequest(const Client &client,
+                        bool near) override;
+
+  void OnWaveSubmit(const Client &client,
+                    std::chrono::milliseconds time_of_day,
+                    const ::GeoPoint &a, const ::GeoPoint &b,
+                    int bottom_altitude,
+                    int top_altitude,
+                    double lift) override;
+
+  void OnThermalSubmit(const Client &client,
+                       std::chrono::milliseconds time_of_day,
+                       const ::GeoPoint &bottom_location,
+                       int bottom_altitude,
+                       const ::GeoPoint &top_location,
+                       int top_altitude,
+                       double lift) override;
+
+  void OnThermalRequest(const Client &client) override;
+
+  void OnSendError(const boost::asio::ip::udp::endpoint &endpoint,
+                   std::exception &&e) override;
+
+  void OnError(std::exception &&e) override;
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ShardSet.hpp"
+#include "Shard.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "IO/Async/AsioThread.hpp"
+#include "Util/Clamp.hpp"
+
+#include <iostream>
+
+#include <math.h>
+
+/**
+ * The number of cells per degree of latitude and longitude.
+ */
+static constexpr unsigned CELLS_PER_DEGREE = 1;
+
+static constexpr unsigned N_CELLS_X = 360 * CELLS_PER_DEGREE;
+static constexpr unsigned N_CELLS_Y = 180 * CELLS_PER_DEGREE;
+
+gcc_const
+static unsigned
+GetCellX(Angle longitude)
+{
+  const int x = (int)floor((longitude.AsDelta().Degrees() + 180)
+                           * CELLS_PER_DEGREE);
+  return Clamp(x, 0, int(N_CELLS_X - 1));
+}
+
+gcc_const
+static unsigned
+GetCellY(Angle latitude)
+{
+  const int y = (int)floor((latitude.Degrees() + 90) * CELLS_PER_DEGREE);
+  return Clamp(y, 0, int(N_CELLS_Y - 1));
+}
+
+/**
+ * Assign a cell to a shard.  This is a hash function, because busy
+ * areas are usually larger than one cell, and their neighbouring
+ * cells should be handled by different shards.
+ */
+gcc_const
+static unsigned
+GetCellShard(unsigned x, unsigned y, unsigned n_shards)
+{
+  uint32_t h = x * 0x9e3779b1u ^ y * 0x85ebca77u;
+  h ^= h >> 15;
+  return h % n_shards;
+}
+
+CloudShardSet::CloudShardSet(boost::asio::io_service &_main_io_service,
+                             CloudJournal &_journal,
+                             boost::asio::ip::udp::endpoint endpoint,
+                             unsigned n_shards)
+  :main_io_service(_main_io_service), journal(_journal)
+{
+  if (n_shards > 1 && !SkyLinesTracking::Server::CanReusePort()) {
+    std::cerr << "SO_REUSEPORT is not supported; using only one shard"
+              << std::endl;
+    n_shards = 1;
+  }
+
+  n_shards = Clamp(n_shards, 1u, MAX_SHARDS);
+
+  /* with only one shard, the port doesn't need to be shared; this
+     way, starting a second server on the same port fails */
+  const bool reuse_port = n_shards > 1;
+
+  for (unsigned i = 0; i < n_shards; ++i) {
+    threads.emplace_back(new AsioThread());
+    shards.emplace_back(new CloudShard(*this, i, threads.back()->Get(),
+                                       endpoint, reuse_port));
+
+    /* each shard assigns the public ids of one residue class; Load()
+       moves the sequences past the ids of the loaded clients */
+    shards.back()->GetData().clients.SetIdSequence(i + 1, n_shards);
+  }
+}
+
+CloudShardSet::~CloudShardSet()
+{
+}
+
+void
+CloudShardSet::Start()
+{
+  for (auto &shard : shards)
+    shard->Start();
+
+  for (auto &thread : threads)
+    if (!thread->Start())
+      throw std::runtime_error("Failed to start thread");
+}
+
+void
+CloudShardSet::Stop()
+{
+  for (auto &thread : threads)
+    thread->Stop();
+}
+
+void
+CloudShardSet::OnError(std::exception &&e)
+{
+  std::cerr << e.what() << std::endl;
+  main_io_service.stop();
+}
+
+unsigned
+CloudShardSet::GetShardIndex(const GeoPoint &location) const
+{
+  return GetCellShard(GetCellX(location.longitude),
+                      GetCellY(location.latitude),
+                      shards.size());
+}
+
+uint32_t
+CloudShardSet::GetShardsWithinRange(const GeoPoint &location,
+                                    double range) const
+{
+  const unsigned n = shards.size();
+  const uint32_t all = n < 32 ? (1u << n) - 1 : ~0u;
+  if (n == 1)
+    return all;
+
+  const auto box = BoostRangeBox(location, range);
+  const unsigned x_begin = GetCellX(box.min_corner().longitude);
+  const unsigned x_end = (GetCellX(box.max_corner().longitude) + 1) % N_CELLS_X;
+  const unsigned y_begin = GetCellY(box.min_corner().latitude);
+  const unsigned y_end = GetCellY(box.max_corner().latitude) + 1;
+
+  uint32_t mask = 0;
+
+  /* the longitude range may wrap around at 180 degrees */
+  unsigned x = x_begin;
+  do {
+    for (unsigned y = y_begin; y != y_end; ++y)
+      mask |= 1u << GetCellShard(x, y, n);
+
+    if (mask == all)
+      break;
+
+    x = (x + 1) % N_CELLS_X;
+  } while (x != x_end);
+
+  return mask;
+}
+
+unsigned
+CloudShardSet::LookupClient(uint64_t key) const
+{
+  const ScopeLock protect(directory_mutex);
+  auto i = directory.find(key);
+  return i != directory.end()
+    ? i->second
+    : NO_SHARD;
+}
+
+unsigned
+CloudShardSet::ClaimClient(uint64_t key, unsigned shard)
+{
+  const ScopeLock protect(directory_mutex);
+  return directory.emplace(key, shard).first->second;
+}
+
+void
+CloudShardSet::MoveClient(uint64_t key, unsigned shard)
+{
+  const ScopeLock protect(directory_mutex);
+  directory[key] = shard;
+}
+
+void
+CloudShardSet::ReleaseClient(uint64_t key, unsigned shard)
+{
+  const ScopeLock protect(directory_mutex);
+  auto i = directory.find(key);
+  if (i != directory.end() && i->second == shard)
+    directory.erase(i);
+}
+
+void
+CloudShardSet::GetSendStatistics(uint64_t &packets, uint64_t &calls) const
+{
+  packets = calls = 0;
+  for (const auto &shard : shards) {
+    packets += shard->GetSentPackets();
+    calls += shard->GetSendCalls();
+  }
+}
+
+/**
+ * Lock the mutexes of all shards starting at the given index, and
+ * then invoke the function.
+ */
+template<typename F>
+static void
+WithShardsLocked(const std::vector<std::unique_ptr<CloudShard>> &shards,
+                 unsigned i, F &&f)
+{
+  if (i == shards.size()) {
+    f();
+    return;
+  }
+
+  const ScopeLock protect(shards[i]->GetMutex());
+  WithShardsLocked(shards, i + 1, f);
+}
+
+void
+CloudShardSet::Load(const CloudData &data)
+{
+  /* each shard assigns the public ids of one residue class */
+  const unsigned n = shards.size();
+  const unsigned next_id = data.clients.GetNextId();
+  for (unsigned i = 0; i < n; ++i)
+    shards[i]->GetData().clients.SetIdSequence(next_id + (i + 1 + n - next_id % n) % n,
+                                               n);
+
+  /* the containers insert at the front, so insert the oldest items
+     first to preserve the order */
+  std::vector<const CloudClient *> clients;
+  for (const auto &client : data.clients)
+    clients.push_back(&client);
+
+  for (auto i = clients.rbegin(); i != clients.rend(); ++i) {
+    const CloudClient &client = **i;
+    const unsigned shard = GetShardIndex(client.location);
+    shards[shard]->GetData().clients.Restore(client);
+    directory[client.key] = shard;
+  }
+
+  std::vector<const CloudThermal *> thermals;
+  for (const auto &thermal : data.thermals)
+    thermals.push_back(&thermal);
+
+  for (auto i = thermals.rbegin(); i != thermals.rend(); ++i) {
+    const CloudThermal &thermal = **i;
+    shards[GetShardIndex(thermal.top_location)]->GetData().thermals.Restore(thermal);
+  }
+}
+
+void
+CloudShardSet::DumpClients() const
+{
+  WithShardsLocked(shards, 0, [this](){
+      for (const auto &shard : shards)
+        shard->GetData().DumpClients();
+    });
+}
@@ -0,0 +1,179 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_SHARD_SET_HPP
+#define XCSOAR_CLOUD_SHARD_SET_HPP
+
+#include "Thread/Mutex.hpp"
+#include "Compiler.h"
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include <stdint.h>
+
+struct GeoPoint;
+class AsioThread;
+class CloudShard;
+class CloudJournal;
+struct CloudData;
+
+/**
+ * The shards of the cloud server, each running in its own thread.
+ *
+ * The world is divided into cells of one degree, and each cell is
+ * assigned to one shard.  A shard owns all clients and thermals
+ * located in its cells.  A directory maps each client's key to the
+ * shard which currently owns it.
+ */
+class CloudShardSet {
+  boost::asio::io_service &main_io_service;
+
+  CloudJournal &journal;
+
+  /* declared before #shards, because the shards' sockets and timers
+     must be destroyed before the io_service */
+  std::vector<std::unique_ptr<AsioThread>> threads;
+
+  std::vector<std::unique_ptr<CloudShard>> shards;
+
+  /**
+   * Protects #directory.
+   */
+  mutable Mutex directory_mutex;
+
+  /**
+   * Maps a client key to the index of the shard owning it.
+   */
+  std::unordered_map<uint64_t, unsigned> directory;
+
+public:
+  /**
+   * The maximum number of shards; limited by the bit mask returned
+   * by GetShardsWithinRange().
+   */
+  static constexpr unsigned MAX_SHARDS = 32;
+
+  static constexpr unsigned NO_SHARD = ~0u;
+
+  /**
+   * @param main_io_service the io_service of the main thread, which
+   * is stopped when a fatal error occurs
+   * @param journal all modifications are recorded here
+   * @param n_shards the number of shards (and threads); will be
+   * clipped to #MAX_SHARDS, and to 1 if the platform cannot share a
+   * port between several sockets
+   */
+  CloudShardSet(boost::asio::io_service &main_io_service,
+                CloudJournal &journal,
+                boost::asio::ip::udp::endpoint endpoint,
+                unsigned n_shards);
+
+  ~CloudShardSet();
+
+  unsigned size() const {
+    return shards.size();
+  }
+
+  CloudShard &operator[](unsigned i) {
+    return *shards[i];
+  }
+
+  CloudJournal &GetJournal() {
+    return journal;
+  }
+
+  /**
+   * Start all threads.  Call Stop() before destructing this object.
+   */
+  void Start();
+  void Stop();
+
+  /**
+   * Stop the server after a fatal error.  Thread-safe.
+   */
+  void OnError(std::exception &&e);
+
+  /**
+   * Returns the index of the shard which owns the given location.
+   */
+  gcc_pure
+  unsigned GetShardIndex(const GeoPoint &location) const;
+
+  /**
+   * Returns a bit mask of all shards owning a part of the area
+   * within the given range.
+   */
+  gcc_pure
+  uint32_t GetShardsWithinRange(const GeoPoint &location,
+                                double range) const;
+
+  /**
+   * Returns the shard which owns the client with the given key, or
+   * #NO_SHARD if the client is unknown.  Thread-safe.
+   */
+  gcc_pure
+  unsigned LookupClient(uint64_t key) const;
+
+  /**
+   * Register the given shard as owner of the client, unless it is
+   * already owned by a shard.  Thread-safe.
+   *
+   * @return the index of the owning shard
+   */
+  unsigned ClaimClient(uint64_t key, unsigned shard);
+
+  /**
+   * Transfer the ownership of a client to another shard.
+   * Thread-safe.
+   */
+  void MoveClient(uint64_t key, unsigned shard);
+
+  /**
+   * Unregister the client, if it is still owned by the given shard.
+   * Thread-safe.
+   */
+  void ReleaseClient(uint64_t key, unsigned shard);
+
+  /**
+   * Sum up the number of datagrams sent by all shards and the number
+   * of system calls needed for that.  Thread-safe.
+   */
+  void GetSendStatistics(uint64_t &packets, uint64_t &calls) const;
+
+  /**
+   * Distribute the data loaded from the database among the shards.
+   * Call this before Start().
+   */
+  void Load(const CloudData &data);
+
+  /**
+   * Print all clients.  Thread-safe.
+   */
+  void DumpClients() const;
+};
+
+#endif
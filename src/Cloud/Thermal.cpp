@@ -63,6 +63,12 @@ CloudThermalContainer::Insert(CloudThermal &thermal)
   rtree.insert(thermal.shared_from_this());
 }
 
+void
+CloudThermalContainer::Restore(const CloudThermal &thermal)
+{
+  Insert(*std::make_shared<CloudThermal>(thermal));
+}
+
 void
 CloudThermalContainer::Remove(CloudThermal &thermal)
 {
@@ -131,9 +137,10 @@ CloudThermalContainer::Save(Serialiser &s) const
 {
   s.Write8(1);
 
-  for (const auto &thermal : list) {
+  /* oldest first, because Load() inserts each thermal at the front */
+  for (auto i = list.rbegin(), end = list.rend(); i != end; ++i) {
     s.Write8(1);
-    thermal.Save(s);
+    i->Save(s);
   }
 
   s.Write8(0);
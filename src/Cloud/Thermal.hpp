@@ -138,6 +138,11 @@ public:
 
   void Insert(CloudThermal &client);
 
+  /**
+   * Insert a copy of the given thermal (e.g. loaded from a journal).
+   */
+  void Restore(const CloudThermal &thermal);
+
   /**
    * Remove a #CloudThermal and its data.  Be careful - the given reference
    * is invalidated, unless the caller holds another #CloudThermalPtr.
@@ -0,0 +1,110 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TrafficQueue.hpp"
+#include "OS/ByteOrder.hpp"
+#include "Util/CRC.hpp"
+
+#include <algorithm>
+
+void
+TrafficQueue::Add(const SkyLinesTracking::Server::Client &client,
+                  const Traffic &traffic)
+{
+  if (destinations.empty()) {
+    timer.expires_from_now(delay);
+    timer.async_wait(std::bind(&TrafficQueue::OnTimer, this,
+                               std::placeholders::_1));
+  }
+
+  auto &d = destinations[client.key];
+  d.endpoint = client.endpoint;
+
+  auto i = std::find_if(d.traffic.begin(), d.traffic.end(),
+                        [&traffic](const Traffic &t){
+                          return t.pilot_id == traffic.pilot_id;
+                        });
+  if (i != d.traffic.end())
+    *i = traffic;
+  else
+    d.traffic.push_back(traffic);
+}
+
+void
+TrafficQueue::Flush()
+{
+  if (destinations.empty())
+    return;
+
+  timer.cancel();
+
+  size_t n_packets = 0;
+  for (const auto &i : destinations)
+    n_packets += (i.second.traffic.size() + MAX_TRAFFIC - 1) / MAX_TRAFFIC;
+
+  /* allocate all packets before creating the datagrams pointing to
+     them */
+  packets.resize(n_packets);
+  datagrams.clear();
+
+  auto packet = packets.begin();
+  for (const auto &i : destinations) {
+    const auto &d = i.second;
+
+    for (size_t position = 0; position < d.traffic.size();
+         position += MAX_TRAFFIC, ++packet) {
+      const size_t n = std::min(d.traffic.size() - position, MAX_TRAFFIC);
+
+      auto &header = packet->header;
+      header.header.magic = ToBE32(SkyLinesTracking::MAGIC);
+      header.header.type = ToBE16(SkyLinesTracking::Type::TRAFFIC_RESPONSE);
+      header.header.key = ToBE64(i.first);
+      header.reserved = 0;
+      header.reserved2 = 0;
+      header.reserved3 = 0;
+      header.traffic_count = n;
+
+      std::copy_n(d.traffic.begin() + position, n, packet->traffic.begin());
+
+      const size_t size = sizeof(header) + sizeof(packet->traffic[0]) * n;
+      header.header.crc = 0;
+      header.header.crc = ToBE16(UpdateCRC16CCITT(&*packet, size, 0));
+
+      datagrams.push_back({&d.endpoint,
+            boost::asio::const_buffer(&*packet, size)});
+    }
+  }
+
+  server.SendBuffers(datagrams.data(), datagrams.size());
+
+  destinations.clear();
+}
+
+void
+TrafficQueue::OnTimer(const boost::system::error_code &ec)
+{
+  if (ec)
+    return;
+
+  Flush();
+}
@@ -0,0 +1,105 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_TRAFFIC_QUEUE_HPP
+#define XCSOAR_CLOUD_TRAFFIC_QUEUE_HPP
+
+#include "Tracking/SkyLines/Server.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <array>
+
+/**
+ * Collects traffic records for many clients and sends them in
+ * batches: all records queued for a client within a short time are
+ * coalesced into one datagram, and all datagrams are sent with as few
+ * system calls as possible.
+ *
+ * This class is not thread-safe; all methods must be called in the
+ * thread of the #SkyLinesTracking::Server's io_service.
+ */
+class TrafficQueue {
+  typedef SkyLinesTracking::TrafficResponsePacket::Traffic Traffic;
+
+  static constexpr size_t MAX_TRAFFIC_SIZE = 1024;
+  static constexpr size_t MAX_TRAFFIC = MAX_TRAFFIC_SIZE / sizeof(Traffic);
+
+  struct Packet {
+    SkyLinesTracking::TrafficResponsePacket header;
+    std::array<Traffic, MAX_TRAFFIC> traffic;
+  };
+
+  struct Destination {
+    boost::asio::ip::udp::endpoint endpoint;
+    std::vector<Traffic> traffic;
+  };
+
+  SkyLinesTracking::Server &server;
+
+  boost::asio::steady_timer timer;
+
+  const std::chrono::steady_clock::duration delay;
+
+  /**
+   * The pending records, indexed by the receiving client's key.
+   */
+  std::unordered_map<uint64_t, Destination> destinations;
+
+  /* buffers for Flush(), kept here to avoid allocating them again
+     each time */
+  std::vector<Packet> packets;
+  std::vector<SkyLinesTracking::Server::Datagram> datagrams;
+
+public:
+  /**
+   * @param delay the maximum time a record waits for other records to
+   * the same client
+   */
+  TrafficQueue(SkyLinesTracking::Server &_server,
+               std::chrono::steady_clock::duration _delay)
+    :server(_server), timer(_server.get_io_service()), delay(_delay) {}
+
+  /**
+   * Queue a traffic record for the given client.  A pending record
+   * about the same pilot is replaced, because only the latest
+   * location is interesting.
+   *
+   * @param traffic a record in wire format (see MakeTraffic())
+   */
+  void Add(const SkyLinesTracking::Server::Client &client,
+           const Traffic &traffic);
+
+  /**
+   * Send all pending records now.
+   */
+  void Flush();
+
+private:
+  void OnTimer(const boost::system::error_code &ec);
+};
+
+#endif
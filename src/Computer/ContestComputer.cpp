@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "Thread/JobScheduler.hpp"
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
@@ -30,6 +31,14 @@ ContestComputer::ContestComputer(const Trace &trace_full,
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+
+  /* run the second one of two independent contest solvers in a
+     worker thread while the calling thread runs the first one */
+  if (GetJobScheduler().GetConcurrency() > 1)
+    contest_manager.SetParallel([](unsigned n,
+                                   const std::function<void(unsigned)> &f){
+        GetJobScheduler().ParallelFor(n, f);
+      });
 }
 
 void
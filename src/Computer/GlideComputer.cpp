@@ -27,6 +27,7 @@ Copyright_License {
 #include "ConditionMonitor/ConditionMonitors.hpp"
 #include "GlideComputerInterface.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
+#include "Thread/Timeline.hpp"
 
 static PeriodClock last_team_code_update;
 
@@ -72,6 +73,8 @@ GlideComputer::Initialise()
 bool
 GlideComputer::ProcessGPS(bool force)
 {
+  const ScopeTimelineSpan timeline("GlideComputer::ProcessGPS");
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
   const ComputerSettings &settings = GetComputerSettings();
@@ -158,6 +161,8 @@ GlideComputer::ProcessGPS(bool force)
 void
 GlideComputer::ProcessIdle(bool exhaustive)
 {
+  const ScopeTimelineSpan timeline("GlideComputer::ProcessIdle");
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
 
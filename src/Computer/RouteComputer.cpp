@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "Thread/JobScheduler.hpp"
 
 #include <algorithm>
 
@@ -35,7 +36,17 @@ RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  /* the calculation thread waits for the result */
+  if (GetJobScheduler().GetConcurrency() > 1)
+    route_planner.SetReachParallel([](unsigned n,
+                                      const std::function<void(unsigned)> &f){
+        GetJobScheduler().ParallelFor(n, f, JobScheduler::Priority::HIGH,
+                                      nullptr, MAX_REACH_THREADS);
+      });
+
+  route_planner.SetReachTimeBudget(std::chrono::milliseconds(REACH_TIME_BUDGET));
+}
 
 void
 RouteComputer::ResetFlight()
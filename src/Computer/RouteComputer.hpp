@@ -40,6 +40,18 @@ class GlidePolar;
 class RouteComputer {
   static constexpr unsigned PERIOD = 5;
 
+  /**
+   * The maximum duration of one reach calculation [ms]; beyond that,
+   * the result would be outdated by the time it is shown.
+   */
+  static constexpr unsigned REACH_TIME_BUDGET = 1000;
+
+  /**
+   * The maximum number of threads which search the reach fans,
+   * including the calculation thread.
+   */
+  static constexpr unsigned MAX_REACH_THREADS = 4;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
@@ -187,6 +187,16 @@ AbstractAirspace::Intercept(const AircraftState &state,
   return solution;
 }
 
+void
+AbstractAirspace::IntersectsMultiple(const GeoPoint &start,
+                                     const GeoPoint *ends, unsigned n,
+                                     const FlatProjection &projection,
+                                     AirspaceIntersectionVector *results) const
+{
+  for (unsigned i = 0; i < n; ++i)
+    results[i] = Intersects(start, ends[i], projection);
+}
+
 bool
 AbstractAirspace::MatchNamePrefix(const TCHAR *prefix) const
 {
@@ -165,6 +165,23 @@ public:
                                                 const GeoPoint &end,
                                                 const FlatProjection &projection) const = 0;
 
+  /**
+   * Checks whether several lines starting at the same location
+   * intersect with the airspace.  This is equivalent to calling
+   * Intersects() for each of them, but polygons load their border
+   * only once for all lines.
+   *
+   * @param start Location of origin of all search vectors
+   * @param ends the ends of the search vectors
+   * @param n the number of search vectors; at most 32
+   * @param results receives one vector of intersection pairs for
+   * each search vector
+   */
+  virtual void IntersectsMultiple(const GeoPoint &start,
+                                  const GeoPoint *ends, unsigned n,
+                                  const FlatProjection &projection,
+                                  AirspaceIntersectionVector *results) const;
+
   /**
    * Find location of closest point on boundary to a reference
    *
@@ -239,6 +256,10 @@ public:
     days_of_operation = mask;
   }
 
+  const AirspaceActivity &GetDays() const {
+    return days_of_operation;
+  }
+
   /**
    * Get type of airspace
    *
@@ -372,7 +393,7 @@ public:
 
 protected:
   /** Project border */
-  void Project(const FlatProjection &tp);
+  virtual void Project(const FlatProjection &tp);
 
 private:
   /**
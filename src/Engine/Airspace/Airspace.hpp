@@ -63,6 +63,13 @@ public:
   Airspace(AbstractAirspace &airspace,
            const FlatProjection &projection);
 
+  /**
+   * Constructor for an airspace whose bounding box is known already
+   * (e.g. loaded from a cache file).
+   */
+  Airspace(AbstractAirspace &_airspace, const FlatBoundingBox &box)
+    :FlatBoundingBox(box), airspace(&_airspace) {}
+
   /**
    * Checks whether an aircraft is inside the airspace.
    *
@@ -44,6 +44,14 @@ AirspaceCircle::AirspaceCircle(const GeoPoint &loc, const double _radius)
   }
 }
 
+AirspaceCircle::AirspaceCircle(const GeoPoint &loc, const double _radius,
+                               SearchPointVector &&border)
+  :AbstractAirspace(Shape::CIRCLE), m_center(loc), m_radius(_radius)
+{
+  is_convex = TriState::TRUE;
+  m_border = std::move(border);
+}
+
 bool
 AirspaceCircle::Inside(const GeoPoint &loc) const
 {
@@ -48,6 +48,13 @@ public:
    */
   AirspaceCircle(const GeoPoint &loc, const double _radius);
 
+  /**
+   * Constructor for a border which has been calculated and projected
+   * already, e.g. one loaded from a cache file.
+   */
+  AirspaceCircle(const GeoPoint &loc, const double _radius,
+                 SearchPointVector &&border);
+
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const override {
     return m_center;
@@ -0,0 +1,158 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceIntrusions.hpp"
+#include "Airspaces.hpp"
+#include "AbstractAirspace.hpp"
+#include "Navigation/Aircraft.hpp"
+
+/**
+ * The number of consecutive fixes which share one bounding box.  An
+ * airspace skips all fixes of a block whose box does not overlap its
+ * own.
+ */
+static constexpr unsigned BLOCK_SIZE = 64;
+
+/**
+ * The number of candidate airspaces checked by one job of the
+ * #AirspaceParallelFunction.
+ */
+static constexpr unsigned JOB_SIZE = 16;
+
+/**
+ * Find the periods of the flight inside one airspace.
+ */
+static void
+ScanAirspace(const Airspace &airspace, unsigned order,
+             const AircraftState *fixes,
+             const std::vector<FlatGeoPoint> &points,
+             const std::vector<FlatBoundingBox> &blocks,
+             AirspaceIntrusionList &result)
+{
+  const FlatBoundingBox &box = airspace;
+  const AbstractAirspace &as = airspace.GetAirspace();
+  const unsigned n_fixes = points.size();
+
+  bool inside = false;
+  unsigned begin = 0;
+
+  for (unsigned b = 0; b < blocks.size(); ++b) {
+    const unsigned first = b * BLOCK_SIZE;
+
+    if (!box.Overlaps(blocks[b])) {
+      if (inside) {
+        result.push_back({&as, order, begin, first});
+        inside = false;
+      }
+
+      continue;
+    }
+
+    const unsigned last = std::min(first + BLOCK_SIZE, n_fixes);
+    for (unsigned i = first; i < last; ++i) {
+      const bool is_inside = box.IsInside(points[i]) && as.Inside(fixes[i]);
+      if (is_inside == inside)
+        continue;
+
+      if (is_inside)
+        begin = i;
+      else
+        result.push_back({&as, order, begin, i});
+
+      inside = is_inside;
+    }
+  }
+
+  if (inside)
+    result.push_back({&as, order, begin, n_fixes});
+}
+
+AirspaceIntrusionList
+FindAirspaceIntrusions(const Airspaces &airspaces,
+                       const AircraftState *fixes, unsigned n_fixes,
+                       const AirspaceParallelFunction &parallel)
+{
+  AirspaceIntrusionList result;
+  if (n_fixes == 0 || airspaces.IsEmpty())
+    return result;
+
+  const auto &projection = airspaces.GetProjection();
+
+  std::vector<FlatGeoPoint> points;
+  points.reserve(n_fixes);
+  for (unsigned i = 0; i < n_fixes; ++i)
+    points.push_back(projection.ProjectInteger(fixes[i].location));
+
+  /* the bounding box of each block of fixes, and of the whole
+     flight */
+  std::vector<FlatBoundingBox> blocks;
+  blocks.reserve((n_fixes + BLOCK_SIZE - 1) / BLOCK_SIZE);
+  for (unsigned first = 0; first < n_fixes; first += BLOCK_SIZE) {
+    const unsigned last = std::min(first + BLOCK_SIZE, n_fixes);
+    FlatBoundingBox block(points[first]);
+    for (unsigned i = first + 1; i < last; ++i)
+      block.Expand(points[i]);
+    blocks.push_back(block);
+  }
+
+  FlatBoundingBox bounds = blocks.front();
+  for (const auto &block : blocks)
+    bounds.Merge(block);
+
+  /* the tree order of the candidates is the order of QueryInside() */
+  std::vector<const Airspace *> candidates;
+  for (const auto &airspace : airspaces.QueryIntersecting(bounds))
+    candidates.push_back(&airspace);
+
+  const unsigned n_candidates = candidates.size();
+  const unsigned n_jobs = (n_candidates + JOB_SIZE - 1) / JOB_SIZE;
+
+  /* each job collects its results separately, therefore the result
+     does not depend on the order in which the jobs run */
+  std::vector<AirspaceIntrusionList> job_results(n_jobs);
+
+  const std::function<void(unsigned)> job = [&](unsigned j){
+    const unsigned first = j * JOB_SIZE;
+    const unsigned last = std::min(first + JOB_SIZE, n_candidates);
+    for (unsigned c = first; c < last; ++c)
+      ScanAirspace(*candidates[c], c, fixes, points, blocks, job_results[j]);
+  };
+
+  if (parallel)
+    parallel(n_jobs, job);
+  else
+    for (unsigned j = 0; j < n_jobs; ++j)
+      job(j);
+
+  for (const auto &i : job_results)
+    result.insert(result.end(), i.begin(), i.end());
+
+  std::sort(result.begin(), result.end(),
+            [](const AirspaceIntrusion &a, const AirspaceIntrusion &b){
+              return a.begin != b.begin
+                ? a.begin < b.begin
+                : a.order < b.order;
+            });
+
+  return result;
+}
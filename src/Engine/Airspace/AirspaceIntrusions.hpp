@@ -0,0 +1,136 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_INTRUSIONS_HPP
+#define XCSOAR_AIRSPACE_INTRUSIONS_HPP
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+class Airspaces;
+class AbstractAirspace;
+struct AircraftState;
+
+/**
+ * A period of a flight inside an airspace, i.e. a range of
+ * consecutive fixes which are inside its lateral and vertical limits.
+ */
+struct AirspaceIntrusion {
+  const AbstractAirspace *airspace;
+
+  /**
+   * The position of the airspace in the order of
+   * Airspaces::QueryInside().
+   */
+  unsigned order;
+
+  /**
+   * The index of the first fix inside the airspace.
+   */
+  unsigned begin;
+
+  /**
+   * The index after the last fix inside the airspace.
+   */
+  unsigned end;
+};
+
+typedef std::vector<AirspaceIntrusion> AirspaceIntrusionList;
+
+/**
+ * A function which invokes f(i) for each i in the range [0, n),
+ * possibly concurrently, and returns after all invocations have
+ * finished, e.g. JobScheduler::ParallelFor().
+ */
+typedef std::function<void(unsigned n,
+                           const std::function<void(unsigned)> &f)>
+  AirspaceParallelFunction;
+
+/**
+ * Find all periods of a flight inside airspaces.  The result is the
+ * same as calling Airspaces::QueryInside(const AircraftState &) for
+ * each fix, but the airspace tree is queried only once for the whole
+ * flight, and each candidate airspace checks only those parts of the
+ * flight which overlap its bounding box.
+ *
+ * @param fixes the fixes of the flight
+ * @param parallel if set, the candidate airspaces are checked with
+ * this function
+ * @return the intrusions, ordered by their first fix and then by
+ * #AirspaceIntrusion::order
+ */
+AirspaceIntrusionList
+FindAirspaceIntrusions(const Airspaces &airspaces,
+                       const AircraftState *fixes, unsigned n_fixes,
+                       const AirspaceParallelFunction &parallel=nullptr);
+
+/**
+ * Invoke f(fix, intrusion) for each fix inside an airspace, in the
+ * order of calling Airspaces::QueryInside() for each fix.
+ *
+ * @param intrusions the return value of FindAirspaceIntrusions()
+ */
+template<typename F>
+void
+VisitAirspaceIntrusions(const AirspaceIntrusionList &intrusions, F &&f)
+{
+  /* the intrusions containing the current fix, ordered by
+     AirspaceIntrusion::order */
+  std::vector<const AirspaceIntrusion *> active;
+
+  auto next = intrusions.begin();
+  unsigned fix = 0;
+
+  while (true) {
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [fix](const AirspaceIntrusion *i){
+                                  return i->end <= fix;
+                                }),
+                 active.end());
+
+    if (active.empty()) {
+      if (next == intrusions.end())
+        break;
+
+      /* skip the fixes outside of all airspaces */
+      fix = next->begin;
+    }
+
+    for (; next != intrusions.end() && next->begin == fix; ++next) {
+      auto i = std::upper_bound(active.begin(), active.end(), next->order,
+                                [](unsigned order,
+                                   const AirspaceIntrusion *intrusion){
+                                  return order < intrusion->order;
+                                });
+      active.insert(i, &*next);
+    }
+
+    for (const auto *i : active)
+      f(fix, *i);
+
+    ++fix;
+  }
+}
+
+#endif
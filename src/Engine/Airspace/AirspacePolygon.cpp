@@ -25,6 +25,7 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
+#include "Util/StaticArray.hxx"
 
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
                                  const bool prune)
@@ -51,6 +52,26 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
   } else {
     is_convex = TriState::UNKNOWN;
   }
+
+  /* the border will be projected by Project() */
+  arrays.Update(m_border, false);
+}
+
+AirspacePolygon::AirspacePolygon(SearchPointVector &&border)
+  :AbstractAirspace(Shape::POLYGON)
+{
+  assert(border.size() >= 3);
+
+  m_border = std::move(border);
+  is_convex = TriState::UNKNOWN;
+  arrays.Update(m_border);
+}
+
+void
+AirspacePolygon::Project(const FlatProjection &projection)
+{
+  AbstractAirspace::Project(projection);
+  arrays.Update(m_border);
 }
 
 const GeoPoint
@@ -82,27 +103,52 @@ AirspacePolygon::GetCenter() const
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  return arrays.IsInside(loc);
 }
 
 AirspaceIntersectionVector
 AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
                             const FlatProjection &projection) const
 {
-  const FlatRay ray(projection.ProjectInteger(start),
-                    projection.ProjectInteger(end));
+  AirspaceIntersectionVector result;
+  IntersectsMultiple(start, &end, 1, projection, &result);
+  return result;
+}
 
-  AirspaceIntersectSort sorter(start, *this);
+void
+AirspacePolygon::IntersectsMultiple(const GeoPoint &start,
+                                    const GeoPoint *ends, unsigned n,
+                                    const FlatProjection &projection,
+                                    AirspaceIntersectionVector *results) const
+{
+  const auto flat_start = projection.ProjectInteger(start);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
+  StaticArray<FlatRay, 32> rays;
+  for (unsigned i = 0; i < n; ++i)
+    rays.append(FlatRay(flat_start, projection.ProjectInteger(ends[i])));
 
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
-    auto t = ray.DistinctIntersection(r_seg);
-    if (t >= 0)
-      sorter.add(t, projection.Unproject(ray.Parametric(t)));
-  }
+  /* the kernel only finds the intersecting edges, which are rare;
+     the intersection points are calculated the traditional way */
+  std::vector<PolygonArrays::Intersection> edges;
+  arrays.FindIntersections(rays.begin(), n, edges);
 
-  return sorter.all();
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatRay &ray = rays[i];
+    AirspaceIntersectSort sorter(start, *this);
+
+    for (const auto &edge : edges) {
+      if ((edge.rays & (1u << i)) == 0)
+        continue;
+
+      const FlatRay r_seg(m_border[edge.edge].GetFlatLocation(),
+                          m_border[edge.edge + 1].GetFlatLocation());
+      auto t = ray.DistinctIntersection(r_seg);
+      if (t >= 0)
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
+
+    results[i] = sorter.all();
+  }
 }
 
 GeoPoint
@@ -24,6 +24,8 @@
 #define AIRSPACEPOLYGON_HPP
 
 #include "AbstractAirspace.hpp"
+#include "Geo/PolygonArrays.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -32,6 +34,12 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * A copy of #m_border for the SIMD kernels, which are used for
+   * the hot Inside() and Intersects() checks.
+   */
+  PolygonArrays arrays;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -44,6 +52,12 @@ public:
    */
   AirspacePolygon(const std::vector<GeoPoint> &pts, const bool prune = false);
 
+  /**
+   * Constructor for a border which has been projected already,
+   * e.g. one loaded from a cache file.  It must be closed.
+   */
+  explicit AirspacePolygon(SearchPointVector &&border);
+
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const override;
   const GeoPoint GetCenter() const override;
@@ -51,9 +65,16 @@ public:
   AirspaceIntersectionVector Intersects(const GeoPoint &g1,
                                         const GeoPoint &end,
                                         const FlatProjection &projection) const override;
+  void IntersectsMultiple(const GeoPoint &start,
+                          const GeoPoint *ends, unsigned n,
+                          const FlatProjection &projection,
+                          AirspaceIntersectionVector *results) const override;
   GeoPoint ClosestPoint(const GeoPoint &loc,
                         const FlatProjection &projection) const override;
 
+protected:
+  void Project(const FlatProjection &projection) override;
+
 public:
 #ifdef DO_PRINT
   friend std::ostream &operator<<(std::ostream &f,
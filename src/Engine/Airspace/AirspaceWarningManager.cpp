@@ -27,6 +27,9 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
+#include "Util/Macros.hpp"
+
+#include <assert.h>
 
 #define CRUISE_FILTER_FACT 0.5
 
@@ -116,7 +119,14 @@ AirspaceWarningManager::GetNewWarningPtr(const AbstractAirspace &airspace)
   return &warnings.back();
 }
 
-bool 
+struct AirspaceWarningManager::Prediction {
+  GeoPoint location;
+  AirspaceAircraftPerformance perf;
+  AirspaceWarning::State warning_state;
+  double max_time;
+};
+
+bool
 AirspaceWarningManager::Update(const AircraftState& state,
                                const GlidePolar &glide_polar,
                                const TaskStats &task_stats,
@@ -136,11 +146,19 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  InsideList inside;
+  for (const auto &i : airspaces.QueryInside(state.location))
+    inside.push_back(&i.GetAirspace());
+
   // check from strongest to weakest alerts
-  UpdateInside(state, glide_polar);
-  UpdateGlide(state, glide_polar);
-  UpdateFilter(state, circling);
-  UpdateTask(state, glide_polar, task_stats);
+  UpdateInside(state, glide_polar, inside);
+
+  PredictionList predictions;
+  predictions.reserve(3);
+  PredictGlide(state, glide_polar, predictions);
+  PredictFilter(state, circling, predictions);
+  PredictTask(state, glide_polar, task_stats, predictions);
+  UpdatePredicted(state, predictions, inside);
 
   // action changes
   for (auto it = warnings.begin(), end = warnings.end(); it != end;) {
@@ -270,18 +288,20 @@ private:
 };
 
 
-bool 
-AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
-                                         const GeoPoint &location_predicted,
-                                         const AirspaceAircraftPerformance &perf,
-                                         const AirspaceWarning::State warning_state,
-                                        const double max_time)
+void
+AirspaceWarningManager::UpdatePredicted(const AircraftState &state,
+                                        const PredictionList &predictions,
+                                        const InsideList &inside)
 {
-  // this is the time limit of intrusions, beyond which we are not interested.
-  // it can be the minimum of the user set warning time, or the time of the 
-  // task segment
+  const unsigned n = predictions.size();
+
+  GeoPoint ends[3];
+  assert(n <= ARRAY_SIZE(ends));
+  for (unsigned i = 0; i < n; ++i)
+    ends[i] = predictions[i].location;
 
-  const auto max_time_limit = std::min(double(config.warning_time), max_time);
+  Airspaces::IntersectingList intersecting[ARRAY_SIZE(ends)];
+  airspaces.FindIntersecting(state.location, ends, n, intersecting);
 
   // the ceiling is the max height for predicted intrusions, given
   // that you may be climbing.  the ceiling is nominally set at 1000m
@@ -294,41 +314,53 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
   const auto ceiling = state.altitude
     + std::max((unsigned)1000, config.altitude_warning_margin);
 
-  AirspaceIntersectionWarningVisitor visitor(state, perf, 
-                                             *this, 
-                                             warning_state, max_time_limit,
-                                             ceiling);
+  for (unsigned i = 0; i < n; ++i) {
+    const Prediction &prediction = predictions[i];
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+    // this is the time limit of intrusions, beyond which we are not interested.
+    // it can be the minimum of the user set warning time, or the time of the
+    // task segment
 
-  visitor.SetMode(true);
+    const auto max_time_limit = std::min(double(config.warning_time),
+                                         prediction.max_time);
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
-    visitor.Visit(airspace);
-  }
+    AirspaceIntersectionWarningVisitor visitor(state, prediction.perf,
+                                               *this,
+                                               prediction.warning_state,
+                                               max_time_limit,
+                                               ceiling);
+
+    for (auto &j : intersecting[i]) {
+      visitor.SetIntersections(std::move(j.intersections));
+      visitor.Visit(*j.airspace);
+    }
 
-  return visitor.Found();
+    visitor.SetMode(true);
+
+    for (const AbstractAirspace *airspace : inside)
+      visitor.Visit(*airspace);
+  }
 }
 
 
-bool 
-AirspaceWarningManager::UpdateTask(const AircraftState &state,
-                                   const GlidePolar &glide_polar,
-                                   const TaskStats &task_stats)
+void
+AirspaceWarningManager::PredictTask(const AircraftState &state,
+                                    const GlidePolar &glide_polar,
+                                    const TaskStats &task_stats,
+                                    PredictionList &predictions)
 {
   if (!glide_polar.IsValid())
-    return false;
+    return;
 
   const ElementStat &current_leg = task_stats.current_leg;
 
   if (!task_stats.task_valid || !current_leg.location_remaining.IsValid())
-    return false;
+    return;
 
   const GlideResult &solution = current_leg.solution_remaining;
   if (!solution.IsOk() || !solution.IsAchievable())
     /* glide solver failed, cannot continue */
-    return false;
+    return;
 
   const AirspaceAircraftPerformance perf_task(glide_polar,
                                               current_leg.solution_remaining);
@@ -342,60 +374,60 @@ AirspaceWarningManager::UpdateTask(const AircraftState &state,
        the configured warning time */
     location_tp = state.location.IntermediatePoint(location_tp, max_distance);
 
-  return UpdatePredicted(state, location_tp, perf_task,
-                          AirspaceWarning::WARNING_TASK, time_remaining);
+  predictions.push_back({location_tp, perf_task,
+                         AirspaceWarning::WARNING_TASK, time_remaining});
 }
 
 
-bool 
-AirspaceWarningManager::UpdateFilter(const AircraftState& state, const bool circling)
+void
+AirspaceWarningManager::PredictFilter(const AircraftState& state,
+                                      const bool circling,
+                                      PredictionList &predictions)
 {
   // update both filters even though we are using only one
   cruise_filter.Update(state);
   circling_filter.Update(state);
 
-  const GeoPoint location_predicted = circling?
-    circling_filter.GetPredictedState(prediction_time_filter).location:
-    cruise_filter.GetPredictedState(prediction_time_filter).location;
-
-  if (circling) 
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(circling_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
-  else
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(cruise_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
+  const AircraftStateFilter &filter = circling
+    ? circling_filter
+    : cruise_filter;
+
+  predictions.push_back({filter.GetPredictedState(prediction_time_filter).location,
+                         AirspaceAircraftPerformance(filter),
+                         AirspaceWarning::WARNING_FILTER,
+                         prediction_time_filter});
 }
 
 
-bool 
-AirspaceWarningManager::UpdateGlide(const AircraftState &state,
-                                    const GlidePolar &glide_polar)
+void
+AirspaceWarningManager::PredictGlide(const AircraftState &state,
+                                     const GlidePolar &glide_polar,
+                                     PredictionList &predictions)
 {
   if (!glide_polar.IsValid())
-    return false;
+    return;
 
-  const GeoPoint location_predicted = 
+  const GeoPoint location_predicted =
     state.GetPredictedState(prediction_time_glide).location;
 
-  const AirspaceAircraftPerformance perf_glide(glide_polar);
-  return UpdatePredicted(state, location_predicted,
-                          perf_glide,
-                          AirspaceWarning::WARNING_GLIDE, prediction_time_glide);
+  predictions.push_back({location_predicted,
+                         AirspaceAircraftPerformance(glide_polar),
+                         AirspaceWarning::WARNING_GLIDE,
+                         prediction_time_glide});
 }
 
 bool
 AirspaceWarningManager::UpdateInside(const AircraftState& state,
-                                     const GlidePolar &glide_polar)
+                                     const GlidePolar &glide_polar,
+                                     const InsideList &inside)
 {
   if (!glide_polar.IsValid())
     return false;
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
+  for (const AbstractAirspace *i : inside) {
+    const AbstractAirspace &airspace = *i;
 
     const AltitudeState &altitude = state;
     if (// ignore inactive airspaces
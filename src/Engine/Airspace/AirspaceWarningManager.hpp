@@ -28,6 +28,7 @@
 #include "Compiler.h"
 
 #include <list>
+#include <vector>
 
 class TaskStats;
 class GlidePolar;
@@ -261,17 +262,35 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const;
 
 private:
-  bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
-                  const TaskStats &task_stats);
-  bool UpdateFilter(const AircraftState& state, const bool circling);
-  bool UpdateGlide(const AircraftState& state, const GlidePolar &glide_polar);
-  bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar);
-
-  bool UpdatePredicted(const AircraftState& state, 
-                       const GeoPoint &location_predicted,
-                       const AirspaceAircraftPerformance &perf,
-                       const AirspaceWarning::State warning_state,
-                       double max_time);
+  /**
+   * A vector along which intrusions are predicted.
+   */
+  struct Prediction;
+
+  typedef std::vector<Prediction> PredictionList;
+
+  /**
+   * The airspaces the aircraft is inside (horizontally).
+   */
+  typedef std::vector<const AbstractAirspace *> InsideList;
+
+  void PredictTask(const AircraftState &state, const GlidePolar &glide_polar,
+                   const TaskStats &task_stats, PredictionList &predictions);
+  void PredictFilter(const AircraftState& state, const bool circling,
+                     PredictionList &predictions);
+  void PredictGlide(const AircraftState& state, const GlidePolar &glide_polar,
+                    PredictionList &predictions);
+  bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar,
+                    const InsideList &inside);
+
+  /**
+   * Check all predicted vectors for intrusions; the intersections of
+   * all of them are calculated at a time, but they are applied one
+   * after the other, in the order of the list.
+   */
+  void UpdatePredicted(const AircraftState& state,
+                       const PredictionList &predictions,
+                       const InsideList &inside);
 };
 
 #endif
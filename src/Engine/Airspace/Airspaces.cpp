@@ -25,11 +25,19 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "Predicate/AirspacePredicate.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "Util/StaticArray.hxx"
 
 #include <boost/geometry/geometries/linestring.hpp>
 
 namespace bgi = boost::geometry::index;
 
+/**
+ * If more than 1/REBUILD_RATIO of the tree's size is pending
+ * insertion, Optimise() rebuilds the whole tree instead of inserting
+ * the new airspaces one by one.
+ */
+static constexpr size_t REBUILD_RATIO = 4;
+
 Airspaces::const_iterator_range
 Airspaces::QueryWithinRange(const GeoPoint &location, double range) const
 {
@@ -56,6 +64,16 @@ Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const
   return {airspace_tree.qbegin(bgi::intersects(line)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QueryIntersecting(const FlatBoundingBox &box) const
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 void
 Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
                              bool include_inside,
@@ -81,6 +99,60 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
   }
 }
 
+void
+Airspaces::FindIntersecting(const GeoPoint &location,
+                            const GeoPoint *ends, unsigned n,
+                            IntersectingList *results) const
+{
+  assert(n <= 32);
+
+  if (IsEmpty() || n == 0)
+    // nothing to do
+    return;
+
+  const FlatGeoPoint flat_location = task_projection.ProjectInteger(location);
+
+  /* query the bounding box of all vectors, and filter the results
+     with the same predicate as QueryIntersecting(); this yields the
+     same airspaces in the same order */
+  std::vector<boost::geometry::model::linestring<FlatGeoPoint>> lines(n);
+  FlatBoundingBox box(flat_location, flat_location);
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint flat_end = task_projection.ProjectInteger(ends[i]);
+    lines[i].push_back(flat_location);
+    lines[i].push_back(flat_end);
+    box.Expand(flat_end);
+  }
+
+  for (auto i = airspace_tree.qbegin(bgi::intersects(box)),
+         end = airspace_tree.qend(); i != end; ++i) {
+    const FlatBoundingBox &airspace_box = *i;
+
+    StaticArray<GeoPoint, 32> hit_ends;
+    StaticArray<unsigned, 32> hit_indices;
+    for (unsigned j = 0; j < n; ++j) {
+      if (boost::geometry::intersects(airspace_box, lines[j])) {
+        hit_ends.append(ends[j]);
+        hit_indices.append(j);
+      }
+    }
+
+    if (hit_ends.empty())
+      continue;
+
+    const AbstractAirspace &airspace = i->GetAirspace();
+
+    AirspaceIntersectionVector intersections[32];
+    airspace.IntersectsMultiple(location, hit_ends.begin(), hit_ends.size(),
+                                task_projection, intersections);
+
+    for (unsigned j = 0; j < hit_ends.size(); ++j)
+      if (!intersections[j].empty())
+        results[hit_indices[j]].push_back({&airspace,
+              std::move(intersections[j])});
+  }
+}
+
 void
 Airspaces::Optimise()
 {
@@ -100,9 +172,25 @@ Airspaces::Optimise()
     airspace_tree.clear();
   }
 
-  for (AbstractAirspace *i : tmp_as) {
-    Airspace as(*i, task_projection);
-    airspace_tree.insert(as);
+  if (tmp_as.size() * REBUILD_RATIO > airspace_tree.size()) {
+    /* bulk-load a new tree; this is much faster than inserting all
+       airspaces one by one, and the packed tree has less overlap
+       between its nodes */
+    AirspaceVector v;
+    v.reserve(airspace_tree.size() + tmp_as.size());
+
+    for (const auto &i : QueryAll())
+      v.push_back(i);
+
+    for (AbstractAirspace *i : tmp_as)
+      v.emplace_back(*i, task_projection);
+
+    airspace_tree = AirspaceTree(v.begin(), v.end());
+  } else {
+    for (AbstractAirspace *i : tmp_as) {
+      Airspace as(*i, task_projection);
+      airspace_tree.insert(as);
+    }
   }
 
   tmp_as.clear();
@@ -110,6 +198,24 @@ Airspaces::Optimise()
   ++serial;
 }
 
+void
+Airspaces::Restore(const TaskProjection &projection, AirspaceVector &&items)
+{
+  assert(owns_children);
+  assert(IsEmpty());
+
+  if (items.empty())
+    return;
+
+  qnh = AtmosphericPressure::Zero();
+  activity_mask.SetAll();
+
+  task_projection = projection;
+  airspace_tree = AirspaceTree(items.begin(), items.end());
+
+  ++serial;
+}
+
 void
 Airspaces::Add(AbstractAirspace *airspace)
 {
@@ -248,10 +354,8 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
 
   for (auto &i : QueryAll())
     i.ClearClearance();
-  airspace_tree.clear();
 
-  for (const auto &i : contents_master)
-    airspace_tree.insert(i);
+  airspace_tree = AirspaceTree(contents_master.begin(), contents_master.end());
 
   ++serial;
 
@@ -25,12 +25,14 @@
 
 #include "AirspacesInterface.hpp"
 #include "AirspaceActivity.hpp"
+#include "AirspaceIntersectionVector.hpp"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Compiler.h"
 
 #include <deque>
+#include <vector>
 
 class RasterTerrain;
 class AirspaceIntersectionVisitor;
@@ -58,6 +60,16 @@ class Airspaces : public AirspacesInterface {
   Serial serial;
 
 public:
+  /**
+   * An airspace intersected by a vector, see FindIntersecting().
+   */
+  struct Intersecting {
+    const AbstractAirspace *airspace;
+    AirspaceIntersectionVector intersections;
+  };
+
+  typedef std::vector<Intersecting> IntersectingList;
+
   /**
    * Constructor.
    * Note this class can't safely be copied (yet)
@@ -97,9 +109,22 @@ public:
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
+   *
+   * Small batches are inserted into the existing tree; large batches
+   * and changes of the projection rebuild the whole tree with a bulk
+   * load.
    */
   void Optimise();
 
+  /**
+   * Fill this empty instance with airspaces which have been projected
+   * with the given projection already, e.g. loaded from a cache file.
+   * The tree is bulk-loaded from the given envelopes, without
+   * projecting anything.  Ownership of the airspace objects is
+   * transferred to this class.
+   */
+  void Restore(const TaskProjection &projection, AirspaceVector &&items);
+
   /**
    * Clear the airspace store, deleting airspace objects if m_owner is true
    */
@@ -170,6 +195,14 @@ public:
   const_iterator_range QueryIntersecting(const GeoPoint &a,
                                          const GeoPoint &b) const;
 
+  /**
+   * Query airspaces whose bounding box overlaps the given one, which
+   * must be in the projection of GetProjection().  The result is in
+   * the order of the tree, which is also the order of QueryInside().
+   */
+  gcc_pure
+  const_iterator_range QueryIntersecting(const FlatBoundingBox &box) const;
+
   /**
    * Call visitor class on airspaces intersected by vector.
    * Note that the visitor is not instantiated separately for each match
@@ -189,6 +222,24 @@ public:
     VisitIntersecting(location, end, false, visitor);
   }
 
+  /**
+   * Find the airspaces intersected by several vectors starting at the
+   * same location.  This is equivalent to calling
+   * QueryIntersecting() and Airspace::Intersects() for each vector,
+   * but the tree is traversed only once, and each airspace tests all
+   * vectors at a time (see AbstractAirspace::IntersectsMultiple()).
+   *
+   * @param location location of origin of all vectors
+   * @param ends the ends of the vectors
+   * @param n the number of vectors; at most 32
+   * @param results receives one list per vector; each one contains
+   * the airspaces with at least one intersection, in the order of
+   * QueryIntersecting()
+   */
+  void FindIntersecting(const GeoPoint &location,
+                        const GeoPoint *ends, unsigned n,
+                        IntersectingList *results) const;
+
   /**
    * Query airspaces this location is inside.
    *
@@ -206,7 +257,7 @@ public:
   gcc_pure
   const_iterator_range QueryInside(const AircraftState &aircraft) const;
 
-  const FlatProjection &GetProjection() const {
+  const TaskProjection &GetProjection() const {
     return task_projection;
   }
 
@@ -116,6 +116,33 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunContests(AbstractContest &a, unsigned a_index,
+                            AbstractContest &b, unsigned b_index,
+                            bool exhaustive)
+{
+  if (!parallel) {
+    bool retval = RunContest(a, stats.result[a_index],
+                             stats.solution[a_index], exhaustive);
+    retval |= RunContest(b, stats.result[b_index],
+                         stats.solution[b_index], exhaustive);
+    return retval;
+  }
+
+  /* the two solvers write to different slots of #stats, so they
+     don't need any locking */
+  bool retval[2];
+  parallel(2, [&](unsigned i){
+      retval[i] = i == 0
+        ? RunContest(a, stats.result[a_index],
+                     stats.solution[a_index], exhaustive)
+        : RunContest(b, stats.result[b_index],
+                     stats.solution[b_index], exhaustive);
+    });
+
+  return retval[0] || retval[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -151,11 +178,7 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(olc_classic, 0, olc_fai, 1, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -173,17 +196,11 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(xcontest_free, 0, xcontest_triangle, 1, exhaustive);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(dhv_xc_free, 0, dhv_xc_triangle, 1, exhaustive);
     break;
 
   case Contest::SIS_AT:
@@ -219,6 +236,25 @@ ContestManager::Reset()
   net_coupe.Reset();
 }
 
+unsigned
+ContestManager::GetTriangleIterations() const
+{
+  switch (contest) {
+  case Contest::OLC_FAI:
+  case Contest::OLC_PLUS:
+    return olc_fai.GetIterations();
+
+  case Contest::XCONTEST:
+    return xcontest_triangle.GetIterations();
+
+  case Contest::DHV_XC:
+    return dhv_xc_triangle.GetIterations();
+
+  default:
+    return 0;
+  }
+}
+
 /*
 
 - SearchPointVector find self intersections (for OLC-FAI)
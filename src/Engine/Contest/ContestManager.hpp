@@ -36,6 +36,8 @@
 #include "Solvers/NetCoupe.hpp"
 #include "ContestStatistics.hpp"
 
+#include <functional>
+
 class Trace;
 
 /**
@@ -45,8 +47,24 @@ class ContestManager
 {
   friend class PrintHelper;
 
+public:
+  /**
+   * A function which invokes f(i) for each i in the range [0, n),
+   * possibly concurrently, and returns after all invocations have
+   * finished, e.g. JobScheduler::ParallelFor().
+   */
+  typedef std::function<void(unsigned n,
+                             const std::function<void(unsigned)> &f)>
+    ParallelFunction;
+
+private:
   Contest contest;
 
+  /**
+   * If set, then independent solvers are run with this function.
+   */
+  ParallelFunction parallel;
+
   ContestStatistics stats;
 
   OLCSprint olc_sprint;
@@ -96,6 +114,17 @@ public:
 
   void SetHandicap(unsigned handicap);
 
+  /**
+   * Run independent solvers (e.g. the free flight and the triangle
+   * of #Contest::XCONTEST) concurrently with the given function.
+   * Each solver works on its own copy of the trace, and the results
+   * are stored in #ContestStatistics in the same order as in serial
+   * operation.  An empty function restores serial operation.
+   */
+  void SetParallel(ParallelFunction &&_parallel) {
+    parallel = std::move(_parallel);
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -130,6 +159,25 @@ public:
   const ContestStatistics &GetStats() const {
     return stats;
   }
+
+  /**
+   * Returns the number of branch and bound iterations the triangle
+   * solver of the selected contest has needed since the last
+   * Reset(), or 0 if the contest has no triangle solver.
+   */
+  gcc_pure
+  unsigned GetTriangleIterations() const;
+
+private:
+  /**
+   * Run two independent solvers, concurrently if a #ParallelFunction
+   * was set.
+   *
+   * @return true if one of the solvers has found a new solution
+   */
+  bool RunContests(AbstractContest &a, unsigned a_index,
+                   AbstractContest &b, unsigned b_index,
+                   bool exhaustive);
 };
 
 #endif
@@ -25,6 +25,8 @@
 #include "Trace/Trace.hpp"
 #include "Util/QuadTree.hpp"
 
+#include <assert.h>
+
 /*
  @todo potential to use 3d convex hull to speed search
 
@@ -64,7 +66,8 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
    is_closed(false),
    is_complete(false),
    max_iterations(1e6),
-   max_tree_size(5e5)
+   max_tree_size(5e5),
+   total_iterations(0)
 {
 }
 
@@ -78,9 +81,11 @@ OLCTriangle::Reset()
   // set tick_iterations to a default value,
   // this should be adjusted when the trace size is known
   tick_iterations = 1000;
+  total_iterations = 0;
 
   closing_pairs.Clear();
   ClearTrace();
+  range_boxes.clear();
 
   ResetBranchAndBound();
   AbstractContest::Reset();
@@ -122,11 +127,14 @@ OLCTriangle::UpdateTrace(bool force)
     closing_pairs.Clear();
     is_closed = FindClosingPairs(0);
 
+    UpdateRangeBoxes();
    } else if (is_complete && incremental) {
     const unsigned old_size = n_points;
     if (UpdateTraceTail()) {
       is_complete = false;
       is_closed = FindClosingPairs(old_size);
+
+      UpdateRangeBoxes();
     }
   }
 
@@ -140,6 +148,53 @@ OLCTriangle::UpdateTrace(bool force)
   tick_iterations = n_points * n_points / 8;
 }
 
+void
+OLCTriangle::UpdateRangeBoxes()
+{
+  range_boxes.clear();
+  if (n_points == 0)
+    return;
+
+  unsigned n_levels = 1;
+  while ((2u << (n_levels - 1)) <= n_points)
+    ++n_levels;
+
+  range_boxes.reserve(n_levels * n_points);
+
+  for (unsigned i = 0; i < n_points; ++i)
+    range_boxes.emplace_back(GetPoint(i).GetFlatLocation());
+
+  /* level k merges two adjacent boxes of level k-1; the entries
+     beyond the end of the trace are only padding and will never be
+     looked up */
+  for (unsigned k = 1, half = 1; k < n_levels; ++k, half *= 2) {
+    const unsigned base = (k - 1) * n_points;
+    for (unsigned i = 0; i < n_points; ++i) {
+      FlatBoundingBox box = range_boxes[base + i];
+      if (i + half < n_points)
+        box.Merge(range_boxes[base + i + half]);
+      range_boxes.push_back(box);
+    }
+  }
+}
+
+FlatBoundingBox
+OLCTriangle::GetRangeBox(unsigned min, unsigned max) const
+{
+  assert(min < max);
+  assert(max <= n_points);
+  assert(!range_boxes.empty());
+
+  /* the two overlapping power-of-two ranges which cover [min,max) */
+  unsigned level = 0;
+  while ((2u << level) <= max - min)
+    ++level;
+
+  const unsigned base = level * n_points;
+  FlatBoundingBox box = range_boxes[base + min];
+  box.Merge(range_boxes[base + max - (1u << level)]);
+  return box;
+}
 
 SolverResult
 OLCTriangle::Solve(bool exhaustive)
@@ -342,6 +397,9 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
 
     // initialize bound-and-branch tree with root node (note: Candidate set interval is [min, max))
     CandidateSet root_candidates(*this, from, to + 1);
+    if (is_fai)
+      root_candidates.TightenFAIBound(large_triangle_check);
+
     if (root_candidates.IsFeasible(is_fai, large_triangle_check) &&
         root_candidates.df_max >= worst_d)
       branch_and_bound.insert(std::pair<unsigned, CandidateSet>(root_candidates.df_max, root_candidates));
@@ -454,6 +512,11 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
       }
 
       if (add) {
+        if (is_fai) {
+          left.TightenFAIBound(large_triangle_check);
+          right.TightenFAIBound(large_triangle_check);
+        }
+
         // add the new candidate set only if it it's feasible and has d_min >= worst_d
         if (left.df_max >= worst_d &&
             left.IsFeasible(is_fai, large_triangle_check)) {
@@ -472,6 +535,8 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   }
 
 
+  total_iterations += iterations;
+
   if (branch_and_bound.empty())
     running = false;
 
@@ -29,6 +29,8 @@
 #include "Geo/Flat/FlatBoundingBox.hpp"
 
 #include <map>
+#include <vector>
+#include <algorithm>
 
 /**
  * Specialisation of AbstractContest for OLC Triangle (triangle) rules
@@ -91,51 +93,90 @@ private:
   unsigned max_iterations,
            max_tree_size;
 
+  /**
+   * The number of branch and bound iterations since the last
+   * Reset(), for diagnostics.
+   */
+  unsigned total_iterations;
+
+  /**
+   * The bounding boxes of all ranges of trace points whose size is a
+   * power of two, which allows looking up the bounding box of any
+   * range in constant time.  Level k (at offset k * n_points)
+   * contains at position i the bounding box of the points
+   * [i, i + 2^k).
+   */
+  std::vector<FlatBoundingBox> range_boxes;
+
   typedef std::pair<unsigned, unsigned> ClosingPair;
 
+  /**
+   * A set of closing pairs, sorted by the first index.  No pair
+   * contains one which follows it, therefore the last index never
+   * decreases, and both indexes can be looked up with a binary
+   * search.
+   */
   struct ClosingPairs {
-    std::map<unsigned, unsigned> closing_pairs;
+    std::vector<ClosingPair> closing_pairs;
 
     bool Insert(const ClosingPair &p) {
       auto found = FindRange(p);
       if (found.first == 0 && found.second == 0) {
-        const auto result = closing_pairs.insert(p);
-        if (!result.second)
-          result.first->second = p.second;
-        RemoveRange(std::next(result.first), p.second);
+        auto i = std::lower_bound(closing_pairs.begin(), closing_pairs.end(),
+                                  p.first,
+                                  [](const ClosingPair &a, unsigned b){
+                                    return a.first < b;
+                                  });
+        if (i != closing_pairs.end() && i->first == p.first)
+          i->second = p.second;
+        else
+          i = closing_pairs.insert(i, p);
+
+        RemoveRange(std::next(i), p.second);
         return true;
       } else {
         return false;
       }
     }
 
+    /**
+     * Find the first pair which contains the given one.  Returns
+     * (0, 0) if there is none.
+     */
     gcc_pure
     ClosingPair FindRange(const ClosingPair &p) const {
-      for (const auto &i : closing_pairs) {
-        if (i.first > p.first)
-          break;
-
-        if (i.second >= p.second)
-          return i;
-      }
+      /* all pairs from here on end at or after p.second; the first of
+         them contains p if it doesn't start after p.first */
+      const auto i = LowerBoundLast(closing_pairs.begin(),
+                                    closing_pairs.end(), p.second);
+      if (i != closing_pairs.end() && i->first <= p.first)
+        return *i;
 
       return ClosingPair(0, 0);
     }
 
-    void RemoveRange(std::map<unsigned, unsigned>::iterator it,
+    /**
+     * Remove all pairs from the given position on which end before
+     * the given index.
+     */
+    void RemoveRange(std::vector<ClosingPair>::iterator it,
                      unsigned last) {
-      const auto end = closing_pairs.end();
-      while (it != end) {
-        if (it->second < last)
-          it = closing_pairs.erase(it);
-        else
-          it++;
-      }
+      closing_pairs.erase(it, LowerBoundLast(it, closing_pairs.end(), last));
     }
 
     void Clear() {
       closing_pairs.clear();
     }
+
+  private:
+    template<typename I>
+    gcc_pure
+    static I LowerBoundLast(I begin, I end, unsigned last) {
+      return std::lower_bound(begin, end, last,
+                              [](const ClosingPair &a, unsigned b){
+                                return a.second < b;
+                              });
+    }
   };
 
   ClosingPairs closing_pairs;
@@ -173,10 +214,7 @@ private:
 
     // updates the bounding box by a given point range
     void Update(const OLCTriangle &parent, unsigned _min, unsigned _max) {
-      bounding_box = FlatBoundingBox(parent.GetPoint(_min).GetFlatLocation());
-
-      for (unsigned i = _min + 1; i < _max; ++i)
-        bounding_box.Expand(parent.GetPoint(i).GetFlatLocation());
+      bounding_box = parent.GetRangeBox(_min, _max);
 
       index_min = _min;
       index_max = _max;
@@ -241,6 +279,18 @@ private:
                         shortest_max * 4);
     }
 
+    /**
+     * Lower #df_max with the FAI shortest leg rule for small
+     * triangles: if the large triangle rule cannot apply, because
+     * even a shortest leg of 25% doesn't allow a large triangle, then
+     * the shortest leg must be at least 28% (here: 27.5%, as in
+     * IsFeasible()).
+     */
+    void TightenFAIBound(const unsigned large_triangle_check) {
+      if (df_max < large_triangle_check)
+        df_max = std::min(df_max, shortest_max * 40 / 11);
+    }
+
     bool operator==(CandidateSet other) const {
       return (tp1 == other.tp1 && tp2 == other.tp2 && tp3 == other.tp3);
     }
@@ -351,6 +401,18 @@ protected:
   void UpdateTrace(bool force) override;
   void ResetBranchAndBound();
 
+private:
+  /**
+   * Rebuild #range_boxes after the trace has been modified.
+   */
+  void UpdateRangeBoxes();
+
+  /**
+   * Returns the bounding box of the trace points [min, max).
+   */
+  gcc_pure
+  FlatBoundingBox GetRangeBox(unsigned min, unsigned max) const;
+
 public:
   void SetMaxIterations(unsigned _max_iterations) {
     max_iterations = _max_iterations;
@@ -360,6 +422,14 @@ public:
     max_tree_size = _max_tree_size;
   };
 
+  /**
+   * Returns the number of branch and bound iterations since the
+   * last Reset().
+   */
+  unsigned GetIterations() const {
+    return total_iterations;
+  }
+
   /* virtual methods from AbstractContest */
   void Reset() override;
   SolverResult Solve(bool exhaustive) override;
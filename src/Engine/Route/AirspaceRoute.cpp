@@ -297,7 +297,7 @@ void
 AirspaceRoute::OnSolve(const AGeoPoint &origin, const AGeoPoint &destination)
 {
   if (m_airspaces.IsEmpty()) {
-    projection.SetCenter(origin);
+    RoutePlanner::OnSolve(origin, destination);
   } else {
     projection = m_airspaces.GetProjection();
   }
@@ -27,6 +27,8 @@
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <assert.h>
+
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
 
@@ -34,6 +36,8 @@
 #define REACH_MIN_STEP 25
 #define REACH_MAX_VERTICES 2000
 
+typedef std::chrono::steady_clock Clock;
+
 static bool
 AlmostTheSame(const FlatGeoPoint p1, const FlatGeoPoint p2)
 {
@@ -63,6 +67,38 @@ FlatTriangleFanTree::CalcBB()
   }
 }
 
+static bool
+IsFull(const ReachFanParms &parms)
+{
+  return parms.vertex_counter > REACH_MAX_VERTICES ||
+    parms.fan_counter > FlatTriangleFanTree::REACH_MAX_FANS;
+}
+
+/**
+ * Decide whether the next tree level is expected to finish before
+ * the deadline.  If only a coarser search would, switch to it.
+ *
+ * @param estimate the expected duration of the next level with the
+ * current probe step
+ */
+static bool
+FitsBudget(ReachFanParms &parms, Clock::time_point now,
+           Clock::duration estimate)
+{
+  if (now + estimate <= parms.deadline)
+    return true;
+
+  if (parms.gap_step >= 0.2)
+    return false;
+
+  /* doubling the step roughly halves the number of probes per gap */
+  if (now + estimate / 2 > parms.deadline)
+    return false;
+
+  parms.gap_step = 0.2;
+  return true;
+}
+
 void
 FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
                                ReachFanParms &parms)
@@ -71,12 +107,32 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
 
   FillReach(origin, 0, ROUTEPOLAR_POINTS, parms);
 
+  /* the number of fans at the next depth, and the time the previous
+     level took per fan; used to estimate the duration of the next
+     level */
+  unsigned n_fans = 1;
+  Clock::duration per_fan = Clock::duration::zero();
+
   for (parms.set_depth = 0; parms.set_depth < REACH_MAX_DEPTH;
-      ++parms.set_depth)
-    if (!FillDepth(origin, parms))
+      ++parms.set_depth) {
+    const auto start = Clock::now();
+    if (!FitsBudget(parms, start, per_fan * n_fans))
+      break;
+
+    const unsigned fans_before = parms.fan_counter;
+    if (!(parms.parallel != nullptr
+          ? FillLevel(origin, parms)
+          : FillDepth(origin, parms)))
       // stop searching
       break;
 
+    per_fan = (Clock::now() - start) / n_fans;
+    n_fans = parms.fan_counter - fans_before;
+    if (n_fans == 0)
+      // no deeper fans to search
+      break;
+  }
+
   // this boundingbox update visits the tree recursively
   CalcBB();
 }
@@ -99,9 +155,7 @@ FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
       return true;
     gaps_filled = true;
 
-    if (parms.vertex_counter > REACH_MAX_VERTICES)
-      return false;
-    if (parms.fan_counter > REACH_MAX_FANS)
+    if (IsFull(parms))
       return false;
 
     FillGaps(origin, parms);
@@ -113,6 +167,74 @@ FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
   return true;
 }
 
+void
+FlatTriangleFanTree::CollectDepth(unsigned char d,
+                                  std::vector<FlatTriangleFanTree *> &dest)
+{
+  if (depth == d)
+    dest.push_back(this);
+  else if (depth < d)
+    for (auto &child : children)
+      child.CollectDepth(d, dest);
+}
+
+bool
+FlatTriangleFanTree::FillLevel(const AFlatGeoPoint &origin,
+                               ReachFanParms &parms)
+{
+  assert(IsRoot());
+  assert(parms.parallel != nullptr);
+
+  std::vector<FlatTriangleFanTree *> nodes;
+  CollectDepth(parms.set_depth, nodes);
+
+  struct Gap {
+    FlatTriangleFanTree *node;
+    RouteLink e_1, e_2;
+    FlatTriangleFanTree child;
+    bool found;
+  };
+
+  std::vector<Gap> gaps;
+  if (!IsFull(parms))
+    for (auto *node : nodes)
+      if (!node->gaps_filled)
+        node->VisitGaps(origin, parms,
+                        [node, &gaps](const RouteLink &e_1,
+                                      const RouteLink &e_2){
+                          gaps.push_back({node, e_1, e_2,
+                                FlatTriangleFanTree(node->depth + 1),
+                                false});
+                        });
+
+  /* the gaps are independent of each other; the counters are not
+     checked while filling the gaps of one fan, so they can be
+     applied afterwards */
+  (*parms.parallel)(gaps.size(), [&gaps, &origin, &parms](unsigned i){
+      Gap &gap = gaps[i];
+      gap.found = gap.node->CheckGap(origin, gap.e_1, gap.e_2, parms,
+                                     gap.child);
+    });
+
+  /* merge the children in the order FillDepth() would have added
+     them, stopping where it would have stopped */
+  auto gap = gaps.begin();
+  for (auto *node : nodes) {
+    if (node->gaps_filled)
+      continue;
+    node->gaps_filled = true;
+
+    if (IsFull(parms))
+      return false;
+
+    for (; gap != gaps.end() && gap->node == node; ++gap)
+      if (gap->found)
+        node->AddChild(std::move(gap->child), parms);
+  }
+
+  return true;
+}
+
 bool
 FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
                                const int index_high,
@@ -131,8 +253,30 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   }
 
   AddOrigin(origin, index_high - index_low);
+
+  /* the rays of the root fan are independent of each other, scan
+     them in sectors concurrently */
+  FlatGeoPoint intercepts[ROUTEPOLAR_POINTS];
+  const bool parallel = IsRoot() && parms.parallel != nullptr;
+  if (parallel) {
+    assert(index_high - index_low <= ROUTEPOLAR_POINTS);
+
+    static constexpr unsigned SECTOR = 4;
+    const unsigned n = index_high - index_low;
+    (*parms.parallel)((n + SECTOR - 1) / SECTOR,
+                      [&](unsigned sector){
+                        const unsigned end = std::min(n, (sector + 1) * SECTOR);
+                        for (unsigned i = sector * SECTOR; i < end; ++i)
+                          intercepts[i] = parms.ReachIntercept(index_low + i,
+                                                               origin,
+                                                               geo_origin);
+                      });
+  }
+
   for (int index = index_low; index < index_high; ++index) {
-    FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
+    FlatGeoPoint x = parallel
+      ? intercepts[index - index_low]
+      : parms.ReachIntercept(index, origin, geo_origin);
     /* if ReachIntercept() did not find anything reasonable it returns
        a FlatGeoPoint that is almost the same as origin, but differs
        +/- 1 due to conversion errors. The resulting polygon can have
@@ -146,8 +290,10 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   return CommitPoints(IsRoot());
 }
 
+template<typename F>
 void
-FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
+FlatTriangleFanTree::VisitGaps(const AFlatGeoPoint &origin,
+                               const ReachFanParms &parms, F &&f) const
 {
   // worth checking for gaps?
   if (vs.size() > 2 && parms.rpolars.IsTurningReachEnabled()) {
@@ -162,13 +308,34 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
 
       const RouteLink e(RoutePoint(*x, 0), origin, parms.projection);
       // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      f(e_last, e);
 
       e_last = e;
     }
   }
 }
 
+void
+FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
+{
+  VisitGaps(origin, parms,
+            [this, &origin, &parms](const RouteLink &e_1,
+                                    const RouteLink &e_2){
+              FlatTriangleFanTree child(depth + 1);
+              if (CheckGap(origin, e_1, e_2, parms, child))
+                AddChild(std::move(child), parms);
+            });
+}
+
+void
+FlatTriangleFanTree::AddChild(FlatTriangleFanTree &&child,
+                              ReachFanParms &parms)
+{
+  parms.vertex_counter += child.vs.size();
+  parms.fan_counter++;
+  children.emplace_back(std::move(child));
+}
+
 void
 FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
                                        ReachFanParms &parms)
@@ -198,7 +365,9 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
 
 bool
 FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                              const RouteLink &e_2, ReachFanParms &parms)
+                              const RouteLink &e_2,
+                              const ReachFanParms &parms,
+                              FlatTriangleFanTree &child) const
 {
   const bool side = (e_1.d > e_2.d);
   const RouteLink &e_long = (side ? e_1 : e_2);
@@ -208,9 +377,6 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
 
   const FlatGeoPoint &p_long = e_long.first;
 
-  // return true if this gap was caught (applicable) whether or not it generated
-  // a change
-
   const auto f0 = e_short.d * e_long.inv_d;
   const int h_loss =
     parms.rpolars.CalcGlideArrival(n, p_long, parms.projection) - n.altitude;
@@ -227,7 +393,7 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     index_right = e_long.polar_index + REACH_SWEEP;
   }
 
-  for (auto f = f0; f < 0.9; f += 0.1) {
+  for (auto f = f0; f < 0.9; f += parms.gap_step) {
     // find corner point
     const FlatGeoPoint px = (dp * f + FlatGeoPoint(n));
     // position x is length (n to p_short) along (n to p_long)
@@ -236,13 +402,9 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     // altitude calculated from pure glide from n to x
     const AFlatGeoPoint x(px, h);
 
-    FlatTriangleFanTree child(depth + 1);
-    if (child.FillReach(x, index_left, index_right, parms)) {
-      parms.vertex_counter += child.vs.size();
-      parms.fan_counter++;
-      children.emplace_back(std::move(child));
+    child.Clear();
+    if (child.FillReach(x, index_left, index_right, parms))
       return true;
-    }
   }
 
   return false;
@@ -28,6 +28,7 @@
 #include "FlatTriangleFan.hpp"
 
 #include <list>
+#include <vector>
 
 class FlatProjection;
 struct GeoPoint;
@@ -101,10 +102,26 @@ public:
                  const ReachFanParms &parms);
 
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
+  /**
+   * Like FillDepth(), but search the gaps of all fans at the depth
+   * ReachFanParms::set_depth concurrently with
+   * ReachFanParms::parallel.  The result is the same as with
+   * FillDepth().
+   */
+  bool FillLevel(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
   void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms);
 
+  /**
+   * Search a child fan which covers the gap between the two edges.
+   *
+   * @param child an empty fan at depth+1 which receives the result
+   * @return true if a child fan was found
+   */
   bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                const RouteLink &e_2, ReachFanParms &parms);
+                const RouteLink &e_2, const ReachFanParms &parms,
+                FlatTriangleFanTree &child) const;
 
   bool FindPositiveArrival(FlatGeoPoint n,
                            const ReachFanParms &parms,
@@ -117,6 +134,23 @@ public:
 
   gcc_pure
   int DirectArrival(FlatGeoPoint dest, const ReachFanParms &parms) const;
+
+private:
+  /**
+   * Invoke f(e_1, e_2) for each pair of adjacent edges which may
+   * need a child fan.
+   */
+  template<typename F>
+  void VisitGaps(const AFlatGeoPoint &origin, const ReachFanParms &parms,
+                 F &&f) const;
+
+  void AddChild(FlatTriangleFanTree &&child, ReachFanParms &parms);
+
+  /**
+   * Append all fans at the given depth to the vector, in the order
+   * in which FillDepth() visits them.
+   */
+  void CollectDepth(unsigned char d, std::vector<FlatTriangleFanTree *> &dest);
 };
 
 #endif
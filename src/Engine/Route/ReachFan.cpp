@@ -38,6 +38,8 @@ bool
 ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
                 const RasterMap* terrain, const bool do_solve)
 {
+  const auto start = std::chrono::steady_clock::now();
+
   Reset();
 
   // initialise projection
@@ -49,6 +51,11 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   const int h2 = h.GetValueOr0();
 
   ReachFanParms parms(rpolars, projection, terrain_base, terrain);
+  if (parallel)
+    parms.parallel = &parallel;
+  if (time_budget > std::chrono::steady_clock::duration::zero())
+    parms.deadline = start + time_budget;
+
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
   // immediate exit if starting below terrain, or starting below floor
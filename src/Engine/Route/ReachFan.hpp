@@ -25,6 +25,7 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "ReachFanParms.hpp"
 
 class RoutePolars;
 class RasterMap;
@@ -37,9 +38,34 @@ class ReachFan
   FlatTriangleFanTree root;
   int terrain_base;
 
+  ReachParallelFunction parallel;
+
+  /**
+   * The time Solve() may take, or zero for no limit.
+   */
+  std::chrono::steady_clock::duration time_budget =
+    std::chrono::steady_clock::duration::zero();
+
 public:
   ReachFan():terrain_base(0) {}
 
+  /**
+   * Use the given function to search the fan tree concurrently.  The
+   * result is the same as without it.
+   */
+  void SetParallel(const ReachParallelFunction &_parallel) {
+    parallel = _parallel;
+  }
+
+  /**
+   * Limit the time Solve() may take.  Deeper levels of the fan tree
+   * are searched more coarsely or skipped if they are not expected
+   * to finish in time.  Zero disables the limit.
+   */
+  void SetTimeBudget(std::chrono::steady_clock::duration _time_budget) {
+    time_budget = _time_budget;
+  }
+
   friend class PrintHelper;
 
   bool IsEmpty() const {
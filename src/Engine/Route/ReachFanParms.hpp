@@ -25,9 +25,20 @@
 
 #include "Route/RoutePolars.hpp"
 
+#include <functional>
+#include <chrono>
+
 class FlatProjection;
 class RasterMap;
 
+/**
+ * A ParallelFor-style function: invoke the given function for each
+ * number in the range [0, n), possibly concurrently, and return when
+ * all invocations have finished.
+ */
+typedef std::function<void(unsigned n,
+                           const std::function<void(unsigned)> &f)> ReachParallelFunction;
+
 struct ReachFanParms {
   const RoutePolars &rpolars;
   const FlatProjection &projection;
@@ -38,6 +49,25 @@ struct ReachFanParms {
   unsigned vertex_counter = 0;
   unsigned char set_depth = 0;
 
+  /**
+   * If set, the rays of the root fan and the gaps of one tree level
+   * are searched concurrently.
+   */
+  const ReachParallelFunction *parallel = nullptr;
+
+  /**
+   * Deeper tree levels are only searched if they are expected to
+   * finish before this point in time.
+   */
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::time_point::max();
+
+  /**
+   * The distance between two probes along a gap's long edge, as a
+   * fraction of its length.
+   */
+  double gap_step = 0.1;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
@@ -0,0 +1,77 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "RouteLinkCache.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+
+void
+RouteLinkCache::Clear()
+{
+  map.clear();
+  terrain = nullptr;
+  center = GeoPoint::Invalid();
+}
+
+void
+RouteLinkCache::Validate(const RasterMap *_terrain,
+                         const FlatProjection &projection,
+                         int _ceiling, int _safety_height)
+{
+  if (_terrain == terrain && _terrain != nullptr &&
+      _terrain->GetSerial() == terrain_serial &&
+      projection.GetCenter() == center &&
+      _ceiling == ceiling && _safety_height == safety_height)
+    return;
+
+  map.clear();
+
+  terrain = _terrain;
+  if (terrain != nullptr)
+    terrain_serial = terrain->GetSerial();
+  center = projection.GetCenter();
+  ceiling = _ceiling;
+  safety_height = _safety_height;
+}
+
+const RouteLinkCache::Result *
+RouteLinkCache::Find(const Key &key)
+{
+  auto i = map.find(key);
+  if (i == map.end()) {
+    ++misses;
+    return nullptr;
+  }
+
+  ++hits;
+  return &i->second;
+}
+
+void
+RouteLinkCache::Add(const Key &key, const Result &result)
+{
+  if (map.size() >= MAX_SIZE)
+    map.clear();
+
+  map.emplace(key, result);
+}
@@ -0,0 +1,152 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_ROUTE_LINK_CACHE_HPP
+#define XCSOAR_ROUTE_LINK_CACHE_HPP
+
+#include "Point.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Util/Serial.hpp"
+#include "Compiler.h"
+
+#include <unordered_map>
+
+#include <stddef.h>
+
+class RasterMap;
+class FlatProjection;
+
+/**
+ * Remembers the results of terrain clearance checks of route links
+ * across RoutePlanner::Solve() calls.  The aircraft moves only a
+ * little between two solutions, so most links of a new search have
+ * been checked before.
+ *
+ * A link is identified by its (already quantised) end points and
+ * altitudes, and by its virtual climb height, which depends on the
+ * polar and the wind; this way, a changed polar never finds a stale
+ * result.  All other parameters of the check are stored once for the
+ * whole cache, and it is cleared when one of them changes (see
+ * Validate()).
+ */
+class RouteLinkCache {
+public:
+  struct Key {
+    RoutePoint first, second;
+
+    /**
+     * The virtual height of the link (see
+     * RoutePolars::CalcVHeight()), as passed to
+     * RasterMap::FirstIntersection().
+     */
+    int h_virt;
+
+    bool operator==(const Key &other) const {
+      return first == other.first && second == other.second &&
+        h_virt == other.h_virt;
+    }
+  };
+
+  struct Result {
+    /**
+     * Is the link clear of terrain?
+     */
+    bool clear;
+
+    /**
+     * The clearance point if the link is not clear.
+     */
+    RoutePoint intercept;
+  };
+
+private:
+  /**
+   * The cache is cleared when it has grown to this number of
+   * entries.
+   */
+  static constexpr size_t MAX_SIZE = 65536;
+
+  struct KeyHasher {
+    gcc_pure
+    size_t operator()(const Key &key) const {
+      size_t h = key.first.x * size_t(104729) + key.first.y;
+      h = h * size_t(27644437) + key.first.altitude;
+      h = h * size_t(104729) + key.second.x;
+      h = h * size_t(104729) + key.second.y;
+      h = h * size_t(27644437) + key.second.altitude;
+      return h * size_t(31) + key.h_virt;
+    }
+  };
+
+  std::unordered_map<Key, Result, KeyHasher> map;
+
+  /* the parameters of all cached checks */
+  const RasterMap *terrain;
+  Serial terrain_serial;
+  GeoPoint center;
+  int ceiling, safety_height;
+
+  unsigned long hits, misses;
+
+public:
+  RouteLinkCache() {
+    Clear();
+    ResetStatistics();
+  }
+
+  void Clear();
+
+  /**
+   * Clear the cache if one of the given parameters differs from the
+   * ones of the cached results.  Call this before each solution.
+   *
+   * @param ceiling the climb ceiling (m)
+   * @param safety_height the terrain safety height (m)
+   */
+  void Validate(const RasterMap *terrain, const FlatProjection &projection,
+                int ceiling, int safety_height);
+
+  /**
+   * Look up the result of a check.  Updates the hit statistics.
+   *
+   * @return the result or nullptr if the link has not been checked
+   * yet
+   */
+  const Result *Find(const Key &key);
+
+  void Add(const Key &key, const Result &result);
+
+  unsigned long GetHits() const {
+    return hits;
+  }
+
+  unsigned long GetMisses() const {
+    return misses;
+  }
+
+  void ResetStatistics() {
+    hits = misses = 0;
+  }
+};
+
+#endif
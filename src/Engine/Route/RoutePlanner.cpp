@@ -48,6 +48,8 @@ RoutePlanner::Reset()
   solution_route.clear();
   planner.Clear();
   unique_links.clear();
+  link_cache.Clear();
+  projection.SetInvalid();
   h_min = -1;
   h_max = 0;
   search_hull.clear();
@@ -112,6 +114,10 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   if (!rpolars_route.IsTerrainEnabled() && !rpolars_route.IsAirspaceEnabled())
     return false; // trivial
 
+  link_cache.Validate(terrain, projection,
+                      rpolars_route.GetClimbCeiling(),
+                      rpolars_route.GetSafetyHeight());
+
   search_hull.clear();
   search_hull.emplace_back(origin_last, projection);
 
@@ -409,7 +415,27 @@ RoutePlanner::CheckClearanceTerrain(const RouteLink &e, RoutePoint& inp) const
     return true;
 
   count_terrain++;
-  return rpolars_route.CheckClearance(e, terrain, projection, inp);
+
+  if (!rpolars_route.IsTerrainEnabled())
+    return true;
+
+  const RouteLinkCache::Key key{e.first, e.second,
+      (int)rpolars_route.CalcVHeight(e)};
+  const auto *cached = link_cache.Find(key);
+  if (cached != nullptr) {
+    if (!cached->clear)
+      inp = cached->intercept;
+    return cached->clear;
+  }
+
+  RouteLinkCache::Result result;
+  result.clear = rpolars_route.CheckClearance(e, terrain, projection,
+                                              result.intercept);
+  link_cache.Add(key, result);
+
+  if (!result.clear)
+    inp = result.intercept;
+  return result.clear;
 }
 
 void
@@ -486,6 +512,10 @@ RoutePlanner::AddNearbyTerrain(const RoutePoint &p, const RouteLink& e)
 void
 RoutePlanner::OnSolve(const AGeoPoint &origin, const AGeoPoint &destination)
 {
+  if (projection.IsValid() &&
+      projection.ProjectInteger(origin) == FlatGeoPoint(0, 0))
+    return;
+
   projection.SetCenter(origin);
 }
 
@@ -26,6 +26,7 @@
 #include "RoutePolars.hpp"
 #include "Route.hpp"
 #include "RouteLink.hpp"
+#include "RouteLinkCache.hpp"
 #include "AStar.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
@@ -131,6 +132,9 @@ private:
 
   /** Links that have been visited during solution */
   RouteLinkSet unique_links;
+
+  /** Terrain clearance results of previous solutions */
+  mutable RouteLinkCache link_cache;
   typedef std::queue< RouteLink> RouteLinkQueue;
   /** Link candidates to be processed for intersection tests */
   RouteLinkQueue links;
@@ -175,6 +179,23 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Search the reach fans concurrently, see ReachFan::SetParallel().
+   */
+  void SetReachParallel(const ReachParallelFunction &parallel) {
+    reach_terrain.SetParallel(parallel);
+    reach_working.SetParallel(parallel);
+  }
+
+  /**
+   * Limit the time of each reach calculation, see
+   * ReachFan::SetTimeBudget().
+   */
+  void SetReachTimeBudget(std::chrono::steady_clock::duration budget) {
+    reach_terrain.SetTimeBudget(budget);
+    reach_working.SetTimeBudget(budget);
+  }
+
   bool IsTerrainReachEmpty() const {
     return reach_terrain.IsEmpty();
   }
@@ -291,6 +312,10 @@ public:
     return reach_terrain.GetTerrainBase();
   }
 
+  const RouteLinkCache &GetLinkCache() const {
+    return link_cache;
+  }
+
 protected:
   /**
    * Test whether a solution is required or the solution is trivial
@@ -371,6 +396,18 @@ protected:
    */
   bool CheckClearanceTerrain(const RouteLink &e, RoutePoint& inp) const;
 
+  /**
+   * Hook to allow subclasses to update internal data at start of solve() call
+   *
+   * The default implementation centers the projection at the origin,
+   * unless the origin has moved by less than one flat unit since the
+   * last call; this keeps the results in #link_cache valid.
+   *
+   * @param origin origin of search
+   * @param destination destination of search
+   */
+  virtual void OnSolve(const AGeoPoint& origin, const AGeoPoint& destination);
+
 private:
   /**
    * Check a second category of obstacle clearance.  This allows compound
@@ -406,14 +443,6 @@ private:
    */
   virtual void AddNearby(const RouteLink &e) = 0;
 
-  /**
-   * Hook to allow subclasses to update internal data at start of solve() call
-   *
-   * @param origin origin of search
-   * @param destination destination of search
-   */
-  virtual void OnSolve(const AGeoPoint& origin, const AGeoPoint& destination);
-
   /**
    * Generate a candidate to left or right of the clearance point, unless:
    * - it is too short
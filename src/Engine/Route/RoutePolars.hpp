@@ -239,6 +239,10 @@ public:
     return config.safety_height_terrain;
   }
 
+  int GetClimbCeiling() const {
+    return climb_ceiling;
+  }
+
   int GetFloor() const {
     return height_min_working;
   }
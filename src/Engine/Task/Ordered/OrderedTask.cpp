@@ -25,6 +25,7 @@
 #include "Points/OrderedTaskPoint.hpp"
 #include "Points/StartPoint.hpp"
 #include "Points/FinishPoint.hpp"
+#include "Points/AATPoint.hpp"
 #include "Task/Solvers/TaskMacCreadyTravelled.hpp"
 #include "Task/Solvers/TaskMacCreadyRemaining.hpp"
 #include "Task/Solvers/TaskMacCreadyTotal.hpp"
@@ -44,10 +45,10 @@
 #include "Geo/Flat/FlatBoundingBox.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Task/Stats/TaskSummary.hpp"
-#include "Task/PathSolvers/TaskDijkstraMin.hpp"
-#include "Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Task/PathSolvers/TaskDistanceSolver.hpp"
 #include "Task/ObservationZones/ObservationZoneClient.hpp"
 #include "Task/ObservationZones/CylinderZone.hpp"
+#include "Util/Tolerances.hpp"
 
 /**
  * According to "FAI Sporting Code / Annex A to Section 3 - Gliding",
@@ -91,7 +92,7 @@ OrderedTask::OrderedTask(const TaskBehaviour &tb)
    factory_mode(tb.task_type_default),
    active_factory(nullptr),
    ordered_settings(tb.ordered_defaults),
-   dijkstra_min(nullptr), dijkstra_max(nullptr)
+   distance_min_solver(nullptr), distance_max_solver(nullptr)
 {
   ClearName();
   active_factory = CreateTaskFactory(factory_mode, *this, task_behaviour);
@@ -104,8 +105,8 @@ OrderedTask::~OrderedTask()
 
   delete active_factory;
 
-  delete dijkstra_min;
-  delete dijkstra_max;
+  delete distance_min_solver;
+  delete distance_max_solver;
 }
 
 const TaskFactoryConstraints &
@@ -126,6 +127,7 @@ void
 OrderedTask::SetTaskBehaviour(const TaskBehaviour &tb)
 {
   AbstractTask::SetTaskBehaviour(tb);
+  target_search.Clear();
 
   ::SetTaskBehaviour(task_points, tb);
   ::SetTaskBehaviour(optional_start_points, tb);
@@ -153,6 +155,8 @@ OrderedTask::UpdateStatsGeometry()
 void
 OrderedTask::UpdateGeometry()
 {
+  target_search.Clear();
+
   UpdateStatsGeometry();
 
   if (task_points.empty())
@@ -222,29 +226,29 @@ OrderedTask::ScanLegStartTime()
 // DISTANCES
 
 inline bool
-OrderedTask::RunDijsktraMin(const GeoPoint &location)
+OrderedTask::RunDistanceMin(const GeoPoint &location)
 {
   const unsigned task_size = TaskSize();
   if (task_size < 2)
     return false;
 
-  if (dijkstra_min == nullptr)
-    dijkstra_min = new TaskDijkstraMin();
-  TaskDijkstraMin &dijkstra = *dijkstra_min;
+  if (distance_min_solver == nullptr)
+    distance_min_solver = new TaskDistanceSolver(true);
+  TaskDistanceSolver &solver = *distance_min_solver;
 
   const unsigned active_index = GetActiveIndex();
-  dijkstra.SetTaskSize(task_size - active_index);
+  solver.SetTaskSize(task_size - active_index);
   for (unsigned i = active_index; i != task_size; ++i) {
     const SearchPointVector &boundary = task_points[i]->GetSearchPoints();
-    dijkstra.SetBoundary(i - active_index, boundary);
+    solver.SetBoundary(i - active_index, boundary);
   }
 
   SearchPoint ac(location, task_projection);
-  if (!dijkstra.DistanceMin(ac))
+  if (!solver.DistanceMin(ac))
     return false;
 
   for (unsigned i = active_index; i != task_size; ++i)
-    SetPointSearchMin(i, dijkstra.GetSolution(i - active_index));
+    SetPointSearchMin(i, solver.GetSolution(i - active_index));
 
   return true;
 }
@@ -273,7 +277,7 @@ OrderedTask::ScanDistanceMin(const GeoPoint &location, bool full)
   }
 
   if (full) {
-    RunDijsktraMin(location);
+    RunDistanceMin(location);
     last_min_location = location;
   }
 
@@ -281,25 +285,25 @@ OrderedTask::ScanDistanceMin(const GeoPoint &location, bool full)
 }
 
 inline bool
-OrderedTask::RunDijsktraMax()
+OrderedTask::RunDistanceMax()
 {
   const unsigned task_size = TaskSize();
   if (task_size < 2)
     return false;
 
-  if (dijkstra_max == nullptr)
-    dijkstra_max = new TaskDijkstraMax();
-  TaskDijkstraMax &dijkstra = *dijkstra_max;
+  if (distance_max_solver == nullptr)
+    distance_max_solver = new TaskDistanceSolver(false);
+  TaskDistanceSolver &solver = *distance_max_solver;
 
   const unsigned active_index = GetActiveIndex();
-  dijkstra.SetTaskSize(task_size);
+  solver.SetTaskSize(task_size);
   for (unsigned i = 0; i != task_size; ++i) {
     const SearchPointVector &boundary = i == active_index
       /* since one can still travel further in the current sector, use
          the full boundary here */
       ? task_points[i]->GetBoundaryPoints()
       : task_points[i]->GetSearchPoints();
-    dijkstra_max->SetBoundary(i, boundary);
+    solver.SetBoundary(i, boundary);
   }
 
   double start_radius(-1), finish_radius(-1);
@@ -311,25 +315,25 @@ OrderedTask::RunDijsktraMax()
     const auto &start = *task_points.front();
     start_radius = GetCylinderRadiusOrMinusOne(start);
     if (start_radius > 0)
-      dijkstra.SetBoundary(0, start.GetNominalPoints());
+      solver.SetBoundary(0, start.GetNominalPoints());
 
     const auto &finish = *task_points.back();
     finish_radius = GetCylinderRadiusOrMinusOne(finish);
     if (finish_radius > 0)
-      dijkstra.SetBoundary(task_size - 1, finish.GetNominalPoints());
+      solver.SetBoundary(task_size - 1, finish.GetNominalPoints());
   }
 
-  if (!dijkstra_max->DistanceMax())
+  if (!solver.DistanceMax())
     return false;
 
   for (unsigned i = 0; i != task_size; ++i) {
-    SearchPoint solution = dijkstra.GetSolution(i);
+    SearchPoint solution = solver.GetSolution(i);
 
     if (i == 0 && start_radius > 0) {
       /* subtract start cylinder radius by finding the intersection
          with the cylinder boundary */
       const GeoPoint &current = task_points.front()->GetLocation();
-      const GeoPoint &neighbour = dijkstra.GetSolution(i + 1).GetLocation();
+      const GeoPoint &neighbour = solver.GetSolution(i + 1).GetLocation();
       GeoPoint gp = current.IntermediatePoint(neighbour, start_radius);
       solution = SearchPoint(gp, task_projection);
     }
@@ -338,7 +342,7 @@ OrderedTask::RunDijsktraMax()
       /* subtract finish cylinder radius by finding the intersection
          with the cylinder boundary */
       const GeoPoint &current = task_points.back()->GetLocation();
-      const GeoPoint &neighbour = dijkstra.GetSolution(i - 1).GetLocation();
+      const GeoPoint &neighbour = solver.GetSolution(i - 1).GetLocation();
       GeoPoint gp = current.IntermediatePoint(neighbour, finish_radius);
       solution = SearchPoint(gp, task_projection);
     }
@@ -359,7 +363,7 @@ OrderedTask::ScanDistanceMax()
 
   assert(active_task_point < task_points.size());
 
-  RunDijsktraMax();
+  RunDistanceMax();
 
   return task_points.front()->ScanDistanceMax();
 }
@@ -623,9 +627,19 @@ OrderedTask::UpdateIdle(const AircraftState &state,
 
   if (HasStart() && task_behaviour.optimise_targets_range &&
       GetOrderedTaskSettings().aat_min_time > 0) {
+    const auto t_target = GetOrderedTaskSettings().aat_min_time +
+      task_behaviour.optimise_targets_margin;
+    const auto t_remaining = fdim(t_target, stats.total.time_elapsed);
+
+    target_search.ResetEvaluations();
 
-    CalcMinTarget(state, glide_polar,
-                  GetOrderedTaskSettings().aat_min_time + task_behaviour.optimise_targets_margin);
+    if (target_search.IsCurrent(state, t_remaining, active_task_point,
+                                glide_polar) &&
+        AreTargetsOptimised())
+      /* the previous solution is still good enough */
+      return retval;
+
+    CalcMinTarget(state, glide_polar, t_target);
 
     if (task_behaviour.optimise_targets_bearing &&
         task_points[active_task_point]->GetType() == TaskPointType::AAT) {
@@ -634,8 +648,15 @@ OrderedTask::UpdateIdle(const AircraftState &state,
       TaskOptTarget tot(task_points, active_task_point, state,
                         task_behaviour.glide, glide_polar,
                         *ap, task_projection, taskpoint_start);
-      tot.search(0.5);
+      const auto p = tot.search(ap->GetIsolineParameter());
+      if (p >= 0)
+        ap->SetIsolineParameter(p);
+
+      target_search.AddOptTargetEvaluations(tot.get_evaluations());
     }
+
+    target_search.Save(state, t_remaining, active_task_point, glide_polar);
+    SaveOptimisedTargets();
     retval = true;
   }
 
@@ -1065,13 +1086,37 @@ OrderedTask::CalcMinTarget(const AircraftState &aircraft,
     TaskMinTarget bmt(task_points, active_task_point, aircraft,
                       task_behaviour.glide, glide_polar,
                       t_rem, taskpoint_start);
-    auto p = bmt.search(0);
+    /* start near the previous solution if there is one */
+    auto p = target_search.HasRange()
+      ? bmt.search(target_search.GetRange(), TOLERANCE_MIN_TARGET_STEP)
+      : bmt.search(0);
+    target_search.SetRange(p);
+    target_search.AddMinTargetEvaluations(bmt.get_evaluations());
     return p;
   }
 
   return 0;
 }
 
+bool
+OrderedTask::AreTargetsOptimised() const
+{
+  for (const OrderedTaskPoint *tp : task_points)
+    if (tp->GetType() == TaskPointType::AAT &&
+        !((const AATPoint *)tp)->IsTargetOptimised())
+      return false;
+
+  return true;
+}
+
+void
+OrderedTask::SaveOptimisedTargets()
+{
+  for (OrderedTaskPoint *tp : task_points)
+    if (tp->GetType() == TaskPointType::AAT)
+      ((AATPoint *)tp)->SaveOptimisedTarget();
+}
+
 double
 OrderedTask::CalcGradient(const AircraftState &state) const
 {
@@ -1118,6 +1163,7 @@ OrderedTask::Reset()
   /// @todo also reset data in this class e.g. stats?
   ResetPoints(task_points);
   ResetPoints(optional_start_points);
+  target_search.Clear();
 
   AbstractTask::Reset();
   stats.task_finished = false;
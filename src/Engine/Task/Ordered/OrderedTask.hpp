@@ -26,6 +26,7 @@
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Task/AbstractTask.hpp"
 #include "SmartTaskAdvance.hpp"
+#include "TargetSearchState.hpp"
 #include "Waypoint/Ptr.hpp"
 #include "Util/DereferenceIterator.hpp"
 #include "Util/StaticString.hxx"
@@ -39,8 +40,7 @@ class OrderedTaskPoint;
 class StartPoint;
 class FinishPoint;
 class AbstractTaskFactory;
-class TaskDijkstraMin;
-class TaskDijkstraMax;
+class TaskDistanceSolver;
 class Waypoints;
 class AATPoint;
 struct FlatBoundingBox;
@@ -83,8 +83,10 @@ private:
   AbstractTaskFactory* active_factory;
   OrderedTaskSettings ordered_settings;
   SmartTaskAdvance task_advance;
-  TaskDijkstraMin *dijkstra_min;
-  TaskDijkstraMax *dijkstra_max;
+  TaskDistanceSolver *distance_min_solver;
+  TaskDistanceSolver *distance_max_solver;
+
+  TargetSearchState target_search;
 
   StaticString<64> name;
 
@@ -359,6 +361,14 @@ public:
     return task_projection;
   }
 
+  /**
+   * Accessor for the state of the target optimisation, which also
+   * counts the solver evaluations of the last UpdateIdle() call.
+   */
+  const TargetSearchState &GetTargetSearchState() const {
+    return target_search;
+  }
+
   void CheckDuplicateWaypoints(Waypoints& waypoints);
 
   /**
@@ -384,7 +394,7 @@ public:
 public:
   /**
    * Retrieve vector of search points to be used in max/min distance
-   * scans (by TaskDijkstra).
+   * scans (by TaskDistanceSolver).
    *
    * @param tp Index of task point of query
    *
@@ -394,7 +404,7 @@ public:
 
 protected:
   /**
-   * Set task point's minimum distance value (by TaskDijkstra).
+   * Set task point's minimum distance value (by TaskDistanceSolver).
    *
    * @param tp Index of task point to set min
    * @param sol Search point found to be minimum distance
@@ -402,7 +412,7 @@ protected:
   void SetPointSearchMin(unsigned tp, const SearchPoint &sol);
 
   /**
-   * Set task point's maximum distance value (by TaskDijkstra).
+   * Set task point's maximum distance value (by TaskDistanceSolver).
    *
    * @param tp Index of task point to set max
    * @param sol Search point found to be maximum distance
@@ -430,7 +440,7 @@ private:
   /**
    * @return true if a solution was found (and applied)
    */
-  bool RunDijsktraMin(const GeoPoint &location);
+  bool RunDistanceMin(const GeoPoint &location);
 
 
   double ScanDistanceMin(const GeoPoint &ref, bool full);
@@ -438,7 +448,7 @@ private:
   /**
    * @return true if a solution was found (and applied)
    */
-  bool RunDijsktraMax();
+  bool RunDistanceMax();
 
   double ScanDistanceMax();
 
@@ -455,6 +465,19 @@ private:
                        const GlidePolar &glide_polar,
                        const double t_target);
 
+  /**
+   * Are all AAT targets still where the last target optimisation left
+   * them?
+   */
+  gcc_pure
+  bool AreTargetsOptimised() const;
+
+  /**
+   * Remember the AAT targets as the result of the target
+   * optimisation.
+   */
+  void SaveOptimisedTargets();
+
   /**
    * Sets previous/next taskpoint pointers for task point at specified
    * index in sequence.
@@ -58,6 +58,20 @@ class AATPoint final : public IntermediateTaskPoint {
   /** Whether target can float */
   bool target_locked;
 
+  /**
+   * The target left behind by the last target optimisation in
+   * OrderedTask::UpdateIdle().  If the target has been moved since
+   * (by the pilot or by CheckTarget()), the optimisation must not be
+   * skipped.
+   */
+  GeoPoint optimised_target;
+
+  /**
+   * The isoline parameter found by the last TaskOptTarget search,
+   * used as the starting guess of the next one.
+   */
+  double isoline_parameter;
+
 public:
   /**
    * Constructor.  Initialises to unlocked target, target is
@@ -74,7 +88,9 @@ public:
            const TaskBehaviour &tb)
     :IntermediateTaskPoint(TaskPointType::AAT, _oz, std::move(wp), tb, true),
      target_location(GetLocation()),
-     target_locked(false)
+     target_locked(false),
+     optimised_target(GeoPoint::Invalid()),
+     isoline_parameter(0.5)
   {
   }
 
@@ -85,6 +101,7 @@ public:
    */
   void LockTarget(bool do_lock) {
     target_locked = do_lock;
+    optimised_target.SetInvalid();
   }
 
   const GeoPoint &GetTarget() const {
@@ -168,6 +185,30 @@ public:
     return target_locked;
   }
 
+  /**
+   * Remember the current target as the result of the target
+   * optimisation.
+   */
+  void SaveOptimisedTarget() {
+    optimised_target = target_location;
+  }
+
+  /**
+   * Is the target still where the last target optimisation left it?
+   */
+  gcc_pure
+  bool IsTargetOptimised() const {
+    return optimised_target.IsValid() && optimised_target == target_location;
+  }
+
+  double GetIsolineParameter() const {
+    return isoline_parameter;
+  }
+
+  void SetIsolineParameter(double p) {
+    isoline_parameter = p;
+  }
+
 private:
   /**
    * Check whether target needs to be moved and if so, to
@@ -0,0 +1,76 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#include "TargetSearchState.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Util/Tolerances.hpp"
+
+#include <math.h>
+
+/**
+ * The magnitude of the difference between two wind vectors [m/s].
+ */
+gcc_pure
+static double
+WindDifference(const SpeedVector &a, const SpeedVector &b)
+{
+  const auto sc_a = a.bearing.SinCos();
+  const auto sc_b = b.bearing.SinCos();
+  return hypot(a.norm * sc_a.first - b.norm * sc_b.first,
+               a.norm * sc_a.second - b.norm * sc_b.second);
+}
+
+bool
+TargetSearchState::IsCurrent(const AircraftState &state,
+                             const double _t_remaining,
+                             const unsigned _active_task_point,
+                             const GlidePolar &glide_polar) const
+{
+  return valid &&
+    _active_task_point == active_task_point &&
+    glide_polar.GetMC() == mc &&
+    glide_polar.GetBugs() == bugs &&
+    glide_polar.GetBallast() == ballast &&
+    fabs(state.altitude - altitude) < TOLERANCE_TARGET_ALTITUDE &&
+    fabs(_t_remaining - t_remaining) < TOLERANCE_TARGET_TIME &&
+    state.location.Distance(location) < TOLERANCE_TARGET_DISTANCE &&
+    WindDifference(state.wind, wind) < TOLERANCE_TARGET_WIND;
+}
+
+void
+TargetSearchState::Save(const AircraftState &state,
+                        const double _t_remaining,
+                        const unsigned _active_task_point,
+                        const GlidePolar &glide_polar)
+{
+  valid = true;
+  location = state.location;
+  altitude = state.altitude;
+  wind = state.wind;
+  t_remaining = _t_remaining;
+  active_task_point = _active_task_point;
+  mc = glide_polar.GetMC();
+  bugs = glide_polar.GetBugs();
+  ballast = glide_polar.GetBallast();
+}
@@ -0,0 +1,133 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#ifndef TARGET_SEARCH_STATE_HPP
+#define TARGET_SEARCH_STATE_HPP
+
+#include "Geo/GeoPoint.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Compiler.h"
+
+struct AircraftState;
+class GlidePolar;
+
+/**
+ * The state of the AAT target optimisation in
+ * OrderedTask::UpdateIdle() which is kept from one call to the next.
+ * The optimisation is skipped while its inputs stay within a
+ * tolerance of the previous ones, and otherwise the solvers are
+ * warm-started from the previous solution.
+ */
+class TargetSearchState {
+  /** Are the remembered inputs valid? */
+  bool valid;
+
+  /** Has #range been set by a search? */
+  bool has_range;
+
+  GeoPoint location;
+  double altitude;
+
+  /** The wind which the glide solutions were calculated with */
+  SpeedVector wind;
+
+  /** Remaining time (s) which the targets were adjusted for */
+  double t_remaining;
+
+  unsigned active_task_point;
+
+  double mc, bugs, ballast;
+
+  /** Range parameter found by the last TaskMinTarget search */
+  double range;
+
+  /**
+   * Number of glide solutions evaluated by TaskMinTarget and
+   * TaskOptTarget in the last UpdateIdle() call.
+   */
+  unsigned min_target_evaluations, opt_target_evaluations;
+
+public:
+  TargetSearchState()
+    :valid(false), has_range(false),
+     min_target_evaluations(0), opt_target_evaluations(0) {}
+
+  /**
+   * Forget the inputs of the last search, e.g. because the task has
+   * been modified.  The last solution is still used as a starting
+   * guess.
+   */
+  void Clear() {
+    valid = false;
+  }
+
+  /**
+   * Have the inputs moved less than the tolerance since the last
+   * search?
+   */
+  gcc_pure
+  bool IsCurrent(const AircraftState &state, double t_remaining,
+                 unsigned active_task_point,
+                 const GlidePolar &glide_polar) const;
+
+  /**
+   * Remember the inputs of a search which has just been completed.
+   */
+  void Save(const AircraftState &state, double t_remaining,
+            unsigned active_task_point, const GlidePolar &glide_polar);
+
+  bool HasRange() const {
+    return has_range;
+  }
+
+  double GetRange() const {
+    return range;
+  }
+
+  void SetRange(double p) {
+    range = p;
+    has_range = true;
+  }
+
+  void ResetEvaluations() {
+    min_target_evaluations = opt_target_evaluations = 0;
+  }
+
+  void AddMinTargetEvaluations(unsigned n) {
+    min_target_evaluations += n;
+  }
+
+  void AddOptTargetEvaluations(unsigned n) {
+    opt_target_evaluations += n;
+  }
+
+  unsigned GetMinTargetEvaluations() const {
+    return min_target_evaluations;
+  }
+
+  unsigned GetOptTargetEvaluations() const {
+    return opt_target_evaluations;
+  }
+};
+
+#endif
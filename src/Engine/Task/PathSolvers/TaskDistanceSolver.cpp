@@ -0,0 +1,219 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#include "TaskDistanceSolver.hpp"
+#include "Geo/SearchPointVector.hpp"
+
+#include <algorithm>
+
+#include <limits.h>
+
+/**
+ * Update the accumulated distances of one stage with the edges
+ * from one point of the previous stage.  This loop has no branches,
+ * which allows the compiler to vectorise it.
+ *
+ * @param base the accumulated distance of the origin point
+ * @param origin the index of the origin point
+ */
+template<bool is_min>
+static void
+Relax(unsigned *gcc_restrict cost, unsigned *gcc_restrict predecessor,
+      const unsigned *gcc_restrict distances, unsigned n,
+      unsigned base, unsigned origin)
+{
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned c = base + distances[i];
+    const bool better = is_min ? c < cost[i] : c > cost[i];
+    cost[i] = better ? c : cost[i];
+    predecessor[i] = better ? origin : predecessor[i];
+  }
+}
+
+/**
+ * Calculate the distances from the given origin to all points.
+ */
+static void
+CalcDistances(unsigned *gcc_restrict distances,
+              const GeoPoint &origin, const ReducedLatitude &origin_reduced,
+              const SearchPointVector &points,
+              const ReducedLatitude *gcc_restrict reduced)
+{
+  /* using expensive floating point formulas here to avoid integer
+     rounding errors */
+
+  for (const auto &i : points)
+    *distances++ = (unsigned)Distance(origin, origin_reduced,
+                                      i.GetLocation(), *reduced++);
+}
+
+inline const SearchPoint &
+TaskDistanceSolver::GetPoint(unsigned stage, unsigned i) const
+{
+  assert(stage < num_stages);
+
+  return (*boundaries[stage])[i];
+}
+
+const SearchPoint &
+TaskDistanceSolver::GetSolution(unsigned stage) const
+{
+  assert(stage < num_stages);
+
+  return GetPoint(stage, solution[stage]);
+}
+
+inline bool
+TaskDistanceSolver::Allocate()
+{
+  if (num_stages == 0)
+    return false;
+
+  unsigned total = 0, max_size = 0;
+  for (unsigned stage = 0; stage < num_stages; ++stage) {
+    const unsigned size = boundaries[stage]->size();
+    if (size == 0)
+      return false;
+
+    offsets[stage] = total;
+    total += size;
+    if (size > max_size)
+      max_size = size;
+  }
+
+  offsets[num_stages] = total;
+
+  reduced.resize(total);
+  for (unsigned stage = 0; stage < num_stages; ++stage) {
+    ReducedLatitude *p = reduced.data() + offsets[stage];
+    for (const auto &i : *boundaries[stage])
+      *p++ = ReducedLatitude(i.GetLocation().latitude);
+  }
+
+  cost.resize(total);
+  predecessor.resize(total);
+  distances.resize(max_size);
+  return true;
+}
+
+inline void
+TaskDistanceSolver::InitFirstStage(const SearchPoint *location)
+{
+  unsigned *first = cost.data() + offsets[0];
+  const SearchPointVector &points = *boundaries[0];
+
+  if (location != nullptr) {
+    const GeoPoint &l = location->GetLocation();
+    const ReducedLatitude l_reduced(l.latitude);
+    const ReducedLatitude *p = reduced.data() + offsets[0];
+
+    for (const auto &i : points)
+      *first++ = (unsigned)Distance(i.GetLocation(), *p++, l, l_reduced);
+  } else
+    std::fill_n(first, points.size(), 0u);
+}
+
+inline void
+TaskDistanceSolver::UpdateStage(unsigned stage)
+{
+  assert(stage > 0);
+  assert(stage < num_stages);
+
+  const SearchPointVector &origins = *boundaries[stage - 1];
+  const SearchPointVector &points = *boundaries[stage];
+  const unsigned n = points.size();
+
+  const ReducedLatitude *origin_reduced = reduced.data() + offsets[stage - 1];
+  const ReducedLatitude *stage_reduced = reduced.data() + offsets[stage];
+  const unsigned *origin_cost = cost.data() + offsets[stage - 1];
+  unsigned *stage_cost = cost.data() + offsets[stage];
+  unsigned *stage_predecessor = predecessor.data() + offsets[stage];
+
+  std::fill_n(stage_cost, n, is_min ? UINT_MAX : 0u);
+  std::fill_n(stage_predecessor, n, 0u);
+
+  for (unsigned i = 0, n_origins = origins.size(); i < n_origins; ++i) {
+    CalcDistances(distances.data(),
+                  origins[i].GetLocation(), origin_reduced[i],
+                  points, stage_reduced);
+
+    if (is_min)
+      Relax<true>(stage_cost, stage_predecessor, distances.data(), n,
+                  origin_cost[i], i);
+    else
+      Relax<false>(stage_cost, stage_predecessor, distances.data(), n,
+                   origin_cost[i], i);
+  }
+}
+
+inline void
+TaskDistanceSolver::FindSolution()
+{
+  const unsigned last = num_stages - 1;
+  const unsigned *last_cost = cost.data() + offsets[last];
+  const unsigned n = boundaries[last]->size();
+
+  unsigned best = 0;
+  for (unsigned i = 1; i < n; ++i)
+    if (is_min ? last_cost[i] < last_cost[best] : last_cost[i] > last_cost[best])
+      best = i;
+
+  for (unsigned stage = last;; --stage) {
+    solution[stage] = best;
+    if (stage == 0)
+      break;
+
+    best = predecessor[offsets[stage] + best];
+  }
+}
+
+bool
+TaskDistanceSolver::Run(const SearchPoint *location)
+{
+  if (!Allocate())
+    return false;
+
+  InitFirstStage(location);
+
+  for (unsigned stage = 1; stage < num_stages; ++stage)
+    UpdateStage(stage);
+
+  FindSolution();
+  return true;
+}
+
+bool
+TaskDistanceSolver::DistanceMin(const SearchPoint &location)
+{
+  assert(is_min);
+
+  return Run(location.IsValid() ? &location : nullptr);
+}
+
+bool
+TaskDistanceSolver::DistanceMax()
+{
+  assert(!is_min);
+
+  return Run(nullptr);
+}
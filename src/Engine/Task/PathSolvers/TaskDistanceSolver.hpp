@@ -0,0 +1,179 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#ifndef TASK_DISTANCE_SOLVER_HPP
+#define TASK_DISTANCE_SOLVER_HPP
+
+#include "Geo/Math.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+
+class SearchPoint;
+class SearchPointVector;
+
+/**
+ * Find the minimum or maximum distance path through the search
+ * points of an #OrderedTask.  This solves the same problem as
+ * #TaskDijkstraMin and #TaskDijkstraMax, and can be used in their
+ * place.
+ *
+ * The task graph is layered: each edge connects a point of one stage
+ * with a point of the following stage.  Therefore, the optimum can be
+ * found by dynamic programming, one stage after another, with the
+ * accumulated distances stored in dense arrays indexed by stage and
+ * point index.  Unlike the Dijkstra search, this needs no priority
+ * queue and no hash map.
+ *
+ * Before each calculation, set up this object with SetTaskSize() and
+ * call SetBoundary() for each task point.
+ */
+class TaskDistanceSolver {
+public:
+  static constexpr unsigned MAX_STAGES = 32;
+
+private:
+  const bool is_min;
+
+  unsigned num_stages;
+
+  const SearchPointVector *boundaries[MAX_STAGES];
+
+  /**
+   * An array containing the point index for each of the solution's
+   * stages.
+   */
+  unsigned solution[MAX_STAGES];
+
+  /**
+   * The index of each stage's first point in #reduced, #cost and
+   * #predecessor.
+   */
+  unsigned offsets[MAX_STAGES + 1];
+
+  /**
+   * The reduced latitude of each point.  It is calculated only once
+   * per point, and not for each of the many edges.
+   */
+  std::vector<ReducedLatitude> reduced;
+
+  /**
+   * The best accumulated distance from the start to each point.
+   */
+  std::vector<unsigned> cost;
+
+  /**
+   * The point index in the previous stage on the best path to each
+   * point.
+   */
+  std::vector<unsigned> predecessor;
+
+  /**
+   * The distances from one point to all points of the following
+   * stage.
+   */
+  std::vector<unsigned> distances;
+
+public:
+  /**
+   * @param is_min Whether this will be used to minimise or maximise
+   * distances
+   */
+  explicit TaskDistanceSolver(bool _is_min)
+    :is_min(_is_min), num_stages(0) {}
+
+  TaskDistanceSolver(const TaskDistanceSolver &) = delete;
+  TaskDistanceSolver &operator=(const TaskDistanceSolver &) = delete;
+
+  void SetTaskSize(unsigned size) {
+    assert(size <= MAX_STAGES);
+
+    num_stages = size;
+  }
+
+  void SetBoundary(unsigned idx, const SearchPointVector &boundary) {
+    assert(idx < num_stages);
+
+    boundaries[idx] = &boundary;
+  }
+
+  /**
+   * Search task points for targets within OZs to produce the
+   * minimum-distance task.  The result is sensitive to the specified
+   * aircraft location.
+   *
+   * @param location Location of aircraft; if it is invalid, the
+   * search starts at the first stage
+   * @return True if succeeded
+   */
+  bool DistanceMin(const SearchPoint &location);
+
+  /**
+   * Search task points for targets within OZs to produce the
+   * maximum-distance task.
+   *
+   * @return True if succeeded
+   */
+  bool DistanceMax();
+
+  /**
+   * Returns the solution point for the specified task point.  Call
+   * this after DistanceMin() or DistanceMax() has returned true.
+   */
+  gcc_pure
+  const SearchPoint &GetSolution(unsigned stage) const;
+
+private:
+  gcc_pure
+  const SearchPoint &GetPoint(unsigned stage, unsigned i) const;
+
+  /**
+   * Initialise #offsets, allocate the arrays and fill #reduced.
+   *
+   * @return false if a stage has no points
+   */
+  bool Allocate();
+
+  /**
+   * Calculate the accumulated distances of the first stage.
+   */
+  void InitFirstStage(const SearchPoint *location);
+
+  /**
+   * Calculate the accumulated distances of the given stage from the
+   * ones of the previous stage.
+   */
+  void UpdateStage(unsigned stage);
+
+  /**
+   * Pick the best point of the last stage, and trace the path back
+   * to the first stage.
+   */
+  void FindSolution();
+
+  bool Run(const SearchPoint *location);
+};
+
+#endif
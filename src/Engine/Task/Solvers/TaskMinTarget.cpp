@@ -61,8 +61,16 @@ TaskMinTarget::valid(const double tp)
   return res.IsOk(); // && (ff>= -tolerance*2);
 }
 
+inline double
+TaskMinTarget::find(const double p, const double step)
+{
+  return step > 0
+    ? find_zero_near(p, step)
+    : find_zero(p);
+}
+
 double
-TaskMinTarget::search(const double tp)
+TaskMinTarget::search(const double tp, const double step)
 {
   if (!tm.has_targets())
     // don't bother if nothing to adjust
@@ -70,12 +78,12 @@ TaskMinTarget::search(const double tp)
 
   force_current = false;
   /// @todo if search fails, force current
-  const auto p = find_zero(tp);
+  const auto p = find(tp, step);
   if (valid(p)) {
     return p;
   } else {
     force_current = true;
-    return find_zero(tp);
+    return find(tp, step);
   }
 }
 
@@ -86,12 +86,19 @@ public:
    * Running this adjusts the target values for AAT task points.
    *
    * @param p Default range (0-1)
+   * @param step If positive, then p is the solution of a previous
+   * search, and the zero is first looked for within this distance of
+   * it
    *
    * @return Range value for solution
    */
-  double search(double p);
+  double search(double p, double step=0);
+
+  using ZeroFinder::get_evaluations;
 
 private:
+  double find(double p, double step);
+
   void set_range(double p);
 };
 
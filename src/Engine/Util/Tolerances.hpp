@@ -36,4 +36,12 @@
 #define TOLERANCE_MIN_TARGET 0.002
 #define TOLERANCE_OPT_TARGET 0.01
 
+#define TOLERANCE_MIN_TARGET_STEP 0.05
+
+/* inputs of the idle target optimisation: m, m, s, m/s */
+#define TOLERANCE_TARGET_DISTANCE 100
+#define TOLERANCE_TARGET_ALTITUDE 10
+#define TOLERANCE_TARGET_TIME 10
+#define TOLERANCE_TARGET_WIND 0.5
+
 #endif
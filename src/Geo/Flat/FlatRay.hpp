@@ -39,6 +39,8 @@ public:
   /** speedups for box intersection test */
   double fy;
 
+  FlatRay() = default;
+
   /**
    * Constructor given start/end locations
    *
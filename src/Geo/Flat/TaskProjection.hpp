@@ -73,6 +73,10 @@ public:
    */
   bool Update();
 
+  const GeoBounds &GetBounds() const {
+    return bounds;
+  }
+
   /** 
    * Calculate radius of points used in task projection
    * 
@@ -159,18 +159,23 @@ Middle(const GeoPoint &a, const GeoPoint &b)
   return IntermediatePoint(a, b, distance / 2);
 }
 
-void
-DistanceBearing(const GeoPoint &loc1, const GeoPoint &loc2,
+ReducedLatitude::ReducedLatitude(Angle latitude)
+{
+  const auto u = atan((1 - FLATTENING) * latitude.tan());
+  sin_u = sin(u);
+  cos_u = cos(u);
+}
+
+static void
+DistanceBearing(const GeoPoint &loc1, const ReducedLatitude &u1,
+                const GeoPoint &loc2, const ReducedLatitude &u2,
                 double *distance, Angle *bearing)
 {
   const auto lon21 = loc2.longitude - loc1.longitude;
 
-  auto u1 = atan((1 - FLATTENING) * loc1.latitude.tan()),
-    u2 = atan((1 - FLATTENING) * loc2.latitude.tan());
+  const auto sinu1 = u1.sin_u, cosu1 = u1.cos_u;
 
-  auto sinu1 = sin(u1), cosu1 = cos(u1);
-
-  auto sinu2 = sin(u2), cosu2 = cos(u2);
+  const auto sinu2 = u2.sin_u, cosu2 = u2.cos_u;
 
   auto lambda = lon21.Radians(), lambda_p = Angle::FullCircle().Radians();
 
@@ -241,6 +246,24 @@ DistanceBearing(const GeoPoint &loc1, const GeoPoint &loc2,
       cosu1 * sinu2 - sinu1 * cosu2 * cos(lambda))).AsBearing();
 }
 
+void
+DistanceBearing(const GeoPoint &loc1, const GeoPoint &loc2,
+                double *distance, Angle *bearing)
+{
+  DistanceBearing(loc1, ReducedLatitude(loc1.latitude),
+                  loc2, ReducedLatitude(loc2.latitude),
+                  distance, bearing);
+}
+
+double
+Distance(const GeoPoint &loc1, const ReducedLatitude &u1,
+         const GeoPoint &loc2, const ReducedLatitude &u2)
+{
+  double distance;
+  DistanceBearing(loc1, u1, loc2, u2, &distance, nullptr);
+  return distance;
+}
+
 double
 ProjectedDistance(const GeoPoint &loc1, const GeoPoint &loc2,
                   const GeoPoint &loc3)
@@ -48,6 +48,29 @@ void
 DistanceBearing(const GeoPoint &loc1, const GeoPoint &loc2,
                 double *distance, Angle *bearing);
 
+/**
+ * The reduced latitude of a location on the WGS84 ellipsoid.  This
+ * is the part of the distance calculation which depends on only one
+ * of the two locations; keeping it saves time when calculating many
+ * distances from or to the same location.
+ */
+struct ReducedLatitude {
+  double sin_u, cos_u;
+
+  ReducedLatitude() = default;
+
+  explicit ReducedLatitude(Angle latitude);
+};
+
+/**
+ * Calculates the distance between two locations, like Distance(),
+ * with the reduced latitudes already calculated.
+ */
+gcc_pure
+double
+Distance(const GeoPoint &loc1, const ReducedLatitude &u1,
+         const GeoPoint &loc2, const ReducedLatitude &u2);
+
 /**
  * Calculates the distance between two locations
  * @param loc1 Location 1
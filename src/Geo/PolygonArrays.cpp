@@ -0,0 +1,209 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PolygonArrays.hpp"
+#include "SearchPointVector.hpp"
+#include "Flat/FlatRay.hpp"
+
+#if defined(__SSE2__)
+#include "PolygonSSE2.hpp"
+#elif defined(__ARM_NEON__)
+#include "PolygonNEON.hpp"
+#endif
+
+#include <assert.h>
+
+/**
+ * The number of edges processed by one iteration of the kernels; the
+ * arrays are padded to a multiple of this.
+ */
+static constexpr unsigned STEP = 4;
+
+#if defined(__SSE2__)
+typedef SSE2PolygonKernels OptimisedPolygonKernels;
+#elif defined(__ARM_NEON__)
+typedef NEONPolygonKernels OptimisedPolygonKernels;
+#endif
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+static_assert(OptimisedPolygonKernels::STEP == STEP, "Wrong step size");
+#endif
+
+void
+PolygonArrays::Update(const SearchPointVector &border, bool projected)
+{
+  /* same as PolygonInterior(): a polygon needs at least 3 vertices
+     (including the closing one) */
+  n_edges = border.size() >= 3 ? border.size() - 1 : 0;
+
+  const unsigned n_padded = (n_edges + STEP - 1) / STEP * STEP + 1;
+
+  longitude.clear();
+  latitude.clear();
+  x.clear();
+  y.clear();
+
+  if (n_edges == 0)
+    return;
+
+  longitude.reserve(n_padded);
+  latitude.reserve(n_padded);
+
+  for (const auto &i : border) {
+    longitude.push_back(i.GetLocation().longitude.Native());
+    latitude.push_back(i.GetLocation().latitude.Native());
+  }
+
+  /* degenerate edges don't change the results */
+  longitude.resize(n_padded, longitude.back());
+  latitude.resize(n_padded, latitude.back());
+
+  if (!projected)
+    return;
+
+  x.reserve(n_padded);
+  y.reserve(n_padded);
+
+  for (const auto &i : border) {
+    x.push_back(i.GetFlatLocation().x);
+    y.push_back(i.GetFlatLocation().y);
+  }
+
+  x.resize(n_padded, x.back());
+  y.resize(n_padded, y.back());
+}
+
+#ifndef __SSE2__
+
+gcc_pure
+static int
+PortableWindingNumber(const double *gcc_restrict longitude,
+                      const double *gcc_restrict latitude,
+                      unsigned n, double px, double py)
+{
+  int wn = 0;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const double ax = longitude[i], ay = latitude[i];
+    const double bx = longitude[i + 1], by = latitude[i + 1];
+
+    /* see Line2D::LocatePoint() */
+    const double left = (bx - ax) * (py - ay) - (px - ax) * (by - ay);
+
+    if (ay <= py) {
+      if (by > py && left > 0)
+        /* an upward crossing, P left of edge */
+        ++wn;
+    } else {
+      if (by <= py && left < 0)
+        /* a downward crossing, P right of edge */
+        --wn;
+    }
+  }
+
+  return wn;
+}
+
+#endif
+
+bool
+PolygonArrays::IsInside(const GeoPoint &p) const
+{
+  const double px = p.longitude.Native(), py = p.latitude.Native();
+
+#ifdef __SSE2__
+  const int wn = SSE2PolygonKernels::WindingNumber(longitude.data(),
+                                                   latitude.data(),
+                                                   n_edges, px, py);
+#else
+  const int wn = PortableWindingNumber(longitude.data(), latitude.data(),
+                                       n_edges, px, py);
+#endif
+
+  return wn != 0;
+}
+
+#if !defined(__SSE2__) && !defined(__ARM_NEON__)
+
+/**
+ * Does the ray intersect with the edge away from their nodes?  This
+ * is FlatRay::DistinctIntersection() without the division.
+ */
+gcc_const
+static inline bool
+IsDistinctIntersection(const FlatRay &ray, int ax, int ay, int ex, int ey)
+{
+  const int dx = ax - ray.point.x, dy = ay - ray.point.y;
+
+  const int second = ray.vector.x * ey - ex * ray.vector.y;
+  const int first = dx * ey - ex * dy;
+  const int ub = dx * ray.vector.y - ray.vector.x * dy;
+
+  /* flip the signs so "second" becomes positive; the comparison
+     with "ub" differs, because FlatRay's sgn(0) is 1 */
+  const int s = second < 0 ? -1 : 0;
+  const int S = (second ^ s) - s;
+  const int F = (first ^ s) - s;
+  const int U = (ub ^ s) - s;
+
+  return F > 0 && F < S && U > ~s && U <= S;
+}
+
+static void
+PortableFindIntersections(const int32_t *gcc_restrict x,
+                          const int32_t *gcc_restrict y,
+                          unsigned n,
+                          const FlatRay *rays, unsigned n_rays,
+                          std::vector<PolygonArrays::Intersection> &result)
+{
+  for (unsigned i = 0; i < n; ++i) {
+    const int ax = x[i], ay = y[i];
+    const int ex = x[i + 1] - ax, ey = y[i + 1] - ay;
+
+    uint32_t mask = 0;
+    for (unsigned r = 0; r < n_rays; ++r)
+      if (IsDistinctIntersection(rays[r], ax, ay, ex, ey))
+        mask |= 1u << r;
+
+    if (mask != 0)
+      result.push_back({i, mask});
+  }
+}
+
+#endif
+
+void
+PolygonArrays::FindIntersections(const FlatRay *rays, unsigned n_rays,
+                                 std::vector<Intersection> &result) const
+{
+  assert(n_rays <= 32);
+  assert(n_edges == 0 || !x.empty());
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+  OptimisedPolygonKernels::FindIntersections(x.data(), y.data(), n_edges,
+                                             rays, n_rays, result);
+#else
+  PortableFindIntersections(x.data(), y.data(), n_edges,
+                            rays, n_rays, result);
+#endif
+}
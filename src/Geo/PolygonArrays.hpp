@@ -0,0 +1,114 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_POLYGON_ARRAYS_HPP
+#define XCSOAR_GEO_POLYGON_ARRAYS_HPP
+
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+struct GeoPoint;
+struct FlatGeoPoint;
+class FlatRay;
+class SearchPointVector;
+
+/**
+ * A copy of the border of a closed polygon as a structure of arrays,
+ * which allows testing several edges at a time with SSE2 or NEON
+ * instructions.  The results are exactly the same as the ones of
+ * PolygonInterior() and FlatRay::DistinctIntersection() applied to
+ * the #SearchPointVector.
+ *
+ * The arrays are padded with copies of the last vertex, which form
+ * degenerate edges that never cross or intersect anything; this way,
+ * the kernels never need to handle a remainder.
+ */
+class PolygonArrays {
+  /**
+   * Angle::Native() of the geographic vertex locations.
+   */
+  std::vector<double> longitude, latitude;
+
+  /**
+   * The projected vertex locations.
+   */
+  std::vector<int32_t> x, y;
+
+  /**
+   * The number of edges, excluding the padding.
+   */
+  unsigned n_edges = 0;
+
+public:
+  /**
+   * Copy the vertices of the given closed polygon.  Call this again
+   * after the polygon has been projected.
+   *
+   * @param projected has the polygon been projected already?  If
+   * not, then only IsInside() may be used.
+   */
+  void Update(const SearchPointVector &border, bool projected=true);
+
+  unsigned GetEdgeCount() const {
+    return n_edges;
+  }
+
+  /**
+   * Same as SearchPointVector::IsInside(const GeoPoint &).
+   */
+  gcc_pure
+  bool IsInside(const GeoPoint &p) const;
+
+  /**
+   * An edge which intersects with at least one ray.
+   */
+  struct Intersection {
+    /**
+     * The index of the edge, i.e. of its first vertex in the
+     * #SearchPointVector.
+     */
+    unsigned edge;
+
+    /**
+     * A bit mask of the rays which intersect with this edge.
+     */
+    uint32_t rays;
+  };
+
+  /**
+   * Test the given rays for distinct intersections (see
+   * FlatRay::DistinctIntersection()) with all edges, loading each
+   * edge only once for all rays.
+   *
+   * @param n_rays the number of rays; at most 32
+   * @param result the intersecting edges are appended to this
+   * vector, in ascending order
+   */
+  void FindIntersections(const FlatRay *rays, unsigned n_rays,
+                         std::vector<Intersection> &result) const;
+};
+
+#endif
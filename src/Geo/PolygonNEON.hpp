@@ -0,0 +1,124 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_POLYGON_NEON_HPP
+#define XCSOAR_GEO_POLYGON_NEON_HPP
+
+#include "PolygonArrays.hpp"
+#include "Flat/FlatRay.hpp"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#include <arm_neon.h>
+
+/**
+ * Implementation of the #PolygonArrays intersection kernel using ARM
+ * NEON instructions, testing four edges at a time with 32 bit
+ * integers.  ARMv7 NEON has no double precision, therefore the
+ * winding number test remains scalar.
+ */
+class NEONPolygonKernels {
+public:
+  static constexpr unsigned STEP = 4;
+
+  /**
+   * Calculate a.x * b.y - b.x * a.y of four pairs of vectors.
+   */
+  gcc_always_inline
+  static int32x4_t CrossProduct(int32x4_t ax, int32x4_t ay,
+                                int32x4_t bx, int32x4_t by) {
+    return vsubq_s32(vmulq_s32(ax, by), vmulq_s32(bx, ay));
+  }
+
+  /**
+   * Test four edges against one ray.
+   *
+   * @return a bit mask of the edges which intersect
+   */
+  gcc_always_inline
+  static unsigned Intersects(int32x4_t ax, int32x4_t ay,
+                             int32x4_t ex, int32x4_t ey,
+                             const FlatRay &ray) {
+    const int32x4_t vx = vdupq_n_s32(ray.vector.x);
+    const int32x4_t vy = vdupq_n_s32(ray.vector.y);
+    const int32x4_t dx = vsubq_s32(ax, vdupq_n_s32(ray.point.x));
+    const int32x4_t dy = vsubq_s32(ay, vdupq_n_s32(ray.point.y));
+
+    const int32x4_t second = CrossProduct(vx, vy, ex, ey);
+    const int32x4_t first = CrossProduct(dx, dy, ex, ey);
+    const int32x4_t ub = CrossProduct(dx, dy, vx, vy);
+
+    /* flip the signs so "second" becomes positive */
+    const int32x4_t s = vshrq_n_s32(second, 31);
+    const int32x4_t S = vsubq_s32(veorq_s32(second, s), s);
+    const int32x4_t F = vsubq_s32(veorq_s32(first, s), s);
+    const int32x4_t U = vsubq_s32(veorq_s32(ub, s), s);
+
+    const uint32x4_t accept =
+      vbicq_u32(vandq_u32(vandq_u32(vcgtq_s32(F, vdupq_n_s32(0)),
+                                    vcltq_s32(F, S)),
+                          vcgtq_s32(U, vmvnq_s32(s))),
+                vcgtq_s32(U, S));
+
+    static constexpr uint32_t weights[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vandq_u32(accept, vld1q_u32(weights));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    sum = vpadd_u32(sum, sum);
+    return vget_lane_u32(sum, 0);
+  }
+
+  gcc_flatten
+  static void FindIntersections(const int32_t *gcc_restrict x,
+                                const int32_t *gcc_restrict y,
+                                unsigned n,
+                                const FlatRay *rays, unsigned n_rays,
+                                std::vector<PolygonArrays::Intersection> &result) {
+    for (unsigned i = 0; i < n; i += STEP) {
+      const int32x4_t ax = vld1q_s32(x + i), ay = vld1q_s32(y + i);
+      const int32x4_t ex = vsubq_s32(vld1q_s32(x + i + 1), ax);
+      const int32x4_t ey = vsubq_s32(vld1q_s32(y + i + 1), ay);
+
+      uint32_t masks[STEP] = {0, 0, 0, 0};
+      unsigned any = 0;
+
+      for (unsigned r = 0; r < n_rays; ++r) {
+        const unsigned m = Intersects(ax, ay, ex, ey, rays[r]);
+        any |= m;
+        for (unsigned j = 0; j < STEP; ++j)
+          if (m & (1u << j))
+            masks[j] |= 1u << r;
+      }
+
+      if (gcc_likely(any == 0))
+        continue;
+
+      for (unsigned j = 0; j < STEP; ++j)
+        if (masks[j] != 0)
+          result.push_back({i + j, masks[j]});
+    }
+  }
+};
+
+#endif
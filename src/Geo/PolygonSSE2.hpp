@@ -0,0 +1,174 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_POLYGON_SSE2_HPP
+#define XCSOAR_GEO_POLYGON_SSE2_HPP
+
+#include "PolygonArrays.hpp"
+#include "Flat/FlatRay.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+/**
+ * Implementation of the #PolygonArrays kernels using SSE2
+ * instructions.  The winding number test processes two edges at a
+ * time with double precision, the intersection test four edges with
+ * 32 bit integers; both do the same operations in the same order as
+ * the scalar code, which gives exactly the same results.
+ */
+class SSE2PolygonKernels {
+public:
+  static constexpr unsigned STEP = 4;
+
+  /**
+   * Calculate the low 32 bits of the products of four 32 bit
+   * integers (SSE4.1's _mm_mullo_epi32()).
+   */
+  gcc_always_inline
+  static __m128i Multiply(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                      _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+
+  /**
+   * Calculate a.x * b.y - b.x * a.y of four pairs of vectors.
+   */
+  gcc_always_inline
+  static __m128i CrossProduct(__m128i ax, __m128i ay,
+                              __m128i bx, __m128i by) {
+    return _mm_sub_epi32(Multiply(ax, by), Multiply(bx, ay));
+  }
+
+  gcc_always_inline
+  static __m128i Load(const int32_t *p) {
+    return _mm_loadu_si128((const __m128i *)p);
+  }
+
+  gcc_flatten
+  static int WindingNumber(const double *gcc_restrict longitude,
+                           const double *gcc_restrict latitude,
+                           unsigned n, double _px, double _py) {
+    const __m128d px = _mm_set1_pd(_px), py = _mm_set1_pd(_py);
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1);
+
+    __m128d wn = zero;
+
+    for (unsigned i = 0; i < n; i += 2) {
+      const __m128d ax = _mm_loadu_pd(longitude + i);
+      const __m128d ay = _mm_loadu_pd(latitude + i);
+      const __m128d bx = _mm_loadu_pd(longitude + i + 1);
+      const __m128d by = _mm_loadu_pd(latitude + i + 1);
+
+      const __m128d left =
+        _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(bx, ax), _mm_sub_pd(py, ay)),
+                   _mm_mul_pd(_mm_sub_pd(px, ax), _mm_sub_pd(by, ay)));
+
+      const __m128d a_below = _mm_cmple_pd(ay, py);
+      const __m128d up = _mm_and_pd(_mm_and_pd(a_below, _mm_cmpgt_pd(by, py)),
+                                    _mm_cmpgt_pd(left, zero));
+      const __m128d down = _mm_andnot_pd(a_below,
+                                         _mm_and_pd(_mm_cmple_pd(by, py),
+                                                    _mm_cmplt_pd(left, zero)));
+
+      wn = _mm_add_pd(wn, _mm_sub_pd(_mm_and_pd(up, one),
+                                     _mm_and_pd(down, one)));
+    }
+
+    return (int)_mm_cvtsd_f64(_mm_add_sd(wn, _mm_unpackhi_pd(wn, wn)));
+  }
+
+  /**
+   * Test four edges against one ray.
+   *
+   * @return a bit mask of the edges which intersect
+   */
+  gcc_always_inline
+  static unsigned Intersects(__m128i ax, __m128i ay,
+                             __m128i ex, __m128i ey,
+                             const FlatRay &ray) {
+    const __m128i vx = _mm_set1_epi32(ray.vector.x);
+    const __m128i vy = _mm_set1_epi32(ray.vector.y);
+    const __m128i dx = _mm_sub_epi32(ax, _mm_set1_epi32(ray.point.x));
+    const __m128i dy = _mm_sub_epi32(ay, _mm_set1_epi32(ray.point.y));
+
+    const __m128i second = CrossProduct(vx, vy, ex, ey);
+    const __m128i first = CrossProduct(dx, dy, ex, ey);
+    const __m128i ub = CrossProduct(dx, dy, vx, vy);
+
+    /* flip the signs so "second" becomes positive */
+    const __m128i s = _mm_srai_epi32(second, 31);
+    const __m128i S = _mm_sub_epi32(_mm_xor_si128(second, s), s);
+    const __m128i F = _mm_sub_epi32(_mm_xor_si128(first, s), s);
+    const __m128i U = _mm_sub_epi32(_mm_xor_si128(ub, s), s);
+
+    const __m128i not_s = _mm_xor_si128(s, _mm_set1_epi32(-1));
+
+    const __m128i accept =
+      _mm_andnot_si128(_mm_cmpgt_epi32(U, S),
+                       _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(F, _mm_setzero_si128()),
+                                                   _mm_cmplt_epi32(F, S)),
+                                     _mm_cmpgt_epi32(U, not_s)));
+
+    return _mm_movemask_ps(_mm_castsi128_ps(accept));
+  }
+
+  gcc_flatten
+  static void FindIntersections(const int32_t *gcc_restrict x,
+                                const int32_t *gcc_restrict y,
+                                unsigned n,
+                                const FlatRay *rays, unsigned n_rays,
+                                std::vector<PolygonArrays::Intersection> &result) {
+    for (unsigned i = 0; i < n; i += STEP) {
+      const __m128i ax = Load(x + i), ay = Load(y + i);
+      const __m128i ex = _mm_sub_epi32(Load(x + i + 1), ax);
+      const __m128i ey = _mm_sub_epi32(Load(y + i + 1), ay);
+
+      uint32_t masks[STEP] = {0, 0, 0, 0};
+      unsigned any = 0;
+
+      for (unsigned r = 0; r < n_rays; ++r) {
+        const unsigned m = Intersects(ax, ay, ex, ey, rays[r]);
+        any |= m;
+        for (unsigned j = 0; j < STEP; ++j)
+          if (m & (1u << j))
+            masks[j] |= 1u << r;
+      }
+
+      if (gcc_likely(any == 0))
+        continue;
+
+      for (unsigned j = 0; j < STEP; ++j)
+        if (masks[j] != 0)
+          result.push_back({i + j, masks[j]});
+    }
+  }
+};
+
+#endif
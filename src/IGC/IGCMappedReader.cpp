@@ -0,0 +1,69 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "IGCMappedReader.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include <string.h>
+
+IGCMappedReader::IGCMappedReader(Path path)
+  :mapping(path), position(nullptr), end(nullptr)
+{
+  if (mapping.error()) {
+    /* FileMapping refuses to map empty files; treat them as an IGC
+       file without records */
+    if (File::Exists(path) && File::GetSize(path) == 0)
+      return;
+
+    throw std::runtime_error("Failed to map " + path.ToUTF8());
+  }
+
+  position = (const char *)mapping.data();
+  end = (const char *)mapping.end();
+}
+
+bool
+IGCMappedReader::ReadLine(const char *&line, size_t &length)
+{
+  if (position == end)
+    return false;
+
+  line = position;
+
+  const char *eol = (const char *)memchr(position, '\n', end - position);
+  if (eol == nullptr) {
+    /* the last line has no line break */
+    position = eol = end;
+  } else
+    position = eol + 1;
+
+  if (eol > line && eol[-1] == '\r')
+    --eol;
+
+  length = eol - line;
+  return true;
+}
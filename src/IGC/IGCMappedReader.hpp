@@ -0,0 +1,79 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_IGC_MAPPED_READER_HPP
+#define XCSOAR_IGC_MAPPED_READER_HPP
+
+#include "OS/FileMapping.hpp"
+
+#include <stddef.h>
+
+class Path;
+
+/**
+ * Reads the records of an IGC file from a #FileMapping, without
+ * copying or converting them.  The lines returned by ReadLine() point
+ * into the mapping; they are not null-terminated, and they are only
+ * valid as long as this object exists.  Pass them to the
+ * length-aware IGCParseFix() and IGCParseExtensions() overloads.
+ */
+class IGCMappedReader {
+  FileMapping mapping;
+
+  const char *position, *end;
+
+public:
+  /**
+   * Throws std::runtime_error if the file cannot be mapped.
+   */
+  explicit IGCMappedReader(Path path);
+
+  IGCMappedReader(const IGCMappedReader &) = delete;
+  IGCMappedReader &operator=(const IGCMappedReader &) = delete;
+
+  /**
+   * Returns the size of the file, in bytes.
+   */
+  size_t GetSize() const {
+    return mapping.error() ? 0 : mapping.size();
+  }
+
+  /**
+   * Returns the number of bytes which have been read so far.
+   */
+  size_t Tell() const {
+    return mapping.error()
+      ? 0
+      : position - (const char *)mapping.data();
+  }
+
+  /**
+   * Read the next line.  The line break (LF or CR LF) is not part of
+   * the line.
+   *
+   * @return false at the end of the file
+   */
+  bool ReadLine(const char *&line, size_t &length);
+};
+
+#endif
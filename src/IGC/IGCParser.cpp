@@ -88,6 +88,50 @@ IGCParseHeader(const char *line, IGCHeader &header)
   return true;
 }
 
+/**
+ * Parse an unsigned integer from the given string range
+ * (null-termination is not necessary).  Parsing stops at the first
+ * non-digit, so this never reads past the null terminator of a
+ * shorter string.
+ *
+ * @param p the string
+ * @param end the end of the string
+ * @return the result, or -1 on error
+ */
+static int
+ParseUnsigned(const char *p, const char *end)
+{
+  unsigned value = 0;
+
+  for (; p < end; ++p) {
+    if (!IsDigitASCII(*p))
+      return -1;
+
+    value = value * 10 + (*p - '0');
+  }
+
+  return value;
+}
+
+static int
+ParseTwoDigits(const char *p)
+{
+  if (!IsDigitASCII(p[0]) || !IsDigitASCII(p[1]))
+    return -1;
+
+  return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+static bool
+MakeDateRecord(unsigned long value, BrokenDate &date)
+{
+  date.year = 1990 + (value + 10) % 100; /* Y2090 bug! */
+  date.month = (value / 100) % 100;
+  date.day = value / 10000;
+
+  return date.IsPlausible();
+}
+
 bool
 IGCParseDateRecord(const char *line, BrokenDate &date)
 {
@@ -101,20 +145,21 @@ IGCParseDateRecord(const char *line, BrokenDate &date)
   if (endptr != line + 6)
     return false;
 
-  date.year = 1990 + (value + 10) % 100; /* Y2090 bug! */
-  date.month = (value / 100) % 100;
-  date.day = value / 10000;
-
-  return date.IsPlausible();
+  return MakeDateRecord(value, date);
 }
 
-static int
-ParseTwoDigits(const char *p)
+bool
+IGCParseDateRecord(const char *line, size_t length, BrokenDate &date)
 {
-  if (!IsDigitASCII(p[0]) || !IsDigitASCII(p[1]))
-    return -1;
+  if (length < 11 || memcmp(line, "HFDTE", 5) != 0)
+    return false;
 
-  return (p[0] - '0') * 10 + (p[1] - '0');
+  /* exactly six digits */
+  const int value = ParseUnsigned(line + 5, line + 11);
+  if (value < 0 || (length > 11 && IsDigitASCII(line[11])))
+    return false;
+
+  return MakeDateRecord(value, date);
 }
 
 static bool
@@ -127,7 +172,16 @@ CheckThreeAlphaNumeric(const char *src)
 bool
 IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
 {
-  if (*buffer++ != 'I')
+  return IGCParseExtensions(buffer, strlen(buffer), extensions);
+}
+
+bool
+IGCParseExtensions(const char *buffer, size_t length,
+                   IGCExtensions &extensions)
+{
+  const char *const end = buffer + length;
+
+  if (length < 3 || *buffer++ != 'I')
     return false;
 
   int count = ParseTwoDigits(buffer);
@@ -139,6 +193,9 @@ IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
   extensions.clear();
 
   while (count-- > 0) {
+    if (end - buffer < 7)
+      return false;
+
     const int start = ParseTwoDigits(buffer);
     if (start < 8)
       return false;
@@ -166,29 +223,6 @@ IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
   return true;
 }
 
-/**
- * Parse an unsigned integer from the given string range
- * (null-termination is not necessary).
- *
- * @param p the string
- * @param end the end of the string
- * @return the result, or -1 on error
- */
-static int
-ParseUnsigned(const char *p, const char *end)
-{
-  unsigned value = 0;
-
-  for (; p < end; ++p) {
-    if (!IsDigitASCII(*p))
-      return -1;
-
-    value = value * 10 + (*p - '0');
-  }
-
-  return value;
-}
-
 static void
 ParseExtensionValue(const char *p, const char *end, int16_t &value_r)
 {
@@ -216,23 +250,46 @@ ParseExtensionValueN(const char *p, const char *end, size_t n,
     value_r = value;
 }
 
+/**
+ * Parse a five character altitude field, which may be negative
+ * (e.g. "-0012").
+ */
+static bool
+ParseAltitude(const char *p, int &value_r)
+{
+  const bool negative = *p == '-';
+  const int value = ParseUnsigned(p + negative, p + 5);
+  if (value < 0)
+    return false;
+
+  value_r = negative ? -value : value;
+  return true;
+}
+
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 {
-  if (*buffer != 'B')
+  return IGCParseFix(buffer, strlen(buffer), extensions, fix);
+}
+
+bool
+IGCParseFix(const char *buffer, size_t length,
+            const IGCExtensions &extensions, IGCFix &fix)
+{
+  /* "B", time, location, validity, pressure altitude, GPS altitude */
+  if (length < 35 || *buffer != 'B')
     return false;
 
   BrokenTime time;
   if (!IGCParseTime(buffer + 1, time))
     return false;
 
-  char valid_char;
   int gps_altitude, pressure_altitude;
-
-  if (sscanf(buffer + 24, "%c%05d%05d",
-             &valid_char, &pressure_altitude, &gps_altitude) != 3)
+  if (!ParseAltitude(buffer + 25, pressure_altitude) ||
+      !ParseAltitude(buffer + 30, gps_altitude))
     return false;
 
+  const char valid_char = buffer[24];
   if (valid_char == 'A')
     fix.gps_valid = true;
   else if (valid_char == 'V')
@@ -250,13 +307,12 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 
   fix.ClearExtensions();
 
-  const size_t line_length = strlen(buffer);
   for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
     const IGCExtension &extension = *i;
     assert(extension.start > 0);
     assert(extension.finish >= extension.start);
 
-    if (extension.finish > line_length)
+    if (extension.finish > length)
       /* exceeds the input line length */
       continue;
 
@@ -291,20 +347,31 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 bool
 IGCParseLocation(const char *buffer, GeoPoint &location)
 {
-  unsigned lat_degrees, lat_minutes, lon_degrees, lon_minutes;
-  char lat_char, lon_char;
+  /* DDMMmmm[N/S]DDDMMmmm[E/W]; each field is checked before the next
+     one is read, so this stops at the end of a short string */
 
-  if (sscanf(buffer, "%02u%05u%c%03u%05u%c",
-             &lat_degrees, &lat_minutes, &lat_char,
-             &lon_degrees, &lon_minutes, &lon_char) != 6)
+  const int lat_degrees = ParseUnsigned(buffer, buffer + 2);
+  if (lat_degrees < 0 || lat_degrees >= 90)
     return false;
 
-  if (lat_degrees >= 90 || lat_minutes >= 60000 ||
-      (lat_char != 'N' && lat_char != 'S'))
+  const int lat_minutes = ParseUnsigned(buffer + 2, buffer + 7);
+  if (lat_minutes < 0 || lat_minutes >= 60000)
     return false;
 
-  if (lon_degrees >= 180 || lon_minutes >= 60000 ||
-      (lon_char != 'E' && lon_char != 'W'))
+  const char lat_char = buffer[7];
+  if (lat_char != 'N' && lat_char != 'S')
+    return false;
+
+  const int lon_degrees = ParseUnsigned(buffer + 8, buffer + 11);
+  if (lon_degrees < 0 || lon_degrees >= 180)
+    return false;
+
+  const int lon_minutes = ParseUnsigned(buffer + 11, buffer + 16);
+  if (lon_minutes < 0 || lon_minutes >= 60000)
+    return false;
+
+  const char lon_char = buffer[16];
+  if (lon_char != 'E' && lon_char != 'W')
     return false;
 
   location.latitude = Angle::Degrees(lat_degrees +
@@ -323,9 +390,16 @@ IGCParseLocation(const char *buffer, GeoPoint &location)
 bool
 IGCParseTime(const char *buffer, BrokenTime &time)
 {
-  unsigned hour, minute, second;
+  const int hour = ParseTwoDigits(buffer);
+  if (hour < 0)
+    return false;
+
+  const int minute = ParseTwoDigits(buffer + 2);
+  if (minute < 0)
+    return false;
 
-  if (sscanf(buffer, "%02u%02u%02u", &hour, &minute, &second) != 3)
+  const int second = ParseTwoDigits(buffer + 4);
+  if (second < 0)
     return false;
 
   time = BrokenTime(hour, minute, second);
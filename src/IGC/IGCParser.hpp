@@ -24,6 +24,8 @@ Copyright_License {
 #ifndef XCSOAR_IGC_PARSER_HPP
 #define XCSOAR_IGC_PARSER_HPP
 
+#include <stddef.h>
+
 struct IGCFix;
 struct IGCHeader;
 struct IGCExtensions;
@@ -49,6 +51,15 @@ IGCParseHeader(const char *line, IGCHeader &header);
 bool
 IGCParseDateRecord(const char *line, BrokenDate &date);
 
+/**
+ * Parse an IGC "HFDTE" record which is not null-terminated.
+ *
+ * @param length the length of the line, excluding the line break
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseDateRecord(const char *line, size_t length, BrokenDate &date);
+
 /**
  * Parse an IGC "I" record.
  *
@@ -57,6 +68,16 @@ IGCParseDateRecord(const char *line, BrokenDate &date);
 bool
 IGCParseExtensions(const char *buffer, IGCExtensions &extensions);
 
+/**
+ * Parse an IGC "I" record which is not null-terminated.
+ *
+ * @param length the length of the line, excluding the line break
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseExtensions(const char *buffer, size_t length,
+                   IGCExtensions &extensions);
+
 /**
  * Parse a location in IGC file format. (DDMMmmm[N/S]DDDMMmmm[E/W])
  *
@@ -73,6 +94,17 @@ IGCParseLocation(const char *buffer, GeoPoint &location);
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix);
 
+/**
+ * Parse an IGC "B" record which is not null-terminated, e.g. a line
+ * inside a file mapping.
+ *
+ * @param length the length of the line, excluding the line break
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseFix(const char *buffer, size_t length,
+            const IGCExtensions &extensions, IGCFix &fix);
+
 /**
  * Parse a time in IGC file format (HHMMSS).
  *
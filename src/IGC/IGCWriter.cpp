@@ -30,11 +30,14 @@ Copyright_License {
 
 #include <assert.h>
 
-IGCWriter::IGCWriter(Path path)
+IGCWriter::IGCWriter(Path path, unsigned sync_interval_ms)
   :file(path,
         /* we use CREATE_VISIBLE here so the user can recover partial
            IGC files after a crash/battery failure/etc. */
-        FileOutputStream::Mode::CREATE_VISIBLE),
+        FileOutputStream::Mode::CREATE_VISIBLE,
+        /* never drop lines, because that would break the G record */
+        AsyncLogWriter::Overflow::WAIT,
+        sync_interval_ms),
    buffered(file)
 {
   fix.Clear();
@@ -26,7 +26,7 @@ Copyright_License {
 
 #include "Logger/GRecord.hpp"
 #include "IGCFix.hpp"
-#include "IO/FileOutputStream.hxx"
+#include "Logger/AsyncLogWriter.hpp"
 #include "IO/BufferedOutputStream.hxx"
 
 #include <tchar.h>
@@ -42,7 +42,12 @@ class IGCWriter {
     MAX_IGC_BUFF = 255,
   };
 
-  FileOutputStream file;
+  /**
+   * Writes in a separate thread, so a slow storage device does not
+   * stall the calculation thread.
+   */
+  AsyncLogWriter file;
+
   BufferedOutputStream buffered;
 
   GRecord grecord;
@@ -53,14 +58,34 @@ class IGCWriter {
 
 public:
   /**
-   * Create a new IGC file.  The caller must check IsOpen().
+   * Create a new IGC file.  Throws std::runtime_error on error.
+   *
+   * @param sync_interval_ms the interval for synchronising the file
+   * to the storage device [ms]; 0 means only on Close()
    */
-  explicit IGCWriter(Path path);
+  explicit IGCWriter(Path path, unsigned sync_interval_ms=0);
 
+  /**
+   * Pass the buffered lines to the writer thread.  This does not
+   * block.
+   */
   void Flush() {
     buffered.Flush();
   }
 
+  /**
+   * Write all lines and close the file.  Throws std::runtime_error
+   * on error.
+   */
+  void Close() {
+    buffered.Flush();
+    file.Close();
+  }
+
+  AsyncLogWriter::Statistics GetStatistics() const {
+    return file.GetStatistics();
+  }
+
   void Sign();
 
 private:
@@ -115,6 +115,13 @@ GetRegularFileInfo(Path path, FileInfo &info)
 FileCache::FileCache(AllocatedPath &&_cache_path)
   :cache_path(std::move(_cache_path)) {}
 
+AllocatedPath
+FileCache::CreatePath(const TCHAR *name)
+{
+  Directory::Create(cache_path);
+  return MakeCachePath(name);
+}
+
 void
 FileCache::Flush(const TCHAR *name)
 {
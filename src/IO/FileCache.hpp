@@ -42,6 +42,13 @@ protected:
   }
 
 public:
+  /**
+   * Create the cache directory and return the path of the specified
+   * cache file.  This is for files which are managed by the caller
+   * instead of Load() and Save().
+   */
+  AllocatedPath CreatePath(const TCHAR *name);
+
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, Path original_path);
 
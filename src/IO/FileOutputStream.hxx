@@ -109,6 +109,12 @@ public:
 	/* virtual methods from class OutputStream */
 	void Write(const void *data, size_t size) override;
 
+	/**
+	 * Flush the file contents to the storage device.  Throws
+	 * std::runtime_error on error.
+	 */
+	void Sync();
+
 	void Commit();
 	void Cancel();
 
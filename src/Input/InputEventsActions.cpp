@@ -84,6 +84,11 @@ doc/html/advanced/input/ALL		http://xcsoar.sourceforge.net/advanced/input/
 #include "MapWindow/GlueMapWindow.hpp"
 #include "Simulator.hpp"
 #include "Formatter/TimeFormatter.hpp"
+#include "Thread/Timeline.hpp"
+#include "JSON/TimelineWriter.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/BufferedOutputStream.hxx"
+#include "LocalPath.hpp"
 
 #include <assert.h>
 #include <tchar.h>
@@ -684,3 +689,26 @@ InputEvents::eventFileManager(const TCHAR *misc)
 {
   ShowFileManager();
 }
+
+// DumpTimeline
+// Writes the most recent work spans of all threads (calculation,
+// merge, terrain, topography, drawing) to "xcsoar-timeline.json" in
+// the data directory.  It can be loaded into chrome://tracing.
+void
+InputEvents::eventDumpTimeline(gcc_unused const TCHAR *misc)
+{
+  const auto threads = SnapshotTimeline();
+
+  try {
+    FileOutputStream file(LocalPath(_T("xcsoar-timeline.json")));
+    BufferedOutputStream os(file);
+    JSON::WriteTimeline(os, threads);
+    os.Flush();
+    file.Commit();
+  } catch (const std::runtime_error &e) {
+    ShowError(e, _("Failed to save the timeline"));
+    return;
+  }
+
+  Message::AddMessage(_("Timeline saved"));
+}
@@ -0,0 +1,84 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TimelineWriter.hpp"
+#include "Writer.hpp"
+
+static void
+WriteUnsigned64(BufferedOutputStream &writer, uint64_t value)
+{
+  writer.Format("%llu", (unsigned long long)value);
+}
+
+static void
+WriteThreadName(BufferedOutputStream &writer, const TimelineThread &thread)
+{
+  JSON::ObjectWriter object(writer);
+  object.WriteElement("name", JSON::WriteString, "thread_name");
+  object.WriteElement("ph", JSON::WriteString, "M");
+  object.WriteElement("pid", JSON::WriteUnsigned, 1);
+  object.WriteElement("tid", JSON::WriteUnsigned, thread.id);
+
+  object.BeginElement("args");
+  {
+    JSON::ObjectWriter args(writer);
+    args.WriteElement("name", JSON::WriteString, thread.name);
+  }
+  object.EndElement();
+}
+
+static void
+WriteSpan(BufferedOutputStream &writer, unsigned tid,
+          const TimelineSpan &span)
+{
+  JSON::ObjectWriter object(writer);
+  object.WriteElement("name", JSON::WriteString, span.name);
+  object.WriteElement("ph", JSON::WriteString, "X");
+  object.WriteElement("pid", JSON::WriteUnsigned, 1);
+  object.WriteElement("tid", JSON::WriteUnsigned, tid);
+  object.WriteElement("ts", WriteUnsigned64, span.start);
+  object.WriteElement("dur", JSON::WriteUnsigned, span.duration);
+}
+
+void
+JSON::WriteTimeline(BufferedOutputStream &writer,
+                    const std::vector<TimelineThread> &threads)
+{
+  ObjectWriter root(writer);
+  root.WriteElement("displayTimeUnit", WriteString, "ms");
+
+  root.BeginElement("traceEvents");
+  {
+    ArrayWriter events(writer);
+
+    for (const auto &thread : threads) {
+      events.BeginElement();
+      WriteThreadName(writer, thread);
+      events.EndElement();
+
+      for (const auto &span : thread.spans)
+        events.WriteElement(WriteSpan, thread.id, span);
+    }
+  }
+  root.EndElement();
+}
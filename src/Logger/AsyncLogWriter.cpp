@@ -0,0 +1,343 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AsyncLogWriter.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+/**
+ * How often does the writer thread look for new records [ms]?
+ * Producers wake it up earlier when the queue is half full.
+ */
+static constexpr unsigned POLL_INTERVAL = 250;
+
+AsyncLogWriter::AsyncLogWriter(Path path, FileOutputStream::Mode mode,
+                               Overflow _overflow,
+                               unsigned _sync_interval_ms)
+  :Thread("LogWriter"),
+   file(path, mode),
+   overflow(_overflow), sync_interval_ms(_sync_interval_ms),
+   slots(new Slot[N_SLOTS]),
+   write_position(0), read_position(0),
+   n_records(0), n_dropped(0), n_stalls(0),
+   n_bytes(0), n_writes(0), n_syncs(0),
+   failed(false),
+   buffer(new char[BUFFER_SIZE]),
+   file_position(file.Tell())
+{
+  static_assert((N_SLOTS & (N_SLOTS - 1)) == 0,
+                "N_SLOTS must be a power of two");
+  static_assert(BUFFER_SIZE >= BLOCK_SIZE + MAX_RECORD,
+                "Buffer too small");
+
+  for (unsigned i = 0; i < N_SLOTS; ++i)
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+
+  sync_clock.Update();
+
+  if (!Start()) {
+    file.Cancel();
+    throw std::runtime_error("Failed to start the log writer thread");
+  }
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+  if (IsDefined()) {
+    try {
+      Close();
+    } catch (...) {
+    }
+  }
+}
+
+bool
+AsyncLogWriter::TryPush(const void *a, size_t a_size,
+                        const void *b, size_t b_size)
+{
+  assert(a_size + b_size <= MAX_RECORD);
+
+  unsigned position = write_position.load(std::memory_order_relaxed);
+  Slot *slot;
+
+  while (true) {
+    slot = &slots[position % N_SLOTS];
+    const unsigned sequence = slot->sequence.load(std::memory_order_acquire);
+    const int diff = int(sequence - position);
+
+    if (diff == 0) {
+      /* the slot is free; try to claim it */
+      if (write_position.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed))
+        break;
+    } else if (diff < 0)
+      /* the writer thread has not consumed this slot yet */
+      return false;
+    else
+      /* another producer was faster */
+      position = write_position.load(std::memory_order_relaxed);
+  }
+
+  memcpy(slot->data, a, a_size);
+  if (b_size > 0)
+    memcpy(slot->data + a_size, b, b_size);
+  slot->size = a_size + b_size;
+
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  /* wake up the writer thread early if the queue is getting full */
+  if (position + 1 - read_position.load(std::memory_order_relaxed)
+      == N_SLOTS / 2) {
+    const ScopeLock protect(mutex);
+    wake_cond.signal();
+  }
+
+  return true;
+}
+
+bool
+AsyncLogWriter::Push(const void *a, size_t a_size,
+                     const void *b, size_t b_size)
+{
+  if (failed.load(std::memory_order_relaxed)) {
+    ++n_dropped;
+    return false;
+  }
+
+  if (!TryPush(a, a_size, b, b_size)) {
+    if (overflow == Overflow::DROP) {
+      ++n_dropped;
+      return false;
+    }
+
+    ++n_stalls;
+
+    do {
+      const ScopeLock protect(mutex);
+      if (quit || failed.load(std::memory_order_relaxed)) {
+        ++n_dropped;
+        return false;
+      }
+
+      wake_cond.signal();
+      done_cond.timed_wait(mutex, POLL_INTERVAL);
+    } while (!TryPush(a, a_size, b, b_size));
+  }
+
+  ++n_records;
+  return true;
+}
+
+bool
+AsyncLogWriter::WriteLine(const char *line)
+{
+#ifdef HAVE_POSIX
+  static constexpr char newline[] = "\n";
+#else
+  static constexpr char newline[] = "\r\n";
+#endif
+  static constexpr size_t newline_size = sizeof(newline) - 1;
+
+  const size_t size = std::min(strlen(line), MAX_RECORD - newline_size);
+  return Push(line, size, newline, newline_size);
+}
+
+void
+AsyncLogWriter::Write(const void *_data, size_t size)
+{
+  const char *data = (const char *)_data;
+
+  while (size > 0) {
+    const size_t chunk = std::min(size, size_t(MAX_RECORD));
+    Push(data, chunk);
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+void
+AsyncLogWriter::Flush()
+{
+  const ScopeLock protect(mutex);
+  assert(!quit);
+
+  const unsigned generation = ++flush_requested;
+  wake_cond.signal();
+
+  while (int(flush_completed - generation) < 0 &&
+         !failed.load(std::memory_order_relaxed))
+    done_cond.wait(mutex);
+}
+
+void
+AsyncLogWriter::Close()
+{
+  assert(IsDefined());
+
+  {
+    const ScopeLock protect(mutex);
+    quit = true;
+    wake_cond.signal();
+  }
+
+  Join();
+
+  if (error) {
+    file.Cancel();
+    std::rethrow_exception(error);
+  }
+
+  file.Commit();
+}
+
+AsyncLogWriter::Statistics
+AsyncLogWriter::GetStatistics() const
+{
+  Statistics s;
+  s.n_records = n_records.load(std::memory_order_relaxed);
+  s.n_dropped = n_dropped.load(std::memory_order_relaxed);
+  s.n_stalls = n_stalls.load(std::memory_order_relaxed);
+  s.n_bytes = n_bytes.load(std::memory_order_relaxed);
+  s.n_writes = n_writes.load(std::memory_order_relaxed);
+  s.n_syncs = n_syncs.load(std::memory_order_relaxed);
+  return s;
+}
+
+void
+AsyncLogWriter::WriteBuffer(bool force)
+{
+  size_t size = buffer_fill;
+  if (!force) {
+    /* end the write at a block boundary of the file */
+    const size_t misalignment = (file_position + size) % BLOCK_SIZE;
+    if (misalignment >= size)
+      return;
+
+    size -= misalignment;
+  }
+
+  if (size == 0)
+    return;
+
+  file.Write(buffer.get(), size);
+  ++n_writes;
+  n_bytes += size;
+  file_position += size;
+  dirty = true;
+
+  buffer_fill -= size;
+  memmove(buffer.get(), buffer.get() + size, buffer_fill);
+}
+
+void
+AsyncLogWriter::Drain()
+{
+  unsigned position = read_position.load(std::memory_order_relaxed);
+
+  while (true) {
+    Slot &slot = slots[position % N_SLOTS];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+      /* empty */
+      break;
+
+    if (buffer_fill + slot.size > BUFFER_SIZE)
+      WriteBuffer(false);
+
+    memcpy(buffer.get() + buffer_fill, slot.data, slot.size);
+    buffer_fill += slot.size;
+
+    /* release the slot for the next round */
+    slot.sequence.store(position + N_SLOTS, std::memory_order_release);
+    read_position.store(++position, std::memory_order_relaxed);
+  }
+
+  /* hand the rest to the kernel now, so a crash loses at most one
+     poll interval; only the fsync() is deferred */
+  WriteBuffer(true);
+}
+
+void
+AsyncLogWriter::Sync()
+{
+  if (dirty) {
+    file.Sync();
+    ++n_syncs;
+    dirty = false;
+  }
+
+  sync_clock.Update();
+}
+
+void
+AsyncLogWriter::Run()
+{
+  const ScopeLock protect(mutex);
+
+  while (true) {
+    const unsigned flush_generation = flush_requested;
+    const bool closing = quit;
+
+    {
+      const ScopeUnlock unlock(mutex);
+
+      try {
+        Drain();
+
+        if (closing ||
+            (sync_interval_ms > 0 && sync_clock.Check(sync_interval_ms)))
+          Sync();
+      } catch (...) {
+        const ScopeLock protect2(mutex);
+        error = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    flush_completed = flush_generation;
+    done_cond.broadcast();
+
+    if (closing || failed.load(std::memory_order_relaxed))
+      break;
+
+    if (quit || flush_requested != flush_generation)
+      /* a request has arrived meanwhile */
+      continue;
+
+    wake_cond.timed_wait(mutex, POLL_INTERVAL);
+  }
+
+  /* discard the records which were queued after the error */
+  if (failed.load(std::memory_order_relaxed)) {
+    const ScopeUnlock unlock(mutex);
+    unsigned position = read_position.load(std::memory_order_relaxed);
+    while (slots[position % N_SLOTS].sequence.load(std::memory_order_acquire) == position + 1) {
+      slots[position % N_SLOTS].sequence.store(position + N_SLOTS,
+                                               std::memory_order_release);
+      read_position.store(++position, std::memory_order_relaxed);
+      ++n_dropped;
+    }
+  }
+}
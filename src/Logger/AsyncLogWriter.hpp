@@ -0,0 +1,288 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_ASYNC_LOG_WRITER_HPP
+#define XCSOAR_ASYNC_LOG_WRITER_HPP
+
+#include "IO/OutputStream.hxx"
+#include "IO/FileOutputStream.hxx"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+#include "Time/PeriodClock.hpp"
+
+#include <atomic>
+#include <memory>
+#include <exception>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Appends records to a file in a dedicated thread, so a slow storage
+ * device does not block the threads which produce them (e.g. the
+ * port threads and the calculation thread).
+ *
+ * Records are passed through a bounded lock-free multi-producer
+ * queue.  The writer thread collects them in a buffer, writes whole
+ * file system blocks while draining a large backlog, and the rest at
+ * the end of each pass, i.e. at least every 250 ms.  The file
+ * is synchronised to the storage device only when the sync interval
+ * has elapsed, and in Close().
+ *
+ * Errors from the writer thread are rethrown by Close(); after an
+ * error, all further records are dropped.
+ */
+class AsyncLogWriter final : public OutputStream, Thread {
+public:
+  /**
+   * The maximum size of one record.  Longer lines passed to
+   * WriteLine() are truncated; Write() splits the data.
+   */
+  static constexpr size_t MAX_RECORD = 256;
+
+  /**
+   * The number of records the queue can hold.  Must be a power of
+   * two.
+   */
+  static constexpr unsigned N_SLOTS = 512;
+
+  /**
+   * The file system block size.  Except for forced writes, the file
+   * is always extended by whole blocks.
+   */
+  static constexpr size_t BLOCK_SIZE = 4096;
+
+  static constexpr size_t BUFFER_SIZE = 16 * BLOCK_SIZE;
+
+  /**
+   * What happens if a record is submitted while the queue is full?
+   */
+  enum class Overflow : uint8_t {
+    /**
+     * Drop the record; it is counted in Statistics::n_dropped.
+     */
+    DROP,
+
+    /**
+     * Block the caller until the writer thread has made room; this
+     * is counted in Statistics::n_stalls.  Use this for files which
+     * must be complete, e.g. signed IGC files.
+     */
+    WAIT,
+  };
+
+  struct Statistics {
+    /**
+     * The number of records which have been queued.
+     */
+    unsigned n_records;
+
+    /**
+     * The number of records which were lost because the queue was
+     * full or because writing has failed.
+     */
+    unsigned n_dropped;
+
+    /**
+     * How often did a caller have to wait for room in the queue?
+     */
+    unsigned n_stalls;
+
+    /**
+     * The number of bytes which have been written to the file.
+     */
+    unsigned n_bytes;
+
+    /**
+     * The number of write() and fsync() calls.
+     */
+    unsigned n_writes, n_syncs;
+  };
+
+private:
+  struct Slot {
+    /**
+     * The queue position this slot is ready for: equal to the
+     * position if it is free for a producer, position+1 if it
+     * contains a record for the writer thread.
+     */
+    std::atomic<unsigned> sequence;
+
+    uint16_t size;
+
+    char data[MAX_RECORD];
+  };
+
+  FileOutputStream file;
+
+  const Overflow overflow;
+
+  /**
+   * The interval for synchronising the file to the storage device
+   * [ms]; 0 means only on Close().  This does not delay write().
+   */
+  const unsigned sync_interval_ms;
+
+  const std::unique_ptr<Slot[]> slots;
+
+  /**
+   * The next queue position for a producer.
+   */
+  std::atomic<unsigned> write_position;
+
+  /**
+   * The next queue position for the writer thread.
+   */
+  std::atomic<unsigned> read_position;
+
+  std::atomic<unsigned> n_records, n_dropped, n_stalls;
+  std::atomic<unsigned> n_bytes, n_writes, n_syncs;
+
+  /**
+   * Set by the writer thread after an error.
+   */
+  std::atomic<bool> failed;
+
+  /**
+   * Protects the attributes below.
+   */
+  Mutex mutex;
+
+  /**
+   * Wakes up the writer thread.
+   */
+  Cond wake_cond;
+
+  /**
+   * Signalled by the writer thread after each pass over the queue.
+   */
+  Cond done_cond;
+
+  unsigned flush_requested = 0, flush_completed = 0;
+
+  bool quit = false;
+
+  std::exception_ptr error;
+
+  /* the attributes below are owned by the writer thread */
+
+  const std::unique_ptr<char[]> buffer;
+  size_t buffer_fill = 0;
+
+  /**
+   * The current size of the file, to align the writes.
+   */
+  uint64_t file_position;
+
+  /**
+   * Have bytes been written since the last fsync()?
+   */
+  bool dirty = false;
+
+  PeriodClock sync_clock;
+
+public:
+  /**
+   * Opens the file and starts the writer thread.  Throws
+   * std::runtime_error on error.
+   */
+  AsyncLogWriter(Path path, FileOutputStream::Mode mode,
+                 Overflow _overflow, unsigned _sync_interval_ms);
+
+  /**
+   * Calls Close() if that has not been done yet, ignoring errors.
+   */
+  ~AsyncLogWriter();
+
+  /**
+   * Queue a line, followed by a line break.  This may be called by
+   * several threads at a time; it does not block unless the queue is
+   * full and #Overflow::WAIT was selected.
+   *
+   * @return false if the line was dropped
+   */
+  bool WriteLine(const char *line);
+
+  /**
+   * Wait until all records which have been queued so far have been
+   * written to the file (but not necessarily synchronised).
+   */
+  void Flush();
+
+  /**
+   * Write all records, synchronise and close the file, and stop the
+   * writer thread.  Throws std::runtime_error if writing has failed.
+   */
+  void Close();
+
+  gcc_pure
+  Statistics GetStatistics() const;
+
+  /* virtual methods from class OutputStream */
+
+  /**
+   * Queue raw data, split into records of at most #MAX_RECORD bytes.
+   * Callers must not interleave Write() calls from several threads,
+   * because that would interleave the pieces.
+   */
+  void Write(const void *data, size_t size) override;
+
+private:
+  /**
+   * Copy the concatenation of the two buffers into a free slot.
+   *
+   * @return false if the queue is full
+   */
+  bool TryPush(const void *a, size_t a_size,
+               const void *b, size_t b_size);
+
+  bool Push(const void *a, size_t a_size,
+            const void *b=nullptr, size_t b_size=0);
+
+  /**
+   * Move all queued records to the buffer, writing whole blocks
+   * whenever it gets full, and write the rest at the end.
+   */
+  void Drain();
+
+  /**
+   * Write the buffer to the file.
+   *
+   * @param force true to write everything, false to write whole
+   * blocks only
+   */
+  void WriteBuffer(bool force);
+
+  /**
+   * Synchronise the file if something has been written since the
+   * last call.
+   */
+  void Sync();
+
+protected:
+  /* virtual methods from class Thread */
+  void Run() override;
+};
+
+#endif
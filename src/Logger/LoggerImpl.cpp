@@ -98,9 +98,17 @@ LoggerImpl::StopLogger(const NMEAInfo &gps_info)
   if (!simulator)
     writer->Sign();
 
-  writer->Flush();
+  try {
+    writer->Close();
+  } catch (const std::runtime_error &e) {
+    LogError(e);
+  }
 
+  const auto statistics = writer->GetStatistics();
   LogFormat(_T("Logger stopped: %s"), filename.c_str());
+  if (statistics.n_stalls > 0 || statistics.n_dropped > 0)
+    LogFormat("Logger: %u stalls, %u lost records",
+              statistics.n_stalls, statistics.n_dropped);
 
   // Logger off
   delete writer;
@@ -253,7 +261,7 @@ LoggerImpl::StartLogger(const NMEAInfo &gps_info,
   frecord.Reset();
 
   try {
-    writer = new IGCWriter(filename);
+    writer = new IGCWriter(filename, settings.sync_interval * 1000u);
   } catch (const std::runtime_error &e) {
     LogError(e);
     return false;
@@ -22,28 +22,39 @@ Copyright_License {
 */
 
 #include "Logger/NMEALogger.hpp"
-#include "IO/TextWriter.hpp"
+#include "Logger/AsyncLogWriter.hpp"
 #include "LocalPath.hpp"
+#include "LogFile.hpp"
 #include "Time/BrokenDateTime.hpp"
 #include "Thread/Mutex.hpp"
 #include "OS/Path.hpp"
 #include "Util/StaticString.hxx"
 
+#include <atomic>
+#include <stdexcept>
+
 namespace NMEALogger
 {
+  /**
+   * Protects the creation of #writer.
+   */
   static Mutex mutex;
-  static TextWriter *writer;
+  static std::atomic<AsyncLogWriter *> writer;
 
   bool enabled = false;
+  unsigned sync_interval = 5;
 
-  static bool Start();
+  static AsyncLogWriter *Start();
 }
 
-bool
+AsyncLogWriter *
 NMEALogger::Start()
 {
-  if (writer != nullptr)
-    return true;
+  const ScopeLock protect(mutex);
+
+  AsyncLogWriter *w = writer.load(std::memory_order_relaxed);
+  if (w != nullptr)
+    return w;
 
   BrokenDateTime dt = BrokenDateTime::NowUTC();
   assert(dt.IsPlausible());
@@ -56,23 +67,40 @@ NMEALogger::Start()
   const auto logs_path = MakeLocalPath(_T("logs"));
 
   const auto path = AllocatedPath::Build(logs_path, name);
-  writer = new TextWriter(path, false);
-  if (writer == nullptr)
-    return false;
-
-  if (!writer->IsOpen()) {
-    delete writer;
-    writer = nullptr;
-    return false;
+
+  try {
+    w = new AsyncLogWriter(path, FileOutputStream::Mode::CREATE_VISIBLE,
+                           AsyncLogWriter::Overflow::DROP,
+                           sync_interval * 1000u);
+  } catch (const std::runtime_error &e) {
+    LogError(e);
+    /* don't retry for each line */
+    enabled = false;
+    return nullptr;
   }
 
-  return true;
+  writer.store(w, std::memory_order_release);
+  return w;
 }
 
 void
 NMEALogger::Shutdown()
 {
-  delete writer;
+  AsyncLogWriter *w = writer.exchange(nullptr);
+  if (w == nullptr)
+    return;
+
+  try {
+    w->Close();
+  } catch (const std::runtime_error &e) {
+    LogError(e);
+  }
+
+  const auto statistics = w->GetStatistics();
+  if (statistics.n_dropped > 0)
+    LogFormat("NMEA logger: %u lines lost", statistics.n_dropped);
+
+  delete w;
 }
 
 void
@@ -81,7 +109,12 @@ NMEALogger::Log(const char *text)
   if (!enabled)
     return;
 
-  ScopeLock protect(mutex);
-  if (Start())
-    writer->WriteLine(text);
+  AsyncLogWriter *w = writer.load(std::memory_order_acquire);
+  if (w == nullptr) {
+    w = Start();
+    if (w == nullptr)
+      return;
+  }
+
+  w->WriteLine(text);
 }
@@ -28,10 +28,18 @@ namespace NMEALogger
 {
   extern bool enabled;
 
+  /**
+   * The interval for synchronising the log file to the storage
+   * device [s], see LoggerSettings::sync_interval.  Must be set
+   * before the first Log() call.
+   */
+  extern unsigned sync_interval;
+
   void Shutdown();
 
   /**
-   * Logs NMEA string to log file
+   * Logs NMEA string to log file.  This does not block; the line is
+   * dropped if the writer thread cannot keep up.
    * @param text
    */
   void Log(const char *line);
@@ -28,6 +28,7 @@ LoggerSettings::SetDefaults()
 {
   time_step_cruise = 5;
   time_step_circling = 1;
+  sync_interval = 5;
   auto_logger = AutoLogger::ON;
   logger_id.clear();
   pilot_name.clear();
@@ -48,6 +48,14 @@ struct LoggerSettings {
   /** Logger interval in circling mode */
   uint16_t time_step_circling;
 
+  /**
+   * How often are the IGC and NMEA log files synchronised to the
+   * storage device [s]?  Zero means only when the file is closed.
+   * Independent of this, records are written to the file within a
+   * fraction of a second.
+   */
+  uint16_t sync_interval;
+
   enum class AutoLogger: uint8_t {
     ON,
     START_ONLY,
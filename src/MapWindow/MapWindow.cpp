@@ -137,8 +137,11 @@ MapWindow::OnPaintBuffer(Canvas &canvas)
 #endif
 
   // Render the moving map
-  Render(canvas, GetClientRect());
-  draw_sw.Finish();
+  {
+    const ScopeTimelineSpan timeline("MapWindow::Render");
+    Render(canvas, GetClientRect());
+    draw_sw.Finish();
+  }
 
 #ifndef ENABLE_OPENGL
   /* save the generation number which was active when rendering had
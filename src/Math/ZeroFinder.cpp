@@ -21,6 +21,7 @@
  */
 #include "ZeroFinder.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include <math.h>
@@ -69,10 +70,10 @@ ZeroFinder::solution_within_tolerance(const double x,
   if (x_plus >= xmax)
     return false;
 
-  const auto fx = f(x);
-  if (f(x_plus)<fx)
+  const auto fx = evaluate(x);
+  if (evaluate(x_plus)<fx)
     return false;
-  if (f(x_minus)<fx)
+  if (evaluate(x_minus)<fx)
     return false;
   // existing solution is good 
   return true;
@@ -138,29 +139,50 @@ ZeroFinder::find_zero(const double xstart)
   zero_total++;
 #endif
   if ((xmin<=xstart) || (xstart<=xmax) ||
-      (f(xstart)> sqrt_epsilon))
-    return find_zero_actual(xstart);
+      (evaluate(xstart)> sqrt_epsilon))
+    return find_zero_full();
 #ifdef INSTRUMENT_ZERO
   zero_skipped++;
 #endif
   return xstart;
 }
 
+double
+ZeroFinder::find_zero_near(const double xstart, const double step)
+{
+  assert(step > 0);
+
+  const double a = std::max(xstart - step, xmin);
+  const double b = std::min(xstart + step, xmax);
+  if (a < b) {
+    const auto fa = evaluate(a);
+    const auto fb = evaluate(b);
+    if ((fa <= 0) != (fb <= 0) || fb == 0)
+      // the root is still near the previous one
+      return find_zero_actual(a, fa, b, fb);
+  }
+
+  return find_zero_full();
+}
+
 inline double
-ZeroFinder::find_zero_actual(const double xstart)
+ZeroFinder::find_zero_full()
 {
-  double a, b, c; // Abscissae, descr. see above
-  double fa; // f(a)
-  double fb; // f(b)
+  const auto fa = evaluate(xmin);
+  const auto fb = evaluate(xmax);
+  return find_zero_actual(xmin, fa, xmax, fb);
+}
+
+inline double
+ZeroFinder::find_zero_actual(double a, double fa, double b, double fb)
+{
+  double c; // Abscissae, descr. see above
   double fc; // f(c)
 
   bool b_best = true; // b is best and last called
 
-  c = a = xmin;  
-  fc = fa = f(a);  
-
-  b = xmax;  
-  fb = f(b);
+  c = a;
+  fc = fa;
 
   // Main iteration loop
   for (;;) {
@@ -191,7 +213,7 @@ ZeroFinder::find_zero_actual(const double xstart)
     if (fabs(new_step) <= tol_act || fabs(fb) < sqrt_epsilon) {
       if (!b_best)
         // call once more
-        f(b);
+        evaluate(b);
 
       // Acceptable approx. is found
       return b;
@@ -247,7 +269,7 @@ ZeroFinder::find_zero_actual(const double xstart)
 
     // Do step to a new approxim.
     b += new_step;
-    fb = f(b);
+    fb = evaluate(b);
 
     // Adjust c for it to have a sign opposite to that of b
     if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
@@ -341,7 +363,7 @@ ZeroFinder::find_min_actual(const double xstart)
 
   /* First step - always gold section*/
   x = w = v = a + r * (b - a);
-  fx = fw = fv = f(v);
+  fx = fw = fv = evaluate(v);
 
   // Main iteration loop
   for (;;) {
@@ -356,7 +378,7 @@ ZeroFinder::find_min_actual(const double xstart)
     if (fabs(x-middle_range) + range / 2 <= double_tol_act) {
       if (!x_best)
         // call once more
-        f(x);
+        evaluate(x);
 
       // Acceptable approx. is found
       return x;
@@ -404,7 +426,7 @@ ZeroFinder::find_min_actual(const double xstart)
     {
       // Tentative point for the min
       const auto t = x + new_step;
-      const auto ft = f(t);
+      const auto ft = evaluate(t);
       // t is a better approximation
       if (ft <= fx) {
         // Reduce the range so that t would fall within it
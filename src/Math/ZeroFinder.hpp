@@ -42,6 +42,10 @@ protected:
   /** search tolerance in x */
   const double tolerance;
 
+private:
+  /** number of evaluations of f(x) so far */
+  unsigned n_evaluations = 0;
+
 public:
   /**
    * Constructor of zero finder search algorithm
@@ -77,6 +81,18 @@ public:
   gcc_pure
   double find_zero(const double xstart);
 
+  /**
+   * Like find_zero(), but first look for the zero within the given
+   * distance of a previous solution.  Only if f(x) has no sign change
+   * there, the whole range is searched.
+   *
+   * @param xstart Previous solution
+   * @param step Half width of the initial bracket around xstart
+   *
+   * @return x value of best solution
+   */
+  double find_zero_near(double xstart, double step);
+
   /**
    * Find value of x that minimises f(x)
    * Method used is a variant of a bisector search.
@@ -89,9 +105,28 @@ public:
   gcc_pure
   double find_min(const double xstart);
 
+  /**
+   * Returns the number of evaluations of f(x) by this object's
+   * searches so far.
+   */
+  unsigned get_evaluations() const {
+    return n_evaluations;
+  }
+
 private:
+  double evaluate(double x) {
+    ++n_evaluations;
+    return f(x);
+  }
+
+  double find_zero_full();
+
+  /**
+   * Find the zero within the range [a,b], where f(a) and f(b) have
+   * already been evaluated (in this order).
+   */
   gcc_pure
-  double find_zero_actual(const double xstart);
+  double find_zero_actual(double a, double fa, double b, double fb);
 
   gcc_pure
   double find_min_actual(const double xstart);
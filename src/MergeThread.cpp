@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/MoreData.hpp"
 #include "Audio/VarioGlue.hpp"
 #include "Device/MultipleDevices.hpp"
+#include "Thread/Timeline.hpp"
 
 MergeThread::MergeThread(DeviceBlackboard &_device_blackboard)
   :WorkerThread("MergeThread", 50, 20, 10),
@@ -42,6 +43,8 @@ MergeThread::Process()
 {
   assert(!IsDefined() || IsInside());
 
+  const ScopeTimelineSpan timeline("MergeThread::Process");
+
   device_blackboard.Merge();
 
   const MoreData &basic = device_blackboard.Basic();
@@ -68,6 +68,7 @@ Profile::Load(const ProfileMap &map, LoggerSettings &settings)
 {
   map.Get(ProfileKeys::LoggerTimeStepCruise, settings.time_step_cruise);
   map.Get(ProfileKeys::LoggerTimeStepCircling, settings.time_step_circling);
+  map.Get(ProfileKeys::LoggerSyncInterval, settings.sync_interval);
 
   if (!map.GetEnum(ProfileKeys::AutoLogger, settings.auto_logger)) {
     // Legacy
@@ -170,6 +170,7 @@ const char EnableNavBaroAltitude[] = "EnableNavBaroAltitude";
 
 const char LoggerTimeStepCruise[] = "LoggerTimeStepCruise";
 const char LoggerTimeStepCircling[] = "LoggerTimeStepCircling";
+const char LoggerSyncInterval[] = "LoggerSyncInterval";
 
 const char SafetyMacCready[] = "SafetyMacCready";
 const char AbortTaskMode[] = "AbortTaskMode";
@@ -275,4 +276,6 @@ const char WaveAssistant[] = "WaveAssistant";
 
 const char MasterAudioVolume[] = "MasterAudioVolume";
 
+const char JobThreads[] = "JobThreads";
+
 }
@@ -165,6 +165,7 @@ extern const char EnableNavBaroAltitude[];
 
 extern const char LoggerTimeStepCruise[];
 extern const char LoggerTimeStepCircling[];
+extern const char LoggerSyncInterval[];
 
 extern const char SafetyMacCready[];
 extern const char AbortTaskMode[];
@@ -273,6 +274,8 @@ extern const char WaveAssistant[];
 
 extern const char MasterAudioVolume[];
 
+extern const char JobThreads[];
+
 }
 
 #endif
@@ -24,6 +24,8 @@ Copyright_License {
 #ifndef XCSOAR_SCREEN_STOP_WATCH_HPP
 #define XCSOAR_SCREEN_STOP_WATCH_HPP
 
+#include "Thread/Timeline.hpp"
+
 #ifdef STOP_WATCH
 
 #include "Util/StaticArray.hxx"
@@ -44,10 +46,39 @@ Copyright_License {
 
 /**
  * A stop watch which measures the time needed to perform an
- * operation, and writes it to the log file.  It is a no-op if the
- * macro STOP_WATCH is not defined.
+ * operation.  Each stage is recorded as a span in the calling
+ * thread's #TimelineBuffer.  If the macro STOP_WATCH is defined, the
+ * screen is flushed at each mark, and the durations are written to
+ * the log file.
  */
 class ScreenStopWatch {
+  /**
+   * The name of the stage which is currently running, or nullptr.
+   */
+  const char *stage = nullptr;
+
+  uint64_t stage_start;
+
+  void EndStage(uint64_t now) {
+    if (stage != nullptr)
+      AddTimelineSpan(stage, stage_start, now);
+  }
+
+  void TimelineMark(const char *text) {
+    const uint64_t now = GetTimelineClock();
+    EndStage(now);
+    stage = text;
+    stage_start = now;
+  }
+
+  void TimelineFinish() {
+    if (stage == nullptr)
+      return;
+
+    EndStage(GetTimelineClock());
+    stage = nullptr;
+  }
+
 #ifdef STOP_WATCH
   typedef uint64_t clock_stamp_t;
   typedef uint64_t cpu_stamp_t;
@@ -126,6 +157,7 @@ public:
   void Mark(const char *text) {
     FlushScreen();
     markers.append().Set(text);
+    TimelineMark(text);
   }
 
   void Finish() {
@@ -134,6 +166,7 @@ public:
 
     FlushScreen();
     markers.append().Set(nullptr);
+    TimelineFinish();
 
     for (unsigned i = 0; markers[i + 1].text != nullptr; ++i) {
       const Marker &start = markers[i];
@@ -155,8 +188,13 @@ public:
 
 #else /* !STOP_WATCH */
 public:
-  void Mark(const char *text) {}
-  void Finish() {}
+  void Mark(const char *text) {
+    TimelineMark(text);
+  }
+
+  void Finish() {
+    TimelineFinish();
+  }
 #endif /* !STOP_WATCH */
 };
 
@@ -98,6 +98,7 @@ Copyright_License {
 #include "Units/Units.hpp"
 #include "Formatter/UserGeoPointFormatter.hpp"
 #include "Thread/Debug.hpp"
+#include "Thread/JobScheduler.hpp"
 
 #include "Lua/StartFile.hpp"
 #include "Lua/Background.hpp"
@@ -260,6 +261,14 @@ Startup()
   if (!LoadProfile())
     return false;
 
+  /* low-end devices may limit the number of threads for background
+     computations */
+  unsigned job_threads;
+  if (Profile::Get(ProfileKeys::JobThreads, job_threads))
+    SetJobSchedulerLimit(job_threads);
+
+  InitialiseJobScheduler();
+
   operation.SetText(_("Initialising"));
 
   /* create XCSoarData on the first start */
@@ -332,7 +341,7 @@ Startup()
 
   // Read the topography file(s)
   topography = new TopographyStore();
-  LoadConfiguredTopography(*topography, operation);
+  LoadConfiguredTopography(*topography, file_cache, operation);
 
   // Read the waypoint files
   WaypointGlue::LoadWaypoints(way_points, terrain, operation);
@@ -356,8 +365,8 @@ Startup()
   rasp->ScanAll();
 
   // Reads the airspace files
-  ReadAirspace(airspace_database, terrain, computer_settings.pressure,
-               operation);
+  ReadAirspace(airspace_database, file_cache, terrain,
+               computer_settings.pressure, operation);
 
   {
     const AircraftState aircraft_state =
@@ -441,6 +450,7 @@ Startup()
     flight_logger->SetPath(LocalPath(_T("flights.log")));
   }
 
+  NMEALogger::sync_interval = computer_settings.logger.sync_interval;
   if (computer_settings.logger.enable_nmea_logger)
     NMEALogger::enabled = true;
 
@@ -576,6 +586,9 @@ Shutdown()
   LogFormat("delete MapWindow");
   main_window->Deinitialise();
 
+  /* all threads which submit jobs have stopped now */
+  DeinitialiseJobScheduler();
+
   // Stop sound
   AudioVarioGlue::Deinitialise();
 
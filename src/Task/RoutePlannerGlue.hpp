@@ -38,6 +38,14 @@ public:
 
   void SetTerrain(const RasterTerrain *terrain);
 
+  void SetReachParallel(const ReachParallelFunction &parallel) {
+    planner.SetReachParallel(parallel);
+  }
+
+  void SetReachTimeBudget(std::chrono::steady_clock::duration budget) {
+    planner.SetReachTimeBudget(budget);
+  }
+
   void UpdatePolar(const GlideSettings &settings,
                    const RoutePlannerConfig &config,
                    const GlidePolar &polar,
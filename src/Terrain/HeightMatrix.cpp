@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "HeightMatrix.hpp"
 #include "RasterMap.hpp"
+#include "Thread/JobScheduler.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
@@ -30,6 +31,8 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
+
 #include <assert.h>
 
 void
@@ -57,29 +60,62 @@ HeightMatrix::SetSize(unsigned width, unsigned height,
           (height + quantisation_pixels - 1) / quantisation_pixels);
 }
 
+unsigned
+HeightMatrix::GetBandCount(unsigned concurrency, unsigned height)
+{
+  if (concurrency <= 1)
+    return 1;
+
+  return std::max(1u, std::min(height, 2 * concurrency));
+}
+
+void
+HeightMatrix::ForEachBand(JobScheduler *scheduler, unsigned max_threads,
+                          unsigned height,
+                          const std::function<void(unsigned, unsigned)> &f)
+{
+  if (scheduler == nullptr) {
+    f(0, height);
+    return;
+  }
+
+  const unsigned concurrency = std::min(scheduler->GetConcurrency(),
+                                        max_threads);
+  const unsigned n_bands = GetBandCount(concurrency, height);
+  scheduler->ParallelFor(n_bands, [&](unsigned i){
+      f(GetBandStart(i, n_bands, height),
+        GetBandStart(i + 1, n_bands, height));
+    }, JobScheduler::Priority::HIGH, nullptr, concurrency);
+}
+
 #ifdef ENABLE_OPENGL
 
 void
 HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
-                   unsigned width, unsigned height, bool interpolate)
+                   unsigned width, unsigned height, bool interpolate,
+                   JobScheduler *scheduler, unsigned max_threads)
 {
   SetSize(width, height);
 
   const Angle delta_y = bounds.GetHeight() / height;
-  Angle latitude = bounds.GetNorth();
-  for (auto p = data.begin(), end = p + width * height;
-       p != end; p += width, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, width, interpolate);
-  }
+
+  ForEachBand(scheduler, max_threads, height, [&](unsigned start_y, unsigned end_y){
+      auto p = data.begin() + start_y * width;
+      for (unsigned y = start_y; y < end_y; ++y, p += width) {
+        const Angle latitude = bounds.GetNorth() - delta_y * y;
+        map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
+                     GeoPoint(bounds.GetEast(), latitude),
+                     p, width, interpolate);
+      }
+    });
 }
 
 #else
 
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
-                   unsigned quantisation_pixels, bool interpolate)
+                   unsigned quantisation_pixels, bool interpolate,
+                   JobScheduler *scheduler, unsigned max_threads)
 {
   const unsigned screen_width = projection.GetScreenWidth();
   const unsigned screen_height = projection.GetScreenHeight();
@@ -87,13 +123,15 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_height + quantisation_pixels - 1) / quantisation_pixels);
 
-  auto p = data.begin();
-  for (unsigned y = 0; y < screen_height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo(0, y),
-                 projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
-  }
+  ForEachBand(scheduler, max_threads, height, [&](unsigned start_y, unsigned end_y){
+      auto p = data.begin() + start_y * width;
+      for (unsigned y = start_y; y < end_y; ++y, p += width) {
+        const unsigned screen_y = y * quantisation_pixels;
+        map.ScanLine(projection.ScreenToGeo(0, screen_y),
+                     projection.ScreenToGeo(screen_width, screen_y),
+                     p, width, interpolate);
+      }
+    });
 }
 
 #endif
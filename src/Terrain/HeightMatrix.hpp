@@ -26,8 +26,12 @@ Copyright_License {
 
 #include "Height.hpp"
 #include "Util/AllocatedArray.hxx"
+#include "Compiler.h"
+
+#include <functional>
 
 class RasterMap;
+class JobScheduler;
 
 #ifdef ENABLE_OPENGL
 class GeoBounds;
@@ -50,19 +54,53 @@ protected:
   void SetSize(unsigned width, unsigned height);
   void SetSize(unsigned width, unsigned height, unsigned quantisation_pixels);
 
+  /**
+   * Invoke the function for each horizontal band of rows, on up to
+   * #max_threads threads of the given scheduler (or in the calling
+   * thread if it is nullptr).  The function receives the range
+   * [start_y, end_y).
+   */
+  static void ForEachBand(JobScheduler *scheduler, unsigned max_threads,
+                          unsigned height,
+                          const std::function<void(unsigned, unsigned)> &f);
+
 public:
+  /**
+   * Determine into how many horizontal bands an image with the given
+   * number of rows shall be split for the given number of threads.
+   * There are more bands than threads, to balance the load.
+   */
+  gcc_const
+  static unsigned GetBandCount(unsigned concurrency, unsigned height);
+
+  /**
+   * Returns the first row of the given band.
+   */
+  gcc_const
+  static unsigned GetBandStart(unsigned i, unsigned n_bands,
+                               unsigned height) {
+    return height * i / n_bands;
+  }
+
 #ifdef ENABLE_OPENGL
   /**
    * Copy values from the #RasterMap to the buffer, north-up only.
+   *
+   * @param scheduler if not nullptr, then the rows are scanned in
+   * bands on up to #max_threads threads of this scheduler
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
-            unsigned _width, unsigned _height, bool interpolate);
+            unsigned _width, unsigned _height, bool interpolate,
+            JobScheduler *scheduler=nullptr, unsigned max_threads=0);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
+   * @param scheduler if not nullptr, then the rows are scanned in
+   * bands on up to #max_threads threads of this scheduler
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
-            unsigned quantisation_pixels, bool interpolate);
+            unsigned quantisation_pixels, bool interpolate,
+            JobScheduler *scheduler=nullptr, unsigned max_threads=0);
 #endif
 
   unsigned GetWidth() const {
@@ -0,0 +1,99 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "HeightPyramid.hpp"
+#include "RasterBuffer.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+
+static int16_t
+ToBlockValue(TerrainHeight h)
+{
+  return h.IsInvalid()
+    ? int16_t(HeightPyramid::BLOCKED)
+    : h.GetValueOr0();
+}
+
+void
+HeightPyramid::Build(const RasterBuffer &buffer, unsigned _block_bits)
+{
+  Clear();
+
+  if (!buffer.IsDefined())
+    return;
+
+  block_bits = _block_bits;
+
+  /* determine the size of all levels */
+  unsigned width = buffer.GetWidth(), height = buffer.GetHeight();
+  unsigned size = 0;
+  for (unsigned shift = block_bits;; ++shift) {
+    const unsigned level_width = ((width - 1) >> shift) + 1;
+    const unsigned level_height = ((height - 1) >> shift) + 1;
+    levels.append({level_width, level_height, size});
+    size += level_width * level_height;
+
+    if ((level_width == 1 && level_height == 1) || levels.full())
+      break;
+  }
+
+  data.resize(size);
+
+  /* level 0 from the buffer */
+  const Level &first = levels.front();
+  int16_t *dest = &data[first.offset];
+  std::fill_n(dest, first.width * first.height, INT16_MIN);
+
+  const TerrainHeight *src = buffer.GetData();
+  for (unsigned y = 0; y < height; ++y) {
+    int16_t *row = dest + (y >> block_bits) * first.width;
+    for (unsigned x = 0; x < width; ++x, ++src) {
+      int16_t &m = row[x >> block_bits];
+      m = std::max(m, ToBlockValue(*src));
+    }
+  }
+
+  /* each following level from the previous one */
+  for (unsigned i = 1; i < levels.size(); ++i) {
+    const Level &prev = levels[i - 1], &level = levels[i];
+    const int16_t *p = &data[prev.offset];
+    int16_t *d = &data[level.offset];
+
+    for (unsigned y = 0; y < level.height; ++y) {
+      for (unsigned x = 0; x < level.width; ++x) {
+        const unsigned x0 = 2 * x, y0 = 2 * y;
+        const unsigned x1 = std::min(x0 + 1, prev.width - 1);
+        const unsigned y1 = std::min(y0 + 1, prev.height - 1);
+
+        d[y * level.width + x] =
+          std::max(std::max(p[y0 * prev.width + x0], p[y0 * prev.width + x1]),
+                   std::max(p[y1 * prev.width + x0], p[y1 * prev.width + x1]));
+      }
+    }
+  }
+
+  assert(levels.back().offset + levels.back().width * levels.back().height
+         == data.size());
+}
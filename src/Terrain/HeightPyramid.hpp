@@ -0,0 +1,118 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_HEIGHT_PYRAMID_HPP
+#define XCSOAR_TERRAIN_HEIGHT_PYRAMID_HPP
+
+#include "Util/StaticArray.hxx"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+class RasterBuffer;
+
+/**
+ * The maximum terrain heights of a #RasterBuffer in square blocks of
+ * several sizes.  Level 0 has blocks of 2^block_bits pixels, and each
+ * following level has blocks twice as wide as the previous one, up
+ * to a single block covering the whole buffer.
+ *
+ * This allows line-vs-terrain tests to skip blocks which lie
+ * entirely below the line.
+ */
+class HeightPyramid {
+public:
+  static constexpr unsigned MAX_LEVELS = 12;
+
+  /**
+   * The value of a block which contains an invalid height; such a
+   * block can never be skipped.
+   */
+  static constexpr int BLOCKED = INT16_MAX;
+
+private:
+  struct Level {
+    unsigned width, height;
+
+    /**
+     * The index of this level's first block in #data.
+     */
+    unsigned offset;
+  };
+
+  unsigned block_bits;
+
+  StaticArray<Level, MAX_LEVELS> levels;
+
+  /**
+   * The maximum height of each block; "special" heights count as 0,
+   * just like TerrainHeight::GetValueOr0().
+   */
+  std::vector<int16_t> data;
+
+public:
+  bool IsDefined() const {
+    return !levels.empty();
+  }
+
+  void Clear() {
+    levels.clear();
+    data.clear();
+  }
+
+  void Build(const RasterBuffer &buffer, unsigned block_bits);
+
+  unsigned GetLevelCount() const {
+    return levels.size();
+  }
+
+  /**
+   * Returns the width and height of the blocks of the given level,
+   * as a power of two.
+   */
+  unsigned GetBlockBits(unsigned level) const {
+    return block_bits + level;
+  }
+
+  /**
+   * Returns the maximum height of the block containing the specified
+   * pixel, or #BLOCKED.
+   *
+   * @param x the pixel column within the buffer
+   * @param y the pixel row within the buffer
+   */
+  gcc_pure
+  int GetMaximum(unsigned level, unsigned x, unsigned y) const {
+    const Level &l = levels[level];
+    const unsigned shift = block_bits + level;
+    x >>= shift;
+    y >>= shift;
+    return x < l.width && y < l.height
+      ? data[l.offset + y * l.width + x]
+      : BLOCKED;
+  }
+};
+
+#endif
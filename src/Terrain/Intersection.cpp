@@ -23,8 +23,10 @@ Copyright_License {
 
 #include "RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
+#include "RasterLineWalk.hpp"
 
 #include <stdlib.h>
+#include <limits.h>
 #include <algorithm>
 
 //#define DEBUG_TILE
@@ -32,6 +34,70 @@ Copyright_License {
 #include <stdio.h>
 #endif
 
+template<typename P>
+bool
+RasterTileCache::FindClearBlock(RasterLocation p, P &&is_clear,
+                                ClearBlock &block) const
+{
+  assert(IsInside(p));
+
+  const unsigned column = p.x / tile_width, row = p.y / tile_height;
+  const RasterTile &tile = tiles.Get(column, row);
+
+  /* the pixels which GetFieldDirect() looks up in this tile (or in
+     the overview on behalf of this tile) */
+  unsigned x_min = column * tile_width, y_min = row * tile_height;
+  unsigned x_max = std::min(x_min + tile_width, width);
+  unsigned y_max = std::min(y_min + tile_height, height);
+
+  const HeightPyramid *pyramid;
+  unsigned x, y, x_origin, y_origin, pixel_bits;
+  if (tile.IsEnabled()) {
+    pyramid = &tile.pyramid;
+    x_origin = tile.xstart;
+    y_origin = tile.ystart;
+    x_min = std::max(x_min, tile.xstart);
+    y_min = std::max(y_min, tile.ystart);
+    x_max = std::min(x_max, tile.xend);
+    y_max = std::min(y_max, tile.yend);
+    pixel_bits = 0;
+  } else {
+    /* GetFieldDirect() clamps pixels beyond the last overview column
+       and row; exclude them */
+    pyramid = &overview_pyramid;
+    x_origin = y_origin = 0;
+    x_max = std::min(x_max, overview.GetWidth() << OVERVIEW_BITS);
+    y_max = std::min(y_max, overview.GetHeight() << OVERVIEW_BITS);
+    pixel_bits = OVERVIEW_BITS;
+  }
+
+  if (!pyramid->IsDefined() || p.x < x_min || p.x >= x_max ||
+      p.y < y_min || p.y >= y_max)
+    return false;
+
+  x = (p.x - x_origin) >> pixel_bits;
+  y = (p.y - y_origin) >> pixel_bits;
+
+  bool found = false;
+  for (unsigned level = 0; level < pyramid->GetLevelCount(); ++level) {
+    const int h = pyramid->GetMaximum(level, x, y);
+    const unsigned bits = pyramid->GetBlockBits(level) + pixel_bits;
+    if (h == HeightPyramid::BLOCKED || !is_clear(h, 2u << bits))
+      break;
+
+    const unsigned x0 = x_origin + (((p.x - x_origin) >> bits) << bits);
+    const unsigned y0 = y_origin + (((p.y - y_origin) >> bits) << bits);
+    block.x0 = std::max(x0, x_min);
+    block.y0 = std::max(y0, y_min);
+    block.x1 = std::min(x0 + (1u << bits), x_max);
+    block.y1 = std::min(y0 + (1u << bits), y_max);
+    block.fine = tile.IsEnabled();
+    found = true;
+  }
+
+  return found;
+}
+
 bool
 RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
                                    const SignedRasterLocation destination,
@@ -59,15 +125,11 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
 
   h_dest = std::max(h_dest, h_origin);
 
-  // line algorithm parameters
-  const int dx = abs(destination.x - origin.x);
-  const int dy = abs(destination.y - origin.y);
-  int err = dx-dy;
-  const int sx = origin.x < destination.x ? 1 : -1;
-  const int sy = origin.y < destination.y ? 1 : -1;
+  // line algorithm
+  RasterLineWalk walk(origin, destination);
 
   // max number of steps to walk
-  const int max_steps = (dx+dy);
+  const int max_steps = walk.GetMaxSteps();
   // calculate number of fine steps to produce a step on the overview field
   const int step_fine = std::max(1, max_steps >> INTERSECT_BITS);
   // number of steps for update to the overview map
@@ -78,8 +140,6 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
 
   // counter for steps to reach next position to be checked on the field.
   unsigned step_counter = 0;
-  // total counter of fine steps
-  int total_steps = 0;
 
   // number of steps since intersection
   int intersect_counter = 0;
@@ -108,13 +168,48 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
+  // current aircraft height after the given number of steps
+  const auto GetGlideHeight = [&](int steps){
+    // calculate height of glide so far
+    const int dh = (steps * slope_fact) >> RASTER_SLOPE_FACT;
+
+    int h_int = dh + h_origin;
+    if (can_climb) {
+      h_int = std::min(h_int, h_dest);
+    }
+    return h_int;
+  };
+
+  /* a block which the glide passes without intersecting and without
+     reaching the ceiling; only valid while intersect_counter is
+     zero, because intersections change the glide */
+  ClearBlock clear_block = ClearBlock::Empty();
+
+  const auto IsClear = [&](int h_terrain, unsigned block_steps){
+    const int h1 = GetGlideHeight(walk.GetTotalSteps());
+    const int h2 = GetGlideHeight(walk.GetTotalSteps() + block_steps);
+    return std::min(h1, h2) >= h_terrain + h_safety &&
+      std::max(h1, h2) <= h_ceiling;
+  };
+
   while (true) {
 
     if (!step_counter) {
+      location = walk.GetLocation();
 
       if (!IsInside(location))
         break; // outside bounds
 
+      if (!intersect_counter &&
+          (clear_block.IsInside(location) ||
+           FindClearBlock(location, IsClear, clear_block))) {
+        /* the terrain in this block is known to be below the glide;
+           don't look at it */
+        step_counter = clear_block.fine ? step_fine : step_coarse;
+        last_clear_location = location;
+        last_clear_h = GetGlideHeight(walk.GetTotalSteps());
+      } else {
+
       const auto field_direct = GetFieldDirect(location.x, location.y);
       if (field_direct.first.IsInvalid())
         break;
@@ -122,14 +217,8 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
       const int h_terrain = field_direct.first.GetValueOr0() + h_safety;
       step_counter = field_direct.second ? step_fine : step_coarse;
 
-      // calculate height of glide so far
-      const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
-
       // current aircraft height
-      int h_int = dh + h_origin;
-      if (can_climb) {
-        h_int = std::min(h_int, h_dest);
-      }
+      int h_int = GetGlideHeight(walk.GetTotalSteps());
 
 #ifdef DEBUG_TILE
       printf("%d %d %d %d %d # fint\n", location.x, location.y, h_int, h_terrain, h_ceiling);
@@ -186,30 +275,24 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
           last_clear_h = h_int;
         }
       }
+      }
     }
 
-    if (!intersect_counter && (total_steps == max_steps)) {
+    if (!intersect_counter && (walk.GetTotalSteps() == max_steps)) {
 #ifdef DEBUG_TILE
       printf("# fint cleared\n");
 #endif
       return false;
     }
 
-    const int e2 = 2*err;
-    if (e2 > -dy) {
-      err -= dy;
-      location.x += sx;
-      if (step_counter)
-        step_counter--;
-      total_steps++;
-    }
-    if (e2 < dx) {
-      err += dx;
-      location.y += sy;
-      if (step_counter)
-        step_counter--;
-      total_steps++;
-    }
+    /* skip to the next position to be checked, but don't miss the
+       destination check above */
+    const unsigned last = walk.GetLastIteration();
+    const unsigned limit = !intersect_counter && walk.GetIteration() < last
+      ? last
+      : UINT_MAX;
+    step_counter -= std::min(step_counter,
+                             walk.Advance(step_counter, limit));
   }
 
   // early exit due to inability to find clearance after intersecting
@@ -224,7 +307,7 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   return false;
 }
 
-inline std::pair<TerrainHeight, bool>
+std::pair<TerrainHeight, bool>
 RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py) const
 {
   assert(px < width);
@@ -258,21 +341,15 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
                               const int slope_fact,
                               const int height_floor) const
 {
-  SignedRasterLocation location = origin;
-
-  if (!IsInside(location))
+  if (!IsInside(RasterLocation(origin)))
     // origin is outside overall bounds
     return {-1, -1};
 
-  // line algorithm parameters
-  const int dx = abs(destination.x - origin.x);
-  const int dy = abs(destination.y - origin.y);
-  int err = dx-dy;
-  const int sx = origin.x < destination.x ? 1 : -1;
-  const int sy = origin.y < destination.y ? 1 : -1;
+  // line algorithm
+  RasterLineWalk walk(origin, destination);
 
   // max number of steps to walk
-  const int max_steps = (dx+dy);
+  const int max_steps = walk.GetMaxSteps();
   // calculate number of fine steps to produce a step on the overview field
 
   // step size at selected refinement level
@@ -285,8 +362,6 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
 
   // counter for steps to reach next position to be checked on the field.
   unsigned step_counter = 0;
-  // total counter of fine steps
-  int total_steps = 0;
 
 #ifdef DEBUG_TILE
   printf("# max steps %d\n", max_steps);
@@ -294,63 +369,77 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
   printf("# step fine %d\n", step_fine);
 #endif
 
-  RasterLocation last_clear_location = location;
+  RasterLocation last_clear_location = origin;
   int last_clear_h = h_origin;
 
+  // current aircraft height after the given number of steps
+  const auto GetGlideHeight = [&](int steps){
+    // calculate height of glide so far
+    const int dh = (steps * slope_fact) >> RASTER_SLOPE_FACT;
+
+    return h_origin - dh;
+  };
+
+  /* a block which the glide passes without intersecting and without
+     reaching the ground */
+  ClearBlock clear_block = ClearBlock::Empty();
+
+  const auto IsClear = [&](int h_terrain, unsigned block_steps){
+    const int h1 = GetGlideHeight(walk.GetTotalSteps());
+    const int h2 = GetGlideHeight(walk.GetTotalSteps() + block_steps);
+    const int h_min = std::min(h1, h2);
+    return h_min >= std::max(h_terrain, height_floor) && h_min > 0;
+  };
+
   while (true) {
 
     if (!step_counter) {
+      const RasterLocation location = walk.GetLocation();
 
       if (!IsInside(location))
         break;
 
-      const auto field_direct = GetFieldDirect(location.x, location.y);
-      if (field_direct.first.IsInvalid())
-        break;
-
-      const int h_terrain = field_direct.first.GetValueOr0();
-      step_counter = field_direct.second ? step_fine : step_coarse;
-
-      // calculate height of glide so far
-      const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
-
       // current aircraft height
-      const int h_int = h_origin - dh;
-
-      if (h_int < std::max(h_terrain, height_floor)) {
-        if (refine_step<3) // can't refine any further
-          return RasterLocation(last_clear_location.x, last_clear_location.y);
+      const int h_int = GetGlideHeight(walk.GetTotalSteps());
+
+      if (clear_block.IsInside(location) ||
+          FindClearBlock(location, IsClear, clear_block)) {
+        /* the terrain in this block is known to be below the glide;
+           don't look at it */
+        step_counter = clear_block.fine ? step_fine : step_coarse;
+      } else {
+        const auto field_direct = GetFieldDirect(location.x, location.y);
+        if (field_direct.first.IsInvalid())
+          break;
+
+        const int h_terrain = field_direct.first.GetValueOr0();
+        step_counter = field_direct.second ? step_fine : step_coarse;
+
+        if (h_int < std::max(h_terrain, height_floor)) {
+          if (refine_step<3) // can't refine any further
+            return RasterLocation(last_clear_location.x, last_clear_location.y);
+
+          // refine solution
+          return Intersection(last_clear_location, location,
+                              last_clear_h, slope_fact, height_floor);
+        }
 
-        // refine solution
-        return Intersection(last_clear_location, location,
-                            last_clear_h, slope_fact, height_floor);
+        if (h_int <= 0)
+          break; // reached max range
       }
 
-      if (h_int <= 0)
-        break; // reached max range
-
       last_clear_location = location;
       last_clear_h = h_int;
     }
 
-    if (total_steps > max_steps)
+    if (walk.GetTotalSteps() > max_steps)
       break;
 
-    const int e2 = 2*err;
-    if (e2 > -dy) {
-      err -= dy;
-      location.x += sx;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
-    }
-    if (e2 < dx) {
-      err += dx;
-      location.y += sy;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
-    }
+    /* skip to the next position to be checked, but stop after the
+       destination */
+    step_counter -= std::min(step_counter,
+                             walk.Advance(step_counter,
+                                          walk.GetLastIteration() + 1));
   }
 
   // if we reached invalid terrain, assume we can hit MSL
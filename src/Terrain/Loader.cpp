@@ -28,6 +28,13 @@ Copyright_License {
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/ConvertPathName.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
 
 extern "C" {
 #include "jasper/jp2/jp2_cod.h"
@@ -35,6 +42,164 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+/**
+ * The shared state of several #TerrainLoader instances which decode
+ * the requested tiles in parallel, each with its own jasper stream.
+ * The tiles are assigned round-robin in the order of their priority,
+ * and the decoded tiles are published to the #RasterTileCache in
+ * that order.
+ */
+class ParallelTileDecoder {
+  RasterTileCache &raster_tile_cache;
+  SharedMutex &cache_mutex;
+
+  /**
+   * The requested tiles, sorted by priority.
+   */
+  RasterTileCache::RequestedTiles tiles;
+
+  const unsigned n_workers;
+
+  struct Slot {
+    /**
+     * The decoded tile data, waiting to be published.
+     */
+    RasterBuffer buffer;
+
+    /**
+     * Has the worker finished this tile (successfully or not)?
+     */
+    bool finished = false;
+  };
+
+  std::array<Slot, RasterTileCache::MAX_ACTIVATE> slots;
+
+  /**
+   * Protects #slots and #n_published.
+   */
+  Mutex mutex;
+
+  /**
+   * The number of slots which have already been published.
+   */
+  unsigned n_published = 0;
+
+public:
+  ParallelTileDecoder(RasterTileCache &_rtc, SharedMutex &_cache_mutex,
+                      unsigned max_workers)
+    :raster_tile_cache(_rtc), cache_mutex(_cache_mutex),
+     n_workers(GetRequestedTiles(_rtc, tiles, max_workers)) {}
+
+  unsigned GetWorkerCount() const {
+    return n_workers;
+  }
+
+  /**
+   * Is the specified tile assigned to the specified worker?
+   */
+  gcc_pure
+  bool IsAssigned(unsigned tile, unsigned worker) const {
+    const int i = FindSlot(tile);
+    return i >= 0 && unsigned(i) % n_workers == worker;
+  }
+
+  /**
+   * Called by a worker after it has decoded a tile.
+   */
+  void Put(unsigned tile, const struct jas_matrix &m) {
+    const int i = FindSlot(tile);
+    if (i < 0)
+      return;
+
+    Slot &slot = slots[i];
+    raster_tile_cache.CopyTileData(tile, m, slot.buffer);
+
+    const ScopeLock protect(mutex);
+    slot.finished = true;
+    Publish();
+  }
+
+  /**
+   * Called after all workers have finished; publishes the remaining
+   * tiles, including those following a tile which failed to decode.
+   */
+  void Finish() {
+    const ScopeLock protect(mutex);
+    for (unsigned i = 0; i < tiles.size(); ++i)
+      slots[i].finished = true;
+    Publish();
+  }
+
+private:
+  /**
+   * Fill the tile list and return the number of workers to be used.
+   */
+  static unsigned GetRequestedTiles(const RasterTileCache &rtc,
+                                    RasterTileCache::RequestedTiles &tiles,
+                                    unsigned max_workers) {
+    rtc.GetRequestedTiles(tiles);
+    return std::max(std::min(max_workers, unsigned(tiles.size())), 1u);
+  }
+
+  gcc_pure
+  int FindSlot(unsigned tile) const {
+    for (unsigned i = 0; i < tiles.size(); ++i)
+      if (tiles[i] == tile)
+        return i;
+
+    return -1;
+  }
+
+  /**
+   * Move all leading finished tiles into the #RasterTileCache.
+   * Caller must lock the mutex.
+   */
+  void Publish() {
+    for (; n_published < tiles.size() && slots[n_published].finished;
+         ++n_published) {
+      Slot &slot = slots[n_published];
+      if (!slot.buffer.IsDefined())
+        continue;
+
+      const ScopeExclusiveLock lock(cache_mutex);
+      raster_tile_cache.PutTileData(tiles[n_published],
+                                    std::move(slot.buffer));
+    }
+  }
+};
+
+/**
+ * Load the requested tiles which are available in the
+ * #RasterTileStore, so they don't need to be decoded.
+ *
+ * @return true if there are requested tiles left to be decoded
+ */
+static bool
+RestoreStoredTiles(RasterTileCache &raster_tile_cache, SharedMutex &mutex)
+{
+  RasterTileCache::RequestedTiles tiles;
+  raster_tile_cache.GetRequestedTiles(tiles);
+
+  bool remaining = false;
+  for (const auto i : tiles) {
+    RasterBuffer buffer;
+    if (raster_tile_cache.LoadStoredTile(i, buffer)) {
+      const ScopeExclusiveLock lock(mutex);
+      raster_tile_cache.RestoreTile(i, std::move(buffer));
+    } else
+      remaining = true;
+  }
+
+  return remaining;
+}
+
+inline bool
+TerrainLoader::IsTileWanted(unsigned index) const
+{
+  return raster_tile_cache.tiles.GetLinear(index).IsRequested() &&
+    (parallel == nullptr || parallel->IsAssigned(index, worker));
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -54,8 +219,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsTileWanted(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -176,7 +340,9 @@ TerrainLoader::PutTileData(unsigned index,
     raster_tile_cache.PutOverviewTile(index, start_x, start_y,
                                       end_x, end_y, m);
 
-  if (scan_tiles) {
+  if (parallel != nullptr) {
+    parallel->Put(index, m);
+  } else if (scan_tiles) {
     const ScopeExclusiveLock lock(mutex);
     raster_tile_cache.PutTileData(index, m);
   }
@@ -224,8 +390,6 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   opts.maxlyrs = JPC_MAXLYRS;
   opts.maxpkts = -1;
 
-  jpc_initluts();
-
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     return false;
@@ -244,7 +408,8 @@ TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
   if (in == nullptr)
     return false;
 
-  env.SetProgressRange(jas_stream_length(in) / 65536);
+  if (parallel == nullptr)
+    env.SetProgressRange(jas_stream_length(in) / 65536);
 
   bool success = ::LoadJPG2000(in, this);
   jas_stream_close(in);
@@ -274,6 +439,8 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
 
   raster_tile_cache.Reset();
 
+  jpc_initluts();
+
   bool success = LoadJPG2000(dir, path);
 
   /* if we loaded the JPG2000 file successfully, but no bounds were
@@ -284,7 +451,9 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
        discard the whole file */
     success = false;
 
-  if (!success)
+  if (success)
+    raster_tile_cache.FinishOverview();
+  else
     raster_tile_cache.Reset();
 
   return success;
@@ -314,11 +483,26 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
     /* nothing to do */
     return true;
 
+  if (!RestoreStoredTiles(raster_tile_cache, mutex)) {
+    raster_tile_cache.FinishTileUpdate();
+    return true;
+  }
+
+  jpc_initluts();
+
   bool success = LoadJPG2000(dir, path);
   raster_tile_cache.FinishTileUpdate();
   return success;
 }
 
+bool
+TerrainLoader::DecodeTiles(struct zzip_dir *dir, const char *path)
+{
+  assert(parallel != nullptr);
+
+  return LoadJPG2000(dir, path);
+}
+
 bool
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
@@ -344,3 +528,70 @@ UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                             raster_location.x, raster_location.y,
                             projection.DistancePixelsCoarse(radius));
 }
+
+bool
+UpdateTerrainTiles(Path archive_path, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   int x, int y, unsigned radius)
+{
+  if (!raster_tile_cache.IsValid())
+    return false;
+
+  if (!raster_tile_cache.PollTiles(x, y, radius))
+    /* nothing to do */
+    return true;
+
+  if (!RestoreStoredTiles(raster_tile_cache, mutex)) {
+    raster_tile_cache.FinishTileUpdate();
+    return true;
+  }
+
+  /* the lookup tables are global; initialise them before the
+     workers start */
+  jpc_initluts();
+
+  const unsigned concurrency =
+    scheduler.GetConcurrency(JobScheduler::Priority::IDLE);
+  ParallelTileDecoder decoder(raster_tile_cache, mutex,
+                              std::min(concurrency, max_threads));
+  const unsigned n_workers = decoder.GetWorkerCount();
+
+  std::array<bool, RasterTileCache::MAX_ACTIVATE> results;
+
+  scheduler.ParallelFor(n_workers, [&](unsigned worker){
+      bool success;
+      try {
+        ZipArchive archive(archive_path);
+        NullOperationEnvironment env;
+        TerrainLoader loader(mutex, raster_tile_cache,
+                             decoder, worker, env);
+        success = loader.DecodeTiles(archive.get(), path);
+      } catch (const std::runtime_error &) {
+        success = false;
+      }
+
+      results[worker] = success;
+    }, JobScheduler::Priority::IDLE);
+
+  decoder.Finish();
+  raster_tile_cache.FinishTileUpdate();
+
+  return std::all_of(results.begin(), results.begin() + n_workers,
+                     [](bool b){ return b; });
+}
+
+bool
+UpdateTerrainTiles(Path archive_path, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius)
+{
+  const auto raster_location = projection.ProjectCoarse(location);
+
+  return UpdateTerrainTiles(archive_path, path, raster_tile_cache, mutex,
+                            scheduler, max_threads,
+                            raster_location.x, raster_location.y,
+                            projection.DistancePixelsCoarse(radius));
+}
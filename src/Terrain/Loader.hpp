@@ -25,12 +25,16 @@ Copyright_License {
 #define XCSOAR_TERRAIN_LOADER_HPP
 
 #include "Thread/SharedMutex.hpp"
+#include "OS/Path.hpp"
+#include "Compiler.h"
 
 struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
 class RasterProjection;
 class OperationEnvironment;
+class JobScheduler;
+class ParallelTileDecoder;
 
 class TerrainLoader {
   SharedMutex &mutex;
@@ -41,6 +45,16 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  /**
+   * If not nullptr, then this is one of several loaders decoding the
+   * requested tiles in parallel.  It decodes only the tiles assigned
+   * to #worker, and passes them to this object instead of writing
+   * them to the #RasterTileCache.
+   */
+  ParallelTileDecoder *const parallel = nullptr;
+
+  const unsigned worker = 0;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -55,11 +69,25 @@ public:
      scan_tiles(!_scan_overview || _scan_all),
      env(_env) {}
 
+  TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
+                ParallelTileDecoder &_parallel, unsigned _worker,
+                OperationEnvironment &_env)
+    :mutex(_mutex), raster_tile_cache(_rtc),
+     scan_overview(false), scan_tiles(true),
+     env(_env),
+     parallel(&_parallel), worker(_worker) {}
+
   bool LoadOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file);
   bool UpdateTiles(struct zzip_dir *dir, const char *path,
                    int x, int y, unsigned radius);
 
+  /**
+   * Decode the tiles assigned to this worker.  Only valid in
+   * parallel mode.
+   */
+  bool DecodeTiles(struct zzip_dir *dir, const char *path);
+
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
   long SkipMarkerSegment(long file_offset) const;
@@ -79,6 +107,9 @@ public:
                    const struct jas_matrix &m);
 
 private:
+  gcc_pure
+  bool IsTileWanted(unsigned index) const;
+
   bool LoadJPG2000(struct zzip_dir *dir, const char *path);
   void ParseBounds(const char *data);
 };
@@ -124,6 +155,52 @@ UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    const RasterProjection &projection,
                    const GeoPoint &location, double radius);
 
+/**
+ * Like UpdateTerrainTiles(), but decode the requested tiles on
+ * several threads of the given #JobScheduler, as
+ * JobScheduler::Priority::IDLE jobs.  Each thread opens its
+ * own handle on the ZIP archive, because a #zzip_dir must not be
+ * shared between threads.  Decoded tiles are published in the order
+ * of their priority.
+ *
+ * @param archive_path the path of the ZIP archive
+ * @param max_threads the maximum number of decoder threads
+ */
+bool
+UpdateTerrainTiles(Path archive_path, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   int x, int y, unsigned radius);
+
+static inline bool
+UpdateTerrainTiles(Path archive_path,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   int x, int y, unsigned radius)
+{
+  return UpdateTerrainTiles(archive_path, "terrain.jp2", tile_cache, mutex,
+                            scheduler, max_threads, x, y, radius);
+}
+
+bool
+UpdateTerrainTiles(Path archive_path, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius);
+
+static inline bool
+UpdateTerrainTiles(Path archive_path,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   JobScheduler &scheduler, unsigned max_threads,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius)
+{
+  return UpdateTerrainTiles(archive_path, "terrain.jp2", tile_cache, mutex,
+                            scheduler, max_threads,
+                            projection, location, radius);
+}
+
 static inline bool
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
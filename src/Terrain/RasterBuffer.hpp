@@ -42,6 +42,9 @@ public:
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
+  RasterBuffer(RasterBuffer &&) = default;
+  RasterBuffer &operator=(RasterBuffer &&) = default;
+
   bool IsDefined() const {
     return data.IsDefined();
   }
@@ -0,0 +1,180 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_LINE_WALK_HPP
+#define XCSOAR_TERRAIN_RASTER_LINE_WALK_HPP
+
+#include "RasterLocation.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The line algorithm of the terrain intersection searches.  Each
+ * iteration moves one pixel along the major axis, and sometimes one
+ * pixel along the minor axis; each of these moves is one "step".
+ *
+ * Besides single iterations, it can skip many iterations at once in
+ * constant time, arriving at exactly the same state.
+ */
+class RasterLineWalk {
+  SignedRasterLocation location;
+
+  const int dx, dy, sx, sy;
+
+  int err;
+
+  /**
+   * The number of steps (not iterations) so far.
+   */
+  int total_steps = 0;
+
+  unsigned iteration = 0;
+
+public:
+  RasterLineWalk(SignedRasterLocation origin,
+                 SignedRasterLocation destination)
+    :location(origin),
+     dx(abs(destination.x - origin.x)), dy(abs(destination.y - origin.y)),
+     sx(origin.x < destination.x ? 1 : -1),
+     sy(origin.y < destination.y ? 1 : -1),
+     err(dx - dy) {}
+
+  SignedRasterLocation GetLocation() const {
+    return location;
+  }
+
+  /**
+   * The number of steps from the origin to the destination.
+   */
+  int GetMaxSteps() const {
+    return dx + dy;
+  }
+
+  int GetTotalSteps() const {
+    return total_steps;
+  }
+
+  unsigned GetIteration() const {
+    return iteration;
+  }
+
+  /**
+   * The iteration which arrives at the destination.
+   */
+  unsigned GetLastIteration() const {
+    return std::max(dx, dy);
+  }
+
+  /**
+   * Perform one iteration.
+   *
+   * @return the number of steps made
+   */
+  unsigned Step() {
+    unsigned steps = 0;
+    const int e2 = 2*err;
+    if (e2 > -dy) {
+      err -= dy;
+      location.x += sx;
+      ++steps;
+    }
+    if (e2 < dx) {
+      err += dx;
+      location.y += sy;
+      ++steps;
+    }
+
+    total_steps += steps;
+    ++iteration;
+    return steps;
+  }
+
+  /**
+   * Perform the smallest number of iterations (but at least one)
+   * which makes at least the given number of steps, but stop at the
+   * given iteration.
+   *
+   * @param max_iteration the iteration to stop at; must be larger
+   * than the current one (unless the line has zero length)
+   * @return the number of steps made
+   */
+  unsigned Advance(unsigned min_steps, unsigned max_iteration) {
+    const bool x_major = dx >= dy;
+    const int64_t major = x_major ? dx : dy;
+    const int64_t minor = x_major ? dy : dx;
+    if (major == 0 && min_steps > 0) {
+      /* zero length: the walk doesn't move */
+      iteration = max_iteration;
+      return 0;
+    }
+
+    assert(max_iteration > iteration);
+
+    if (min_steps <= 1)
+      return Step();
+
+    /* each iteration subtracts "minor" from the error term, and each
+       move along the minor axis adds "major"; that keeps the error
+       term within a window of the width "major", starting at
+       "lower" */
+    const int64_t e0 = x_major ? err : -err;
+    const int64_t lower = (major + 1) / 2 - minor;
+
+    /* the number of minor moves after k iterations */
+    const auto minor_moves = [=](int64_t k) -> int64_t {
+      const int64_t a = lower - e0 + k * minor;
+      return a > 0 ? (a + major - 1) / major : 0;
+    };
+
+    const int64_t limit = max_iteration - iteration;
+    int64_t k = std::min<int64_t>(limit,
+                                  std::max<int64_t>(1, min_steps * major
+                                                    / (major + minor)));
+    while (k < limit && k + minor_moves(k) < min_steps)
+      ++k;
+    while (k > 1 && k - 1 + minor_moves(k - 1) >= min_steps)
+      --k;
+
+    const int64_t m = minor_moves(k);
+    const int64_t e = e0 - k * minor + m * major;
+    err = int(x_major ? e : -e);
+
+    if (x_major) {
+      location.x += int(k) * sx;
+      location.y += int(m) * sy;
+    } else {
+      location.y += int(k) * sy;
+      location.x += int(m) * sx;
+    }
+
+    total_steps += int(k + m);
+    iteration += unsigned(k);
+    return unsigned(k + m);
+  }
+};
+
+#endif
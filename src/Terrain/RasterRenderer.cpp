@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/ShadingKernels.hpp"
 #include "Math/FastMath.hpp"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
@@ -32,8 +33,11 @@ Copyright_License {
 #include "Renderer/GeoBitmapRenderer.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Asset.hpp"
+#include "Thread/JobScheduler.hpp"
 #include "Event/Idle.hpp"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <stdint.h>
 
@@ -89,6 +93,12 @@ ContourInterval(const unsigned h, const unsigned contour_height_scale)
   return std::min(254u, h >> contour_height_scale);
 }
 
+/**
+ * A contour_column_base value which means that no pixel has updated
+ * the column; ContourInterval() never returns it.
+ */
+static constexpr unsigned char NO_CONTOUR = 255;
+
 gcc_const
 static unsigned
 ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
@@ -113,6 +123,9 @@ RasterRenderer::~RasterRenderer()
   delete[] color_table;
   delete image;
   delete[] contour_column_base;
+  delete[] row_heights;
+  delete[] row_contours;
+  delete[] row_shades;
 }
 
 #ifdef ENABLE_OPENGL
@@ -192,14 +205,34 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
   height_matrix.Fill(map, bounds,
                      projection.GetScreenWidth() / quantisation_pixels,
                      projection.GetScreenHeight() / quantisation_pixels,
-                     true);
+                     true, &GetJobScheduler(), MAX_RENDER_THREADS);
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  height_matrix.Fill(map, projection, quantisation_pixels, true,
+                     &GetJobScheduler(), MAX_RENDER_THREADS);
 #endif
 }
 
+RasterRenderer::Band
+RasterRenderer::GetBand(unsigned i, unsigned n) const
+{
+  assert(i < n);
+  assert(n <= n_bands);
+
+  const unsigned height = height_matrix.GetHeight();
+  const size_t offset = size_t(i) * image->GetWidth();
+
+  Band band;
+  band.start_y = HeightMatrix::GetBandStart(i, n, height);
+  band.end_y = HeightMatrix::GetBandStart(i + 1, n, height);
+  band.contour_column_base = contour_column_base + offset;
+  band.row_heights = row_heights + offset;
+  band.row_contours = row_contours + offset;
+  band.row_shades = row_shades + offset;
+  return band;
+}
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -207,14 +240,31 @@ RasterRenderer::GenerateImage(bool do_shading,
                               const Angle sunazimuth,
                               bool do_contour)
 {
+  auto &scheduler = GetJobScheduler();
+  const unsigned concurrency = std::min(scheduler.GetConcurrency(),
+                                        unsigned(MAX_RENDER_THREADS));
+  const unsigned n = HeightMatrix::GetBandCount(concurrency,
+                                                height_matrix.GetHeight());
+
   if (image == nullptr ||
       height_matrix.GetWidth() > image->GetWidth() ||
-      height_matrix.GetHeight() > image->GetHeight()) {
+      height_matrix.GetHeight() > image->GetHeight() ||
+      n > n_bands) {
     delete image;
     image = new RawBitmap(height_matrix.GetWidth(), height_matrix.GetHeight());
 
+    n_bands = n;
+    const size_t buffer_size = size_t(n_bands) * image->GetWidth();
+
     delete[] contour_column_base;
-    contour_column_base = new unsigned char[height_matrix.GetWidth()];
+    contour_column_base = new unsigned char[buffer_size];
+
+    delete[] row_heights;
+    row_heights = new uint8_t[buffer_size];
+    delete[] row_contours;
+    row_contours = new uint8_t[buffer_size];
+    delete[] row_shades;
+    row_shades = new int8_t[buffer_size];
   }
 
   if (quantisation_effective == 0) {
@@ -224,41 +274,58 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+  int sx = 0, sy = 0, sz = 0;
+  if (do_shading) {
+    const Angle fudgeelevation = Angle::Degrees(10) +
+      Angle::Degrees(80.0 / 255.0) * brightness;
 
-  if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
-  else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+    sx = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastsine());
+    sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
+    sz = (int)(255 * fudgeelevation.fastsine());
+  }
+
+  /* with the contour state at their first rows known, the bands are
+     independent */
+  ContourStart(n, do_shading, contour_height_scale);
+
+  scheduler.ParallelFor(n, [&](unsigned i){
+      const Band band = GetBand(i, n);
+
+      if (do_shading)
+        GenerateSlopeImage(band, height_scale, contrast,
+                           sx, sy, sz, contour_height_scale);
+      else
+        GenerateUnshadedImage(band, height_scale, contour_height_scale);
+    }, JobScheduler::Priority::HIGH, nullptr, concurrency);
 
   image->SetDirty();
 }
 
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+RasterRenderer::GenerateUnshadedImage(const Band &band, unsigned height_scale,
                                       const unsigned contour_height_scale)
 {
-  const auto *src = height_matrix.GetData();
+  const unsigned width = height_matrix.GetWidth();
+  const auto *src = height_matrix.GetRow(band.start_y);
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
+  RawColor *dest = image->GetRow(band.start_y);
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
+  for (unsigned y = band.start_y; y < band.end_y; ++y, src += width) {
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
+    CalculateHeightIndices(band.row_heights, band.row_contours, src, width,
+                           height_scale, contour_height_scale);
+
     unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned char *contour_this_column_base = band.contour_column_base;
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
-      const auto e = *src++;
+    for (unsigned x = 0; x < width; ++x) {
+      const auto e = src[x];
       if (gcc_likely(!e.IsSpecial())) {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+        const unsigned h = band.row_heights[x];
+        const unsigned contour_interval = band.row_contours[x];
 
-        h = std::min(254u, h >> height_scale);
         if (gcc_unlikely((contour_interval != contour_row_base)
                          || (contour_interval != *contour_this_column_base))) {
 
@@ -281,23 +348,73 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
 }
 
 /**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
+ * Calculate the slope shading index of a pixel at the left or right
+ * border of the height matrix, where the X neighbours are closer.
  */
-gcc_const
-static int
-ClipHeightDelta(int d)
+gcc_pure
+static int8_t
+CalculateBorderSlopeShade(const TerrainHeight *src, unsigned x,
+                          const PixelRect &border, unsigned width,
+                          unsigned quantisation_effective,
+                          unsigned row_minus_offset, unsigned row_plus_offset,
+                          unsigned p31, const SlopeShadingParameters &s)
 {
-  return Clamp(d, -512, 512);
+  const unsigned column_plus_index = x < (unsigned)border.right
+    ? quantisation_effective
+    : width - 1 - x;
+  const unsigned column_minus_index = x >= (unsigned)border.left
+    ? quantisation_effective : x;
+
+  const auto h_above = src[-(int)row_minus_offset];
+  const auto h_below = src[row_plus_offset];
+  const auto h_left = src[-(int)column_minus_index];
+  const auto h_right = src[column_plus_index];
+
+  if (gcc_unlikely(h_above.IsSpecial() ||
+                   h_below.IsSpecial() ||
+                   h_left.IsSpecial() ||
+                   h_right.IsSpecial()))
+    /* some "special" terrain value surrounding us (water or
+       invalid), skip slope calculation */
+    return NO_SLOPE;
+
+  const int p32 = ClipHeightDelta(h_above, h_below);
+  const int p22 = ClipHeightDelta(h_right, h_left);
+
+  const unsigned p20 = column_plus_index + column_minus_index;
+
+  return CalculateSlopeShade(p22, p32, p20, p31, s);
 }
 
-gcc_const
-static int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b)
+/**
+ * Is one of the neighbours which are used for the slope calculation
+ * of this pixel "special"?  GenerateSlopeImage() doesn't shade such
+ * pixels.
+ */
+gcc_pure
+static bool
+HasSpecialSlopeNeighbour(const HeightMatrix &matrix, unsigned x, unsigned y,
+                         unsigned quantisation_effective)
 {
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
+  const unsigned width = matrix.GetWidth(), height = matrix.GetHeight();
+
+  /* these must match the offsets used by GenerateSlopeImage() */
+  const unsigned row_plus_index =
+    y < unsigned(int(height) - int(quantisation_effective))
+    ? quantisation_effective
+    : height - 1 - y;
+  const unsigned row_minus_index = std::min(y, quantisation_effective);
+  const unsigned column_plus_index =
+    x < unsigned(int(width) - int(quantisation_effective))
+    ? quantisation_effective
+    : width - 1 - x;
+  const unsigned column_minus_index = std::min(x, quantisation_effective);
+
+  const auto *row = matrix.GetRow(y);
+  return matrix.GetRow(y - row_minus_index)[x].IsSpecial() ||
+    matrix.GetRow(y + row_plus_index)[x].IsSpecial() ||
+    row[x - column_minus_index].IsSpecial() ||
+    row[x + column_plus_index].IsSpecial();
 }
 
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
@@ -306,91 +423,101 @@ ClipHeightDelta(TerrainHeight a, TerrainHeight b)
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const Band &band, unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
                                    const unsigned contour_height_scale)
 {
   assert(quantisation_effective > 0);
 
+  const unsigned width = height_matrix.GetWidth();
+
   PixelRect border;
   border.left = quantisation_effective;
   border.top = quantisation_effective;
-  border.right = height_matrix.GetWidth() - quantisation_effective;
+  border.right = width - quantisation_effective;
   border.bottom = height_matrix.GetHeight() - quantisation_effective;
 
-  const unsigned height_slope_factor =
+  /* the columns between these two can be calculated by the row
+     kernel; the others are too close to the border */
+  const unsigned inner_left = std::min(quantisation_effective, width);
+  const unsigned inner_right = std::max(inner_left,
+                                        (unsigned)std::max(border.right, 0));
+
+  SlopeShadingParameters shading;
+  shading.sx = sx;
+  shading.sy = sy;
+  shading.sz = sz;
+  shading.contrast = contrast;
+  shading.height_slope_factor =
     Clamp((unsigned)pixel_size, 1u,
           /* this upper limit avoids integer overflows in the "mag"
              formula; it effectively limits "dd2" so calculating its
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const auto *src = height_matrix.GetData();
+  const auto *src = height_matrix.GetRow(band.start_y);
   const RawColor *oColorBuf = color_table + 64 * 256;
 
-  RawColor *dest = image->GetTopRow();
+  RawColor *dest = image->GetRow(band.start_y);
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
+  for (unsigned y = band.start_y; y < band.end_y; ++y, src += width) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetWidth() * row_plus_index;
+    const unsigned row_plus_offset = width * row_plus_index;
 
     const unsigned row_minus_index = y >= quantisation_effective
       ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetWidth() * row_minus_index;
+    const unsigned row_minus_offset = width * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
+    assert(src - row_minus_offset >= height_matrix.GetData());
+    assert(src + row_plus_offset + width <= height_matrix.GetDataEnd());
+
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
+    CalculateHeightIndices(band.row_heights, band.row_contours, src, width,
+                           height_scale, contour_height_scale);
+
+    for (unsigned x = 0; x < inner_left; ++x)
+      band.row_shades[x] =
+        CalculateBorderSlopeShade(src + x, x, border, width,
+                                  quantisation_effective,
+                                  row_minus_offset, row_plus_offset,
+                                  p31, shading);
+
+    CalculateSlopeShading(band.row_shades + inner_left,
+                          src - row_minus_offset + inner_left,
+                          src + inner_left,
+                          src + row_plus_offset + inner_left,
+                          inner_right - inner_left,
+                          quantisation_effective, p31, shading);
+
+    for (unsigned x = inner_right; x < width; ++x)
+      band.row_shades[x] =
+        CalculateBorderSlopeShade(src + x, x, border, width,
+                                  quantisation_effective,
+                                  row_minus_offset, row_plus_offset,
+                                  p31, shading);
+
     unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned char *contour_this_column_base = band.contour_column_base;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
-      const auto e = *src;
+    for (unsigned x = 0; x < width; ++x) {
+      const auto e = src[x];
       if (gcc_likely(!e.IsSpecial())) {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
-
-        h = std::min(254u, h >> height_scale);
+        const unsigned h = band.row_heights[x];
+        const unsigned contour_interval = band.row_contours[x];
+        const int sindex = band.row_shades[x];
 
         // no need to calculate slope if undefined height or sea level
 
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
-
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetWidth() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        const auto h_above = src[-(int)row_minus_offset];
-        const auto h_below = src[row_plus_offset];
-        const auto h_left = src[-(int)column_minus_index];
-        const auto h_right = src[column_plus_index];
-
-        if (gcc_unlikely(h_above.IsSpecial() ||
-                         h_below.IsSpecial() ||
-                         h_left.IsSpecial() ||
-                         h_right.IsSpecial())) {
+        if (gcc_unlikely(sindex == NO_SLOPE)) {
           /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
+             invalid), no slope shading */
           *p++ = oColorBuf[h];
           contour_this_column_base++;
           continue;
@@ -404,25 +531,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * Clamp(sindex, -63, 63)];
+        *p++ = oColorBuf[int(h) + 256 * sindex];
       } else if (e.IsWater()) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -436,23 +545,6 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   }
 }
 
-void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
-                                   int contrast, int brightness,
-                                   const Angle sunazimuth,
-                                   const unsigned contour_height_scale)
-{
-  const Angle fudgeelevation = Angle::Degrees(10) +
-    Angle::Degrees(80.0 / 255.0) * brightness;
-
-  const int sx = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastsine());
-  const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
-  const int sz = (int)(255 * fudgeelevation.fastsine());
-
-  GenerateSlopeImage(height_scale, contrast,
-                     sx, sy, sz, contour_height_scale);
-}
-
 void
 RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
                                   unsigned height_scale, int interp_levels)
@@ -488,13 +580,64 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourEnd(const Band &band, bool do_shading,
+                           const unsigned contour_height_scale,
+                           unsigned char *dest) const
+{
+  const unsigned width = height_matrix.GetWidth();
+
+  for (unsigned x = 0; x < width; ++x) {
+    unsigned value = NO_CONTOUR;
+
+    /* the state of a column is the contour interval of the last
+       pixel which has updated it; usually that is the band's last
+       row */
+    for (unsigned y = band.end_y; y > band.start_y;) {
+      --y;
+
+      const auto h = height_matrix.GetRow(y)[x];
+      if (!h.IsSpecial() &&
+          (!do_shading ||
+           !HasSpecialSlopeNeighbour(height_matrix, x, y,
+                                     quantisation_effective))) {
+        value = ContourInterval(h, contour_height_scale);
+        break;
+      }
+    }
+
+    dest[x] = value;
+  }
+}
+
+void
+RasterRenderer::ContourStart(unsigned n, bool do_shading,
+                             const unsigned contour_height_scale) const
 {
-  // initialise column to first row
-  const auto *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  const unsigned width = height_matrix.GetWidth();
+
+  /* the end state of each band is the start state of the next one */
+  if (n > 1)
+    GetJobScheduler().ParallelFor(n - 1, [&](unsigned i){
+        ContourEnd(GetBand(i, n), do_shading, contour_height_scale,
+                   GetBand(i + 1, n).contour_column_base);
+      }, JobScheduler::Priority::HIGH, nullptr, n - 1);
+
+  // initialise the first band's columns to the first row
+  const auto *first_row = height_matrix.GetData();
+  unsigned char *previous = GetBand(0, n).contour_column_base;
+  for (unsigned x = 0; x < width; ++x)
+    previous[x] = ContourInterval(first_row[x], contour_height_scale);
+
+  /* a column which no pixel of the band above has updated keeps the
+     state from further up */
+  for (unsigned i = 1; i < n; ++i) {
+    unsigned char *current = GetBand(i, n).contour_column_base;
+    for (unsigned x = 0; x < width; ++x)
+      if (current[x] == NO_CONTOUR)
+        current[x] = previous[x];
+
+    previous = current;
+  }
 }
 
 void
@@ -26,6 +26,8 @@ Copyright_License {
 
 #include "Terrain/HeightMatrix.hpp"
 
+#include <stdint.h>
+
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
 #endif
@@ -45,6 +47,13 @@ class GLTexture;
 #endif
 
 class RasterRenderer {
+  /**
+   * Scanning the map and generating the image is split into
+   * horizontal bands which are processed by up to this number of
+   * threads of the #JobScheduler.
+   */
+  static constexpr unsigned MAX_RENDER_THREADS = 4;
+
   /** screen dimensions in coarse pixels */
   unsigned quantisation_pixels = 2;
 
@@ -74,8 +83,31 @@ class RasterRenderer {
   HeightMatrix height_matrix;
   RawBitmap *image = nullptr;
 
+  /**
+   * The number of bands the buffers below are allocated for; each
+   * band has its own slice of them.
+   */
+  unsigned n_bands = 0;
+
   unsigned char *contour_column_base = nullptr;
 
+  /**
+   * Per-row buffers for the kernels in ShadingKernels.hpp.
+   */
+  uint8_t *row_heights = nullptr, *row_contours = nullptr;
+  int8_t *row_shades = nullptr;
+
+  /**
+   * The per-band state passed to the row generators.
+   */
+  struct Band {
+    unsigned start_y, end_y;
+
+    unsigned char *contour_column_base;
+    uint8_t *row_heights, *row_contours;
+    int8_t *row_shades;
+  };
+
   double pixel_size;
 
   RawColor *color_table = nullptr;
@@ -149,29 +181,44 @@ public:
 
 protected:
   /**
-   * Convert the height matrix into the image, without shading.
+   * Convert one band of the height matrix into the image, without
+   * shading.
    */
-  void GenerateUnshadedImage(unsigned height_scale,
+  void GenerateUnshadedImage(const Band &band, unsigned height_scale,
                              const unsigned contour_height_scale);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert one band of the height matrix into the image, with slope
+   * shading.
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
+  void GenerateSlopeImage(const Band &band, unsigned height_scale,
+                          int contrast,
                           const int sx, const int sy, const int sz,
                           const unsigned contour_height_scale);
 
+private:
+  Band GetBand(unsigned i, unsigned n) const;
+
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Determine the contour state of each column after the band has
+   * been generated, or NO_CONTOUR if none of its pixels updates the
+   * column.
+   *
+   * @param do_shading true if the image is generated by
+   * GenerateSlopeImage(), which doesn't update the contour state of
+   * pixels without slope
    */
-  void GenerateSlopeImage(unsigned height_scale,
-                          int contrast, int brightness,
-                          const Angle sunazimuth,
-                          const unsigned contour_height_scale);
-
-private:
+  void ContourEnd(const Band &band, bool do_shading,
+                  const unsigned contour_height_scale,
+                  unsigned char *dest) const;
 
-  void ContourStart(const unsigned contour_height_scale);
+  /**
+   * Initialise the contour state of the columns of all #n bands, as
+   * it would be after all rows above each band have been generated.
+   * Each band's state is carried forward from the band above it.
+   */
+  void ContourStart(unsigned n, bool do_shading,
+                    const unsigned contour_height_scale) const;
 };
 
 #endif
@@ -28,9 +28,23 @@ Copyright_License {
 #include "IO/FileCache.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Thread/Timeline.hpp"
 #include "Util/ConvertString.hpp"
+#include "LogFile.hpp"
 
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const terrain_tile_store_name = _T("terrain_tiles");
+
+RasterTerrain::RasterTerrain(Path _path, ZipArchive &&_archive)
+  :Guard<RasterMap>(map), path(_path), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain()
+{
+  if (tile_store.IsDefined())
+    LogFormat("Terrain tile store: %u hits, %u misses",
+              tile_store.GetHits(), tile_store.GetMisses());
+}
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -63,20 +77,34 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   return success;
 }
 
+inline void
+RasterTerrain::OpenTileStore(FileCache &cache, Path path)
+{
+  auto &tile_cache = map.GetTileCache();
+  if (tile_store.Open(cache.CreatePath(terrain_tile_store_name), path,
+                      tile_cache.GetTileWidth(), tile_cache.GetTileHeight(),
+                      tile_cache.GetTileCount()))
+    tile_cache.SetStore(&tile_store);
+  else
+    LogFormat("Failed to open the terrain tile store");
+}
+
 inline bool
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
-  if (LoadCache(cache, path))
-    return true;
+  if (!LoadCache(cache, path)) {
+    if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
+      return false;
 
-  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
-    return false;
+    map.UpdateProjection();
 
-  map.UpdateProjection();
+    if (cache != nullptr)
+      SaveCache(*cache, path);
+  }
 
   if (cache != nullptr)
-    SaveCache(*cache, path);
+    OpenTileStore(*cache, path);
 
   return true;
 }
@@ -88,7 +116,7 @@ try {
   if (path.IsNull())
     return nullptr;
 
-  RasterTerrain *rt = new RasterTerrain(ZipArchive(path));
+  RasterTerrain *rt = new RasterTerrain(path, ZipArchive(path));
   if (!rt->Load(path, cache, operation)) {
     delete rt;
     return nullptr;
@@ -107,7 +135,15 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius)
   if (!tile_cache.IsValid())
     return false;
 
-  UpdateTerrainTiles(archive.get(), tile_cache, mutex,
-                     map.GetProjection(), location, radius);
+  const ScopeTimelineSpan timeline("RasterTerrain::UpdateTiles");
+
+  auto &scheduler = GetJobScheduler();
+  if (scheduler.GetConcurrency(JobScheduler::Priority::IDLE) > 1)
+    UpdateTerrainTiles(path, tile_cache, mutex,
+                       scheduler, MAX_DECODER_THREADS,
+                       map.GetProjection(), location, radius);
+  else
+    UpdateTerrainTiles(archive.get(), tile_cache, mutex,
+                       map.GetProjection(), location, radius);
   return map.IsDirty();
 }
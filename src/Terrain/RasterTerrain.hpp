@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_TERRAIN_RASTER_TERRAIN_HPP
 
 #include "RasterMap.hpp"
+#include "RasterTileStore.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Thread/Guard.hpp"
 #include "OS/Path.hpp"
@@ -45,18 +46,36 @@ public:
   friend class WaypointVisitorMap; // for intersection rendering
 
 private:
+  /**
+   * The maximum number of threads decoding terrain tiles at a time.
+   */
+  static constexpr unsigned MAX_DECODER_THREADS = 4;
+
+  /**
+   * The path of the map file.  The tile decoder threads open their
+   * own handles on it.
+   */
+  const AllocatedPath path;
+
   ZipArchive archive;
 
   RasterMap map;
 
+  /**
+   * Keeps decoded tiles on disk; only used if a #FileCache is
+   * available.
+   */
+  RasterTileStore tile_store;
+
 private:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive)
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  RasterTerrain(Path _path, ZipArchive &&_archive);
 
 public:
+  ~RasterTerrain();
+
   const Serial &GetSerial() const {
     return map.GetSerial();
   }
@@ -91,6 +110,8 @@ private:
 
   bool SaveCache(FileCache &cache, Path path) const;
 
+  void OpenTileStore(FileCache &cache, Path path);
+
   bool Load(Path path, FileCache *cache,
             OperationEnvironment &operation);
 };
@@ -53,14 +53,13 @@ RasterTile::LoadCache(FILE *file)
 }
 
 void
-RasterTile::CopyFrom(const struct jas_matrix &m)
+RasterTile::CopyTo(RasterBuffer &target, const struct jas_matrix &m) const
 {
-  if (!IsDefined())
-    return;
+  assert(IsDefined());
 
-  buffer.Resize(width, height);
+  target.Resize(width, height);
 
-  auto *gcc_restrict dest = buffer.GetData();
+  auto *gcc_restrict dest = target.GetData();
   assert(dest != nullptr);
 
   const unsigned width = m.numcols_, height = m.numrows_;
@@ -26,6 +26,9 @@ Copyright_License {
 
 #include "RasterTraits.hpp"
 #include "RasterBuffer.hpp"
+#include "HeightPyramid.hpp"
+
+#include <utility>
 
 #include <stdio.h>
 
@@ -50,6 +53,18 @@ public:
 
   RasterBuffer buffer;
 
+  /**
+   * The maximum heights of #buffer; rebuilt each time the buffer is
+   * loaded.
+   */
+  HeightPyramid pyramid;
+
+  /**
+   * The size of the smallest #pyramid blocks, as a power of two.
+   * This equals the resolution of the overview.
+   */
+  static constexpr unsigned PYRAMID_BLOCK_BITS = RasterTraits::OVERVIEW_BITS;
+
 public:
   RasterTile() = default;
 
@@ -104,6 +119,7 @@ public:
 
   void Disable() {
     buffer.Reset();
+    pyramid.Clear();
   }
 
   bool IsEnabled() const {
@@ -113,7 +129,28 @@ public:
     return !buffer.IsDefined();
   }
 
-  void CopyFrom(const struct jas_matrix &m);
+  void CopyFrom(const struct jas_matrix &m) {
+    if (IsDefined()) {
+      CopyTo(buffer, m);
+      pyramid.Build(buffer, PYRAMID_BLOCK_BITS);
+    }
+  }
+
+  /**
+   * Convert the decoded tile data into the specified buffer, without
+   * modifying this object.  This may be called without holding the
+   * cache lock; the result can be installed later with
+   * Install().
+   */
+  void CopyTo(RasterBuffer &target, const struct jas_matrix &m) const;
+
+  /**
+   * Install a buffer which was filled by CopyTo().
+   */
+  void Install(RasterBuffer &&src) {
+    buffer = std::move(src);
+    pyramid.Build(buffer, PYRAMID_BLOCK_BITS);
+  }
 
   /**
    * Determine the non-interpolated height at the specified pixel
@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "RasterTileCache.hpp"
+#include "RasterTileStore.hpp"
 #include "Math/Angle.hpp"
 #include "Math/FastMath.hpp"
 
@@ -81,12 +82,67 @@ RasterTileCache::PutTileData(unsigned index,
     return;
 
   tile.CopyFrom(m);
+
+  if (store != nullptr && tile.IsEnabled())
+    store->Put(index, tile.buffer);
+}
+
+bool
+RasterTileCache::CopyTileData(unsigned index, const struct jas_matrix &m,
+                              RasterBuffer &dest) const
+{
+  const auto &tile = tiles.GetLinear(index);
+  if (!tile.IsRequested() || !tile.IsDefined())
+    return false;
+
+  tile.CopyTo(dest, m);
+  return true;
+}
+
+void
+RasterTileCache::PutTileData(unsigned index, RasterBuffer &&buffer)
+{
+  auto &tile = tiles.GetLinear(index);
+  if (!tile.IsRequested())
+    return;
+
+  tile.Install(std::move(buffer));
+
+  if (store != nullptr)
+    store->Put(index, tile.buffer);
+}
+
+bool
+RasterTileCache::LoadStoredTile(unsigned index, RasterBuffer &dest) const
+{
+  const auto &tile = tiles.GetLinear(index);
+  if (store == nullptr || !tile.IsRequested() || !tile.IsDefined() ||
+      !store->Get(index, dest))
+    return false;
+
+  if (dest.GetWidth() != tile.width || dest.GetHeight() != tile.height) {
+    dest.Reset();
+    return false;
+  }
+
+  return true;
+}
+
+void
+RasterTileCache::RestoreTile(unsigned index, RasterBuffer &&buffer)
+{
+  auto &tile = tiles.GetLinear(index);
+  if (!tile.IsRequested())
+    return;
+
+  tile.Install(std::move(buffer));
+  tile.ClearRequest();
 }
 
 struct RTDistanceSort {
   const RasterTileCache &rtc;
 
-  RTDistanceSort(RasterTileCache &_rtc):rtc(_rtc) {}
+  RTDistanceSort(const RasterTileCache &_rtc):rtc(_rtc) {}
 
   bool operator()(unsigned short ai, unsigned short bi) const {
     const RasterTile &a = rtc.tiles.GetLinear(ai);
@@ -105,14 +161,6 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      the screen will be loaded in advance */
   radius += 256;
 
-  /**
-   * Maximum number of tiles loaded at a time, to reduce system load
-   * peaks.
-   */
-  constexpr unsigned MAX_ACTIVATE = MAX_ACTIVE_TILES > 32
-    ? 16
-    : MAX_ACTIVE_TILES / 2;
-
   /* query all tiles; all tiles which are either in range or already
      loaded are added to RequestTiles */
 
@@ -158,6 +206,32 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   return num_activate > 0;
 }
 
+void
+RasterTileCache::GetRequestedTiles(RequestedTiles &dest) const
+{
+  dest.clear();
+
+  for (const auto i : request_tiles) {
+    if (dest.full())
+      break;
+
+    if (tiles.GetLinear(i).IsRequested())
+      dest.append(i);
+  }
+
+  const RTDistanceSort sort(*this);
+  std::stable_sort(dest.begin(), dest.end(), sort);
+}
+
+unsigned
+RasterTileCache::GetActiveTileCount() const
+{
+  return std::count_if(tiles.begin(), tiles.end(),
+                       [](const RasterTile &tile){
+                         return tile.IsEnabled();
+                       });
+}
+
 TerrainHeight
 RasterTileCache::GetHeight(unsigned px, unsigned py) const
 {
@@ -236,6 +310,7 @@ RasterTileCache::Reset()
   segments.clear();
 
   overview.Reset();
+  overview_pyramid.Clear();
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
@@ -267,6 +342,13 @@ RasterTileCache::FinishTileUpdate()
   ++serial;
 }
 
+void
+RasterTileCache::FinishOverview()
+{
+  /* one overview pixel covers one block of the tile pyramids */
+  overview_pyramid.Build(overview, 0);
+}
+
 bool
 RasterTileCache::SaveCache(FILE *file) const
 {
@@ -370,5 +452,6 @@ RasterTileCache::LoadCache(FILE *file)
             overview_size, file) != overview_size)
     return false;
 
+  FinishOverview();
   return true;
 }
@@ -39,6 +39,7 @@ Copyright_License {
 
 struct jas_matrix;
 struct GridLocation;
+class RasterTileStore;
 
 class RasterTileCache {
   static constexpr unsigned MAX_RTC_TILES = 4096;
@@ -54,6 +55,21 @@ class RasterTileCache {
   static constexpr unsigned MAX_ACTIVE_TILES = 512;
 #endif
 
+public:
+  /**
+   * Maximum number of tiles loaded at a time, to reduce system load
+   * peaks.
+   */
+  static constexpr unsigned MAX_ACTIVATE = MAX_ACTIVE_TILES > 32
+    ? 16
+    : MAX_ACTIVE_TILES / 2;
+
+  /**
+   * A list of tile indices, see GetRequestedTiles().
+   */
+  typedef StaticArray<uint16_t, MAX_ACTIVATE> RequestedTiles;
+
+private:
   /**
    * The width and height of the terrain bitmap is shifted by this
    * number of bits to determine the overview size.
@@ -123,6 +139,12 @@ protected:
   unsigned short tile_width, tile_height;
 
   RasterBuffer overview;
+
+  /**
+   * The maximum heights of #overview, built by FinishOverview().
+   */
+  HeightPyramid overview_pyramid;
+
   unsigned int width, height;
   unsigned int overview_width_fine, overview_height_fine;
 
@@ -132,11 +154,18 @@ protected:
 
   /**
    * An array that is used to sort the requested tiles by distance.
-   * This is only used by PollTiles() internally, but is stored in the
-   * class because it would be too large for the stack.
+   * This is only used by PollTiles() and GetRequestedTiles()
+   * internally, but is stored in the class because it would be too
+   * large for the stack.
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * An optional second tier which keeps decoded tiles on disk after
+   * they were evicted from memory.
+   */
+  RasterTileStore *store = nullptr;
+
 public:
   RasterTileCache() {
     Reset();
@@ -205,7 +234,6 @@ public:
                int h_origin, const int slope_fact,
                const int height_floor) const;
 
-private:
   /**
    * Get field (not interpolated) directly, without bringing tiles to front.
    * @param px X position/256
@@ -217,6 +245,44 @@ private:
   gcc_pure
   std::pair<TerrainHeight, bool> GetFieldDirect(unsigned px, unsigned py) const;
 
+private:
+  /**
+   * A rectangle of pixels which all have the same source (a loaded
+   * tile or the overview), and whose heights don't exceed a given
+   * value.
+   */
+  struct ClearBlock {
+    unsigned x0, y0, x1, y1;
+
+    /**
+     * Were the heights loaded from a "fine" tile?  See
+     * GetFieldDirect().
+     */
+    bool fine;
+
+    static constexpr ClearBlock Empty() {
+      return {0, 0, 0, 0, false};
+    }
+
+    bool IsInside(RasterLocation p) const {
+      return p.x >= x0 && p.x < x1 && p.y >= y0 && p.y < y1;
+    }
+  };
+
+  /**
+   * Find the largest block of the height pyramids which contains the
+   * given pixel and passes the given test.
+   *
+   * @param is_clear a function which receives the block's maximum
+   * height and the maximum number of line steps within the block,
+   * and returns true if a line can pass over it
+   * @param block receives the block on success; left unmodified
+   * otherwise
+   */
+  template<typename P>
+  bool FindClearBlock(RasterLocation p, P &&is_clear,
+                      ClearBlock &block) const;
+
 public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
@@ -238,6 +304,33 @@ public:
     return serial;
   }
 
+  unsigned GetTileWidth() const {
+    return tile_width;
+  }
+
+  unsigned GetTileHeight() const {
+    return tile_height;
+  }
+
+  unsigned GetTileCount() const {
+    return tiles.GetSize();
+  }
+
+  /**
+   * Attach a #RasterTileStore; decoded tiles will be copied to it,
+   * and RestoreTile() may be used to load them back.  Pass nullptr
+   * to detach.
+   */
+  void SetStore(RasterTileStore *_store) {
+    store = _store;
+  }
+
+  /**
+   * Count the tiles which are currently loaded.
+   */
+  gcc_pure
+  unsigned GetActiveTileCount() const;
+
   void Reset();
 
   const GeoBounds &GetBounds() const {
@@ -276,10 +369,51 @@ public:
 
   bool PollTiles(int x, int y, unsigned radius);
 
+  /**
+   * Obtain the list of tiles which were requested by the last
+   * PollTiles() call, sorted by priority (nearest first).
+   */
+  void GetRequestedTiles(RequestedTiles &dest) const;
+
   void PutTileData(unsigned index, const struct jas_matrix &m);
 
+  /**
+   * Convert decoded tile data into a buffer which can be installed
+   * with PutTileData(unsigned, RasterBuffer &&) later.  This method
+   * does not modify the object, and the caller does not need to hold
+   * an exclusive lock.
+   *
+   * @return false if the tile is not wanted anymore
+   */
+  bool CopyTileData(unsigned index, const struct jas_matrix &m,
+                    RasterBuffer &dest) const;
+
+  void PutTileData(unsigned index, RasterBuffer &&buffer);
+
+  /**
+   * Load a requested tile from the #RasterTileStore into a buffer
+   * which can be installed with RestoreTile() later.  This method
+   * does not modify the tile, and the caller does not need to hold
+   * an exclusive lock.
+   *
+   * @return false if there is no store or the tile is not in it
+   */
+  bool LoadStoredTile(unsigned index, RasterBuffer &dest) const;
+
+  /**
+   * Install a buffer obtained by LoadStoredTile(), and remove the
+   * tile from the decoder's request list.
+   */
+  void RestoreTile(unsigned index, RasterBuffer &&buffer);
+
   void FinishTileUpdate();
 
+  /**
+   * Build the height pyramid of the overview.  Call this after the
+   * overview has been loaded.
+   */
+  void FinishOverview();
+
 public:
   TerrainHeight GetMaxElevation() const {
     return overview.GetMaximum();
@@ -0,0 +1,282 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "RasterTileStore.hpp"
+#include "RasterBuffer.hpp"
+#include "OS/Path.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef HAVE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct RasterTileStore::Header {
+  static constexpr uint32_t MAGIC = 0x5254b2c7;
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  /**
+   * The identity of the terrain file.
+   */
+  uint64_t mtime, file_size;
+
+  uint32_t tile_width, tile_height, n_tiles, n_slots;
+
+  /**
+   * A counter which is incremented on each access, used to determine
+   * the least recently used slot.
+   */
+  uint32_t clock;
+};
+
+struct RasterTileStore::Slot {
+  static constexpr uint16_t NO_TILE = 0xffff;
+
+  /**
+   * The value of Header::clock when this slot was accessed last.
+   */
+  uint32_t last_used;
+
+  uint16_t tile;
+  uint16_t width, height;
+  uint16_t reserved;
+};
+
+static constexpr size_t PAGE_SIZE_ALIGN = 4096;
+
+static constexpr size_t
+AlignPage(size_t size)
+{
+  return (size + PAGE_SIZE_ALIGN - 1) & ~(PAGE_SIZE_ALIGN - 1);
+}
+
+bool
+RasterTileStore::Open(Path path, Path terrain_path,
+                      unsigned tile_width, unsigned tile_height,
+                      unsigned n_tiles)
+{
+  Close();
+
+#ifdef HAVE_POSIX
+  if (tile_width == 0 || tile_height == 0 ||
+      n_tiles == 0 || n_tiles > Slot::NO_TILE)
+    return false;
+
+  struct stat st;
+  if (stat(terrain_path.c_str(), &st) < 0 || !S_ISREG(st.st_mode))
+    return false;
+
+  slot_size = AlignPage(tile_width * tile_height * sizeof(TerrainHeight));
+  data_offset = AlignPage(sizeof(Header) + MAX_TILES * sizeof(Slot));
+  size = data_offset + MAX_TILES * slot_size;
+
+  int flags = O_RDWR|O_CREAT;
+#ifdef O_NOCTTY
+  flags |= O_NOCTTY;
+#endif
+#ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+#endif
+
+  int fd = open(path.c_str(), flags, 0666);
+  if (fd < 0)
+    return false;
+
+  /* the file is sparse; the tile data gets allocated only when it
+     is written */
+  if (ftruncate(fd, size) < 0) {
+    close(fd);
+    return false;
+  }
+
+  void *p = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED)
+    return false;
+
+  data = p;
+  header = (Header *)data;
+  slots = (Slot *)(header + 1);
+
+  if (header->magic != Header::MAGIC ||
+      header->version != Header::VERSION ||
+      header->mtime != uint64_t(st.st_mtime) ||
+      header->file_size != uint64_t(st.st_size) ||
+      header->tile_width != tile_width ||
+      header->tile_height != tile_height ||
+      header->n_tiles != n_tiles ||
+      header->n_slots != MAX_TILES) {
+    header->magic = 0;
+    header->version = Header::VERSION;
+    header->mtime = st.st_mtime;
+    header->file_size = st.st_size;
+    header->tile_width = tile_width;
+    header->tile_height = tile_height;
+    header->n_tiles = n_tiles;
+    header->n_slots = MAX_TILES;
+    Clear();
+    header->magic = Header::MAGIC;
+  }
+
+  /* build the tile index, and drop slots which look inconsistent */
+
+  tile_slots.ResizeDiscard(n_tiles);
+  std::fill(tile_slots.begin(), tile_slots.end(), uint16_t(NO_SLOT));
+
+  for (unsigned i = 0; i < MAX_TILES; ++i) {
+    Slot &slot = slots[i];
+    if (slot.tile == Slot::NO_TILE)
+      continue;
+
+    if (slot.tile >= n_tiles || tile_slots[slot.tile] != NO_SLOT ||
+        slot.width > tile_width || slot.height > tile_height) {
+      slot.tile = Slot::NO_TILE;
+      slot.last_used = 0;
+      continue;
+    }
+
+    tile_slots[slot.tile] = i;
+  }
+
+  hits = misses = 0;
+  return true;
+#else
+  (void)path;
+  (void)terrain_path;
+  (void)tile_width;
+  (void)tile_height;
+  (void)n_tiles;
+  return false;
+#endif
+}
+
+void
+RasterTileStore::Close()
+{
+#ifdef HAVE_POSIX
+  if (data != nullptr) {
+    munmap(data, size);
+    data = nullptr;
+  }
+#endif
+}
+
+void
+RasterTileStore::Clear()
+{
+  assert(IsDefined());
+
+  header->clock = 0;
+
+  for (unsigned i = 0; i < MAX_TILES; ++i) {
+    Slot &slot = slots[i];
+    slot.last_used = 0;
+    slot.tile = Slot::NO_TILE;
+    slot.width = slot.height = 0;
+    slot.reserved = 0;
+  }
+}
+
+unsigned
+RasterTileStore::FindVictim() const
+{
+  unsigned result = 0;
+  for (unsigned i = 0; i < MAX_TILES; ++i) {
+    const Slot &slot = slots[i];
+    if (slot.tile == Slot::NO_TILE)
+      return i;
+
+    if (slot.last_used < slots[result].last_used)
+      result = i;
+  }
+
+  return result;
+}
+
+inline void
+RasterTileStore::Touch(unsigned slot)
+{
+  slots[slot].last_used = ++header->clock;
+}
+
+bool
+RasterTileStore::Get(unsigned tile, RasterBuffer &dest)
+{
+  if (!IsDefined() || tile >= tile_slots.size())
+    return false;
+
+  const unsigned i = tile_slots[tile];
+  if (i == NO_SLOT) {
+    ++misses;
+    return false;
+  }
+
+  const Slot &slot = slots[i];
+  dest.Resize(slot.width, slot.height);
+  memcpy(dest.GetData(), GetSlotData(i),
+         slot.width * slot.height * sizeof(TerrainHeight));
+
+  Touch(i);
+  ++hits;
+  return true;
+}
+
+void
+RasterTileStore::Put(unsigned tile, const RasterBuffer &src)
+{
+  if (!IsDefined() || tile >= tile_slots.size() || !src.IsDefined())
+    return;
+
+  const unsigned width = src.GetWidth(), height = src.GetHeight();
+  const size_t nbytes = width * height * sizeof(TerrainHeight);
+  if (nbytes > slot_size)
+    return;
+
+  unsigned i = tile_slots[tile];
+  if (i == NO_SLOT) {
+    i = FindVictim();
+    if (slots[i].tile != Slot::NO_TILE)
+      tile_slots[slots[i].tile] = NO_SLOT;
+  }
+
+  Slot &slot = slots[i];
+
+  /* invalidate the slot while its data is being overwritten */
+  slot.tile = Slot::NO_TILE;
+
+  memcpy(GetSlotData(i), src.GetData(), nbytes);
+
+  slot.width = width;
+  slot.height = height;
+  slot.tile = tile;
+  tile_slots[tile] = i;
+  Touch(i);
+}
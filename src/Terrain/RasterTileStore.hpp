@@ -0,0 +1,150 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_TILE_STORE_HPP
+#define XCSOAR_TERRAIN_RASTER_TILE_STORE_HPP
+
+#include "Util/AllocatedArray.hxx"
+#include "Compiler.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Path;
+class RasterBuffer;
+
+/**
+ * A memory-mapped file which stores decoded terrain tiles.  It is the
+ * second tier below the tiles held in memory by #RasterTileCache:
+ * tiles which were evicted from memory can be loaded from here with
+ * a page-in instead of decoding the JPEG2000 stream again.
+ *
+ * The file is keyed by the identity (modification time and size) of
+ * the terrain file and by the tile geometry; if either does not
+ * match, the store is cleared.  The number of tiles is bounded; when
+ * the store is full, the least recently used tile is replaced.
+ *
+ * This class is not thread-safe; the caller must serialize all
+ * method calls.
+ */
+class RasterTileStore {
+public:
+  /**
+   * The maximum number of tiles in the store.
+   */
+#if defined(ANDROID)
+  static constexpr unsigned MAX_TILES = 512;
+#else
+  static constexpr unsigned MAX_TILES = 2048;
+#endif
+
+private:
+  struct Header;
+  struct Slot;
+
+  static constexpr uint16_t NO_SLOT = 0xffff;
+
+  void *data = nullptr;
+  size_t size;
+
+  Header *header;
+  Slot *slots;
+
+  /**
+   * Maps tile indices to slot numbers (or #NO_SLOT).
+   */
+  AllocatedArray<uint16_t> tile_slots;
+
+  /**
+   * The offset of the first slot's tile data within the file.
+   */
+  size_t data_offset;
+
+  size_t slot_size;
+
+  unsigned hits = 0, misses = 0;
+
+public:
+  RasterTileStore() = default;
+  ~RasterTileStore() {
+    Close();
+  }
+
+  RasterTileStore(const RasterTileStore &) = delete;
+  RasterTileStore &operator=(const RasterTileStore &) = delete;
+
+  bool IsDefined() const {
+    return data != nullptr;
+  }
+
+  /**
+   * Open (or create) the store file.
+   *
+   * @param path the path of the store file
+   * @param terrain_path the path of the terrain file; its identity
+   * is used to validate the store's contents
+   * @param n_tiles the total number of tiles in the terrain file
+   * @return false if the store could not be opened; the object is
+   * then unusable, but all methods may still be called
+   */
+  bool Open(Path path, Path terrain_path,
+            unsigned tile_width, unsigned tile_height,
+            unsigned n_tiles);
+
+  void Close();
+
+  /**
+   * Copy the specified tile into the buffer.
+   *
+   * @return true on success, false if the tile is not in the store
+   */
+  bool Get(unsigned tile, RasterBuffer &dest);
+
+  /**
+   * Copy the specified tile into the store, possibly replacing the
+   * least recently used one.
+   */
+  void Put(unsigned tile, const RasterBuffer &src);
+
+  unsigned GetHits() const {
+    return hits;
+  }
+
+  unsigned GetMisses() const {
+    return misses;
+  }
+
+private:
+  void Clear();
+
+  gcc_pure
+  unsigned FindVictim() const;
+
+  void *GetSlotData(unsigned slot) const {
+    return (uint8_t *)data + data_offset + slot * slot_size;
+  }
+
+  void Touch(unsigned slot);
+};
+
+#endif
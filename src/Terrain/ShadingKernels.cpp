@@ -0,0 +1,184 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ShadingKernels.hpp"
+
+#if defined(__SSE2__)
+#include "ShadingSSE2.hpp"
+#elif defined(__ARM_NEON__)
+#include "ShadingNEON.hpp"
+#endif
+
+#include <algorithm>
+
+void
+PortableCalculateHeightIndices(uint8_t *gcc_restrict heights,
+                               uint8_t *gcc_restrict contours,
+                               const TerrainHeight *gcc_restrict src,
+                               unsigned n,
+                               unsigned height_scale,
+                               unsigned contour_height_scale)
+{
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned h = std::max(0, (int)src[i].GetValue());
+    heights[i] = std::min(254u, h >> height_scale);
+    contours[i] = std::min(254u, h >> contour_height_scale);
+  }
+}
+
+void
+PortableCalculateSlopeShading(int8_t *gcc_restrict dest,
+                              const TerrainHeight *above,
+                              const TerrainHeight *src,
+                              const TerrainHeight *below,
+                              unsigned n, unsigned column_offset,
+                              unsigned p31,
+                              const SlopeShadingParameters &s)
+{
+  const unsigned p20 = 2 * column_offset;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const auto h_above = above[i];
+    const auto h_below = below[i];
+    const auto h_left = src[int(i - column_offset)];
+    const auto h_right = src[i + column_offset];
+
+    if (gcc_unlikely(h_above.IsSpecial() ||
+                     h_below.IsSpecial() ||
+                     h_left.IsSpecial() ||
+                     h_right.IsSpecial())) {
+      dest[i] = NO_SLOPE;
+      continue;
+    }
+
+    dest[i] = CalculateSlopeShade(ClipHeightDelta(h_right, h_left),
+                                  ClipHeightDelta(h_above, h_below),
+                                  p20, p31, s);
+  }
+}
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+
+/**
+ * The number of pixels processed by one iteration of the optimised
+ * kernels; the remainder is done by the portable ones.
+ */
+static constexpr unsigned OPTIMISED_STEP = 8;
+static constexpr unsigned PORTABLE_MASK = OPTIMISED_STEP - 1;
+static constexpr unsigned OPTIMISED_MASK = ~PORTABLE_MASK;
+
+#if defined(__SSE2__)
+typedef SSE2ShadingKernels OptimisedShadingKernels;
+#else
+typedef NEONShadingKernels OptimisedShadingKernels;
+#endif
+
+static_assert(OptimisedShadingKernels::STEP == OPTIMISED_STEP,
+              "Wrong step size");
+
+/**
+ * Are the parameters within the ranges for which the optimised slope
+ * kernel gives exactly the same results as the portable one?  This
+ * is always the case for the values used by #RasterRenderer.
+ */
+gcc_pure
+static bool
+CanOptimiseSlopeShading(unsigned column_offset, unsigned p31,
+                        const SlopeShadingParameters &s)
+{
+  const unsigned p20 = 2 * column_offset;
+
+  return p20 > 0 && p20 <= 63 && p31 > 0 && p31 <= 63 &&
+    uint64_t(p20) * p31 * s.height_slope_factor <= 32768 &&
+    s.sx >= -1024 && s.sx <= 1024 &&
+    s.sy >= -1024 && s.sy <= 1024 &&
+    s.sz >= -1024 && s.sz <= 1024 &&
+    s.contrast >= -32768 && s.contrast <= 32767;
+}
+
+void
+CalculateHeightIndices(uint8_t *gcc_restrict heights,
+                       uint8_t *gcc_restrict contours,
+                       const TerrainHeight *gcc_restrict src, unsigned n,
+                       unsigned height_scale,
+                       unsigned contour_height_scale)
+{
+  const unsigned no = n & OPTIMISED_MASK;
+  const unsigned np = n & PORTABLE_MASK;
+
+  OptimisedShadingKernels::CalculateHeightIndices(heights, contours, src, no,
+                                                  height_scale,
+                                                  contour_height_scale);
+  PortableCalculateHeightIndices(heights + no, contours + no, src + no, np,
+                                 height_scale, contour_height_scale);
+}
+
+void
+CalculateSlopeShading(int8_t *gcc_restrict dest,
+                      const TerrainHeight *above,
+                      const TerrainHeight *src,
+                      const TerrainHeight *below,
+                      unsigned n, unsigned column_offset, unsigned p31,
+                      const SlopeShadingParameters &s)
+{
+  if (!CanOptimiseSlopeShading(column_offset, p31, s)) {
+    PortableCalculateSlopeShading(dest, above, src, below, n,
+                                  column_offset, p31, s);
+    return;
+  }
+
+  const unsigned no = n & OPTIMISED_MASK;
+  const unsigned np = n & PORTABLE_MASK;
+
+  OptimisedShadingKernels::CalculateSlopeShading(dest, above, src, below, no,
+                                                 column_offset, p31, s);
+  PortableCalculateSlopeShading(dest + no, above + no, src + no, below + no,
+                                np, column_offset, p31, s);
+}
+
+#else
+
+void
+CalculateHeightIndices(uint8_t *gcc_restrict heights,
+                       uint8_t *gcc_restrict contours,
+                       const TerrainHeight *gcc_restrict src, unsigned n,
+                       unsigned height_scale,
+                       unsigned contour_height_scale)
+{
+  PortableCalculateHeightIndices(heights, contours, src, n,
+                                 height_scale, contour_height_scale);
+}
+
+void
+CalculateSlopeShading(int8_t *gcc_restrict dest,
+                      const TerrainHeight *above,
+                      const TerrainHeight *src,
+                      const TerrainHeight *below,
+                      unsigned n, unsigned column_offset, unsigned p31,
+                      const SlopeShadingParameters &s)
+{
+  PortableCalculateSlopeShading(dest, above, src, below, n,
+                                column_offset, p31, s);
+}
+
+#endif
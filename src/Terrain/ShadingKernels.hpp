@@ -0,0 +1,161 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SHADING_KERNELS_HPP
+#define XCSOAR_TERRAIN_SHADING_KERNELS_HPP
+
+#include "Height.hpp"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * Row kernels for RasterRenderer.  Each kernel has a portable
+ * implementation, and on CPUs with SSE2 or NEON an optimised one,
+ * which is selected at compile time (like the pixel operations in
+ * Screen/Memory/Optimised.hpp).  Both produce bit-identical results.
+ */
+
+/**
+ * The parameters of the slope shading formula.
+ */
+struct SlopeShadingParameters {
+  /**
+   * The sun vector, scaled to 255.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  unsigned height_slope_factor;
+};
+
+/**
+ * Special value for the slope shading index: one of the neighbours is
+ * "special" (water or invalid), and no slope was calculated.
+ */
+static constexpr int8_t NO_SLOPE = -128;
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * CalculateSlopeShade() formula when the map file is broken, avoiding
+ * the sqrt() call with a negative argument.
+ */
+gcc_const
+static inline int
+ClipHeightDelta(int d)
+{
+  return Clamp(d, -512, 512);
+}
+
+gcc_const
+static inline int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b)
+{
+  return ClipHeightDelta(a.GetValue() - b.GetValue());
+}
+
+/**
+ * Calculate the slope shading index of one pixel.
+ *
+ * @param p22 the clipped height delta in X direction
+ * @param p32 the clipped height delta in Y direction
+ * @param p20 the horizontal distance of the two X neighbours
+ * @param p31 the vertical distance of the two Y neighbours
+ * @return the shading index (-63..63)
+ */
+gcc_pure
+static inline int
+CalculateSlopeShade(int p22, int p32, unsigned p20, unsigned p31,
+                    const SlopeShadingParameters &s)
+{
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+  const int num = (int(dd2) * s.sz + dd0 * s.sx + dd1 * s.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+  const unsigned mag = (unsigned)sqrt(square_mag);
+  /* this is a workaround for a SIGFPE (division by zero)
+     observed by our users on some Android devices (e.g. Nexus
+     7), even though we did our best to make sure that the
+     integer arithmetics above can't overflow */
+  /* TODO: debug this problem and replace this workaround */
+  const int sval = num / int(mag|1);
+  const int sindex = (sval - s.sz) * s.contrast / 128;
+  return Clamp(sindex, -63, 63);
+}
+
+/**
+ * Calculate the colour table index and the contour interval of a row
+ * of terrain heights.  The results for "special" heights are
+ * undefined.
+ *
+ * @param heights receives the colour table index (0..254)
+ * @param contours receives the contour interval (0..254)
+ */
+void
+CalculateHeightIndices(uint8_t *gcc_restrict heights,
+                       uint8_t *gcc_restrict contours,
+                       const TerrainHeight *gcc_restrict src, unsigned n,
+                       unsigned height_scale,
+                       unsigned contour_height_scale);
+
+void
+PortableCalculateHeightIndices(uint8_t *gcc_restrict heights,
+                               uint8_t *gcc_restrict contours,
+                               const TerrainHeight *gcc_restrict src,
+                               unsigned n,
+                               unsigned height_scale,
+                               unsigned contour_height_scale);
+
+/**
+ * Calculate the slope shading index of a row of pixels.  The left
+ * and right neighbours are #column_offset pixels away, and the
+ * caller must ensure that they exist.
+ *
+ * @param dest receives the shading index (-63..63) or #NO_SLOPE
+ * @param above the row above #src
+ * @param below the row below #src
+ * @param p31 the vertical distance between #above and #below
+ */
+void
+CalculateSlopeShading(int8_t *gcc_restrict dest,
+                      const TerrainHeight *above,
+                      const TerrainHeight *src,
+                      const TerrainHeight *below,
+                      unsigned n, unsigned column_offset, unsigned p31,
+                      const SlopeShadingParameters &s);
+
+void
+PortableCalculateSlopeShading(int8_t *gcc_restrict dest,
+                              const TerrainHeight *above,
+                              const TerrainHeight *src,
+                              const TerrainHeight *below,
+                              unsigned n, unsigned column_offset,
+                              unsigned p31,
+                              const SlopeShadingParameters &s);
+
+#endif
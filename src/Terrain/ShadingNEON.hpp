@@ -0,0 +1,216 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SHADING_NEON_HPP
+#define XCSOAR_TERRAIN_SHADING_NEON_HPP
+
+#include "ShadingKernels.hpp"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#include <arm_neon.h>
+
+/**
+ * Implementation of the #RasterRenderer row kernels using ARM NEON
+ * instructions.  NEON has neither a square root nor a division
+ * instruction; both are estimated with single precision and then
+ * corrected with integer arithmetics, which gives exactly the same
+ * results as the scalar code.
+ */
+class NEONShadingKernels {
+public:
+  static constexpr unsigned STEP = 8;
+
+  gcc_always_inline
+  static int16x8_t LoadHeights(const TerrainHeight *p) {
+    return vld1q_s16((const int16_t *)p);
+  }
+
+  gcc_flatten
+  static void CalculateHeightIndices(uint8_t *gcc_restrict heights,
+                                     uint8_t *gcc_restrict contours,
+                                     const TerrainHeight *gcc_restrict src,
+                                     unsigned n,
+                                     unsigned height_scale,
+                                     unsigned contour_height_scale) {
+    const int16x8_t zero = vdupq_n_s16(0);
+    const uint16x8_t max_index = vdupq_n_u16(254);
+
+    /* negative shift counts shift to the right */
+    const int16x8_t v_height_scale = vdupq_n_s16(-int(height_scale));
+    const int16x8_t v_contour_scale =
+      vdupq_n_s16(-int(contour_height_scale));
+
+    for (unsigned i = 0; i < n / STEP; ++i, src += STEP,
+           heights += STEP, contours += STEP) {
+      const uint16x8_t h =
+        vreinterpretq_u16_s16(vmaxq_s16(LoadHeights(src), zero));
+
+      vst1_u8(heights, vmovn_u16(vminq_u16(vshlq_u16(h, v_height_scale),
+                                           max_index)));
+      vst1_u8(contours, vmovn_u16(vminq_u16(vshlq_u16(h, v_contour_scale),
+                                            max_index)));
+    }
+  }
+
+  /**
+   * Calculate floor(sqrt(x)) of four non-zero 32 bit integers.
+   */
+  gcc_always_inline
+  static uint32x4_t SquareRoot(uint32x4_t x) {
+    const float32x4_t f = vcvtq_f32_u32(x);
+
+    /* reciprocal square root estimate with two Newton-Raphson
+       steps */
+    float32x4_t e = vrsqrteq_f32(f);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+
+    uint32x4_t r = vcvtq_u32_f32(vmulq_f32(f, e));
+
+    /* the estimate is off by at most one; correct it */
+    r = vaddq_u32(r, vcgtq_u32(vmulq_u32(r, r), x));
+
+    const uint32x4_t r1 = vaddq_u32(r, vdupq_n_u32(1));
+    r = vsubq_u32(r, vcleq_u32(vmulq_u32(r1, r1), x));
+
+    return r;
+  }
+
+  /**
+   * Divide four signed 32 bit integers by positive ones, rounding
+   * towards zero.
+   */
+  gcc_always_inline
+  static int32x4_t Divide(int32x4_t a, int32x4_t b) {
+    const int32x4_t abs_a = vabsq_s32(a);
+    const float32x4_t fb = vcvtq_f32_s32(b);
+
+    /* reciprocal estimate with two Newton-Raphson steps */
+    float32x4_t e = vrecpeq_f32(fb);
+    e = vmulq_f32(e, vrecpsq_f32(fb, e));
+    e = vmulq_f32(e, vrecpsq_f32(fb, e));
+
+    int32x4_t q = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(abs_a), e));
+
+    /* the estimate is off by at most one; correct it */
+    const int32x4_t rem = vmlsq_s32(abs_a, q, b);
+    q = vaddq_s32(q, vreinterpretq_s32_u32(vcltq_s32(rem, vdupq_n_s32(0))));
+    q = vsubq_s32(q, vreinterpretq_s32_u32(vcgeq_s32(vsubq_s32(abs_a,
+                                                               vmulq_s32(q, b)),
+                                                     b)));
+
+    /* apply the sign */
+    const int32x4_t sign = vshrq_n_s32(a, 31);
+    return vsubq_s32(veorq_s32(q, sign), sign);
+  }
+
+  /**
+   * Calculate the shading index of four pixels.
+   */
+  gcc_always_inline
+  static int16x4_t Shade4(int16x4_t dd0, int16x4_t dd1,
+                          const SlopeShadingParameters &s,
+                          int32x4_t num_offset, uint32x4_t square_offset) {
+    const int32x4_t num = vmlal_n_s16(vmlal_n_s16(num_offset, dd0, s.sx),
+                                      dd1, s.sy);
+
+    const int32x4_t square = vmlal_s16(vmull_s16(dd0, dd0), dd1, dd1);
+    const uint32x4_t mag =
+      SquareRoot(vaddq_u32(vreinterpretq_u32_s32(square), square_offset));
+
+    const int32x4_t sval =
+      Divide(num, vreinterpretq_s32_u32(vorrq_u32(mag, vdupq_n_u32(1))));
+
+    int32x4_t x = vmulq_n_s32(vsubq_s32(sval, vdupq_n_s32(s.sz)),
+                              s.contrast);
+
+    /* signed division by 128, rounding towards zero */
+    x = vshrq_n_s32(vaddq_s32(x, vandq_s32(vshrq_n_s32(x, 31),
+                                           vdupq_n_s32(127))),
+                    7);
+
+    x = vminq_s32(vmaxq_s32(x, vdupq_n_s32(-63)), vdupq_n_s32(63));
+    return vmovn_s32(x);
+  }
+
+  gcc_flatten
+  static void CalculateSlopeShading(int8_t *gcc_restrict dest,
+                                    const TerrainHeight *above,
+                                    const TerrainHeight *src,
+                                    const TerrainHeight *below,
+                                    unsigned n, unsigned column_offset,
+                                    unsigned p31,
+                                    const SlopeShadingParameters &s) {
+    const unsigned p20 = 2 * column_offset;
+    const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+
+    const int16x8_t special_threshold = vdupq_n_s16(-29999);
+    const int16x8_t min_delta = vdupq_n_s16(-512);
+    const int16x8_t max_delta = vdupq_n_s16(512);
+    const int32x4_t num_offset = vdupq_n_s32(int(dd2) * s.sz);
+    const uint32x4_t square_offset = vdupq_n_u32(dd2 * dd2);
+    const int16x8_t no_slope = vdupq_n_s16(NO_SLOPE);
+
+    const TerrainHeight *left = src - column_offset;
+    const TerrainHeight *right = src + column_offset;
+
+    for (unsigned i = 0; i < n / STEP; ++i, dest += STEP,
+           above += STEP, below += STEP, left += STEP, right += STEP) {
+      const int16x8_t h_above = LoadHeights(above);
+      const int16x8_t h_below = LoadHeights(below);
+      const int16x8_t h_left = LoadHeights(left);
+      const int16x8_t h_right = LoadHeights(right);
+
+      const uint16x8_t special =
+        vorrq_u16(vorrq_u16(vcltq_s16(h_above, special_threshold),
+                            vcltq_s16(h_below, special_threshold)),
+                  vorrq_u16(vcltq_s16(h_left, special_threshold),
+                            vcltq_s16(h_right, special_threshold)));
+
+      /* the saturation doesn't matter, because the result is
+         clipped to a much smaller range anyway */
+      const int16x8_t p22 = vminq_s16(vmaxq_s16(vqsubq_s16(h_right, h_left),
+                                                min_delta),
+                                      max_delta);
+      const int16x8_t p32 = vminq_s16(vmaxq_s16(vqsubq_s16(h_above, h_below),
+                                                min_delta),
+                                      max_delta);
+
+      const int16x8_t dd0 = vmulq_n_s16(p22, p31);
+      const int16x8_t dd1 = vmulq_n_s16(p32, p20);
+
+      const int16x8_t sindex =
+        vcombine_s16(Shade4(vget_low_s16(dd0), vget_low_s16(dd1),
+                            s, num_offset, square_offset),
+                     Shade4(vget_high_s16(dd0), vget_high_s16(dd1),
+                            s, num_offset, square_offset));
+
+      vst1_s8(dest, vmovn_s16(vbslq_s16(special, no_slope, sindex)));
+    }
+  }
+};
+
+#endif
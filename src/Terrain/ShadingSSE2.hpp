@@ -0,0 +1,219 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SHADING_SSE2_HPP
+#define XCSOAR_TERRAIN_SHADING_SSE2_HPP
+
+#include "ShadingKernels.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+/**
+ * Implementation of the #RasterRenderer row kernels using SSE2
+ * instructions.  The square root and the division are done with
+ * double precision, which gives exactly the same results as the
+ * scalar integer code for the value ranges which can occur here.
+ */
+class SSE2ShadingKernels {
+public:
+  static constexpr unsigned STEP = 8;
+
+  gcc_always_inline
+  static __m128i LoadHeights(const TerrainHeight *p) {
+    return _mm_loadu_si128((const __m128i *)p);
+  }
+
+  gcc_flatten
+  static void CalculateHeightIndices(uint8_t *gcc_restrict heights,
+                                     uint8_t *gcc_restrict contours,
+                                     const TerrainHeight *gcc_restrict src,
+                                     unsigned n,
+                                     unsigned height_scale,
+                                     unsigned contour_height_scale) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max_index = _mm_set1_epi16(254);
+    const __m128i v_height_scale = _mm_cvtsi32_si128(height_scale);
+    const __m128i v_contour_scale = _mm_cvtsi32_si128(contour_height_scale);
+
+    for (unsigned i = 0; i < n / STEP; ++i, src += STEP,
+           heights += STEP, contours += STEP) {
+      const __m128i h = _mm_max_epi16(LoadHeights(src), zero);
+
+      const __m128i a = _mm_min_epi16(_mm_srl_epi16(h, v_height_scale),
+                                      max_index);
+      _mm_storel_epi64((__m128i *)heights, _mm_packus_epi16(a, a));
+
+      const __m128i b = _mm_min_epi16(_mm_srl_epi16(h, v_contour_scale),
+                                      max_index);
+      _mm_storel_epi64((__m128i *)contours, _mm_packus_epi16(b, b));
+    }
+  }
+
+  /**
+   * Calculate floor(sqrt(a + b)) of four 32 bit integers.  The sum
+   * may exceed the signed range, therefore it is done with double
+   * precision.
+   */
+  gcc_always_inline
+  static __m128i SquareRoot(__m128i a, __m128d b) {
+    const __m128i a_high = _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+
+    const __m128d low = _mm_sqrt_pd(_mm_add_pd(_mm_cvtepi32_pd(a), b));
+    const __m128d high = _mm_sqrt_pd(_mm_add_pd(_mm_cvtepi32_pd(a_high), b));
+
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+  }
+
+  /**
+   * Divide four signed 32 bit integers, rounding towards zero.
+   */
+  gcc_always_inline
+  static __m128i Divide(__m128i a, __m128i b) {
+    const __m128i a_high = _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+    const __m128i b_high = _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2));
+
+    const __m128d low = _mm_div_pd(_mm_cvtepi32_pd(a), _mm_cvtepi32_pd(b));
+    const __m128d high = _mm_div_pd(_mm_cvtepi32_pd(a_high),
+                                    _mm_cvtepi32_pd(b_high));
+
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+  }
+
+  /**
+   * Calculate the shading index of four pixels.
+   *
+   * @param d pairs of (dd0, dd1)
+   */
+  gcc_always_inline
+  static __m128i Shade4(__m128i d, __m128i sxy, __m128i num_offset,
+                        __m128d square_offset, __m128i sz, __m128i one) {
+    const __m128i num = _mm_add_epi32(_mm_madd_epi16(d, sxy), num_offset);
+    const __m128i mag = _mm_or_si128(SquareRoot(_mm_madd_epi16(d, d),
+                                                square_offset),
+                                     one);
+    return _mm_sub_epi32(Divide(num, mag), sz);
+  }
+
+  gcc_flatten
+  static void CalculateSlopeShading(int8_t *gcc_restrict dest,
+                                    const TerrainHeight *above,
+                                    const TerrainHeight *src,
+                                    const TerrainHeight *below,
+                                    unsigned n, unsigned column_offset,
+                                    unsigned p31,
+                                    const SlopeShadingParameters &s) {
+    const unsigned p20 = 2 * column_offset;
+    const unsigned dd2 = p20 * p31 * s.height_slope_factor;
+
+    const __m128i special_threshold = _mm_set1_epi16(-29999);
+    const __m128i min_delta = _mm_set1_epi16(-512);
+    const __m128i max_delta = _mm_set1_epi16(512);
+    const __m128i v_p31 = _mm_set1_epi16(p31);
+    const __m128i v_p20 = _mm_set1_epi16(p20);
+    const __m128i sxy = _mm_set1_epi32((unsigned(s.sy) << 16) |
+                                       (unsigned(s.sx) & 0xffff));
+    const __m128i num_offset = _mm_set1_epi32(int(dd2) * s.sz);
+    const __m128d square_offset = _mm_set1_pd(double(dd2) * double(dd2));
+    const __m128i sz = _mm_set1_epi32(s.sz);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i contrast = _mm_set1_epi16(s.contrast);
+    const __m128i round = _mm_set1_epi32(127);
+    const __m128i min_index = _mm_set1_epi16(-63);
+    const __m128i max_index = _mm_set1_epi16(63);
+    const __m128i no_slope = _mm_set1_epi16(NO_SLOPE);
+
+    const TerrainHeight *left = src - column_offset;
+    const TerrainHeight *right = src + column_offset;
+
+    for (unsigned i = 0; i < n / STEP; ++i, dest += STEP,
+           above += STEP, below += STEP, left += STEP, right += STEP) {
+      const __m128i h_above = LoadHeights(above);
+      const __m128i h_below = LoadHeights(below);
+      const __m128i h_left = LoadHeights(left);
+      const __m128i h_right = LoadHeights(right);
+
+      const __m128i special =
+        _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(h_above, special_threshold),
+                                  _mm_cmplt_epi16(h_below, special_threshold)),
+                     _mm_or_si128(_mm_cmplt_epi16(h_left, special_threshold),
+                                  _mm_cmplt_epi16(h_right, special_threshold)));
+
+      /* the saturation doesn't matter, because the result is
+         clipped to a much smaller range anyway */
+      const __m128i p22 = _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(h_right,
+                                                                     h_left),
+                                                      min_delta),
+                                        max_delta);
+      const __m128i p32 = _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(h_above,
+                                                                     h_below),
+                                                      min_delta),
+                                        max_delta);
+
+      const __m128i dd0 = _mm_mullo_epi16(p22, v_p31);
+      const __m128i dd1 = _mm_mullo_epi16(p32, v_p20);
+
+      const __m128i d_low = _mm_unpacklo_epi16(dd0, dd1);
+      const __m128i d_high = _mm_unpackhi_epi16(dd0, dd1);
+
+      /* sval - sz, which fits into 16 bits */
+      const __m128i delta =
+        _mm_packs_epi32(Shade4(d_low, sxy, num_offset, square_offset,
+                               sz, one),
+                        Shade4(d_high, sxy, num_offset, square_offset,
+                               sz, one));
+
+      /* 32 bit product with the contrast */
+      const __m128i product_low = _mm_mullo_epi16(delta, contrast);
+      const __m128i product_high = _mm_mulhi_epi16(delta, contrast);
+      __m128i x_low = _mm_unpacklo_epi16(product_low, product_high);
+      __m128i x_high = _mm_unpackhi_epi16(product_low, product_high);
+
+      /* signed division by 128, rounding towards zero */
+      x_low = _mm_srai_epi32(_mm_add_epi32(x_low,
+                                           _mm_and_si128(_mm_srai_epi32(x_low, 31),
+                                                         round)),
+                             7);
+      x_high = _mm_srai_epi32(_mm_add_epi32(x_high,
+                                            _mm_and_si128(_mm_srai_epi32(x_high, 31),
+                                                          round)),
+                              7);
+
+      /* the saturation doesn't matter, see above */
+      __m128i sindex = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(x_low,
+                                                                   x_high),
+                                                   min_index),
+                                     max_index);
+
+      sindex = _mm_or_si128(_mm_and_si128(special, no_slope),
+                            _mm_andnot_si128(special, sindex));
+
+      _mm_storel_epi64((__m128i *)dest, _mm_packs_epi16(sindex, sindex));
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,328 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "JobScheduler.hpp"
+#include "ThreadPool.hpp"
+#include "Operation/Operation.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+
+bool
+CancellationToken::IsCancelled() const
+{
+  return cancelled.load(std::memory_order_relaxed) ||
+    (env != nullptr && env->IsCancelled());
+}
+
+/**
+ * The state of one ParallelFor() call.  It is shared with the jobs
+ * which have been queued to help the caller, because these may still
+ * be queued when the call returns; they will then find no numbers
+ * left and do nothing.
+ */
+struct JobScheduler::Batch {
+  const std::function<void(unsigned)> &function;
+
+  const unsigned n;
+
+  const CancellationToken *const token;
+
+  /**
+   * The next number which has not been claimed yet.
+   */
+  std::atomic<unsigned> next;
+
+  /**
+   * Protects #n_finished.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when the last number has been finished.
+   */
+  Cond cond;
+
+  unsigned n_finished;
+
+  Batch(const std::function<void(unsigned)> &_function, unsigned _n,
+        const CancellationToken *_token)
+    :function(_function), n(_n), token(_token), next(0), n_finished(0) {}
+
+  /**
+   * Claim and run numbers until there are none left.  Once all
+   * numbers have been claimed, neither #function nor #token are
+   * accessed anymore.
+   */
+  void Run() {
+    unsigned count = 0;
+
+    unsigned i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < n) {
+      if (token == nullptr || !token->IsCancelled())
+        function(i);
+      ++count;
+    }
+
+    if (count > 0) {
+      const ScopeLock lock(mutex);
+      n_finished += count;
+      if (n_finished == n)
+        cond.broadcast();
+    }
+  }
+
+  void Wait() {
+    const ScopeLock lock(mutex);
+    while (n_finished < n)
+      cond.wait(mutex);
+  }
+};
+
+JobScheduler::JobScheduler(const char *_name, unsigned n_threads,
+                           unsigned n_idle_threads)
+  :name(_name), next_worker(0), quit(false)
+{
+  for (Group *group : {&normal_group, &idle_group}) {
+    group->begin = workers.size();
+
+    const unsigned n = group == &normal_group ? n_threads : n_idle_threads;
+    for (unsigned i = 0; i < n; ++i) {
+      workers.emplace_back(new Worker(*this, workers.size(), *group));
+      if (!workers.back()->Start()) {
+        /* continue with fewer threads */
+        workers.pop_back();
+        break;
+      }
+    }
+
+    group->end = workers.size();
+  }
+}
+
+JobScheduler::~JobScheduler()
+{
+  sleep_mutex.Lock();
+  quit = true;
+  normal_group.wake_cond.broadcast();
+  idle_group.wake_cond.broadcast();
+  sleep_mutex.Unlock();
+
+  for (auto &worker : workers)
+    worker->Join();
+}
+
+JobScheduler::Worker *
+JobScheduler::FindCurrentWorker() const
+{
+  for (const auto &worker : workers)
+    if (worker->IsInside())
+      return worker.get();
+
+  return nullptr;
+}
+
+void
+JobScheduler::Push(Function &&f, Priority priority)
+{
+  Group &group = GetGroup(priority);
+  assert(!group.empty());
+
+  Worker *worker = FindCurrentWorker();
+  if (worker == nullptr || &worker->group != &group)
+    worker = workers[group.begin +
+                     next_worker.fetch_add(1, std::memory_order_relaxed)
+                     % group.size()].get();
+
+  {
+    const ScopeLock lock(worker->mutex);
+    worker->queues[unsigned(priority)].push_back(std::move(f));
+  }
+
+  /* increment before locking #sleep_mutex; a worker checks the
+     counter with #sleep_mutex locked before it goes to sleep, so the
+     signal cannot get lost */
+  group.n_queued.fetch_add(1);
+
+  const ScopeLock lock(sleep_mutex);
+  group.wake_cond.signal();
+}
+
+bool
+JobScheduler::Take(Worker &worker, Function &f)
+{
+  Group &group = worker.group;
+  const unsigned n_workers = group.size();
+  const unsigned offset = worker.index - group.begin;
+
+  for (unsigned priority = 0; priority < N_PRIORITIES; ++priority) {
+    if (&GetGroup(Priority(priority)) != &group)
+      continue;
+
+    /* newest first from the own queue, which is probably still in
+       the CPU cache */
+    {
+      auto &queue = worker.queues[priority];
+      const ScopeLock lock(worker.mutex);
+      if (!queue.empty()) {
+        f = std::move(queue.back());
+        queue.pop_back();
+        --group.n_queued;
+        return true;
+      }
+    }
+
+    /* steal the oldest job of the same priority */
+    for (unsigned i = 1; i < n_workers; ++i) {
+      Worker &victim = *workers[group.begin + (offset + i) % n_workers];
+      auto &victim_queue = victim.queues[priority];
+
+      const ScopeLock lock(victim.mutex);
+      if (!victim_queue.empty()) {
+        f = std::move(victim_queue.front());
+        victim_queue.pop_front();
+        --group.n_queued;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void
+JobScheduler::Worker::Run()
+{
+  if (&group == &scheduler.idle_group)
+    SetIdlePriority();
+
+  Function f;
+
+  while (true) {
+    if (scheduler.Take(*this, f)) {
+      f();
+      f = nullptr;
+      continue;
+    }
+
+    const ScopeLock lock(scheduler.sleep_mutex);
+    if (group.n_queued.load() > 0)
+      /* a job was queued meanwhile */
+      continue;
+
+    if (scheduler.quit)
+      break;
+
+    group.wake_cond.wait(scheduler.sleep_mutex);
+  }
+}
+
+void
+JobScheduler::Submit(Function &&f, Priority priority,
+                     const CancellationToken *token)
+{
+  if (token != nullptr) {
+    Function inner(std::move(f));
+    f = [inner, token](){
+      if (!token->IsCancelled())
+        inner();
+    };
+  }
+
+  if (GetGroup(priority).empty())
+    f();
+  else
+    Push(std::move(f), priority);
+}
+
+void
+JobScheduler::ParallelFor(unsigned n, const std::function<void(unsigned)> &f,
+                          Priority priority,
+                          const CancellationToken *token,
+                          unsigned max_concurrency)
+{
+  const Group &group = GetGroup(priority);
+  if (n <= 1 || group.empty() || max_concurrency == 1) {
+    for (unsigned i = 0; i < n; ++i)
+      if (token == nullptr || !token->IsCancelled())
+        f(i);
+    return;
+  }
+
+  const auto batch = std::make_shared<Batch>(f, n, token);
+
+  unsigned n_helpers = std::min<unsigned>(n - 1, group.size());
+  if (max_concurrency > 0)
+    n_helpers = std::min(n_helpers, max_concurrency - 1);
+  for (unsigned i = 0; i < n_helpers; ++i)
+    Push([batch](){ batch->Run(); }, priority);
+
+  batch->Run();
+  batch->Wait();
+}
+
+static unsigned job_scheduler_limit = 0;
+
+void
+SetJobSchedulerLimit(unsigned max_concurrency)
+{
+  job_scheduler_limit = max_concurrency;
+}
+
+gcc_pure
+static unsigned
+GetJobSchedulerThreadCount()
+{
+  unsigned n = GetProcessorCount();
+  if (job_scheduler_limit > 0)
+    n = std::min(n, job_scheduler_limit);
+  return n - 1;
+}
+
+static JobScheduler *job_scheduler;
+
+void
+InitialiseJobScheduler()
+{
+  assert(job_scheduler == nullptr);
+
+  /* as many workers again for background jobs, at idle priority */
+  job_scheduler = new JobScheduler("Job", GetJobSchedulerThreadCount(),
+                                   GetJobSchedulerThreadCount());
+}
+
+void
+DeinitialiseJobScheduler()
+{
+  delete job_scheduler;
+  job_scheduler = nullptr;
+}
+
+JobScheduler &
+GetJobScheduler()
+{
+  assert(job_scheduler != nullptr);
+
+  return *job_scheduler;
+}
@@ -0,0 +1,320 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_JOB_SCHEDULER_HPP
+#define XCSOAR_JOB_SCHEDULER_HPP
+
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+#include "Compiler.h"
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+#include <stdint.h>
+
+class OperationEnvironment;
+
+/**
+ * Allows cancelling jobs of a #JobScheduler which have not started
+ * yet.  If the token is tied to an #OperationEnvironment, it is also
+ * cancelled when the environment is.
+ */
+class CancellationToken {
+  std::atomic<bool> cancelled;
+
+  const OperationEnvironment *const env;
+
+public:
+  explicit CancellationToken(const OperationEnvironment *_env=nullptr)
+    :cancelled(false), env(_env) {}
+
+  CancellationToken(const CancellationToken &) = delete;
+  CancellationToken &operator=(const CancellationToken &) = delete;
+
+  void Cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+  }
+
+  gcc_pure
+  bool IsCancelled() const;
+};
+
+/**
+ * A set of worker threads shared by all subsystems which have
+ * background work to spread over several cores.  Use
+ * GetJobScheduler() to obtain the process-wide instance, which is
+ * created by InitialiseJobScheduler().
+ *
+ * Each worker has its own job queue per priority.  Jobs submitted by
+ * a worker go to its own queues, which it processes newest first;
+ * idle workers steal the oldest jobs from the others.  Jobs submitted
+ * by other threads are distributed round-robin.  A worker always
+ * picks a job of the highest priority it can find.
+ *
+ * #Priority::IDLE jobs may have a separate set of workers which run
+ * at idle OS priority, so background work does not compete with the
+ * calculation and drawing threads.  These workers run only IDLE
+ * jobs, and the others only HIGH and NORMAL jobs.  Without idle
+ * workers, the normal workers run all jobs.
+ *
+ * Jobs must not throw exceptions.
+ */
+class JobScheduler {
+public:
+  enum class Priority : uint8_t {
+    /**
+     * Somebody is waiting for the result, e.g. the calculation
+     * thread.
+     */
+    HIGH,
+
+    NORMAL,
+
+    /**
+     * Background work which may be delayed, e.g. loading terrain
+     * tiles.
+     */
+    IDLE,
+  };
+
+  static constexpr unsigned N_PRIORITIES = 3;
+
+  typedef std::function<void()> Function;
+
+private:
+  /**
+   * The workers which serve a set of priorities.
+   */
+  struct Group {
+    /**
+     * The range of #workers belonging to this group.
+     */
+    unsigned begin, end;
+
+    /**
+     * The number of jobs in the queues of this group's workers.
+     */
+    std::atomic<unsigned> n_queued;
+
+    /**
+     * Idle workers of this group wait on this; protected by
+     * #sleep_mutex.
+     */
+    Cond wake_cond;
+
+    Group():begin(0), end(0), n_queued(0) {}
+
+    bool empty() const {
+      return begin == end;
+    }
+
+    unsigned size() const {
+      return end - begin;
+    }
+  };
+
+  class Worker final : public Thread {
+    JobScheduler &scheduler;
+
+  public:
+    const unsigned index;
+
+    Group &group;
+
+    /**
+     * Protects #queues.
+     */
+    Mutex mutex;
+
+    std::deque<Function> queues[N_PRIORITIES];
+
+    Worker(JobScheduler &_scheduler, unsigned _index, Group &_group)
+      :Thread(_scheduler.name), scheduler(_scheduler), index(_index),
+       group(_group) {}
+
+  protected:
+    /* virtual methods from class Thread */
+    void Run() override;
+  };
+
+  struct Batch;
+
+  const char *const name;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  /**
+   * The workers for HIGH and NORMAL jobs, and the ones for IDLE
+   * jobs.
+   */
+  Group normal_group, idle_group;
+
+  /**
+   * The worker which gets the next job submitted by a thread which
+   * is not a worker of the job's group.
+   */
+  std::atomic<unsigned> next_worker;
+
+  /**
+   * Protects #quit; idle workers wait on Group::wake_cond.
+   */
+  Mutex sleep_mutex;
+
+  bool quit;
+
+public:
+  /**
+   * @param n_threads the number of worker threads; zero means that
+   * all jobs run in the thread which submits them
+   * @param n_idle_threads the number of additional worker threads
+   * for #Priority::IDLE jobs, which run at idle OS priority; zero
+   * means IDLE jobs are run by the other workers
+   */
+  JobScheduler(const char *_name, unsigned n_threads,
+               unsigned n_idle_threads=0);
+
+  /**
+   * Runs the jobs which are still queued, and then stops the
+   * workers.
+   */
+  ~JobScheduler();
+
+  JobScheduler(const JobScheduler &) = delete;
+  JobScheduler &operator=(const JobScheduler &) = delete;
+
+  /**
+   * Returns the maximum number of jobs of the given priority which
+   * may run at the same time in a ParallelFor() call, including the
+   * calling thread.
+   */
+  gcc_pure
+  unsigned GetConcurrency(Priority priority=Priority::NORMAL) const {
+    return GetGroup(priority).size() + 1;
+  }
+
+  /**
+   * Run the function asynchronously in a worker thread.  Without
+   * workers, it runs right away in the calling thread.
+   *
+   * @param token if not nullptr, the job is dropped if this token is
+   * cancelled before the job starts; it must remain valid until then
+   */
+  void Submit(Function &&f, Priority priority=Priority::NORMAL,
+              const CancellationToken *token=nullptr);
+
+  /**
+   * Invoke the function for each number in the range [0, n), and
+   * return after all invocations have finished.  The calling thread
+   * participates, and it may call ParallelFor() again from within
+   * the function.
+   *
+   * At most n-1 workers are employed, so the caller can limit the
+   * concurrency with the number of jobs.
+   *
+   * @param token if not nullptr, invocations which have not started
+   * when the token is cancelled are skipped
+   * @param max_concurrency if not zero, at most this number of
+   * threads (including the calling thread) work on this call, even
+   * if there are more jobs
+   */
+  void ParallelFor(unsigned n, const std::function<void(unsigned)> &f,
+                   Priority priority=Priority::NORMAL,
+                   const CancellationToken *token=nullptr,
+                   unsigned max_concurrency=0);
+
+private:
+  gcc_pure
+  const Group &GetGroup(Priority priority) const {
+    return priority == Priority::IDLE && !idle_group.empty()
+      ? idle_group
+      : normal_group;
+  }
+
+  gcc_pure
+  Group &GetGroup(Priority priority) {
+    return priority == Priority::IDLE && !idle_group.empty()
+      ? idle_group
+      : normal_group;
+  }
+
+  gcc_pure
+  Worker *FindCurrentWorker() const;
+
+  void Push(Function &&f, Priority priority);
+
+  /**
+   * Dequeue the job with the highest priority served by the worker's
+   * group, preferring the worker's own queues over stealing from
+   * other workers of the group.
+   */
+  bool Take(Worker &worker, Function &f);
+};
+
+/**
+ * Limit the number of threads of the process-wide #JobScheduler
+ * including the calling thread, e.g. on low-end devices; the limit
+ * applies to the normal and to the idle workers separately.  Zero
+ * means one per processor.  This must be called before
+ * InitialiseJobScheduler().
+ */
+void
+SetJobSchedulerLimit(unsigned max_concurrency);
+
+/**
+ * Create the process-wide #JobScheduler.  This must be called from
+ * the main thread before any other thread uses it.
+ */
+void
+InitialiseJobScheduler();
+
+/**
+ * Stop and destroy the process-wide #JobScheduler.  No thread may
+ * use it anymore.
+ */
+void
+DeinitialiseJobScheduler();
+
+/**
+ * Returns the process-wide #JobScheduler.  Must not be called before
+ * InitialiseJobScheduler() or after DeinitialiseJobScheduler().
+ */
+JobScheduler &
+GetJobScheduler();
+
+class ScopeGlobalJobScheduler {
+public:
+  ScopeGlobalJobScheduler() {
+    InitialiseJobScheduler();
+  }
+
+  ~ScopeGlobalJobScheduler() {
+    DeinitialiseJobScheduler();
+  }
+};
+
+#endif
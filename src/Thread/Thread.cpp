@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Thread/Thread.hpp"
 #include "Name.hpp"
+#include "Timeline.hpp"
 #include "Util.hpp"
 
 #ifdef ANDROID
@@ -153,6 +154,8 @@ Thread::ThreadProc(void *p)
   if (thread->name != nullptr)
     SetThreadName(thread->name);
 
+  SetTimelineThreadName(thread->name != nullptr ? thread->name : "Thread");
+
   thread->Run();
 
 #ifdef ANDROID
@@ -169,6 +172,8 @@ Thread::ThreadProc(LPVOID lpParameter)
 {
   Thread *thread = (Thread *)lpParameter;
 
+  SetTimelineThreadName(thread->name != nullptr ? thread->name : "Thread");
+
   thread->Run();
   return 0;
 }
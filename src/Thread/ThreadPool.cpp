@@ -0,0 +1,133 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ThreadPool.hpp"
+#include "Util.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+ThreadPool::ThreadPool(const char *_name, unsigned n_threads,
+                       bool _idle_priority)
+  :name(_name), idle_priority(_idle_priority)
+{
+  for (unsigned i = 0; i < n_threads; ++i) {
+    workers.emplace_back(*this);
+    if (!workers.back().Start()) {
+      /* continue with fewer threads */
+      workers.pop_back();
+      break;
+    }
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  mutex.Lock();
+  quit = true;
+  work_cond.broadcast();
+  mutex.Unlock();
+
+  for (auto &worker : workers)
+    worker.Join();
+}
+
+void
+ThreadPool::RunJobs()
+{
+  assert(mutex.IsLockedByCurrent());
+
+  while (function != nullptr && next_job < n_jobs) {
+    const unsigned i = next_job++;
+    const auto &f = *function;
+    ++n_running;
+
+    {
+      const ScopeUnlock unlock(mutex);
+      f(i);
+    }
+
+    if (--n_running == 0 && next_job == n_jobs)
+      done_cond.broadcast();
+  }
+}
+
+void
+ThreadPool::Worker::Run()
+{
+  if (pool.idle_priority)
+    SetThreadIdlePriority();
+
+  const ScopeLock lock(pool.mutex);
+  while (!pool.quit) {
+    if (pool.function != nullptr && pool.next_job < pool.n_jobs)
+      pool.RunJobs();
+    else
+      pool.work_cond.wait(pool.mutex);
+  }
+}
+
+void
+ThreadPool::ParallelFor(unsigned n, const std::function<void(unsigned)> &f)
+{
+  if (n <= 1 || workers.empty()) {
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+
+  const ScopeLock batch_lock(batch_mutex);
+  const ScopeLock lock(mutex);
+
+  assert(function == nullptr);
+
+  function = &f;
+  next_job = 0;
+  n_jobs = n;
+  work_cond.broadcast();
+
+  RunJobs();
+
+  while (n_running > 0)
+    done_cond.wait(mutex);
+
+  function = nullptr;
+}
+
+unsigned
+GetProcessorCount()
+{
+#ifdef HAVE_POSIX
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? unsigned(n) : 1u;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0
+    ? unsigned(info.dwNumberOfProcessors)
+    : 1u;
+#endif
+}
@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_POOL_HPP
+#define XCSOAR_THREAD_POOL_HPP
+
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+#include "Compiler.h"
+
+#include <functional>
+#include <list>
+
+/**
+ * A fixed set of threads which help the calling thread with a batch
+ * of independent jobs.  Each call to ParallelFor() is synchronous: it
+ * returns after all jobs have finished.
+ *
+ * The jobs must not throw exceptions, and they must not call
+ * ParallelFor() on the same pool.
+ */
+class ThreadPool {
+  class Worker final : public Thread {
+    ThreadPool &pool;
+
+  public:
+    explicit Worker(ThreadPool &_pool)
+      :Thread(_pool.name), pool(_pool) {}
+
+  protected:
+    /* virtual methods from class Thread */
+    void Run() override;
+  };
+
+  const char *const name;
+
+  const bool idle_priority;
+
+  /**
+   * Serialises concurrent ParallelFor() calls from different threads.
+   */
+  Mutex batch_mutex;
+
+  /**
+   * Protects all attributes below.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when a new batch is available, or when the pool shall
+   * shut down.
+   */
+  Cond work_cond;
+
+  /**
+   * Signalled when the last job of the current batch has finished.
+   */
+  Cond done_cond;
+
+  std::list<Worker> workers;
+
+  /**
+   * The function of the current batch, or nullptr if there is none.
+   */
+  const std::function<void(unsigned)> *function = nullptr;
+
+  unsigned next_job = 0, n_jobs = 0;
+
+  /**
+   * The number of jobs which are currently being executed.
+   */
+  unsigned n_running = 0;
+
+  bool quit = false;
+
+public:
+  /**
+   * @param n_threads the number of threads to be launched in addition
+   * to the calling thread; zero means ParallelFor() runs all jobs in
+   * the calling thread
+   * @param idle_priority run the worker threads with idle priority?
+   */
+  ThreadPool(const char *_name, unsigned n_threads,
+             bool _idle_priority=false);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Returns the maximum number of jobs which may run at the same
+   * time, including the calling thread.
+   */
+  unsigned GetConcurrency() const {
+    return workers.size() + 1;
+  }
+
+  /**
+   * Invoke the function for each number in the range [0, n).  The
+   * calling thread participates.  Returns after all invocations
+   * have finished.
+   */
+  void ParallelFor(unsigned n, const std::function<void(unsigned)> &f);
+
+private:
+  /**
+   * Execute jobs of the current batch until there are none left.
+   * Caller must lock the mutex.
+   */
+  void RunJobs();
+};
+
+/**
+ * Determine the number of CPU cores which are available to this
+ * process.  Returns 1 if that is unknown.
+ */
+gcc_pure
+unsigned
+GetProcessorCount();
+
+#endif
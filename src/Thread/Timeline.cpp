@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Timeline.hpp"
+#include "Mutex.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ * The maximum number of threads which can record spans.  Buffers are
+ * never freed, because a thread may outlive the static destructors.
+ */
+static constexpr unsigned MAX_TIMELINE_THREADS = 32;
+
+static Mutex timeline_mutex;
+
+/**
+ * Protected by #timeline_mutex.
+ */
+static TimelineBuffer *timeline_buffers[MAX_TIMELINE_THREADS];
+static unsigned n_timeline_buffers;
+
+static thread_local const char *timeline_thread_name;
+static thread_local TimelineBuffer *timeline_buffer;
+
+/**
+ * Was the #TimelineBuffer of this thread refused because there were
+ * too many?  This avoids locking the mutex each time.
+ */
+static thread_local bool timeline_full;
+
+void
+TimelineBuffer::Snapshot(std::vector<TimelineSpan> &dest) const
+{
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two");
+
+  /* the slot after the newest span may be being overwritten
+     right now, therefore it is never copied */
+  const unsigned end = head.load(std::memory_order_acquire);
+  const unsigned n = std::min(end, CAPACITY - 1);
+  const unsigned begin = end - n;
+
+  const size_t offset = dest.size();
+  for (unsigned i = begin; i != end; ++i) {
+    const Slot &slot = spans[i % CAPACITY];
+    dest.push_back({slot.name.load(std::memory_order_relaxed),
+                    slot.start.load(std::memory_order_relaxed),
+                    slot.duration.load(std::memory_order_relaxed)});
+  }
+
+  /* the writer may meanwhile have overwritten the oldest slots; the
+     fence pairs with the one in Push() */
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  const unsigned end2 = head.load(std::memory_order_relaxed);
+  const unsigned distance = end2 - begin + 1;
+  if (distance > CAPACITY) {
+    const unsigned n_overwritten = std::min(distance - CAPACITY, n);
+    dest.erase(dest.begin() + offset, dest.begin() + offset + n_overwritten);
+  }
+}
+
+uint64_t
+GetTimelineClock()
+{
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void
+SetTimelineThreadName(const char *name)
+{
+  timeline_thread_name = name;
+}
+
+TimelineBuffer *
+GetTimelineBuffer()
+{
+  if (timeline_buffer != nullptr || timeline_full)
+    return timeline_buffer;
+
+  /* threads not started by class Thread, i.e. the main thread */
+  const char *name = timeline_thread_name != nullptr
+    ? timeline_thread_name
+    : "Main";
+
+  const ScopeLock protect(timeline_mutex);
+  if (n_timeline_buffers >= MAX_TIMELINE_THREADS) {
+    timeline_full = true;
+    return nullptr;
+  }
+
+  timeline_buffer = new TimelineBuffer(name, n_timeline_buffers + 1);
+  timeline_buffers[n_timeline_buffers++] = timeline_buffer;
+  return timeline_buffer;
+}
+
+void
+AddTimelineSpan(const char *name, uint64_t start, uint64_t end)
+{
+  TimelineBuffer *buffer = GetTimelineBuffer();
+  if (buffer != nullptr)
+    buffer->Push(name, start, end);
+}
+
+std::vector<TimelineThread>
+SnapshotTimeline()
+{
+  std::vector<TimelineThread> result;
+
+  const ScopeLock protect(timeline_mutex);
+  result.reserve(n_timeline_buffers);
+
+  for (unsigned i = 0; i < n_timeline_buffers; ++i) {
+    const TimelineBuffer &buffer = *timeline_buffers[i];
+    result.push_back({buffer.GetThreadName(), buffer.GetThreadId(), {}});
+    buffer.Snapshot(result.back().spans);
+  }
+
+  return result;
+}
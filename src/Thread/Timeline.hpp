@@ -0,0 +1,202 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_TIMELINE_HPP
+#define XCSOAR_THREAD_TIMELINE_HPP
+
+#include "Compiler.h"
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * A completed span of work recorded in a #TimelineBuffer.
+ */
+struct TimelineSpan {
+  /**
+   * A string literal describing the work.
+   */
+  const char *name;
+
+  /**
+   * The start time [us], see GetTimelineClock().
+   */
+  uint64_t start;
+
+  /**
+   * The duration [us].
+   */
+  uint32_t duration;
+};
+
+/**
+ * A ring buffer with the most recent #TimelineSpan objects of one
+ * thread.  Only that thread writes to it, without locking; other
+ * threads may copy it at any time with Snapshot().
+ */
+class TimelineBuffer {
+public:
+  /**
+   * The number of slots.  Must be a power of two.  Snapshot()
+   * returns at most CAPACITY-1 spans.
+   */
+  static constexpr unsigned CAPACITY = 1024;
+
+private:
+  const char *const thread_name;
+
+  const unsigned thread_id;
+
+  /**
+   * The number of spans which have been recorded so far.  The slot
+   * of span i is spans[i % CAPACITY].
+   */
+  std::atomic<unsigned> head;
+
+  /**
+   * A #TimelineSpan which may be read by Snapshot() while the owning
+   * thread overwrites it.
+   */
+  struct Slot {
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> start;
+    std::atomic<uint32_t> duration;
+  };
+
+  Slot spans[CAPACITY];
+
+public:
+  TimelineBuffer(const char *_thread_name, unsigned _thread_id)
+    :thread_name(_thread_name), thread_id(_thread_id), head(0) {}
+
+  TimelineBuffer(const TimelineBuffer &) = delete;
+  TimelineBuffer &operator=(const TimelineBuffer &) = delete;
+
+  const char *GetThreadName() const {
+    return thread_name;
+  }
+
+  unsigned GetThreadId() const {
+    return thread_id;
+  }
+
+  /**
+   * Record a span.  May only be called by the owning thread.
+   */
+  void Push(const char *name, uint64_t start, uint64_t end) {
+    const unsigned i = head.load(std::memory_order_relaxed);
+
+    /* a Snapshot() which sees one of the following stores also sees
+       the #head value which marks this slot as overwritten */
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Slot &slot = spans[i % CAPACITY];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(uint32_t(end - start), std::memory_order_relaxed);
+
+    head.store(i + 1, std::memory_order_release);
+  }
+
+  /**
+   * Append a copy of the recorded spans (oldest first) to the vector.
+   * Spans which were overwritten while being copied are omitted.
+   */
+  void Snapshot(std::vector<TimelineSpan> &dest) const;
+};
+
+/**
+ * Returns a monotonic time stamp in microseconds for
+ * TimelineBuffer::Push().
+ */
+gcc_pure
+uint64_t
+GetTimelineClock();
+
+/**
+ * Set the name which is used for the #TimelineBuffer of the calling
+ * thread.  It must be called before the thread records its first
+ * span.  The string must remain valid forever.
+ *
+ * This is called by class #Thread.
+ */
+void
+SetTimelineThreadName(const char *name);
+
+/**
+ * Returns the #TimelineBuffer of the calling thread, and creates it on
+ * the first call.  Returns nullptr if the maximum number of threads
+ * has been reached.
+ */
+TimelineBuffer *
+GetTimelineBuffer();
+
+/**
+ * Record a span in the #TimelineBuffer of the calling thread.
+ */
+void
+AddTimelineSpan(const char *name, uint64_t start, uint64_t end);
+
+/**
+ * Records the lifetime of this object as a span in the calling
+ * thread's #TimelineBuffer.  This is cheap enough to remain enabled
+ * all the time, but it is not meant for inner loops.
+ */
+class ScopeTimelineSpan {
+  const char *const name;
+  const uint64_t start;
+
+public:
+  /**
+   * @param _name a string literal
+   */
+  explicit ScopeTimelineSpan(const char *_name)
+    :name(_name), start(GetTimelineClock()) {}
+
+  ~ScopeTimelineSpan() {
+    AddTimelineSpan(name, start, GetTimelineClock());
+  }
+
+  ScopeTimelineSpan(const ScopeTimelineSpan &) = delete;
+  ScopeTimelineSpan &operator=(const ScopeTimelineSpan &) = delete;
+};
+
+/**
+ * A copy of one thread's #TimelineBuffer.
+ */
+struct TimelineThread {
+  const char *name;
+  unsigned id;
+  std::vector<TimelineSpan> spans;
+};
+
+/**
+ * Copy the spans of all threads.  This may be called at any time
+ * from any thread; the recording threads are not blocked.
+ */
+std::vector<TimelineThread>
+SnapshotTimeline();
+
+#endif
@@ -0,0 +1,99 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ProjectedShapeCache.hpp"
+
+#include <stdlib.h>
+
+/**
+ * The maximum error of the translated points [px].
+ */
+static constexpr int MAX_ERROR = 1;
+
+gcc_pure
+static PixelPoint
+GetOffset(const Projection &from, const Projection &to, const GeoPoint &p)
+{
+  return to.GeoToScreen(p) - from.GeoToScreen(p);
+}
+
+bool
+ProjectedShapeCache::IsTranslation(const Projection &current,
+                                   unsigned _thinning_level,
+                                   PixelPoint &offset) const
+{
+  if (!valid || _thinning_level != thinning_level ||
+      current.GetScale() != projection.GetScale() ||
+      current.GetScreenAngle() != projection.GetScreenAngle())
+    return false;
+
+  const GeoPoint &reference = projection.GetGeoLocation();
+  offset = GetOffset(projection, current, reference);
+
+  /* the longitude is scaled with the cosine of each point's
+     latitude, therefore the offset of a point depends on its
+     latitude; the cosine is monotonic on each hemisphere, so the
+     largest deviations are at the northern and southern edge, and at
+     the equator */
+  Angle latitudes[3] = { bounds.GetNorth(), bounds.GetSouth() };
+  unsigned n_latitudes = 2;
+  if (bounds.GetSouth().Native() < 0 && bounds.GetNorth().Native() > 0)
+    latitudes[n_latitudes++] = Angle::Zero();
+
+  for (unsigned i = 0; i < n_latitudes; ++i) {
+    const GeoPoint p(reference.longitude, latitudes[i]);
+    const PixelPoint error = GetOffset(projection, current, p) - offset;
+    if (abs(error.x) > MAX_ERROR || abs(error.y) > MAX_ERROR)
+      return false;
+  }
+
+  return true;
+}
+
+void
+ProjectedShapeCache::Begin(const Projection &_projection,
+                           const GeoBounds &_bounds,
+                           unsigned _thinning_level)
+{
+  projection = _projection;
+  bounds = _bounds;
+  thinning_level = _thinning_level;
+  valid = true;
+
+  shapes.clear();
+  shapes.push_back(0);
+  parts.clear();
+  points.clear();
+}
+
+void
+ProjectedShapeCache::EndPart(unsigned min_points)
+{
+  assert(!parts.empty());
+
+  const Part &part = parts.back();
+  if (part.count < min_points) {
+    points.resize(part.first);
+    parts.pop_back();
+  }
+}
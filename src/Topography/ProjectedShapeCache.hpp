@@ -0,0 +1,159 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_PROJECTED_SHAPE_CACHE_HPP
+#define TOPOGRAPHY_PROJECTED_SHAPE_CACHE_HPP
+
+#include "Projection/Projection.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Screen/Point.hpp"
+#include "Util/ConstBuffer.hxx"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+
+/**
+ * The screen coordinates of the visible shapes of a topography
+ * layer, for the renderer which projects the vertices on the CPU
+ * (i.e. without OpenGL).
+ *
+ * The coordinates remain usable while the projection only
+ * translates, i.e. while scale and screen angle are unchanged; then
+ * the shapes are drawn with an offset instead of projecting all
+ * vertices again.
+ */
+class ProjectedShapeCache {
+public:
+  /**
+   * One line or polygon ring.
+   */
+  struct Part {
+    unsigned first, count;
+  };
+
+private:
+  /**
+   * The projection the points were calculated with.
+   */
+  Projection projection;
+
+  /**
+   * The area covered by the cached shapes.
+   */
+  GeoBounds bounds = GeoBounds::Invalid();
+
+  unsigned thinning_level;
+
+  bool valid = false;
+
+  /**
+   * The index of each shape's first element in #parts.  The last
+   * element is the end of the last shape.
+   */
+  std::vector<unsigned> shapes;
+
+  std::vector<Part> parts;
+
+  std::vector<PixelPoint> points;
+
+public:
+  void Clear() {
+    valid = false;
+  }
+
+  /**
+   * Can the cached points be drawn with the given projection?  This
+   * is the case if it only translates the projection the points were
+   * calculated with, and the error caused by the latitude dependent
+   * longitude scale is at most one pixel.
+   *
+   * @param offset receives the offset which needs to be added to the
+   * cached points
+   */
+  gcc_pure
+  bool IsTranslation(const Projection &current, unsigned thinning_level,
+                     PixelPoint &offset) const;
+
+  /**
+   * Discard the cached points and begin adding shapes calculated
+   * with the given projection.
+   *
+   * @param bounds the area covered by the shapes
+   */
+  void Begin(const Projection &projection, const GeoBounds &bounds,
+             unsigned thinning_level);
+
+  void BeginPart() {
+    parts.push_back({unsigned(points.size()), 0});
+  }
+
+  void AddPoint(PixelPoint pt) {
+    assert(!parts.empty());
+
+    points.push_back(pt);
+    ++parts.back().count;
+  }
+
+  /**
+   * Adds the point only if it a few pixels distant from the previous
+   * one, just like ShapeRenderer::AddPointIfDistant().
+   */
+  void AddPointIfDistant(PixelPoint pt) {
+    assert(!parts.empty());
+
+    if (parts.back().count == 0 ||
+        ManhattanDistance(points.back(), pt) >= 8)
+      AddPoint(pt);
+  }
+
+  /**
+   * Finish the current part.  It is discarded if it has less than
+   * the given number of points.
+   */
+  void EndPart(unsigned min_points);
+
+  /**
+   * Finish the current shape.  This must be called for each shape,
+   * even if it has no parts.
+   */
+  void EndShape() {
+    shapes.push_back(parts.size());
+  }
+
+  gcc_pure
+  ConstBuffer<Part> GetParts(unsigned shape) const {
+    assert(valid);
+    assert(shape + 1 < shapes.size());
+
+    return {parts.data() + shapes[shape], shapes[shape + 1] - shapes[shape]};
+  }
+
+  gcc_pure
+  ConstBuffer<PixelPoint> GetPoints(const Part &part) const {
+    return {points.data() + part.first, part.count};
+  }
+};
+
+#endif
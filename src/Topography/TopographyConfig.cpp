@@ -0,0 +1,133 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TopographyConfig.hpp"
+#include "Util/StringAPI.hxx"
+#include "Util/StringCompare.hxx"
+#include "Util/StringUtil.hpp"
+#include "Asset.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+
+static bool
+IsHugeTopographyFile(const char *name)
+{
+  return StringIsEqual(name, "village_point") ||
+    StringIsEqual(name, "citysmall_point") ||
+    StringIsEqual(name, "roadsmall_point") ||
+    StringIsEqual(name, "roadsmall_line");
+}
+
+bool
+ParseTopographyLine(char *line, TopographyFileConfig &config)
+{
+  // Ignore comments (lines starting with *) and empty lines
+  if (StringIsEmpty(line) || line[0] == '*')
+    return false;
+
+  // Find first comma to extract shape filename
+  char *p = strchr(line, ',');
+  if (p == nullptr || p == line ||
+      size_t(p - line) >= sizeof(config.name))
+    // If no comma was found -> ignore this line/shapefile
+    return false;
+
+  *p = 0;
+  strcpy(config.name, line);
+
+  if (HasLittleMemory() && IsHugeTopographyFile(config.name))
+    /* hard-coded blacklist for huge files on PPC2000; those
+       devices usually have very little memory */
+    return false;
+
+  // Parse shape range
+  config.shape_range = strtod(p + 1, &p) * 1000;
+  if (*p != ',')
+    return false;
+
+  // Extract shape icon name
+  char *start = p + 1;
+  p = strchr(start, ',');
+  if (p == nullptr)
+    return false;
+
+  *p = 0;
+  CopyString(config.icon_name, start, sizeof(config.icon_name));
+
+  // Parse shape field for text display
+  config.label_field = strtol(p + 1, &p, 10) - 1;
+  if (*p != ',')
+    return false;
+
+  // Parse red component of line / shading colour
+  config.red = (uint8_t)strtol(p + 1, &p, 10);
+  if (*p != ',')
+    return false;
+
+  // Parse green component of line / shading colour
+  config.green = (uint8_t)strtol(p + 1, &p, 10);
+  if (*p != ',')
+    return false;
+
+  // Parse blue component of line / shading colour
+  config.blue = (uint8_t)strtol(p + 1, &p, 10);
+
+  // Parse pen width of lines
+  config.pen_width = 1;
+  if (*p == ',') {
+    config.pen_width = strtoul(p + 1, &p, 10);
+    if (config.pen_width < 1)
+      config.pen_width = 1;
+    else if (config.pen_width > 31)
+      config.pen_width = 31;
+  }
+
+  // Parse range for displaying labels
+  config.label_range = config.shape_range;
+  if (*p == ',')
+    config.label_range = strtod(p + 1, &p) * 1000;
+
+  // Parse range for displaying labels with "important" rendering style
+  config.important_label_range = 0;
+  if (*p == ',')
+    config.important_label_range = strtod(p + 1, &p) * 1000;
+
+  // Handle alpha component
+  // If not present at all (i.e. v6.6 or earlier file), default to 100% opaque
+  config.alpha = 255;
+  if (*p == ',') {
+    // An alpha component of shading colour is present (v6.7 or later file).
+    config.alpha = (uint8_t)strtol(p + 1, &p, 10);
+    // Ignore a totally transparent file!
+    if (config.alpha == 0)
+      return false;
+#ifndef ENABLE_OPENGL
+    // Without OpenGL ignore anything but 100% opaque
+    if (config.alpha != 255)
+      return false;
+#endif
+  }
+
+  return true;
+}
@@ -0,0 +1,67 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_CONFIG_HPP
+#define TOPOGRAPHY_CONFIG_HPP
+
+#include "TopographyPackFormat.hpp"
+
+#include <stdint.h>
+
+/**
+ * The settings of one layer, parsed from a line of "topology.tpl".
+ */
+struct TopographyFileConfig {
+  /**
+   * The shapefile name without the ".shp" suffix.
+   */
+  char name[TopographyPackFormat::NAME_SIZE];
+
+  char icon_name[23];
+
+  double shape_range, label_range, important_label_range;
+
+  /**
+   * The DBF field containing the labels, -1 for none.
+   */
+  int label_field;
+
+  uint8_t red, green, blue, alpha;
+
+  unsigned pen_width;
+};
+
+/**
+ * Parse a line of "topology.tpl".  The line format is:
+ *
+ *   filename,range,icon,field,r,g,b,pen_width,label_range,important_range,alpha
+ *
+ * The line buffer is modified.
+ *
+ * @return false if the line is a comment or malformed, or if the
+ * layer shall not be loaded on this platform
+ */
+bool
+ParseTopographyLine(char *line, TopographyFileConfig &config);
+
+#endif
@@ -22,88 +22,32 @@ Copyright_License {
 */
 
 #include "Topography/TopographyFile.hpp"
-#include "Topography/XShape.hpp"
-#include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
-
-#include <zzip/lib.h>
+#include "Thread/Timeline.hpp"
 
 #include <algorithm>
 
-TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
+TopographyFile::TopographyFile(const TopographyPackLayer &_layer,
                                double _threshold,
                                double _label_threshold,
                                double _important_label_threshold,
                                const Color _color,
-                               int _label_field,
                                ResourceId _icon, ResourceId _big_icon,
                                unsigned _pen_width)
-  :dir(_dir), first(nullptr),
-   label_field(_label_field), icon(_icon), big_icon(_big_icon),
+  :layer(_layer), shapes(_layer.n_shapes), first(nullptr),
+   icon(_icon), big_icon(_big_icon),
    pen_width(_pen_width),
    color(_color), scale_threshold(_threshold),
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold),
    cache_bounds(GeoBounds::Invalid())
 {
-  if (msShapefileOpen(&file, "rb", dir, filename, 0) == -1)
-    return;
-
-  if (file.numshapes == 0) {
-    msShapefileClose(&file);
-    return;
-  }
-
-  const auto file_bounds = ImportRect(file.bounds);
-  if (!file_bounds.Check()) {
-    /* malformed bounds */
-    msShapefileClose(&file);
-    return;
-  }
-
-  center = file_bounds.GetCenter();
-
-  shapes.ResizeDiscard(file.numshapes);
-  std::fill(shapes.begin(), shapes.end(), ShapeList(nullptr));
-
-  if (dir != nullptr)
-    ++dir->refcount;
+  for (unsigned i = 0; i < layer.n_shapes; ++i)
+    shapes[i].shape = XShape(layer, i);
 
   ++serial;
 }
 
-TopographyFile::~TopographyFile()
-{
-  if (IsEmpty())
-    return;
-
-  ClearCache();
-  msShapefileClose(&file);
-
-  if (dir != nullptr) {
-    --dir->refcount;
-    zzip_dir_free(dir);
-  }
-}
-
-void
-TopographyFile::ClearCache()
-{
-  for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i) {
-    delete i->shape;
-    i->shape = nullptr;
-  }
-
-  first = nullptr;
-}
-
-static XShape *
-LoadShape(shapefileObj *file, const GeoPoint &center, int i,
-          int label_field)
-{
-  return new XShape(file, center, i, label_field);
-}
-
 bool
 TopographyFile::Update(const WindowProjection &map_projection)
 {
@@ -120,71 +64,42 @@ TopographyFile::Update(const WindowProjection &map_projection)
     /* the cache is still fresh */
     return false;
 
+  const ScopeTimelineSpan timeline("TopographyFile::Update");
+
   cache_bounds = screenRect.Scale(2);
 
-  rectObj deg_bounds = ConvertRect(cache_bounds);
+  query.clear();
+  layer.VisitShapes(cache_bounds, [this](unsigned i){
+      query.push_back(i);
+    });
 
-  // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (msShapefileWhichShapes(&file, dir, deg_bounds, 0)) {
-  case MS_FAILURE:
-    ClearCache();
-    return false;
+  /* keep the file order, which is the drawing order */
+  std::sort(query.begin(), query.end());
 
-  case MS_DONE:
-    /* screen is outside of map bounds */
-    return false;
+  /* relink the list (protected); the serial is only incremented if
+     it has really changed */
+  const ScopeLock lock(mutex);
 
-  case MS_SUCCESS:
-    break;
-  }
-
-  assert(file.status != nullptr);
-
-  // Iterate through the shapefile entries
+  bool modified = false;
   const ShapeList **current = &first;
-  auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (!msGetBit(file.status, i)) {
-      // If the shape is outside the bounds
-      // delete the shape from the cache
-      if (it->shape != nullptr) {
-        assert(*current == it);
-
-        /* remove from linked list (protected) */
-        {
-          const ScopeLock lock(mutex);
-          *current = it->next;
-          ++serial;
-        }
-
-        /* now it's unreachable, and we can delete the XShape without
-           holding a lock */
-        delete it->shape;
-        it->shape = nullptr;
-      }
-    } else {
-      // is inside the bounds
-      if (it->shape == nullptr) {
-        assert(*current != it);
-
-        // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(&file, center, i, label_field);
-        it->next = *current;
-
-        /* insert into linked list (protected) */
-        {
-          const ScopeLock lock(mutex);
-          *current = it;
-          ++serial;
-        }
-      }
-
-      current = &it->next;
+  for (unsigned i : query) {
+    ShapeList &item = shapes[i];
+    if (*current != &item) {
+      *current = &item;
+      modified = true;
     }
+
+    current = &item.next;
   }
+
   // end of list marker
-  assert(*current == nullptr);
+  if (*current != nullptr) {
+    *current = nullptr;
+    modified = true;
+  }
+
+  if (modified)
+    ++serial;
 
   return true;
 }
@@ -192,16 +107,12 @@ TopographyFile::Update(const WindowProjection &map_projection)
 void
 TopographyFile::LoadAll()
 {
-  // Iterate through the shapefile entries
+  const ScopeLock lock(mutex);
+
   const ShapeList **current = &first;
-  auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (it->shape == nullptr)
-      // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(&file, center, i, label_field);
-    // update list pointer
-    *current = it;
-    current = &it->next;
+  for (auto &item : shapes) {
+    *current = &item;
+    current = &item.next;
   }
   // end of list marker
   *current = nullptr;
@@ -221,8 +132,6 @@ TopographyFile::GetSkipSteps(double map_scale) const
   return 1;
 }
 
-#ifdef ENABLE_OPENGL
-
 unsigned
 TopographyFile::GetThinningLevel(double map_scale) const
 {
@@ -235,19 +144,3 @@ TopographyFile::GetThinningLevel(double map_scale) const
 
   return 0;
 }
-
-unsigned
-TopographyFile::GetMinimumPointDistance(unsigned level) const
-{
-  switch (level) {
-    case 1:
-      return (unsigned)(4 * scale_threshold / 30);
-    case 2:
-      return (unsigned)(6 * scale_threshold / 30);
-    case 3:
-      return (unsigned)(9 * scale_threshold / 30);
-  }
-  return 1;
-}
-
-#endif
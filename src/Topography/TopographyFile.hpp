@@ -25,7 +25,7 @@ Copyright_License {
 #ifndef TOPOGRAPHY_HPP
 #define TOPOGRAPHY_HPP
 
-#include "shapelib/mapserver.h"
+#include "XShape.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "Util/AllocatedArray.hxx"
 #include "Util/Serial.hpp"
@@ -37,20 +37,17 @@ Copyright_License {
 #include "XShapePoint.hpp"
 #endif
 
+#include <vector>
+
 #include <assert.h>
 
 class WindowProjection;
-class XShape;
-struct zzip_dir;
 
 class TopographyFile {
   struct ShapeList {
-    const ShapeList *next;
-
-    const XShape *shape;
+    const ShapeList *next = nullptr;
 
-    ShapeList() {}
-    ShapeList(const XShape *_shape):shape(_shape) {}
+    XShape shape;
   };
 
   /**
@@ -58,19 +55,20 @@ class TopographyFile {
    */
   Serial serial;
 
-  zzip_dir *const dir;
-
-  shapefileObj file;
+  const TopographyPackLayer &layer;
 
   /**
-   * The center of shapefileObj::bounds.
+   * One list item for each shape of the layer, allocated once by the
+   * constructor; Update() only relinks them.
    */
-  GeoPoint center;
-
   AllocatedArray<ShapeList> shapes;
   const ShapeList *first;
 
-  const int label_field;
+  /**
+   * The result of the last R-tree query.  It is kept to avoid
+   * allocating memory on each Update().
+   */
+  std::vector<unsigned> query;
 
   const ResourceId icon, big_icon;
 
@@ -127,15 +125,14 @@ public:
 
     const XShape &operator*() const {
       assert(current != nullptr);
-      assert(current->shape != nullptr);
 
-      return *current->shape;
+      return current->shape;
     }
 
     const XShape *operator->() const {
       assert(current != nullptr);
 
-      return current->shape;
+      return &current->shape;
     }
 
     bool operator==(const const_iterator &other) const {
@@ -149,11 +146,10 @@ public:
 
 public:
   /**
-   * The constructor opens the given shapefile and clears the cache
-   * @param shpname The shapefile to open (*.shp)
+   * @param layer the layer in the #TopographyPack; it must outlive
+   * this object
    * @param threshold the zoom threshold for displaying this object
    * @param color The color to use for drawing, including alpha for OpenGL
-   * @param label_field The field in which the labels should be searched
    * @param icon the resource id of the icon, 0 for no icon
    * @param big_icon the resource id of the big icon, 0 for no big icon
    * @param pen_width The pen width used for line drawing
@@ -162,22 +158,16 @@ public:
    * be rendered in default style
    * @return
    */
-  TopographyFile(zzip_dir *dir, const char *shpname,
+  TopographyFile(const TopographyPackLayer &layer,
                  double threshold, double label_threshold,
                  double important_label_threshold,
                  const Color color,
-                 int label_field=-1,
                  ResourceId icon=ResourceId::Null(),
                  ResourceId big_icon=ResourceId::Null(),
                  unsigned pen_width=1);
 
   TopographyFile(const TopographyFile &) = delete;
 
-  /**
-   * The destructor clears the cache and closes the shapefile
-   */
-  ~TopographyFile();
-
   const Serial &GetSerial() const {
     assert(mutex.IsLockedByCurrent());
 
@@ -185,7 +175,7 @@ public:
   }
 
   const GeoPoint &GetCenter() const {
-    return center;
+    return layer.center;
   }
 
   bool IsEmpty() const {
@@ -260,35 +250,29 @@ public:
 #ifdef ENABLE_OPENGL
   gcc_pure
   GeoPoint ToGeoPoint(const ShapePoint &p) const {
-    return GeoPoint(center.longitude + Angle::Native(p.x),
-                    center.latitude + Angle::Native(p.y));
+    return GeoPoint(layer.center.longitude + Angle::Native(p.x),
+                    layer.center.latitude + Angle::Native(p.y));
   }
+#endif
 
   /**
-   * @return thinning level, range: 0 .. XShape::THINNING_LEVELS-1
+   * @return thinning level, range: 0 .. TopographyPackFormat::THINNING_LEVELS-1
    */
   gcc_pure
   unsigned GetThinningLevel(double map_scale) const;
 
   /**
-   * @return minimum distance between points in ShapePoint coordinates
-   */
-  gcc_pure
-  unsigned GetMinimumPointDistance(unsigned level) const;
-#endif
-
-  /**
-   * @return true if new data from the topography file has been loaded
+   * Query the shapes around the screen from the pack's R-tree.  This
+   * does not allocate memory (after the first few calls).
+   *
+   * @return true if the cache scope has been moved
    */
   bool Update(const WindowProjection &map_projection);
 
   /**
-   * Load all shapes into memory.  For debugging purposes.
+   * Link all shapes.  For debugging purposes.
    */
   void LoadAll();
-
-protected:
-  void ClearCache();
 };
 
 #endif
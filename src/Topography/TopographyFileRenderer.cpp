@@ -34,7 +34,6 @@ Copyright_License {
 #include "Util/AllocatedArray.hxx"
 #include "Util/tstring.hpp"
 #include "Geo/GeoClip.hpp"
-#include "Geo/FAISphere.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/VertexPointer.hpp"
@@ -96,6 +95,10 @@ TopographyFileRenderer::UpdateVisibleShapes(const WindowProjection &projection)
   visible_shapes.clear();
   visible_labels.clear();
 
+#ifndef ENABLE_OPENGL
+  projected_shapes.Clear();
+#endif
+
   for (const XShape &shape : file) {
     if (!visible_bounds.Overlaps(shape.get_bounds()))
       continue;
@@ -173,6 +176,88 @@ TopographyFileRenderer::PaintPoint(Canvas &canvas,
 
 #else
 
+void
+TopographyFileRenderer::UpdateProjectedShapes(const WindowProjection &projection,
+                                              unsigned level)
+{
+  /* clip polygons to the area of the visible shapes, which contains
+     the screen while this cache is valid; this avoids integer
+     overflows (as PixelPoint may store only 16 bit integers on some
+     platforms) */
+  const GeoClip clip(visible_bounds);
+  AllocatedArray<GeoPoint> geo_points;
+
+  projected_shapes.Begin(projection, visible_bounds, level);
+
+  for (const XShape *shape_p : visible_shapes) {
+    const XShape &shape = *shape_p;
+    const MS_SHAPE_TYPE type = shape.get_type();
+    if (type != MS_SHAPE_LINE && type != MS_SHAPE_POLYGON) {
+      projected_shapes.EndShape();
+      continue;
+    }
+
+    const auto lines = shape.GetLines();
+    const GeoPoint *const points = shape.GetPoints();
+
+    const uint16_t *count;
+    const uint16_t *indices = shape.GetIndices(level, count);
+
+    const GeoPoint *src = points;
+    for (unsigned l = 0; l < lines.size; ++l) {
+      unsigned n = indices != nullptr ? count[l] : lines[l];
+
+      /* copy the points of this level into the geo_points array
+         (the clipped polygon may have more points) */
+      geo_points.GrowDiscard(n * 3);
+      if (indices != nullptr) {
+        for (unsigned i = 0; i < n; ++i)
+          geo_points[i] = points[indices[i]];
+        indices += n;
+      } else {
+        std::copy_n(src, n, geo_points.begin());
+        src += n;
+      }
+
+      if (type == MS_SHAPE_POLYGON) {
+        n = clip.ClipPolygon(geo_points.begin(), geo_points.begin(), n);
+        if (n < 3)
+          continue;
+      }
+
+      projected_shapes.BeginPart();
+
+      for (unsigned i = 0; i + 1 < n; ++i)
+        projected_shapes.AddPointIfDistant(projection.GeoToScreen(geo_points[i]));
+
+      // make sure we always draw the last point
+      projected_shapes.AddPoint(projection.GeoToScreen(geo_points[n - 1]));
+
+      projected_shapes.EndPart(type == MS_SHAPE_POLYGON ? 3 : 2);
+    }
+
+    projected_shapes.EndShape();
+  }
+}
+
+inline void
+TopographyFileRenderer::PaintProjectedShape(Canvas &canvas, unsigned i,
+                                            PixelPoint offset,
+                                            bool polygon) const
+{
+  for (const auto &part : projected_shapes.GetParts(i)) {
+    shape_renderer.Begin(part.count);
+
+    for (const PixelPoint &pt : projected_shapes.GetPoints(part))
+      shape_renderer.AddPoint(pt + offset);
+
+    if (polygon)
+      shape_renderer.FinishPolygon(canvas);
+    else
+      shape_renderer.FinishPolyline(canvas);
+  }
+}
+
 inline void
 TopographyFileRenderer::PaintPoint(Canvas &canvas,
                                    const WindowProjection &projection,
@@ -234,12 +319,9 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
   // get drawing info
 
-#ifdef ENABLE_OPENGL
   const unsigned level = file.GetThinningLevel(map_scale);
-  const ShapeScalar min_distance =
-    ShapeScalar(file.GetMinimumPointDistance(level))
-    / (Layout::Scale(1) * FAISphere::REARTH);
 
+#ifdef ENABLE_OPENGL
 #ifdef HAVE_GLES
   const float *const opengl_matrix = nullptr;
 #else
@@ -255,10 +337,13 @@ TopographyFileRenderer::Paint(Canvas &canvas,
   ApplyProjection(projection, file.GetCenter());
 #endif /* !USE_GLSL */
 #else // !ENABLE_OPENGL
-  const GeoClip clip(projection.GetScreenBounds().Scale(1.1));
-  AllocatedArray<GeoPoint> geo_points;
-
-  int iskip = file.GetSkipSteps(map_scale);
+  /* reuse the screen coordinates of the previous call while the map
+     is only panned */
+  PixelPoint offset;
+  if (!projected_shapes.IsTranslation(projection, level, offset)) {
+    UpdateProjectedShapes(projection, level);
+    offset = PixelPoint(0, 0);
+  }
 #endif
 
 #ifdef ENABLE_OPENGL
@@ -270,8 +355,9 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #endif
 #endif
 
-  for (const XShape *shape_p : visible_shapes) {
-    const XShape &shape = *shape_p;
+  for (unsigned shape_index = 0; shape_index < visible_shapes.size();
+       ++shape_index) {
+    const XShape &shape = *visible_shapes[shape_index];
 
     const auto lines = shape.GetLines();
 #ifdef ENABLE_OPENGL
@@ -311,7 +397,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
         const GLushort *indices, *count;
         if (level == 0 ||
-            (indices = shape.GetIndices(level, min_distance, count)) == nullptr) {
+            (indices = shape.GetIndices(level, count)) == nullptr) {
           unsigned offset = 0;
           for (unsigned n : lines) {
             glDrawArrays(GL_LINE_STRIP, offset, n);
@@ -324,18 +410,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
           }
         }
 #else // !ENABLE_OPENGL
-        for (unsigned msize : lines) {
-        shape_renderer.Begin(msize);
-
-        const GeoPoint *end = points + msize - 1;
-        for (; points < end; ++points)
-          shape_renderer.AddPointIfDistant(projection.GeoToScreen(*points));
-
-        // make sure we always draw the last point
-        shape_renderer.AddPoint(projection.GeoToScreen(*points));
-
-        shape_renderer.FinishPolyline(canvas);
-      }
+        PaintProjectedShape(canvas, shape_index, offset, false);
 #endif
       }
       break;
@@ -344,8 +419,10 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #ifdef ENABLE_OPENGL
       {
         const GLushort *index_count;
-        const GLushort *triangles = shape.GetIndices(level, min_distance,
-                                                     index_count);
+        const GLushort *triangles = shape.GetIndices(level, index_count);
+        if (triangles == nullptr)
+          break;
+
         const unsigned n = *index_count;
 
 #ifdef GL_EXT_multi_draw_arrays
@@ -367,36 +444,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
                        triangles);
       }
 #else // !ENABLE_OPENGL
-      {
-        const GeoPoint *src = &points[0];
-        for (const unsigned n : lines) {
-          unsigned msize = n / iskip;
-
-          /* copy all polygon points into the geo_points array and
-             clip them, to avoid integer overflows (as PixelPoint may
-             store only 16 bit integers on some platforms) */
-
-          geo_points.GrowDiscard(msize * 3);
-          for (unsigned i = 0; i < msize; ++i)
-            geo_points[i] = src[i * iskip];
-
-          msize = clip.ClipPolygon(geo_points.begin(),
-                                   geo_points.begin(), msize);
-          if (msize < 3)
-            continue;
-
-          shape_renderer.Begin(msize);
-
-          for (unsigned i = 0; i < msize; ++i) {
-            GeoPoint g = geo_points[i];
-            shape_renderer.AddPointIfDistant(projection.GeoToScreen(g));
-          }
-
-          shape_renderer.FinishPolygon(canvas);
-
-          src += n;
-        }
-      }
+      PaintProjectedShape(canvas, shape_index, offset, true);
 #endif
       break;
     }
@@ -34,6 +34,7 @@ Copyright_License {
 #else
 #include "Screen/Brush.hpp"
 #include "Topography/ShapeRenderer.hpp"
+#include "Topography/ProjectedShapeCache.hpp"
 #endif
 
 #include <vector>
@@ -79,6 +80,11 @@ class TopographyFileRenderer final
 #ifdef ENABLE_OPENGL
   GLFallbackArrayBuffer *array_buffer;
   Serial array_buffer_serial;
+#else
+  /**
+   * The screen coordinates of #visible_shapes.
+   */
+  ProjectedShapeCache projected_shapes;
 #endif
 
 public:
@@ -119,6 +125,12 @@ private:
   virtual void SurfaceCreated() override;
   virtual void SurfaceDestroyed() override;
 #else
+  void UpdateProjectedShapes(const WindowProjection &projection,
+                             unsigned level);
+
+  void PaintProjectedShape(Canvas &canvas, unsigned i, PixelPoint offset,
+                           bool polygon) const;
+
   void PaintPoint(Canvas &canvas, const WindowProjection &projection,
                   const unsigned short *lines, const unsigned short *end_lines,
                   const GeoPoint *points) const;
@@ -23,28 +23,90 @@ Copyright_License {
 
 #include "Topography/TopographyGlue.hpp"
 #include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyPack.hpp"
+#include "Topography/TopographyPackWriter.hpp"
 #include "Language/Language.hpp"
 #include "Profile/Profile.hpp"
 #include "LogFile.hpp"
 #include "Operation/Operation.hpp"
-#include "IO/MapFile.hpp"
+#include "IO/FileCache.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
+#include "Screen/Layout.hpp"
+
+static const TCHAR *const topography_cache_name = _T("topography");
+
+/**
+ * Open the cached pack of the map file, or convert the map file's
+ * shapefiles and cache the result.
+ */
+static bool
+LoadTopographyPack(TopographyPack &pack, Path path, ZipArchive &archive,
+                   FileCache *cache, OperationEnvironment &operation)
+{
+  const unsigned layout_scale = Layout::Scale(1u);
+
+  if (cache != nullptr) {
+    FILE *file = cache->Load(topography_cache_name, path);
+    if (file != nullptr) {
+      const long offset = ftell(file);
+      fclose(file);
+
+      if (offset > 0 &&
+          pack.Open(cache->CreatePath(topography_cache_name), offset,
+                    layout_scale))
+        return true;
+
+      LogFormat("Discarding topography cache");
+    }
+  }
+
+  std::vector<uint8_t> buffer;
+
+  {
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+    BuildTopographyPack(archive.get(), reader, layout_scale, buffer,
+                        operation);
+  }
+
+  if (cache != nullptr) {
+    FILE *file = cache->Save(topography_cache_name, path);
+    if (file != nullptr) {
+      const long offset = ftell(file);
+      if (offset > 0 && WriteTopographyPack(file, buffer)) {
+        if (cache->Commit(topography_cache_name, file) &&
+            pack.Open(cache->CreatePath(topography_cache_name), offset,
+                      layout_scale))
+          return true;
+      } else
+        cache->Cancel(topography_cache_name, file);
+    }
+  }
+
+  /* no cache: keep the converted pack in memory */
+  return pack.Open(std::move(buffer), layout_scale);
+}
 
 /**
  * Load topography from the map file (ZIP), load the other files from
  * the same ZIP file.
  */
 static bool
-LoadConfiguredTopographyZip(TopographyStore &store,
+LoadConfiguredTopographyZip(TopographyStore &store, FileCache *cache,
                             OperationEnvironment &operation)
 try {
-  auto archive = OpenMapFile();
-  if (!archive)
+  const auto path = Profile::GetPath(ProfileKeys::MapFile);
+  if (path.IsNull())
+    return false;
+
+  ZipArchive archive(path);
+
+  TopographyPack pack;
+  if (!LoadTopographyPack(pack, path, archive, cache, operation))
     return false;
 
-  ZipLineReaderA reader(archive->get(), "topology.tpl");
-  store.Load(operation, reader, nullptr, archive->get());
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+  store.Load(operation, reader, std::move(pack));
   return true;
 } catch (const std::runtime_error &e) {
   LogError("No topography in map file", e);
@@ -52,11 +114,11 @@ try {
 }
 
 bool
-LoadConfiguredTopography(TopographyStore &store,
+LoadConfiguredTopography(TopographyStore &store, FileCache *cache,
                          OperationEnvironment &operation)
 {
   LogFormat("Loading Topography File...");
   operation.SetText(_("Loading Topography File..."));
 
-  return LoadConfiguredTopographyZip(store, operation);
+  return LoadConfiguredTopographyZip(store, cache, operation);
 }
@@ -25,10 +25,19 @@ Copyright_License {
 #define TOPOGRAPHY_GLUE_H
 
 class TopographyStore;
+class FileCache;
 class OperationEnvironment;
 
+/**
+ * Load the topography of the configured map file.  The shapefiles
+ * are converted to a #TopographyPack once and stored in the cache;
+ * later calls map the cached pack.
+ *
+ * @param cache the cache for the converted pack; nullptr to convert
+ * into memory each time
+ */
 bool
-LoadConfiguredTopography(TopographyStore &store,
+LoadConfiguredTopography(TopographyStore &store, FileCache *cache,
                          OperationEnvironment &operation);
 
 #endif
@@ -0,0 +1,271 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TopographyPack.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/Path.hpp"
+#include "Util/StringAPI.hxx"
+#include "shapelib/mapserver.h"
+
+using namespace TopographyPackFormat;
+
+TopographyPack::TopographyPack() = default;
+
+TopographyPack::TopographyPack(TopographyPack &&other)
+{
+  *this = std::move(other);
+}
+
+TopographyPack::~TopographyPack() = default;
+
+TopographyPack &
+TopographyPack::operator=(TopographyPack &&other)
+{
+  /* moving the buffer keeps its address, so the layer pointers stay
+     valid */
+  mapping = std::move(other.mapping);
+  buffer = std::move(other.buffer);
+  layers = other.layers;
+  other.layers.clear();
+  return *this;
+}
+
+void
+TopographyPack::Close()
+{
+  layers.clear();
+  mapping.reset();
+  buffer.clear();
+  buffer.shrink_to_fit();
+}
+
+bool
+TopographyPack::Open(Path path, size_t offset, unsigned layout_scale)
+{
+  Close();
+
+  offset = Align(offset);
+
+  std::unique_ptr<FileMapping> m(new FileMapping(path));
+  if (m->error() || m->size() < offset ||
+      !Parse((const uint8_t *)m->at(offset), m->size() - offset,
+             layout_scale))
+    return false;
+
+  mapping = std::move(m);
+  return true;
+}
+
+bool
+TopographyPack::Open(std::vector<uint8_t> &&_buffer, unsigned layout_scale)
+{
+  Close();
+
+  if (!Parse(_buffer.data(), _buffer.size(), layout_scale))
+    return false;
+
+  buffer = std::move(_buffer);
+  return true;
+}
+
+const TopographyPackLayer *
+TopographyPack::FindLayer(const char *name) const
+{
+  for (const auto &layer : layers)
+    if (StringIsEqual(layer.name, name))
+      return &layer;
+
+  return nullptr;
+}
+
+/**
+ * Returns a pointer to the given section, or nullptr if it does not
+ * fit into the pack.
+ */
+template<typename T>
+static const T *
+GetSection(const uint8_t *data, size_t size, uint64_t offset, uint64_t count)
+{
+  if (offset % alignof(T) != 0 || offset > size ||
+      count > (size - offset) / sizeof(T))
+    return nullptr;
+
+  return (const T *)(const void *)(data + offset);
+}
+
+/**
+ * Verify that the R-tree has exactly the structure produced by the
+ * writer; this bounds the height of the tree and guarantees that each
+ * shape is reachable.
+ */
+gcc_pure
+static bool
+CheckTree(const TopographyPackLayer &layer)
+{
+  if (layer.n_shapes == 0)
+    return layer.n_nodes == 0;
+
+  for (unsigned i = 0; i < layer.n_shapes; ++i)
+    if (layer.entries[i] >= layer.n_shapes)
+      return false;
+
+  unsigned child_begin = 0, child_count = layer.n_shapes;
+  unsigned level_begin = 0;
+  unsigned level_size = (child_count + NODE_CAPACITY - 1) / NODE_CAPACITY;
+  if (layer.n_leaf_nodes != level_size)
+    return false;
+
+  for (unsigned height = 1;; ++height) {
+    if (height > MAX_TREE_HEIGHT ||
+        level_size > layer.n_nodes - level_begin)
+      return false;
+
+    unsigned next = child_begin;
+    for (unsigned i = level_begin; i < level_begin + level_size; ++i) {
+      const auto &node = layer.nodes[i];
+      if (node.first != next || node.count == 0 ||
+          node.count > NODE_CAPACITY)
+        return false;
+
+      next += node.count;
+    }
+
+    if (next != child_begin + child_count)
+      return false;
+
+    if (level_size == 1)
+      return level_begin + 1 == layer.n_nodes;
+
+    child_begin = level_begin;
+    child_count = level_size;
+    level_begin += level_size;
+    level_size = (level_size + NODE_CAPACITY - 1) / NODE_CAPACITY;
+  }
+}
+
+/**
+ * Verify that all references of a shape are within the layer's
+ * sections.  The index values themselves are not checked, because
+ * that would mean reading the whole pack.
+ */
+gcc_pure
+static bool
+CheckShape(const TopographyPackLayer &layer,
+           const TopographyPackLayer::Shape &shape,
+           unsigned n_lines, unsigned n_points, unsigned n_indices,
+           unsigned n_labels)
+{
+  if (shape.n_lines > MAX_LINES || shape.first_line > n_lines ||
+      shape.n_lines > n_lines - shape.first_line)
+    return false;
+
+  unsigned shape_points = 0;
+  for (unsigned i = 0; i < shape.n_lines; ++i)
+    shape_points += layer.lines[shape.first_line + i];
+
+  if (shape.first_point > n_points ||
+      shape_points > n_points - shape.first_point)
+    return false;
+
+  if (shape.label != NONE && shape.label >= n_labels)
+    return false;
+
+  for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+    const uint32_t i = shape.indices[level];
+    if (i == NONE)
+      continue;
+
+    const unsigned n_counts = shape.GetIndexCountSize();
+    if (i > n_indices || n_counts > n_indices - i)
+      return false;
+
+    unsigned total = 0;
+    for (unsigned j = 0; j < n_counts; ++j)
+      total += layer.indices[i + j];
+
+    if (total > n_indices - i - n_counts)
+      return false;
+  }
+
+  return true;
+}
+
+bool
+TopographyPack::Parse(const uint8_t *data, size_t size,
+                      unsigned layout_scale)
+{
+  const auto *header = GetSection<Header>(data, size, 0, 1);
+  if (header == nullptr ||
+      header->magic != MAGIC ||
+      header->version != VERSION ||
+      header->char_size != sizeof(TCHAR) ||
+      header->point_size != sizeof(Point) ||
+      header->layout_scale != layout_scale ||
+      header->n_layers > MAX_LAYERS)
+    return false;
+
+  const auto *src = GetSection<Layer>(data, size, sizeof(*header),
+                                      header->n_layers);
+  if (src == nullptr)
+    return false;
+
+  decltype(layers) result;
+  for (const auto *end = src + header->n_layers; src != end; ++src) {
+    if (src->name[NAME_SIZE - 1] != 0)
+      return false;
+
+    TopographyPackLayer layer;
+    layer.name = src->name;
+    layer.center = src->center;
+    layer.n_shapes = src->n_shapes;
+    layer.n_nodes = src->n_nodes;
+    layer.n_leaf_nodes = src->n_leaf_nodes;
+    layer.shapes = GetSection<Shape>(data, size, src->shapes, src->n_shapes);
+    layer.nodes = GetSection<Node>(data, size, src->nodes, src->n_nodes);
+    layer.entries = GetSection<uint32_t>(data, size, src->entries,
+                                         src->n_shapes);
+    layer.lines = GetSection<uint16_t>(data, size, src->lines, src->n_lines);
+    layer.points = GetSection<Point>(data, size, src->points, src->n_points);
+    layer.indices = GetSection<uint16_t>(data, size, src->indices,
+                                         src->n_indices);
+    layer.labels = GetSection<TCHAR>(data, size, src->labels, src->n_labels);
+
+    if (layer.shapes == nullptr || layer.nodes == nullptr ||
+        layer.entries == nullptr || layer.lines == nullptr ||
+        layer.points == nullptr || layer.indices == nullptr ||
+        layer.labels == nullptr ||
+        (src->n_labels > 0 && layer.labels[src->n_labels - 1] != 0) ||
+        !CheckTree(layer))
+      return false;
+
+    for (unsigned i = 0; i < layer.n_shapes; ++i)
+      if (!CheckShape(layer, layer.shapes[i], src->n_lines, src->n_points,
+                      src->n_indices, src->n_labels))
+        return false;
+
+    result.append(layer);
+  }
+
+  layers = result;
+  return true;
+}
@@ -0,0 +1,164 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_PACK_HPP
+#define TOPOGRAPHY_PACK_HPP
+
+#include "TopographyPackFormat.hpp"
+#include "Util/StaticArray.hxx"
+#include "Util/Macros.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <memory>
+
+#include <assert.h>
+#include <tchar.h>
+
+class Path;
+class FileMapping;
+
+/**
+ * A read-only view of one layer in a #TopographyPack.
+ */
+struct TopographyPackLayer {
+  typedef TopographyPackFormat::Shape Shape;
+  typedef TopographyPackFormat::Node Node;
+  typedef TopographyPackFormat::Point Point;
+
+  const char *name;
+
+  GeoPoint center;
+
+  const Shape *shapes;
+  unsigned n_shapes;
+
+  const Node *nodes;
+  unsigned n_nodes, n_leaf_nodes;
+
+  const uint32_t *entries;
+  const uint16_t *lines;
+  const Point *points;
+  const uint16_t *indices;
+  const TCHAR *labels;
+
+  bool IsEmpty() const {
+    return n_shapes == 0;
+  }
+
+  /**
+   * Invoke the function for the number of each shape whose bounds
+   * overlap the given rectangle, in no particular order.  This does
+   * not allocate memory.
+   */
+  template<typename F>
+  void VisitShapes(const GeoBounds &bounds, F &&f) const {
+    using TopographyPackFormat::NODE_CAPACITY;
+    using TopographyPackFormat::MAX_TREE_HEIGHT;
+
+    if (n_nodes == 0)
+      return;
+
+    /* depth-first search; each level pushes at most all children of
+       one node */
+    unsigned stack[MAX_TREE_HEIGHT * NODE_CAPACITY];
+    unsigned n = 0;
+    stack[n++] = n_nodes - 1;
+
+    while (n > 0) {
+      const Node &node = nodes[stack[--n]];
+      if (!bounds.Overlaps(node.bounds))
+        continue;
+
+      if (&node < nodes + n_leaf_nodes) {
+        for (unsigned i = node.first, end = i + node.count; i != end; ++i)
+          if (bounds.Overlaps(shapes[entries[i]].bounds))
+            f(entries[i]);
+      } else {
+        for (unsigned i = node.first, end = i + node.count; i != end; ++i) {
+          assert(n < ARRAY_SIZE(stack));
+          stack[n++] = i;
+        }
+      }
+    }
+  }
+};
+
+/**
+ * A topography pack (see TopographyPackFormat.hpp) which is either
+ * mapped from a file or owned in memory.
+ */
+class TopographyPack {
+  std::unique_ptr<FileMapping> mapping;
+  std::vector<uint8_t> buffer;
+
+  StaticArray<TopographyPackLayer, TopographyPackFormat::MAX_LAYERS> layers;
+
+public:
+  TopographyPack();
+  TopographyPack(TopographyPack &&);
+  ~TopographyPack();
+
+  TopographyPack &operator=(TopographyPack &&);
+
+  bool IsDefined() const {
+    return mapping != nullptr || !buffer.empty();
+  }
+
+  /**
+   * Map a pack file into memory.
+   *
+   * @param offset the file position at which the pack was written
+   * (see WriteTopographyPack()); it is aligned internally
+   * @param layout_scale the expected Layout::Scale(1) value; a pack
+   * built for another scale is rejected
+   * @return false if the file could not be mapped or is malformed
+   */
+  bool Open(Path path, size_t offset, unsigned layout_scale);
+
+  /**
+   * Take ownership of a pack built in memory.
+   */
+  bool Open(std::vector<uint8_t> &&_buffer, unsigned layout_scale);
+
+  void Close();
+
+  unsigned size() const {
+    return layers.size();
+  }
+
+  const TopographyPackLayer &operator[](unsigned i) const {
+    return layers[i];
+  }
+
+  /**
+   * Look up a layer by its shapefile name (without ".shp").
+   */
+  gcc_pure
+  const TopographyPackLayer *FindLayer(const char *name) const;
+
+private:
+  bool Parse(const uint8_t *data, size_t size, unsigned layout_scale);
+};
+
+#endif
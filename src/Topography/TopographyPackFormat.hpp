@@ -0,0 +1,210 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_PACK_FORMAT_HPP
+#define TOPOGRAPHY_PACK_FORMAT_HPP
+
+#include "Geo/GeoBounds.hpp"
+#include "shapelib/mapserver.h"
+
+#ifdef ENABLE_OPENGL
+#include "Topography/XShapePoint.hpp"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The on-disk layout of a topography pack: all layers of a map's
+ * "topology.tpl" in one flat file which can be mapped into memory
+ * and used without parsing.  Each layer has a packed R-tree of its
+ * shapes and the thinned indices of all zoom levels; OpenGL builds
+ * store polygons as triangle strips.
+ *
+ * All offsets are relative to the beginning of the #Header and
+ * aligned to #ALIGNMENT bytes.  The format is native endian; it is
+ * a cache, not an exchange format.
+ */
+namespace TopographyPackFormat {
+
+static constexpr uint32_t MAGIC = 0x54505831;
+static constexpr uint32_t VERSION = 2;
+
+static constexpr size_t ALIGNMENT = 16;
+
+static constexpr unsigned MAX_LAYERS = 32;
+static constexpr unsigned NAME_SIZE = 60;
+
+/**
+ * The maximum number of lines of one shape; the rest is discarded.
+ */
+static constexpr unsigned MAX_LINES = 32;
+
+/**
+ * The maximum number of points of one line; the rest is discarded.
+ */
+static constexpr unsigned MAX_LINE_POINTS = 16384;
+
+static constexpr unsigned THINNING_LEVELS = 4;
+
+/**
+ * The maximum number of children of an R-tree node.
+ */
+static constexpr unsigned NODE_CAPACITY = 16;
+
+/**
+ * The maximum height of the R-tree; enough for 2^32 shapes.
+ */
+static constexpr unsigned MAX_TREE_HEIGHT = 8;
+
+/**
+ * Marks an absent label or index list.
+ */
+static constexpr uint32_t NONE = ~uint32_t(0);
+
+#ifdef ENABLE_OPENGL
+/**
+ * OpenGL builds store points relative to Layer::center.
+ */
+typedef ShapePoint Point;
+#else
+typedef GeoPoint Point;
+#endif
+
+static constexpr size_t
+Align(size_t offset)
+{
+  return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+
+  /**
+   * sizeof(TCHAR) of the labels.
+   */
+  uint32_t char_size;
+
+  /**
+   * sizeof(Point), which differs between OpenGL and other builds.
+   */
+  uint32_t point_size;
+
+  /**
+   * The Layout::Scale(1) value the thinned indices were built for.
+   */
+  uint32_t layout_scale;
+
+  uint32_t n_layers;
+
+  /* followed by Layer[n_layers] */
+};
+
+struct Layer {
+  /**
+   * The shapefile name without the ".shp" suffix, null-terminated.
+   */
+  char name[NAME_SIZE];
+
+  uint32_t n_shapes;
+
+  /**
+   * The center of the shapefile's bounds.
+   */
+  GeoPoint center;
+
+  uint32_t n_nodes, n_leaf_nodes;
+  uint32_t n_lines, n_points, n_indices, n_labels;
+
+  /**
+   * Section offsets: Shape[n_shapes], Node[n_nodes],
+   * uint32_t[n_shapes] (shape numbers in R-tree leaf order),
+   * uint16_t[n_lines], Point[n_points], uint16_t[n_indices] and
+   * TCHAR[n_labels].
+   */
+  uint64_t shapes, nodes, entries, lines, points, indices, labels;
+};
+
+struct Shape {
+  GeoBounds bounds;
+
+  /**
+   * Index of the first element in Layer::lines and Layer::points.
+   */
+  uint32_t first_line, first_point;
+
+  /**
+   * Index of the null-terminated label in Layer::labels, or #NONE.
+   */
+  uint32_t label;
+
+  /**
+   * Index of each thinning level's index list in Layer::indices,
+   * or #NONE.  The list starts with GetIndexCountSize() counts,
+   * followed by the indices.
+   */
+  uint32_t indices[THINNING_LEVELS];
+
+  /**
+   * The MS_SHAPE_TYPE.
+   */
+  uint8_t type;
+
+  uint8_t n_lines;
+
+  uint16_t reserved;
+
+  /**
+   * The number of counts at the beginning of an index list: the
+   * number of indices of each line, except for OpenGL polygons,
+   * which have only the number of triangle strip indices.
+   */
+  unsigned GetIndexCountSize() const {
+#ifdef ENABLE_OPENGL
+    return type == MS_SHAPE_POLYGON ? 1 : n_lines;
+#else
+    return n_lines;
+#endif
+  }
+};
+
+/**
+ * A node of a layer's R-tree.  The leaf nodes come first, followed
+ * by the levels above them; the root is the last node.
+ */
+struct Node {
+  GeoBounds bounds;
+
+  /**
+   * The first child: an index in Layer::entries for leaf nodes,
+   * else an index in Layer::nodes.
+   */
+  uint32_t first;
+
+  uint32_t count;
+};
+
+}
+
+#endif
@@ -0,0 +1,656 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TopographyPackWriter.hpp"
+#include "TopographyPackFormat.hpp"
+#include "TopographyConfig.hpp"
+#include "Convert.hpp"
+#include "shapelib/mapserver.h"
+#include "shapelib/mapshape.h"
+#include "IO/LineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/AllocatedString.hxx"
+#include "Util/StringAPI.hxx"
+#include "Util/StringUtil.hpp"
+#include "Util/UTF8.hpp"
+#include "Util/ScopeExit.hxx"
+
+#include "Geo/FAISphere.hpp"
+
+#ifdef ENABLE_OPENGL
+#include "Screen/OpenGL/Triangulate.hpp"
+#endif
+
+#ifdef _UNICODE
+#include "Util/ConvertString.hpp"
+#endif
+
+#include <algorithm>
+#include <numeric>
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <tchar.h>
+
+using namespace TopographyPackFormat;
+
+namespace {
+
+/**
+ * The sections of one layer while it is being built.
+ */
+struct LayerData {
+  GeoPoint center;
+
+  std::vector<Shape> shapes;
+  std::vector<Node> nodes;
+  unsigned n_leaf_nodes = 0;
+  std::vector<uint32_t> entries;
+  std::vector<uint16_t> lines;
+  std::vector<Point> points;
+  std::vector<uint16_t> indices;
+  std::vector<TCHAR> labels;
+};
+
+}
+
+static AllocatedString<TCHAR>
+ImportLabel(const char *src)
+{
+  if (src == nullptr)
+    return nullptr;
+
+  src = StripLeft(src);
+  if (StringIsEqual(src, "RAILWAY STATION") ||
+      StringIsEqual(src, "RAILROAD STATION") ||
+      StringIsEqual(src, "UNK"))
+    return nullptr;
+
+#ifdef _UNICODE
+  return AllocatedString<TCHAR>::Donate(ConvertUTF8ToWide(src));
+#else
+  if (!ValidateUTF8(src))
+    return nullptr;
+
+  return AllocatedString<TCHAR>::Duplicate(src);
+#endif
+}
+
+/**
+ * Append a label to the label section.
+ *
+ * @return the label's index or #NONE
+ */
+static uint32_t
+AddLabel(std::vector<TCHAR> &labels, const char *src)
+{
+  const auto label = ImportLabel(src);
+  if (label.IsNull())
+    return NONE;
+
+  const uint32_t index = labels.size();
+  const TCHAR *s = label.c_str();
+  labels.insert(labels.end(), s, s + StringLength(s) + 1);
+  return index;
+}
+
+/**
+ * Returns the minimum number of points for each line of this shape
+ * type.  Returns -1 if the shape type is not supported.
+ */
+gcc_const
+static int
+GetMinPointsForShapeType(int shapelib_type)
+{
+  switch (shapelib_type) {
+  case MS_SHAPE_POINT:
+    return 1;
+
+  case MS_SHAPE_LINE:
+    return 2;
+
+  case MS_SHAPE_POLYGON:
+    return 3;
+
+  default:
+    /* not supported */
+    return -1;
+  }
+}
+
+/**
+ * @return minimum distance between points in pixels
+ */
+gcc_const
+static unsigned
+GetMinimumPointDistance(double scale_threshold, unsigned level)
+{
+  switch (level) {
+    case 1:
+      return (unsigned)(4 * scale_threshold / 30);
+    case 2:
+      return (unsigned)(6 * scale_threshold / 30);
+    case 3:
+      return (unsigned)(9 * scale_threshold / 30);
+  }
+  return 1;
+}
+
+#ifndef ENABLE_OPENGL
+
+/**
+ * The "manhattan distance" of two vertices in radians.  Like the
+ * OpenGL vertices, the longitude is not scaled by the cosine of the
+ * latitude.
+ */
+gcc_const
+static double
+ManhattanDistance(const GeoPoint &a, const GeoPoint &b)
+{
+  return fabs((a.longitude - b.longitude).Native()) +
+    fabs((a.latitude - b.latitude).Native());
+}
+
+#endif
+
+/**
+ * Append the indices of a line shape, leaving out points which are
+ * closer than min_distance to their predecessor.
+ *
+ * @return the index of the list or #NONE
+ */
+static uint32_t
+AddLineIndices(std::vector<uint16_t> &dest,
+               const uint16_t *lines, unsigned num_lines,
+               const Point *points, double min_distance)
+{
+  const unsigned num_points = std::accumulate(lines, lines + num_lines, 0u);
+  if (num_points <= 2)
+    return NONE;  // line cannot be simplified, so don't create indices
+
+  const uint32_t result = dest.size();
+  dest.resize(result + num_lines + num_points);
+
+  uint16_t *idx_count = &dest[result];
+  uint16_t *idx = idx_count + num_lines;
+
+  const uint16_t *end_l = lines + num_lines;
+  const Point *p = points;
+  unsigned i = 0;
+  for (const uint16_t *l = lines; l < end_l; l++) {
+    assert(*l >= 2);
+    const Point *end_p = p + *l - 1;
+    // always add first point
+    *idx++ = i;
+    p++; i++;
+    const uint16_t *after_first_idx = idx;
+    // add points if they are not too close to the previous point
+    for (; p < end_p; p++, i++)
+      if (ManhattanDistance(points[idx[-1]], *p) >= min_distance)
+        *idx++ = i;
+    // remove points from behind if they are too close to the end point
+    while (idx > after_first_idx &&
+           ManhattanDistance(points[idx[-1]], *p) < min_distance)
+      idx--;
+    // always add last point
+    *idx++ = i;
+    p++; i++;
+    *idx_count++ = idx - after_first_idx + 1;
+  }
+
+  dest.resize(idx - dest.data());
+  return result;
+}
+
+#ifdef ENABLE_OPENGL
+
+/**
+ * Append the triangle strip of a polygon shape.
+ *
+ * @return the index of the list
+ */
+static uint32_t
+AddPolygonIndices(std::vector<uint16_t> &dest,
+                  const uint16_t *lines, unsigned num_lines,
+                  const ShapePoint *points, ShapeScalar min_distance)
+{
+  const unsigned num_points = std::accumulate(lines, lines + num_lines, 0u);
+
+  const uint32_t result = dest.size();
+  dest.resize(result + 1 + 3 * (num_points - 2) + 2 * (num_lines - 1));
+
+  uint16_t *idx_count = &dest[result];
+  uint16_t *idx = idx_count + 1;
+
+  *idx_count = 0;
+  const ShapePoint *pt = points;
+  for (unsigned i = 0; i < num_lines; i++) {
+    unsigned count = PolygonToTriangles(pt, lines[i], idx + *idx_count,
+                                        min_distance);
+    if (i > 0) {
+      const GLushort offset = pt - points;
+      const unsigned max_idx_count = *idx_count + count;
+      for (unsigned j = *idx_count; j < max_idx_count; j++)
+        idx[j] += offset;
+    }
+    *idx_count += count;
+    pt += lines[i];
+  }
+  *idx_count = TriangleToStrip(idx, *idx_count, num_points, num_lines);
+
+  dest.resize(result + 1 + *idx_count);
+  return result;
+}
+
+#endif
+
+/**
+ * Read one shape and append it to the layer.
+ *
+ * @return false if the shape is malformed or not supported
+ */
+static bool
+ImportShape(shapefileObj &file, int i, const TopographyFileConfig &config,
+            unsigned layout_scale, LayerData &layer)
+{
+  shapeObj shape;
+  msInitShape(&shape);
+  AtScopeExit(&shape) { msFreeShape(&shape); };
+  msSHPReadShape(file.hSHP, i, &shape);
+
+  Shape record;
+  record.bounds = ImportRect(shape.bounds);
+  if (!record.bounds.Check())
+    /* malformed bounds */
+    return false;
+
+  const int min_points = GetMinPointsForShapeType(shape.type);
+  if (min_points < 0)
+    /* not supported */
+    return false;
+
+  record.type = shape.type;
+  record.n_lines = 0;
+  record.reserved = 0;
+  record.first_line = layer.lines.size();
+  record.first_point = layer.points.size();
+
+  const unsigned input_lines = std::min((unsigned)shape.numlines,
+                                        MAX_LINES);
+  for (unsigned l = 0; l < input_lines; ++l) {
+    if (shape.line[l].numpoints < min_points)
+      /* malformed line */
+      continue;
+
+    const unsigned num_points = std::min((unsigned)shape.line[l].numpoints,
+                                         MAX_LINE_POINTS);
+    layer.lines.push_back(num_points);
+    ++record.n_lines;
+
+    const pointObj *src = shape.line[l].point;
+    for (unsigned j = 0; j < num_points; ++j, ++src) {
+#ifdef ENABLE_OPENGL
+      /* OpenGL: make the points relative to the map's boundary
+         center */
+      const GeoPoint vertex(Angle::Degrees(src->x), Angle::Degrees(src->y));
+      const GeoPoint relative = vertex - layer.center;
+
+      layer.points.emplace_back(ShapeScalar(relative.longitude.Native()),
+                                ShapeScalar(relative.latitude.Native()));
+#else
+      layer.points.emplace_back(Angle::Degrees(src->x),
+                                Angle::Degrees(src->y));
+#endif
+    }
+  }
+
+  if (record.n_lines == 0)
+    /* malformed shape */
+    return false;
+
+  record.label = config.label_field >= 0
+    ? AddLabel(layer.labels,
+               msDBFReadStringAttribute(file.hDBF, i, config.label_field))
+    : NONE;
+
+  std::fill_n(record.indices, THINNING_LEVELS, NONE);
+
+  const uint16_t *lines = &layer.lines[record.first_line];
+  const Point *points = &layer.points[record.first_point];
+
+  for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+    const double min_distance =
+      GetMinimumPointDistance(config.shape_range, level)
+      / (layout_scale * FAISphere::REARTH);
+
+#ifdef ENABLE_OPENGL
+    if (record.type == MS_SHAPE_LINE) {
+      /* level 0 lines are drawn without indices */
+      if (level > 0)
+        record.indices[level] = AddLineIndices(layer.indices,
+                                               lines, record.n_lines,
+                                               points, min_distance);
+    } else if (record.type == MS_SHAPE_POLYGON)
+      record.indices[level] = AddPolygonIndices(layer.indices,
+                                                lines, record.n_lines,
+                                                points,
+                                                ShapeScalar(min_distance));
+#else
+    /* without OpenGL, polygon rings are thinned just like lines;
+       level 0 shapes are drawn without indices */
+    if (level > 0 && (record.type == MS_SHAPE_LINE ||
+                      record.type == MS_SHAPE_POLYGON))
+      record.indices[level] = AddLineIndices(layer.indices,
+                                             lines, record.n_lines,
+                                             points, min_distance);
+#endif
+  }
+
+  layer.shapes.push_back(record);
+  return true;
+}
+
+static void
+Extend(GeoBounds &bounds, const GeoBounds &other)
+{
+  bounds.Extend(other.GetNorthWest());
+  bounds.Extend(other.GetSouthEast());
+}
+
+/**
+ * Order the items for the "Sort-Tile-Recursive" R-tree packing: sort
+ * by longitude, cut into vertical slices of whole nodes and sort each
+ * slice by latitude.
+ */
+template<typename T, typename F>
+static void
+SortTileRecursive(T *begin, T *end, F get_center)
+{
+  const size_t n = end - begin;
+  const size_t n_nodes = (n + NODE_CAPACITY - 1) / NODE_CAPACITY;
+  const size_t n_slices = (size_t)ceil(sqrt((double)n_nodes));
+  const size_t slice_size = n_slices * NODE_CAPACITY;
+
+  std::sort(begin, end, [&get_center](const T &a, const T &b){
+      return get_center(a).longitude < get_center(b).longitude;
+    });
+
+  for (T *i = begin; i < end; i += slice_size)
+    std::sort(i, std::min(i + slice_size, end),
+              [&get_center](const T &a, const T &b){
+                return get_center(a).latitude < get_center(b).latitude;
+              });
+}
+
+/**
+ * Append one R-tree level with a node for each #NODE_CAPACITY
+ * children.
+ */
+template<typename F>
+static void
+AddLevel(std::vector<Node> &nodes, unsigned first, unsigned count,
+         F get_bounds)
+{
+  for (unsigned i = 0; i < count; i += NODE_CAPACITY) {
+    Node node;
+    node.first = first + i;
+    node.count = std::min(count - i, NODE_CAPACITY);
+    node.bounds = get_bounds(node.first);
+    for (unsigned j = 1; j < node.count; ++j)
+      Extend(node.bounds, get_bounds(node.first + j));
+
+    nodes.push_back(node);
+  }
+}
+
+/**
+ * Renumber the nodes and entries level by level, starting at the
+ * root, so the children of each level are contiguous and in the
+ * order of their parents.  This undoes the gaps left by sorting the
+ * upper levels, and allows the reader to verify the structure
+ * cheaply.
+ *
+ * @param levels the first node of each level, from the leaves to the
+ * root, followed by the number of nodes
+ */
+static void
+RenumberTree(LayerData &layer, const std::vector<unsigned> &levels)
+{
+  const auto &old_nodes = layer.nodes;
+  std::vector<Node> nodes(old_nodes.size());
+  std::vector<uint32_t> entries;
+  entries.reserve(layer.entries.size());
+
+  /* the old indices of the current level's nodes, in the new order */
+  std::vector<unsigned> order{unsigned(old_nodes.size() - 1)};
+  std::vector<unsigned> children;
+
+  for (unsigned level = levels.size() - 1; level-- > 0;) {
+    children.clear();
+
+    for (unsigned i = 0; i < order.size(); ++i) {
+      Node node = old_nodes[order[i]];
+      const unsigned first = node.first, end = first + node.count;
+
+      if (level > 0) {
+        node.first = levels[level - 1] + children.size();
+        for (unsigned j = first; j < end; ++j)
+          children.push_back(j);
+      } else {
+        node.first = entries.size();
+        for (unsigned j = first; j < end; ++j)
+          entries.push_back(layer.entries[j]);
+      }
+
+      nodes[levels[level] + i] = node;
+    }
+
+    order.swap(children);
+  }
+
+  layer.nodes.swap(nodes);
+  layer.entries.swap(entries);
+}
+
+static void
+BuildTree(LayerData &layer)
+{
+  const unsigned n = layer.shapes.size();
+  if (n == 0)
+    return;
+
+  auto &shapes = layer.shapes;
+  auto &entries = layer.entries;
+  auto &nodes = layer.nodes;
+
+  entries.resize(n);
+  std::iota(entries.begin(), entries.end(), 0u);
+
+  SortTileRecursive(entries.data(), entries.data() + n,
+                    [&shapes](uint32_t i){
+                      return shapes[i].bounds.GetCenter();
+                    });
+
+  AddLevel(nodes, 0, n, [&shapes, &entries](unsigned i) -> GeoBounds {
+      return shapes[entries[i]].bounds;
+    });
+  layer.n_leaf_nodes = nodes.size();
+
+  std::vector<unsigned> levels{0};
+  while (nodes.size() - levels.back() > 1) {
+    const unsigned level_begin = levels.back();
+    const unsigned level_end = nodes.size();
+
+    /* reordering the nodes of a level is allowed, because the level
+       above has not been built yet */
+    SortTileRecursive(&nodes[level_begin], nodes.data() + level_end,
+                      [](const Node &node){
+                        return node.bounds.GetCenter();
+                      });
+
+    AddLevel(nodes, level_begin, level_end - level_begin,
+             [&nodes](unsigned i) -> GeoBounds {
+               return nodes[i].bounds;
+             });
+
+    levels.push_back(level_end);
+  }
+
+  levels.push_back(nodes.size());
+  RenumberTree(layer, levels);
+}
+
+static bool
+BuildLayer(zzip_dir *dir, const TopographyFileConfig &config,
+           unsigned layout_scale, LayerData &layer)
+{
+  char path[sizeof(config.name) + 4];
+  strcpy(path, config.name);
+  strcat(path, ".shp");
+
+  shapefileObj file;
+  if (msShapefileOpen(&file, "rb", dir, path, 0) == -1)
+    return false;
+
+  AtScopeExit(&file) { msShapefileClose(&file); };
+
+  if (file.numshapes == 0)
+    return false;
+
+  const auto file_bounds = ImportRect(file.bounds);
+  if (!file_bounds.Check())
+    /* malformed bounds */
+    return false;
+
+  layer.center = file_bounds.GetCenter();
+
+  for (int i = 0; i < file.numshapes; ++i)
+    ImportShape(file, i, config, layout_scale, layer);
+
+  BuildTree(layer);
+  return true;
+}
+
+/**
+ * Append an aligned section to the pack.
+ *
+ * @return the section's offset
+ */
+template<typename T>
+static uint64_t
+AppendSection(std::vector<uint8_t> &dest, const std::vector<T> &src)
+{
+  const size_t offset = Align(dest.size());
+  const size_t size = src.size() * sizeof(T);
+  dest.resize(offset + size);
+  if (size > 0)
+    memcpy(&dest[offset], src.data(), size);
+  return offset;
+}
+
+static void
+AppendLayer(std::vector<uint8_t> &dest, Layer &header,
+            const LayerData &layer)
+{
+  header.center = layer.center;
+  header.n_shapes = layer.shapes.size();
+  header.n_nodes = layer.nodes.size();
+  header.n_leaf_nodes = layer.n_leaf_nodes;
+  header.n_lines = layer.lines.size();
+  header.n_points = layer.points.size();
+  header.n_indices = layer.indices.size();
+  header.n_labels = layer.labels.size();
+
+  header.shapes = AppendSection(dest, layer.shapes);
+  header.nodes = AppendSection(dest, layer.nodes);
+  header.entries = AppendSection(dest, layer.entries);
+  header.lines = AppendSection(dest, layer.lines);
+  header.points = AppendSection(dest, layer.points);
+  header.indices = AppendSection(dest, layer.indices);
+  header.labels = AppendSection(dest, layer.labels);
+}
+
+void
+BuildTopographyPack(zzip_dir *dir, NLineReader &tpl, unsigned layout_scale,
+                    std::vector<uint8_t> &dest,
+                    OperationEnvironment &operation)
+{
+  /* the layer table has room for all layers; the unused entries are
+     padding */
+  std::vector<Layer> table;
+  dest.assign(Align(sizeof(Header) + MAX_LAYERS * sizeof(Layer)), 0);
+
+  // Read file size to have a rough progress estimate for the progress bar
+  const long filesize = std::max(tpl.GetSize(), 1l);
+
+  operation.SetProgressRange(100);
+
+  char *line;
+  while (table.size() < MAX_LAYERS && (line = tpl.ReadLine()) != nullptr) {
+    TopographyFileConfig config;
+    if (!ParseTopographyLine(line, config) ||
+        std::any_of(table.begin(), table.end(), [&config](const Layer &l){
+            return StringIsEqual(l.name, config.name);
+          }))
+      continue;
+
+    LayerData layer;
+    if (BuildLayer(dir, config, layout_scale, layer)) {
+      Layer header;
+      memset(&header, 0, sizeof(header));
+      strcpy(header.name, config.name);
+      AppendLayer(dest, header, layer);
+      table.push_back(header);
+    }
+
+    operation.SetProgressPosition((tpl.Tell() * 100) / filesize);
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.char_size = sizeof(TCHAR);
+  header.point_size = sizeof(Point);
+  header.layout_scale = layout_scale;
+  header.n_layers = table.size();
+
+  memcpy(dest.data(), &header, sizeof(header));
+  if (!table.empty())
+    memcpy(dest.data() + sizeof(header), table.data(),
+           table.size() * sizeof(table.front()));
+}
+
+bool
+WriteTopographyPack(FILE *file, const std::vector<uint8_t> &pack)
+{
+  const long position = ftell(file);
+  if (position < 0)
+    return false;
+
+  static constexpr uint8_t zero[ALIGNMENT] = {};
+  const size_t padding = Align(position) - position;
+  return fwrite(zero, 1, padding, file) == padding &&
+    fwrite(pack.data(), 1, pack.size(), file) == pack.size();
+}
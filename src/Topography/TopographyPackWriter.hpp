@@ -0,0 +1,58 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_PACK_WRITER_HPP
+#define TOPOGRAPHY_PACK_WRITER_HPP
+
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct zzip_dir;
+class NLineReader;
+class OperationEnvironment;
+
+/**
+ * Convert the shapefiles listed in "topology.tpl" into a topography
+ * pack (see TopographyPackFormat.hpp).  OpenGL builds thin and
+ * triangulate the shapes for all zoom levels; the thinning distance
+ * depends on the given Layout::Scale(1) value.
+ *
+ * @param dir the ZIP archive containing the shapefiles
+ * @param tpl the "topology.tpl" file
+ */
+void
+BuildTopographyPack(zzip_dir *dir, NLineReader &tpl, unsigned layout_scale,
+                    std::vector<uint8_t> &dest,
+                    OperationEnvironment &operation);
+
+/**
+ * Write a pack at the current file position, preceded by padding
+ * which aligns it.  Pass the position before this call to
+ * TopographyPack::Open().
+ */
+bool
+WriteTopographyPack(FILE *file, const std::vector<uint8_t> &pack);
+
+#endif
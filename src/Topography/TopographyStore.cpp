@@ -23,26 +23,14 @@ Copyright_License {
 
 #include "Topography/TopographyStore.hpp"
 #include "Topography/TopographyFile.hpp"
+#include "Topography/TopographyConfig.hpp"
 #include "Util/StringAPI.hxx"
 #include "Util/StringCompare.hxx"
-#include "Util/ConvertString.hpp"
 #include "IO/LineReader.hpp"
 #include "Operation/Operation.hpp"
-#include "Compatibility/path.h"
-#include "Asset.hpp"
 #include "Resources.hpp"
 
-#include <stdint.h>
-#include <windef.h> // for MAX_PATH
-
-static bool
-IsHugeTopographyFile(const char *name)
-{
-  return StringIsEqual(name, "village_point") ||
-    StringIsEqual(name, "citysmall_point") ||
-    StringIsEqual(name, "roadsmall_point") ||
-    StringIsEqual(name, "roadsmall_line");
-}
+#include <algorithm>
 
 typedef struct {
   const char *name;
@@ -143,21 +131,11 @@ TopographyStore::~TopographyStore()
 
 void
 TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
-                      const TCHAR *directory, struct zzip_dir *zdir)
+                      TopographyPack &&_pack)
 {
   Reset();
 
-  // Create buffer for the shape filenames
-  // (shape_filename will be modified with the shape_filename_end pointer)
-  char shape_filename[MAX_PATH];
-  if (directory != nullptr) {
-    const WideToACPConverter narrow_directory(directory);
-    strcpy(shape_filename, narrow_directory);
-    strcat(shape_filename, DIR_SEPARATOR_S);
-  } else
-    shape_filename[0] = 0;
-
-  char *shape_filename_end = shape_filename + strlen(shape_filename);
+  pack = std::move(_pack);
 
   // Read file size to have a rough progress estimate for the progress bar
   const long filesize = std::max(reader.GetSize(), 1l);
@@ -169,54 +147,21 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
   // end or max. file number reached
   char *line;
   while (!files.full() && (line = reader.ReadLine()) != nullptr) {
-    // .tpl Line format: filename,range,icon,field,r,g,b,pen_width,label_range,important_range,alpha
-
-    // Ignore comments (lines starting with *) and empty lines
-    if (StringIsEmpty(line) || line[0] == '*')
-      continue;
-
-    // Find first comma to extract shape filename
-    char *p = strchr(line, ',');
-    if (p == nullptr || p == line)
-      // If no comma was found -> ignore this line/shapefile
+    TopographyFileConfig config;
+    if (!ParseTopographyLine(line, config))
       continue;
 
-    if (HasLittleMemory()) {
-      /* hard-coded blacklist for huge files on PPC2000; those
-         devices usually have very little memory */
-
-      // Null-terminate the line string after the first comma
-      // for strcmp() calls in IsHugeTopographyFile() function
-      *p = 0;
-
-      // Skip large topography files
-      if (IsHugeTopographyFile(line))
-        continue;
-    }
-
-    // Extract filename and append it to the shape_filename buffer
-    memcpy(shape_filename_end, line, p - line);
-    // Append ".shp" file extension to the shape_filename buffer
-    strcpy(shape_filename_end + (p - line), ".shp");
-
-    // Parse shape range
-    auto shape_range = strtod(p + 1, &p) * 1000;
-    if (*p != _T(','))
+    const TopographyPackLayer *layer = pack.FindLayer(config.name);
+    if (layer == nullptr || layer->IsEmpty())
+      // If the shape file could not be read -> skip this line/file
       continue;
 
-    // Extract shape icon name
-    char icon_name[23];
-    char *start = p + 1;
-    p = strchr(start, ',');
-    // Null-terminate the line string at the next comma for strncpy() call
-    *p = 0;
-    strncpy(icon_name, start, 22);
     ResourceId icon = ResourceId::Null(), big_icon = ResourceId::Null();
 
-    if (strlen(icon_name) > 0) {
+    if (!StringIsEmpty(config.icon_name)) {
       const LOOKUP_ICON *ip = icon_list;
       while (ip->name != nullptr) {
-        if (StringIsEqual(ip->name, icon_name)) {
+        if (StringIsEqual(ip->name, config.icon_name)) {
           icon = ip->resource_id;
           big_icon = ip->big_resource_id;
           break;
@@ -225,77 +170,19 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
       }
     }
 
-    // Parse shape field for text display
-    long shape_field = strtol(p + 1, &p, 10) - 1;
-    if (*p != _T(','))
-      continue;
-
-    // Parse red component of line / shading colour
-    uint8_t red = (uint8_t)strtol(p + 1, &p, 10);
-    if (*p != _T(','))
-      continue;
-
-    // Parse green component of line / shading colour
-    uint8_t green = (uint8_t)strtol(p + 1, &p, 10);
-    if (*p != _T(','))
-      continue;
-
-    // Parse blue component of line / shading colour
-    uint8_t blue = (uint8_t)strtol(p + 1, &p, 10);
-
-    // Parse pen width of lines
-    unsigned pen_width = 1;
-    if (*p == _T(',')) {
-      pen_width = strtoul(p + 1, &p, 10);
-      if (pen_width < 1)
-        pen_width = 1;
-      else if (pen_width>31)
-        pen_width=31;
-    }
-
-    // Parse range for displaying labels
-    auto label_range = shape_range;
-    if (*p == _T(','))
-      label_range = strtod(p + 1, &p) * 1000;
-
-    // Parse range for displaying labels with "important" rendering style
-    double labelImportantRange = 0;
-    if (*p == _T(','))
-      labelImportantRange = strtod(p + 1, &p) * 1000;
-
-    // Handle alpha component
-    // If not present at all (i.e. v6.6 or earlier file), default to 100% opaque
-    uint8_t alpha = 255;
-    if (*p == _T(',')) {
-      // An alpha component of shading colour is present (v6.7 or later file).
-      alpha = (uint8_t)strtol(p + 1, &p, 10);
-      // Ignore a totally transparent file!
-      if (alpha == 0)
-        continue;
-#ifndef ENABLE_OPENGL
-      // Without OpenGL ignore anything but 100% opaque
-      if (alpha != 255)
-        continue;
-#endif
-    }
-
     // Create TopographyFile instance from parsed line
-    TopographyFile *file = new TopographyFile(zdir, shape_filename,
-                                              shape_range, label_range,
-                                              labelImportantRange,
+    files.append(new TopographyFile(*layer,
+                                    config.shape_range, config.label_range,
+                                    config.important_label_range,
 #ifdef ENABLE_OPENGL
-                                              Color(red, green, blue, alpha),
+                                    Color(config.red, config.green,
+                                          config.blue, config.alpha),
 #else
-                                              Color(red, green, blue),
+                                    Color(config.red, config.green,
+                                          config.blue),
 #endif
-                                              shape_field, icon, big_icon,
-                                              pen_width);
-    if (file->IsEmpty())
-      // If the shape file could not be read -> skip this line/file
-      delete file;
-    else
-      // .. otherwise append it to our list of shape files
-      files.append(file);
+                                    icon, big_icon,
+                                    config.pen_width));
 
     // Update progress bar
     operation.SetProgressPosition((reader.Tell() * 100) / filesize);
@@ -309,4 +196,5 @@ TopographyStore::Reset()
     delete file;
 
   files.clear();
+  pack.Close();
 }
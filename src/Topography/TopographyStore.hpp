@@ -24,6 +24,7 @@ Copyright_License {
 #ifndef TOPOGRAPHY_STORE_HPP
 #define TOPOGRAPHY_STORE_HPP
 
+#include "TopographyPack.hpp"
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hxx"
 #include "Compiler.h"
@@ -34,7 +35,6 @@ class WindowProjection;
 class TopographyFile;
 class NLineReader;
 class OperationEnvironment;
-struct zzip_dir;
 
 /**
  * Class used to manage and render vector topography layers
@@ -45,6 +45,12 @@ public:
   static constexpr unsigned MAXTOPOGRAPHY = 30;
 
 private:
+  /**
+   * The geometry of all layers; the #TopographyFile objects refer to
+   * it.
+   */
+  TopographyPack pack;
+
   StaticArray<TopographyFile *, MAXTOPOGRAPHY> files;
 
   /**
@@ -92,8 +98,13 @@ public:
    */
   void LoadAll();
 
+  /**
+   * Create the layers listed in "topology.tpl" from the given pack
+   * (see BuildTopographyPack()), which must have been built from
+   * the same file.
+   */
   void Load(OperationEnvironment &operation, NLineReader &reader,
-            const TCHAR *directory, struct zzip_dir *zdir = nullptr);
+            TopographyPack &&_pack);
   void Reset();
 };
 
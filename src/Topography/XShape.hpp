@@ -25,11 +25,10 @@ Copyright_License {
 #ifndef TOPOGRAPHY_XSHAPE_HPP
 #define TOPOGRAPHY_XSHAPE_HPP
 
+#include "TopographyPack.hpp"
 #include "Util/ConstBuffer.hxx"
-#include "Util/AllocatedString.hxx"
 #include "Geo/GeoBounds.hpp"
 #include "shapelib/mapserver.h"
-#include "shapelib/mapshape.h"
 #ifdef ENABLE_OPENGL
 #include "Topography/XShapePoint.hpp"
 #endif
@@ -37,68 +36,35 @@ Copyright_License {
 #include <tchar.h>
 #include <stdint.h>
 
-struct GeoPoint;
-
+/**
+ * A shape in a #TopographyPackLayer.  This is a lightweight view
+ * which does not own any data; all of it lives in the pack.
+ */
 class XShape {
-  static constexpr unsigned MAX_LINES = 32;
-#ifdef ENABLE_OPENGL
-  static constexpr unsigned THINNING_LEVELS = 4;
-#endif
+  const TopographyPackLayer *layer;
 
-  GeoBounds bounds;
+  unsigned index;
 
-  uint8_t type;
-
-  /**
-   * The number of elements in the "lines" array.
-   */
-  uint8_t num_lines;
-
-  /**
-   * An array which stores the number of points of each line.  This is
-   * a fixed-size array to reduce the number of allocations at
-   * runtime.
-   */
-  uint16_t lines[MAX_LINES];
-
-  /**
-   * All points of all lines.
-   */
 #ifdef ENABLE_OPENGL
-  ShapePoint *points;
-
-  /**
-   * Indices of polygon triangles or lines with reduced number of vertices.
-   */
-  uint16_t *indices[THINNING_LEVELS];
-
-  /**
-   * For polygons this will contain the total number of triangle vertices
-   * for each thinning level.
-   * For lines there will be an array of size num_lines for each thinning
-   * level, which contains the number of points for each line.
-   */
-  uint16_t *index_count[THINNING_LEVELS];
-
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
    * It is managed by #TopographyFileRenderer.
    */
   mutable unsigned offset;
-#else // !ENABLE_OPENGL
-  GeoPoint *points;
 #endif
 
-  AllocatedString<TCHAR> label;
-
 public:
-  XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-         int label_field=-1);
+  XShape() = default;
 
-  XShape(const XShape &) = delete;
+  XShape(const TopographyPackLayer &_layer, unsigned _index)
+    :layer(&_layer), index(_index) {}
 
-  ~XShape();
+private:
+  const TopographyPackLayer::Shape &GetRecord() const {
+    return layer->shapes[index];
+  }
 
+public:
 #ifdef ENABLE_OPENGL
   void SetOffset(unsigned _offset) const {
     offset = _offset;
@@ -107,38 +73,57 @@ public:
   unsigned GetOffset() const {
     return offset;
   }
-
-protected:
-  bool BuildIndices(unsigned thinning_level, ShapeScalar min_distance);
-
-public:
-  const uint16_t *GetIndices(int thinning_level,
-                             ShapeScalar min_distance,
-                             const uint16_t *&count) const;
 #endif
 
+  /**
+   * Returns the indices of polygon triangles or lines with reduced
+   * number of vertices for the given thinning level.  Without
+   * OpenGL, polygon rings are thinned like lines.
+   *
+   * @param count for OpenGL polygons, the total number of triangle
+   * strip indices; else the number of indices of each line
+   * @return nullptr if there are no indices for this level
+   */
+  const uint16_t *GetIndices(unsigned thinning_level,
+                             const uint16_t *&count) const {
+    const auto &record = GetRecord();
+    const uint32_t i = record.indices[thinning_level];
+    if (i == TopographyPackFormat::NONE)
+      return nullptr;
+
+    count = layer->indices + i;
+    return count + record.GetIndexCountSize();
+  }
+
   const GeoBounds &get_bounds() const {
-    return bounds;
+    return GetRecord().bounds;
   }
 
   MS_SHAPE_TYPE get_type() const {
-    return (MS_SHAPE_TYPE)type;
+    return (MS_SHAPE_TYPE)GetRecord().type;
   }
 
   ConstBuffer<uint16_t> GetLines() const {
-    return { lines, num_lines };
+    const auto &record = GetRecord();
+    return { layer->lines + record.first_line, record.n_lines };
   }
 
+  /**
+   * All points of all lines.
+   */
 #ifdef ENABLE_OPENGL
   const ShapePoint *GetPoints() const {
 #else
   const GeoPoint *GetPoints() const {
 #endif
-    return points;
+    return layer->points + GetRecord().first_point;
   }
 
   const TCHAR *GetLabel() const {
-    return label.c_str();
+    const uint32_t label = GetRecord().label;
+    return label != TopographyPackFormat::NONE
+      ? layer->labels + label
+      : nullptr;
   }
 };
 
@@ -28,12 +28,33 @@ Copyright_License {
 #include "OS/ByteOrder.hpp"
 #include "Util/CRC.hpp"
 
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 namespace SkyLinesTracking {
 
 Server::Server(boost::asio::io_service &io_service,
-               boost::asio::ip::udp::endpoint endpoint)
-  :socket(io_service, endpoint)
+               boost::asio::ip::udp::endpoint endpoint,
+               bool reuse_port)
+  :socket(io_service, endpoint.protocol()),
+   n_sent_packets(0), n_send_calls(0)
 {
+  if (reuse_port) {
+#ifdef SO_REUSEPORT
+    typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET,
+                                                        SO_REUSEPORT> ReusePort;
+    socket.set_option(ReusePort(true));
+#else
+    throw std::runtime_error("SO_REUSEPORT is not supported");
+#endif
+  }
+
+  socket.bind(endpoint);
+
   AsyncReceive();
 }
 
@@ -51,13 +72,95 @@ Server::SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
 {
   // TODO: use async_send_to()?
 
+  n_send_calls.fetch_add(1, std::memory_order_relaxed);
+
   try {
     socket.send_to(boost::asio::const_buffers_1(data), endpoint, 0);
+    n_sent_packets.fetch_add(1, std::memory_order_relaxed);
   } catch (std::runtime_error e) {
     OnSendError(endpoint, std::move(e));
   }
 }
 
+#ifdef __linux__
+
+/**
+ * Send a batch of datagrams with one sendmmsg() call.
+ *
+ * @return the number of datagrams sent, or -1 on error (with errno
+ * set)
+ */
+static int
+SendMultiple(int fd, const Server::Datagram *datagrams, unsigned n)
+{
+  static constexpr unsigned MAX_BATCH = 64;
+  if (n > MAX_BATCH)
+    n = MAX_BATCH;
+
+  struct iovec iov[MAX_BATCH];
+  struct mmsghdr msgs[MAX_BATCH];
+
+  for (unsigned i = 0; i < n; ++i) {
+    const auto &d = datagrams[i];
+
+    iov[i].iov_base = const_cast<void *>(boost::asio::buffer_cast<const void *>(d.data));
+    iov[i].iov_len = boost::asio::buffer_size(d.data);
+
+    auto &h = msgs[i].msg_hdr;
+    h.msg_name = const_cast<void *>((const void *)d.endpoint->data());
+    h.msg_namelen = d.endpoint->size();
+    h.msg_iov = &iov[i];
+    h.msg_iovlen = 1;
+    h.msg_control = nullptr;
+    h.msg_controllen = 0;
+    h.msg_flags = 0;
+  }
+
+  return sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+}
+
+#endif
+
+void
+Server::SendBuffers(const Datagram *datagrams, size_t n)
+{
+#ifdef __linux__
+  const int fd = socket.native_handle();
+
+  while (n > 0) {
+    n_send_calls.fetch_add(1, std::memory_order_relaxed);
+
+    int result = SendMultiple(fd, datagrams, n);
+    if (result <= 0) {
+      if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        /* sendmmsg() fails only if the first datagram fails; report
+           it and skip it */
+        OnSendError(*datagrams->endpoint,
+                    boost::system::system_error(errno,
+                                                boost::system::system_category()));
+        ++datagrams;
+        --n;
+        continue;
+      }
+
+      /* the socket buffer is full: fall back to the blocking
+         send_to() for the next datagram */
+      SendBuffer(*datagrams->endpoint, datagrams->data);
+      ++datagrams;
+      --n;
+      continue;
+    }
+
+    n_sent_packets.fetch_add(result, std::memory_order_relaxed);
+    datagrams += result;
+    n -= result;
+  }
+#else
+  for (size_t i = 0; i < n; ++i)
+    SendBuffer(*datagrams[i].endpoint, datagrams[i].data);
+#endif
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
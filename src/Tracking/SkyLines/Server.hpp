@@ -27,6 +27,7 @@ Copyright_License {
 #include <boost/asio/ip/udp.hpp>
 
 #include <chrono>
+#include <atomic>
 
 #include <stdint.h>
 
@@ -54,9 +55,21 @@ public:
 private:
   Client client_buffer;
 
+  std::atomic<uint64_t> n_sent_packets, n_send_calls;
+
 public:
+  /**
+   * @param reuse_port set SO_REUSEPORT on the socket, to allow
+   * several #Server instances to share one port (the kernel
+   * distributes incoming datagrams among them); only available if
+   * CanReusePort() returns true
+   *
+   * Throws std::runtime_error on error, e.g. if #reuse_port is not
+   * supported.
+   */
   Server(boost::asio::io_service &io_service,
-         boost::asio::ip::udp::endpoint endpoint);
+         boost::asio::ip::udp::endpoint endpoint,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -70,6 +83,15 @@ public:
     return "5597";
   }
 
+  constexpr
+  static bool CanReusePort() {
+#ifdef SO_REUSEPORT
+    return true;
+#else
+    return false;
+#endif
+  }
+
   boost::asio::io_service &get_io_service() {
     return socket.get_io_service();
   }
@@ -77,6 +99,32 @@ public:
   void SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
                   boost::asio::const_buffer data);
 
+  struct Datagram {
+    const boost::asio::ip::udp::endpoint *endpoint;
+    boost::asio::const_buffer data;
+  };
+
+  /**
+   * Send many datagrams with as few system calls as possible (using
+   * sendmmsg() where available).
+   */
+  void SendBuffers(const Datagram *datagrams, size_t n);
+
+  /**
+   * Returns the number of datagrams sent so far.  Thread-safe.
+   */
+  uint64_t GetSentPackets() const {
+    return n_sent_packets.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the number of system calls used to send the datagrams
+   * counted by GetSentPackets().  Thread-safe.
+   */
+  uint64_t GetSendCalls() const {
+    return n_send_calls.load(std::memory_order_relaxed);
+  }
+
   template<typename P>
   void SendPacket(const boost::asio::ip::udp::endpoint &endpoint,
                   const P &packet) {
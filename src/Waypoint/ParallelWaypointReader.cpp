@@ -0,0 +1,166 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ParallelWaypointReader.hpp"
+#include "WaypointReader.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Operation/Operation.hpp"
+#include "IO/FileLineReader.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "Util/StringAPI.hxx"
+
+#include <algorithm>
+
+static void
+ReadLines(TLineReader &reader,
+          std::vector<TCHAR> &text, std::vector<size_t> &lines)
+{
+  const TCHAR *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    lines.push_back(text.size());
+    text.insert(text.end(), line, line + StringLength(line) + 1);
+  }
+}
+
+inline void
+ParallelWaypointReader::File::ParseChunk(Chunk &chunk) const
+{
+  for (unsigned i = chunk.begin; i < chunk.end; ++i) {
+    chunk.reader->ParseLine(GetLine(i), chunk.waypoints);
+
+    if (chunk.reader->IsDone())
+      /* the following lines are ignored, but the chunks after this
+         one have been parsed already; Run() discards them */
+      break;
+  }
+}
+
+void
+ParallelWaypointReader::Load(File &file)
+{
+  if (file.type == WaypointFileType::UNKNOWN && file.dir == nullptr)
+    file.type = DetermineWaypointFileType(file.path);
+
+  WaypointReaderBase *reader = CreateWaypointReader(file.type, file.factory);
+  if (reader == nullptr)
+    return;
+
+  file.chunks.emplace_back(reader, 0, 0);
+
+  try {
+    if (file.dir != nullptr) {
+      const ScopeLock protect(zip_mutex);
+      ZipLineReader line_reader(file.dir, file.zip_path.c_str(),
+                                Charset::AUTO);
+      ReadLines(line_reader, file.text, file.lines);
+    } else {
+      FileLineReader line_reader(file.path, Charset::AUTO);
+      ReadLines(line_reader, file.text, file.lines);
+    }
+  } catch (const std::runtime_error &) {
+    file.chunks.clear();
+    return;
+  }
+
+  file.success = true;
+
+  const unsigned n_lines = file.lines.size();
+  Chunk &head = file.chunks.front();
+  head.end = std::min(chunk_lines, n_lines);
+  file.ParseChunk(head);
+
+  if (head.end == n_lines || reader->IsDone())
+    return;
+
+  WaypointReaderBase *fork = reader->Fork();
+  if (fork == nullptr) {
+    /* the reader state is not settled yet: parse the rest of the
+       file sequentially */
+    head.begin = head.end;
+    head.end = n_lines;
+    file.ParseChunk(head);
+    return;
+  }
+
+  const unsigned first = head.end;
+  file.chunks.reserve(1 + (n_lines - first + chunk_lines - 1) / chunk_lines);
+
+  for (unsigned begin = first; begin < n_lines; begin += chunk_lines) {
+    if (begin > first)
+      fork = reader->Fork();
+
+    file.chunks.emplace_back(fork, begin,
+                             std::min(begin + chunk_lines, n_lines));
+  }
+}
+
+void
+ParallelWaypointReader::Run(JobScheduler &scheduler, Waypoints &way_points,
+                            OperationEnvironment &operation)
+{
+  operation.SetProgressRange(3);
+  operation.SetProgressPosition(0);
+
+  const CancellationToken token(&operation);
+
+  scheduler.ParallelFor(files.size(), [this](unsigned i){
+      Load(files[i]);
+    }, JobScheduler::Priority::HIGH, &token);
+
+  operation.SetProgressPosition(1);
+
+  std::vector<std::pair<File *, Chunk *>> jobs;
+  for (auto &file : files)
+    for (auto i = std::next(file.chunks.begin()); i < file.chunks.end(); ++i)
+      jobs.emplace_back(&file, &*i);
+
+  scheduler.ParallelFor(jobs.size(), [&jobs](unsigned i){
+      jobs[i].first->ParseChunk(*jobs[i].second);
+    }, JobScheduler::Priority::HIGH, &token);
+
+  operation.SetProgressPosition(2);
+
+  const bool cancelled = token.IsCancelled();
+
+  for (auto &file : files) {
+    if (cancelled)
+      file.success = false;
+
+    for (auto &chunk : file.chunks) {
+      if (cancelled)
+        break;
+
+      chunk.waypoints.CommitTo(way_points);
+
+      if (chunk.reader->IsDone())
+        break;
+    }
+
+    file.chunks.clear();
+    file.text = std::vector<TCHAR>();
+    file.lines = std::vector<size_t>();
+  }
+
+  operation.SetProgressPosition(3);
+}
@@ -0,0 +1,189 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PARALLEL_WAYPOINT_READER_HPP
+#define XCSOAR_PARALLEL_WAYPOINT_READER_HPP
+
+#include "WaypointReaderBase.hpp"
+#include "WaypointFileType.hpp"
+#include "OS/Path.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <assert.h>
+#include <stddef.h>
+
+struct zzip_dir;
+class JobScheduler;
+
+/**
+ * Loads several waypoint files at the same time.  The files are read
+ * and parsed in the threads of a #JobScheduler; large files are split
+ * into chunks of lines which are parsed concurrently, if the file
+ * format allows that (see WaypointReaderBase::Fork()).
+ *
+ * The parsed waypoints are appended to the #Waypoints instance in
+ * the calling thread, in the order the files were added and in file
+ * order within each file; therefore, the waypoint ids are the same
+ * as with ReadWaypointFile().
+ */
+class ParallelWaypointReader {
+  struct Chunk {
+    std::unique_ptr<WaypointReaderBase> reader;
+
+    /**
+     * The range of line numbers.
+     */
+    unsigned begin, end;
+
+    StagedWaypoints waypoints;
+
+    Chunk(WaypointReaderBase *_reader, unsigned _begin, unsigned _end)
+      :reader(_reader), begin(_begin), end(_end) {}
+  };
+
+  struct File {
+    AllocatedPath path;
+
+    /**
+     * If this is not nullptr, then #zip_path is a file inside this
+     * ZIP archive.
+     */
+    struct zzip_dir *dir;
+    std::string zip_path;
+
+    WaypointFileType type;
+    WaypointFactory factory;
+
+    bool success = false;
+
+    /**
+     * All lines of the file, each terminated by a null character.
+     * They are freed after parsing.
+     */
+    std::vector<TCHAR> text;
+
+    /**
+     * The offset of each line within #text.
+     */
+    std::vector<size_t> lines;
+
+    /**
+     * The first chunk is parsed while loading the file, the others
+     * in a second pass.
+     */
+    std::vector<Chunk> chunks;
+
+    File(Path _path, WaypointFileType _type, WaypointFactory _factory)
+      :path(_path), dir(nullptr), type(_type), factory(_factory) {}
+
+    File(struct zzip_dir *_dir, const char *_zip_path,
+         WaypointFileType _type, WaypointFactory _factory)
+      :path(nullptr), dir(_dir), zip_path(_zip_path),
+       type(_type), factory(_factory) {}
+
+    const TCHAR *GetLine(unsigned i) const {
+      return text.data() + lines[i];
+    }
+
+    void ParseChunk(Chunk &chunk) const;
+  };
+
+  const unsigned chunk_lines;
+
+  std::vector<File> files;
+
+  /**
+   * ZZIPlib is not thread-safe; this serialises access to ZIP
+   * archives.
+   */
+  Mutex zip_mutex;
+
+public:
+  /**
+   * @param _chunk_lines the number of lines parsed by one job
+   */
+  explicit ParallelWaypointReader(unsigned _chunk_lines=4096)
+    :chunk_lines(_chunk_lines) {
+    assert(chunk_lines > 0);
+  }
+
+  /**
+   * Add a file whose type is determined by DetermineWaypointFileType().
+   *
+   * @return the index of the file for IsSuccessful()
+   */
+  unsigned Add(Path path, WaypointFactory factory) {
+    return Add(path, WaypointFileType::UNKNOWN, factory);
+  }
+
+  unsigned Add(Path path, WaypointFileType type, WaypointFactory factory) {
+    files.emplace_back(path, type, factory);
+    return files.size() - 1;
+  }
+
+  /**
+   * Add a file inside a ZIP archive.  The archive must remain open
+   * until Run() returns.
+   */
+  unsigned Add(struct zzip_dir *dir, const char *path,
+               WaypointFileType type, WaypointFactory factory) {
+    files.emplace_back(dir, path, type, factory);
+    return files.size() - 1;
+  }
+
+  unsigned size() const {
+    return files.size();
+  }
+
+  /**
+   * Load and parse all files, and append their waypoints to the
+   * given #Waypoints instance.  This does not call
+   * Waypoints::Optimise().
+   *
+   * If the operation is cancelled, the remaining jobs are skipped,
+   * and no waypoints are added.
+   */
+  void Run(JobScheduler &scheduler, Waypoints &way_points,
+           OperationEnvironment &operation);
+
+  /**
+   * Was the specified file read successfully by Run()?  This returns
+   * false if the file could not be opened or if its type is not
+   * supported.
+   */
+  bool IsSuccessful(unsigned i) const {
+    return files[i].success;
+  }
+
+private:
+  /**
+   * Read all lines of the file and parse the first chunk.
+   */
+  void Load(File &file);
+};
+
+#endif
@@ -27,60 +27,17 @@ Copyright_License {
 #include "Profile/Profile.hpp"
 #include "LogFile.hpp"
 #include "Waypoint/Waypoints.hpp"
-#include "WaypointReader.hpp"
+#include "ParallelWaypointReader.hpp"
 #include "Language/Language.hpp"
 #include "LocalPath.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/Path.hpp"
 #include "IO/MapFile.hpp"
 #include "IO/ZipArchive.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Util/Macros.hpp"
 
-static bool
-LoadWaypointFile(Waypoints &waypoints, Path path,
-                 WaypointFileType file_type,
-                 WaypointOrigin origin,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
-{
-  if (!ReadWaypointFile(path, file_type, waypoints,
-                        WaypointFactory(origin, terrain),
-                        operation)) {
-    LogFormat(_T("Failed to read waypoint file: %s"), path.c_str());
-    return false;
-  }
-
-  return true;
-}
-
-static bool
-LoadWaypointFile(Waypoints &waypoints, Path path,
-                 WaypointOrigin origin,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
-{
-  if (!ReadWaypointFile(path, waypoints,
-                        WaypointFactory(origin, terrain),
-                        operation)) {
-    LogFormat(_T("Failed to read waypoint file: %s"), path.c_str());
-    return false;
-  }
-
-  return true;
-}
-
-static bool
-LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir, const char *path,
-                 WaypointFileType file_type,
-                 WaypointOrigin origin,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
-{
-  if (!ReadWaypointFile(dir, path, file_type, waypoints,
-                        WaypointFactory(origin, terrain),
-                        operation)) {
-    LogFormat("Failed to read waypoint file: %s", path);
-    return false;
-  }
-
-  return true;
-}
+#include <vector>
 
 bool
 WaypointGlue::LoadWaypoints(Waypoints &way_points,
@@ -95,27 +52,51 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
   // Delete old waypoints
   way_points.Clear();
 
-  LoadWaypointFile(way_points, LocalPath(_T("user.cup")),
-                   WaypointFileType::SEEYOU,
-                   WaypointOrigin::USER, terrain, operation);
+  auto &scheduler = GetJobScheduler();
+
+  /* all configured files are read and parsed at the same time; the
+     waypoints are appended in the order of the files below */
+  ParallelWaypointReader reader;
+
+  const auto user_path = LocalPath(_T("user.cup"));
+  const unsigned user_index =
+    reader.Add(user_path, WaypointFileType::SEEYOU,
+               WaypointFactory(WaypointOrigin::USER, terrain));
+
+  static constexpr struct {
+    const char *key;
+    WaypointOrigin origin;
+  } profile_files[] = {
+    // ### FIRST FILE ###
+    { ProfileKeys::WaypointFile, WaypointOrigin::PRIMARY },
+    // ### SECOND FILE ###
+    { ProfileKeys::AdditionalWaypointFile, WaypointOrigin::ADDITIONAL },
+    // ### WATCHED WAYPOINT/THIRD FILE ###
+    { ProfileKeys::WatchedWaypointFile, WaypointOrigin::WATCHED },
+  };
+
+  /* the configured paths and their indices in the reader */
+  std::vector<std::pair<AllocatedPath, unsigned>> paths;
+  for (const auto &i : profile_files) {
+    auto path = Profile::GetPath(i.key);
+    if (!path.IsNull()) {
+      const unsigned index =
+        reader.Add(path, WaypointFactory(i.origin, terrain));
+      paths.emplace_back(std::move(path), index);
+    }
+  }
 
-  // ### FIRST FILE ###
-  auto path = Profile::GetPath(ProfileKeys::WaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
-                              terrain, operation);
+  reader.Run(scheduler, way_points, operation);
 
-  // ### SECOND FILE ###
-  path = Profile::GetPath(ProfileKeys::AdditionalWaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
-                              terrain, operation);
+  if (!reader.IsSuccessful(user_index))
+    LogFormat(_T("Failed to read waypoint file: %s"), user_path.c_str());
 
-  // ### WATCHED WAYPOINT/THIRD FILE ###
-  path = Profile::GetPath(ProfileKeys::WatchedWaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
-                              terrain, operation);
+  for (const auto &i : paths) {
+    if (reader.IsSuccessful(i.second))
+      found = true;
+    else
+      LogFormat(_T("Failed to read waypoint file: %s"), i.first.c_str());
+  }
 
   // ### MAP/FOURTH FILE ###
 
@@ -123,15 +104,27 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
   if (!found) {
     auto archive = OpenMapFile();
     if (archive) {
-      found |= LoadWaypointFile(way_points, archive->get(), "waypoints.xcw",
-                                WaypointFileType::WINPILOT,
-                                WaypointOrigin::MAP,
-                                terrain, operation);
-
-      found |= LoadWaypointFile(way_points, archive->get(), "waypoints.cup",
-                                WaypointFileType::SEEYOU,
-                                WaypointOrigin::MAP,
-                                terrain, operation);
+      static constexpr struct {
+        const char *path;
+        WaypointFileType type;
+      } map_files[] = {
+        { "waypoints.xcw", WaypointFileType::WINPILOT },
+        { "waypoints.cup", WaypointFileType::SEEYOU },
+      };
+
+      ParallelWaypointReader map_reader;
+      for (const auto &i : map_files)
+        map_reader.Add(archive->get(), i.path, i.type,
+                       WaypointFactory(WaypointOrigin::MAP, terrain));
+
+      map_reader.Run(scheduler, way_points, operation);
+
+      for (unsigned i = 0; i < ARRAY_SIZE(map_files); ++i) {
+        if (map_reader.IsSuccessful(i))
+          found = true;
+        else
+          LogFormat("Failed to read waypoint file: %s", map_files[i].path);
+      }
     }
   }
 
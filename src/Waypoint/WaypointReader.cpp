@@ -34,7 +34,7 @@ Copyright_License {
 
 #include <memory>
 
-static WaypointReaderBase *
+WaypointReaderBase *
 CreateWaypointReader(WaypointFileType type, WaypointFactory factory)
 {
   switch (type) {
@@ -33,6 +33,16 @@ class Path;
 class Waypoints;
 class WaypointFactory;
 class OperationEnvironment;
+class WaypointReaderBase;
+
+/**
+ * Create a reader for the given file type.
+ *
+ * @return a new object (to be freed by the caller) or nullptr if the
+ * file type is not supported
+ */
+WaypointReaderBase *
+CreateWaypointReader(WaypointFileType type, WaypointFactory factory);
 
 bool
 ReadWaypointFile(Path path, WaypointFileType file_type,
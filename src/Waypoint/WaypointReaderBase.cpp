@@ -22,9 +22,19 @@ Copyright_License {
 */
 
 #include "WaypointReaderBase.hpp"
+#include "Waypoint/Waypoints.hpp"
 #include "Operation/Operation.hpp"
 #include "IO/LineReader.hpp"
 
+void
+StagedWaypoints::CommitTo(Waypoints &way_points)
+{
+  for (auto &wp : list)
+    way_points.Append(std::move(wp));
+
+  list.clear();
+}
+
 void
 WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
                           OperationEnvironment &operation)
@@ -32,13 +42,17 @@ WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
   const long filesize = std::max(reader.GetSize(), 1l);
   operation.SetProgressRange(100);
 
+  StagedWaypoints staged;
+
   // Read through the lines of the file
   TCHAR *line;
   for (unsigned i = 0; (line = reader.ReadLine()) != nullptr; i++) {
     // and parse them
-    ParseLine(line, way_points);
+    ParseLine(line, staged);
 
     if ((i & 0x3f) == 0)
       operation.SetProgressPosition(reader.Tell() * 100 / filesize);
   }
+
+  staged.CommitTo(way_points);
 }
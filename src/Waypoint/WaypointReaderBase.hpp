@@ -26,6 +26,9 @@ Copyright_License {
 #define WAYPOINTFILE_HPP
 
 #include "Factory.hpp"
+#include "Engine/Waypoint/Ptr.hpp"
+
+#include <vector>
 
 #include <tchar.h>
 
@@ -33,6 +36,34 @@ class Waypoints;
 class TLineReader;
 class OperationEnvironment;
 
+/**
+ * Waypoints which have been parsed, but not yet appended to a
+ * #Waypoints instance.  This allows parsing in several threads;
+ * the #Waypoints instance is only modified by CommitTo().
+ */
+class StagedWaypoints {
+  std::vector<WaypointPtr> list;
+
+public:
+  bool empty() const {
+    return list.empty();
+  }
+
+  unsigned size() const {
+    return list.size();
+  }
+
+  void Append(Waypoint &&wp) {
+    list.emplace_back(new Waypoint(std::move(wp)));
+  }
+
+  /**
+   * Append all waypoints to the given #Waypoints instance, in the
+   * order they were parsed, and clear this list.
+   */
+  void CommitTo(Waypoints &way_points);
+};
+
 class WaypointReaderBase 
 {
 protected:
@@ -53,16 +84,33 @@ public:
   void Parse(Waypoints &way_points, TLineReader &reader,
              OperationEnvironment &operation);
 
-protected:
   /**
    * Parse a file line
    * @param line The line to parse
-   * @param linenum The line number in the file
    * @param way_points The waypoint list to fill
    * @return True if the line was parsed correctly or ignored, False if
    * parsing error occured
    */
-  virtual bool ParseLine(const TCHAR* line, Waypoints &way_points) = 0;
+  virtual bool ParseLine(const TCHAR* line, StagedWaypoints &way_points) = 0;
+
+  /**
+   * Create a reader which continues in the current state of this one,
+   * for parsing the following lines of the file in another thread.
+   *
+   * @return the new reader, or nullptr if this format does not
+   * support that, or if the state may still change (e.g. because the
+   * file header has not been parsed completely)
+   */
+  virtual WaypointReaderBase *Fork() const {
+    return nullptr;
+  }
+
+  /**
+   * Does this reader ignore all following lines of the file?
+   */
+  virtual bool IsDone() const {
+    return false;
+  }
 };
 
 #endif
@@ -139,7 +139,7 @@ ParseAltitude(const TCHAR *&src, double &dest)
 }
 
 bool
-WaypointReaderCompeGPS::ParseLine(const TCHAR *line, Waypoints &waypoints)
+WaypointReaderCompeGPS::ParseLine(const TCHAR *line, StagedWaypoints &waypoints)
 {
   /*
    * G  WGS 84
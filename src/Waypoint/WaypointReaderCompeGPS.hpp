@@ -35,9 +35,8 @@ public:
 
   static bool VerifyFormat(TLineReader &reader);
 
-protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, StagedWaypoints &way_points) override;
 };
 
 #endif
@@ -67,7 +67,7 @@ ParseString(const TCHAR *src, tstring &dest)
 }
 
 bool
-WaypointReaderOzi::ParseLine(const TCHAR *line, Waypoints &way_points)
+WaypointReaderOzi::ParseLine(const TCHAR *line, StagedWaypoints &way_points)
 {
   if (line[0] == '\0')
     return true;
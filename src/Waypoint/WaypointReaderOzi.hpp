@@ -37,9 +37,12 @@ public:
 
   static bool VerifyFormat(TLineReader &reader);
 
-protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, StagedWaypoints &way_points) override;
+
+  WaypointReaderBase *Fork() const override {
+    return ignore_lines > 0 ? nullptr : new WaypointReaderOzi(*this);
+  }
 };
 
 #endif
@@ -160,7 +160,7 @@ ParseStyle(const TCHAR* src, Waypoint::Type &type)
 }
 
 bool
-WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
+WaypointReaderSeeYou::ParseLine(const TCHAR *line, StagedWaypoints &waypoints)
 {
   enum {
     iName = 0,
@@ -42,9 +42,16 @@ public:
     :WaypointReaderBase(_factory),
      first(true), ignore_following(false) {}
 
-protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR* line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR* line, StagedWaypoints &way_points) override;
+
+  WaypointReaderBase *Fork() const override {
+    return first ? nullptr : new WaypointReaderSeeYou(*this);
+  }
+
+  bool IsDone() const override {
+    return ignore_following;
+  }
 };
 
 #endif
@@ -188,7 +188,7 @@ ParseFlags(const TCHAR* src, Waypoint &dest)
 }
 
 bool
-WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
+WaypointReaderWinPilot::ParseLine(const TCHAR *line, StagedWaypoints &waypoints)
 {
   TCHAR ctemp[4096];
   const TCHAR *params[20];
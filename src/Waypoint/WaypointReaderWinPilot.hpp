@@ -39,9 +39,13 @@ public:
     :WaypointReaderBase(_factory),
      first(true), welt2000_format(false) {}
 
-protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, StagedWaypoints &way_points) override;
+
+  WaypointReaderBase *Fork() const override {
+    /* the first comment line may still switch to WELT2000 format */
+    return first ? nullptr : new WaypointReaderWinPilot(*this);
+  }
 };
 
 #endif
@@ -31,9 +31,12 @@ public:
   explicit WaypointReaderZander(WaypointFactory _factory)
     :WaypointReaderBase(_factory) {}
 
-protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+  bool ParseLine(const TCHAR *line, StagedWaypoints &way_points) override;
+
+  WaypointReaderBase *Fork() const override {
+    return new WaypointReaderZander(*this);
+  }
 };
 
 #endif
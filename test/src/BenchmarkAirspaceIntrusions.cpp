@@ -0,0 +1,199 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the throughput of finding the airspace
+ * intrusions of a corpus of flights: the classic method which calls
+ * Airspaces::QueryInside() for each fix, and FindAirspaceIntrusions()
+ * with and without a thread pool.  It verifies that all methods give
+ * the same results.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceIntrusions.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "NMEA/Aircraft.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+#include "DebugReplayIGC.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Each method is run this many times over the whole corpus.
+ */
+static constexpr unsigned N_ROUNDS = 5;
+
+typedef std::vector<std::pair<unsigned, const AbstractAirspace *>> HitList;
+
+/**
+ * Load the fixes which are relevant for airspace intrusions, just
+ * like the Python method Airspaces.findIntrusions() does.
+ */
+static std::vector<AircraftState>
+LoadFlight(Path path)
+{
+  std::vector<AircraftState> fixes;
+
+  std::unique_ptr<DebugReplay> replay(DebugReplayIGC::Create(path));
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    fixes.push_back(ToAircraftState(basic, replay->Calculated()));
+  }
+
+  return fixes;
+}
+
+static HitList
+QueryEachFix(const Airspaces &airspaces,
+             const std::vector<AircraftState> &fixes)
+{
+  HitList result;
+  for (unsigned i = 0; i < fixes.size(); ++i)
+    for (const auto &airspace : airspaces.QueryInside(fixes[i]))
+      result.emplace_back(i, &airspace.GetAirspace());
+
+  return result;
+}
+
+static HitList
+FindIntrusions(const Airspaces &airspaces,
+               const std::vector<AircraftState> &fixes,
+               const AirspaceParallelFunction &parallel)
+{
+  HitList result;
+  VisitAirspaceIntrusions(FindAirspaceIntrusions(airspaces, fixes.data(),
+                                                 fixes.size(), parallel),
+                          [&result](unsigned fix,
+                                    const AirspaceIntrusion &intrusion){
+                            result.emplace_back(fix, intrusion.airspace);
+                          });
+  return result;
+}
+
+template<typename F>
+static bool
+Measure(const char *name,
+        const std::vector<std::vector<AircraftState>> &flights,
+        const std::vector<HitList> &expected, F &&f)
+{
+  unsigned n_fixes = 0;
+  for (const auto &i : flights)
+    n_fixes += i.size();
+
+  bool success = true;
+
+  const auto start = MonotonicClockUS();
+  for (unsigned round = 0; round < N_ROUNDS; ++round)
+    for (unsigned i = 0; i < flights.size(); ++i)
+      if (f(flights[i]) != expected[i])
+        success = false;
+
+  const double seconds = (MonotonicClockUS() - start) / 1000000.;
+
+  printf("%s: %.3fs (%.0f fixes/s)%s\n", name, seconds,
+         seconds > 0 ? N_ROUNDS * n_fixes / seconds : 0.,
+         success ? "" : " MISMATCH");
+  return success;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "AIRSPACES IGC...");
+  const auto airspace_path = args.ExpectNextPath();
+  if (args.IsEmpty())
+    args.UsageError();
+
+  Airspaces airspaces;
+
+  {
+    FileLineReader reader(airspace_path, Charset::AUTO);
+    AirspaceParser parser(airspaces);
+    NullOperationEnvironment operation;
+    if (!parser.Parse(reader, operation)) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  airspaces.Optimise();
+
+  std::vector<std::vector<AircraftState>> flights;
+  unsigned n_fixes = 0;
+  while (!args.IsEmpty()) {
+    flights.push_back(LoadFlight(args.ExpectNextPath()));
+    n_fixes += flights.back().size();
+  }
+
+  std::vector<HitList> expected;
+  unsigned n_hits = 0;
+  for (const auto &i : flights) {
+    expected.push_back(QueryEachFix(airspaces, i));
+    n_hits += expected.back().size();
+  }
+
+  printf("%u airspaces, %u flights, %u fixes, %u fixes inside airspaces\n",
+         unsigned(airspaces.GetSize()), unsigned(flights.size()),
+         n_fixes, n_hits);
+
+  ThreadPool pool("Intrusions", GetProcessorCount() - 1);
+
+  bool success = Measure("query each fix", flights, expected,
+                         [&airspaces](const std::vector<AircraftState> &fixes){
+                           return QueryEachFix(airspaces, fixes);
+                         });
+
+  success &= Measure("sweep", flights, expected,
+                     [&airspaces](const std::vector<AircraftState> &fixes){
+                       return FindIntrusions(airspaces, fixes, nullptr);
+                     });
+
+  char name[64];
+  snprintf(name, sizeof(name), "sweep, %u threads", pool.GetConcurrency());
+  success &= Measure(name, flights, expected,
+                     [&airspaces, &pool](const std::vector<AircraftState> &fixes){
+                       return FindIntrusions(airspaces, fixes,
+                                             [&pool](unsigned n,
+                                                     const std::function<void(unsigned)> &f){
+                                               pool.ParallelFor(n, f);
+                                             });
+                     });
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (const std::exception &exception) {
+  PrintException(exception);
+  return EXIT_FAILURE;
+}
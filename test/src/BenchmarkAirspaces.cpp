@@ -0,0 +1,248 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures how long it takes to load an airspace file,
+ * to build the airspace tree (Airspaces::Optimise()), to query it and
+ * to update the airspace warnings along simulated flights.
+ * If a count is given, a synthetic OpenAir file with that many
+ * airspaces scattered over Europe is written to PATH first.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <random>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tchar.h>
+
+static constexpr double MIN_LATITUDE = 36, MAX_LATITUDE = 70;
+static constexpr double MIN_LONGITUDE = -10, MAX_LONGITUDE = 30;
+
+static void
+WriteCoordinate(FILE *file, double value, char positive, char negative)
+{
+  const char hemisphere = value >= 0 ? positive : negative;
+  const unsigned seconds = (unsigned)lround(fabs(value) * 3600);
+  fprintf(file, "%02u:%02u:%02u %c", seconds / 3600, (seconds / 60) % 60,
+          seconds % 60, hemisphere);
+}
+
+static void
+WritePoint(FILE *file, const char *prefix, double latitude, double longitude)
+{
+  fputs(prefix, file);
+  WriteCoordinate(file, latitude, 'N', 'S');
+  fputc(' ', file);
+  WriteCoordinate(file, longitude, 'E', 'W');
+  fputc('\n', file);
+}
+
+/**
+ * Write an OpenAir file with the given number of airspaces; four out
+ * of five are polygons (with as many vertices as the arcs of real
+ * airspace files have), the others are circles.
+ */
+static void
+WriteSyntheticAirspaces(Path path, unsigned n)
+{
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == nullptr)
+    throw std::runtime_error("Failed to create file");
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> latitude(MIN_LATITUDE, MAX_LATITUDE);
+  std::uniform_real_distribution<double> longitude(MIN_LONGITUDE,
+                                                   MAX_LONGITUDE);
+  std::uniform_real_distribution<double> radius(0.02, 0.3);
+  std::uniform_int_distribution<unsigned> base(0, 60);
+  std::uniform_int_distribution<unsigned> n_vertices(8, 200);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const double lat = latitude(random), lon = longitude(random);
+    const double r = radius(random);
+
+    fprintf(file, "AC %c\nAN Synthetic %u\nAL FL%u\nAH FL%u\n",
+            "CDRQ"[i % 4], i, base(random), 100 + base(random));
+
+    if (i % 5 == 4) {
+      WritePoint(file, "V X=", lat, lon);
+      fprintf(file, "DC %.1f\n", r * 60);
+    } else {
+      const unsigned n_vertices_i = n_vertices(random);
+      for (unsigned j = 0; j < n_vertices_i; ++j) {
+        const double angle = j * 2 * M_PI / n_vertices_i;
+        WritePoint(file, "DP ", lat + r * sin(angle),
+                   lon + r * cos(angle) / cos(lat * M_PI / 180));
+      }
+    }
+
+    fputc('\n', file);
+  }
+
+  fclose(file);
+}
+
+static double
+Seconds(uint64_t start_us)
+{
+  return (MonotonicClockUS() - start_us) / 1000000.;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [COUNT]");
+  const auto path = args.ExpectNextPath();
+  if (!args.IsEmpty()) {
+    const unsigned n = strtoul(args.GetNext(), nullptr, 10);
+    if (n == 0)
+      args.UsageError();
+
+    WriteSyntheticAirspaces(path, n);
+  }
+
+  args.ExpectEnd();
+
+  Airspaces airspaces;
+
+  auto start = MonotonicClockUS();
+
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    AirspaceParser parser(airspaces);
+    NullOperationEnvironment operation;
+    if (!parser.Parse(reader, operation)) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  printf("load: %.3fs\n", Seconds(start));
+
+  start = MonotonicClockUS();
+  airspaces.Optimise();
+  printf("optimise: %.3fs (%u airspaces)\n",
+         Seconds(start), unsigned(airspaces.GetSize()));
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> latitude(MIN_LATITUDE, MAX_LATITUDE);
+  std::uniform_real_distribution<double> longitude(MIN_LONGITUDE,
+                                                   MAX_LONGITUDE);
+
+  constexpr unsigned N_QUERIES = 100000;
+  unsigned long n_results = 0;
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    const GeoPoint location(Angle::Degrees(longitude(random)),
+                            Angle::Degrees(latitude(random)));
+    for (const auto &j : airspaces.QueryWithinRange(location, 20000)) {
+      (void)j;
+      ++n_results;
+    }
+  }
+
+  const double query_duration = Seconds(start);
+  printf("query: %.3fs (%.2fus/query, %.2f results/query)\n",
+         query_duration, query_duration * 1000000. / N_QUERIES,
+         double(n_results) / N_QUERIES);
+
+  /* small deltas are inserted into the existing tree */
+  constexpr unsigned N_DELTA = 10;
+  for (unsigned pass = 0; pass < 3; ++pass) {
+    for (unsigned i = 0; i < N_DELTA; ++i)
+      airspaces.Add(new AirspaceCircle(GeoPoint(Angle::Degrees(longitude(random)),
+                                                Angle::Degrees(latitude(random))),
+                                       5000));
+
+    start = MonotonicClockUS();
+    airspaces.Optimise();
+    printf("optimise delta: %.6fs (%u airspaces)\n",
+           Seconds(start), N_DELTA);
+  }
+
+  /* fly straight lines through the airspaces, updating the warnings
+     once per second */
+  constexpr unsigned N_FLIGHTS = 50, FLIGHT_DURATION = 600;
+  std::uniform_real_distribution<double> track(0, 360);
+
+  AirspaceWarningConfig warning_config;
+  warning_config.SetDefaults();
+
+  const GlidePolar glide_polar(1);
+  TaskStats task_stats;
+  task_stats.reset();
+
+  unsigned long n_warnings = 0;
+  double warnings_duration = 0;
+
+  for (unsigned i = 0; i < N_FLIGHTS; ++i) {
+    AirspaceWarningManager warnings(warning_config, airspaces);
+
+    AircraftState state;
+    state.Reset();
+    state.location = GeoPoint(Angle::Degrees(longitude(random)),
+                              Angle::Degrees(latitude(random)));
+    state.track = Angle::Degrees(track(random));
+    state.altitude = 1500;
+    state.ground_speed = state.true_airspeed = 40;
+    state.flying = true;
+    warnings.Reset(state);
+
+    start = MonotonicClockUS();
+
+    for (unsigned t = 0; t < FLIGHT_DURATION; ++t) {
+      state.time = t;
+      state.location = GeoVector(state.ground_speed, state.track)
+        .EndPoint(state.location);
+
+      warnings.Update(state, glide_polar, task_stats, false, 1);
+      n_warnings += warnings.size();
+    }
+
+    warnings_duration += Seconds(start);
+  }
+
+  printf("warnings: %.3fs (%.2fus/update, %.2f warnings/update)\n",
+         warnings_duration,
+         warnings_duration * 1000000. / (N_FLIGHTS * FLIGHT_DURATION),
+         double(n_warnings) / (N_FLIGHTS * FLIGHT_DURATION));
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program parses a corpus of IGC files repeatedly, once with
+ * #FileLineReaderA (which copies and converts each line) and once
+ * with #IGCMappedReader (which parses the records in place), and
+ * reports the throughput of both.
+ */
+
+#include "IGC/IGCMappedReader.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/Path.hpp"
+#include "Util/PrintException.hxx"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Accumulates the parsed fixes, to verify that both readers produce
+ * the same result (and to keep the compiler from discarding the
+ * parser calls).
+ */
+struct Result {
+  uint64_t n_bytes = 0, n_fixes = 0;
+  int64_t altitude_sum = 0;
+
+  void Add(const IGCFix &fix) {
+    ++n_fixes;
+    altitude_sum += fix.gps_altitude + fix.pressure_altitude + fix.enl;
+  }
+
+  bool operator==(const Result &other) const {
+    return n_bytes == other.n_bytes && n_fixes == other.n_fixes &&
+      altitude_sum == other.altitude_sum;
+  }
+};
+
+static void
+ParseLines(Path path, Result &result)
+{
+  FileLineReaderA reader(path);
+  result.n_bytes += reader.GetSize();
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    if (line[0] == 'B') {
+      IGCFix fix;
+      if (IGCParseFix(line, extensions, fix))
+        result.Add(fix);
+    } else if (line[0] == 'I')
+      IGCParseExtensions(line, extensions);
+  }
+}
+
+static void
+ParseMapped(Path path, Result &result)
+{
+  IGCMappedReader reader(path);
+  result.n_bytes += reader.GetSize();
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  const char *line;
+  size_t length;
+  while (reader.ReadLine(line, length)) {
+    if (length == 0)
+      continue;
+
+    if (line[0] == 'B') {
+      IGCFix fix;
+      if (IGCParseFix(line, length, extensions, fix))
+        result.Add(fix);
+    } else if (line[0] == 'I')
+      IGCParseExtensions(line, length, extensions);
+  }
+}
+
+template<typename F>
+static Result
+Run(const char *name, const std::vector<AllocatedPath> &paths,
+    unsigned n_passes, F &&f)
+{
+  Result result;
+
+  const auto start = MonotonicClockUS();
+
+  for (unsigned pass = 0; pass < n_passes; ++pass)
+    for (const auto &path : paths)
+      f(path, result);
+
+  const double duration = (MonotonicClockUS() - start) / 1000000.;
+  const double mb = result.n_bytes / (1024. * 1024.);
+
+  printf("%s: files=%u fixes=%llu size=%.1fMB time=%.3fs MB/s=%.1f\n",
+         name, unsigned(paths.size() * n_passes),
+         (unsigned long long)result.n_fixes, mb, duration,
+         duration > 0 ? mb / duration : 0.);
+
+  return result;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[--passes=N] FILE.igc ...");
+
+  unsigned n_passes = 10;
+  const char *p = args.PeekNext();
+  if (p != nullptr && strncmp(p, "--passes=", 9) == 0) {
+    args.Skip();
+    n_passes = strtoul(p + 9, nullptr, 10);
+    if (n_passes == 0)
+      args.UsageError();
+  }
+
+  std::vector<AllocatedPath> paths;
+  do {
+    paths.emplace_back(args.ExpectNextPath());
+  } while (!args.IsEmpty());
+
+  const Result lines = Run("FileLineReader", paths, n_passes, ParseLines);
+  const Result mapped = Run("IGCMappedReader", paths, n_passes, ParseMapped);
+
+  if (!(lines == mapped)) {
+    fprintf(stderr, "Results differ\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
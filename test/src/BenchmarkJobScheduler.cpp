@@ -0,0 +1,156 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program runs batches of synthetic jobs of different sizes
+ * with #ThreadPool and with #JobScheduler, and reports the time per
+ * job, to measure the scheduling overhead.  The last test runs
+ * nested batches, which only #JobScheduler supports.
+ */
+
+#include "Thread/JobScheduler.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Util/NumberParser.hpp"
+#include "Util/PrintException.hxx"
+
+#include <atomic>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_JOBS = 100000;
+
+/**
+ * Burn the given number of iterations; the result is used to keep
+ * the compiler from optimising the loop away.
+ */
+static unsigned
+Work(unsigned seed, unsigned iterations)
+{
+  unsigned x = seed;
+  for (unsigned i = 0; i < iterations; ++i)
+    x = x * 1103515245u + 12345u;
+  return x;
+}
+
+static std::atomic<unsigned> sink(0);
+
+static void
+Print(const char *name, unsigned n_threads, unsigned grain, uint64_t start)
+{
+  const double duration = MonotonicClockUS() - start;
+
+  printf("%s threads=%u grain=%u time/job=%.3fus\n",
+         name, n_threads, grain, duration / N_JOBS);
+}
+
+static void
+RunSerial(unsigned grain)
+{
+  const auto start = MonotonicClockUS();
+
+  unsigned x = 0;
+  for (unsigned i = 0; i < N_JOBS; ++i)
+    x += Work(i, grain);
+  sink += x;
+
+  Print("serial", 1, grain, start);
+}
+
+static void
+RunThreadPool(unsigned n_threads, unsigned grain)
+{
+  ThreadPool pool("Benchmark", n_threads - 1);
+
+  const auto start = MonotonicClockUS();
+
+  pool.ParallelFor(N_JOBS, [grain](unsigned i){
+      sink += Work(i, grain);
+    });
+
+  Print("ThreadPool", n_threads, grain, start);
+}
+
+static void
+RunJobScheduler(unsigned n_threads, unsigned grain)
+{
+  JobScheduler scheduler("Benchmark", n_threads - 1);
+
+  const auto start = MonotonicClockUS();
+
+  scheduler.ParallelFor(N_JOBS, [grain](unsigned i){
+      sink += Work(i, grain);
+    });
+
+  Print("JobScheduler", n_threads, grain, start);
+}
+
+static void
+RunNested(unsigned n_threads, unsigned grain)
+{
+  JobScheduler scheduler("Benchmark", n_threads - 1);
+
+  static constexpr unsigned N_OUTER = 100;
+
+  const auto start = MonotonicClockUS();
+
+  scheduler.ParallelFor(N_OUTER, [&scheduler, grain](unsigned i){
+      scheduler.ParallelFor(N_JOBS / N_OUTER, [i, grain](unsigned j){
+          sink += Work(i * N_JOBS + j, grain);
+        });
+    });
+
+  Print("JobScheduler/nested", n_threads, grain, start);
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[MAX_THREADS]");
+  unsigned max_threads = GetProcessorCount();
+  if (!args.IsEmpty()) {
+    max_threads = ParseUnsigned(args.GetNext());
+    if (max_threads == 0)
+      args.UsageError();
+  }
+  args.ExpectEnd();
+
+  static constexpr unsigned grains[] = { 10, 1000, 100000 };
+
+  for (const unsigned grain : grains) {
+    RunSerial(grain);
+
+    for (unsigned n_threads = 1; n_threads <= max_threads; ++n_threads) {
+      RunThreadPool(n_threads, grain);
+      RunJobScheduler(n_threads, grain);
+      RunNested(n_threads, grain);
+    }
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::exception &exception) {
+  PrintException(exception);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program compares the speed of #TaskDistanceSolver with
+ * #TaskDijkstraMin and #TaskDijkstraMax on a large AAT task whose
+ * areas are sampled with many boundary points, and verifies that
+ * both find paths with the same distance.
+ */
+
+#include "Engine/Task/PathSolvers/TaskDistanceSolver.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMin.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Util/PrintException.hxx"
+
+#include <vector>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Create the boundaries of an AAT task: cylinders with a radius of
+ * 20 km along a zig-zag course.
+ */
+static std::vector<SearchPointVector>
+MakeTask(unsigned n_stages, unsigned n_points)
+{
+  std::vector<SearchPointVector> task(n_stages);
+
+  GeoPoint center(Angle::Degrees(7.7), Angle::Degrees(51.0));
+  for (unsigned stage = 0; stage < n_stages; ++stage) {
+    for (unsigned i = 0; i < n_points; ++i) {
+      const GeoVector v(20000, Angle::Degrees(360. * i / n_points));
+      task[stage].emplace_back(v.EndPoint(center));
+    }
+
+    center = GeoVector(100000, Angle::Degrees(stage % 2 == 0 ? 60 : 120))
+      .EndPoint(center);
+  }
+
+  return task;
+}
+
+/**
+ * Sum up the distances of a solution in the same way the solvers do.
+ */
+template<typename S>
+static unsigned
+GetTotal(const S &solver, unsigned n_stages, const SearchPoint *location)
+{
+  unsigned total = location != nullptr
+    ? (unsigned)solver.GetSolution(0).GetLocation().Distance(location->GetLocation())
+    : 0;
+
+  for (unsigned stage = 1; stage < n_stages; ++stage)
+    total += (unsigned)solver.GetSolution(stage - 1).GetLocation()
+      .Distance(solver.GetSolution(stage).GetLocation());
+
+  return total;
+}
+
+template<typename S>
+static void
+SetTask(S &solver, const std::vector<SearchPointVector> &task)
+{
+  solver.SetTaskSize(task.size());
+  for (unsigned i = 0; i < task.size(); ++i)
+    solver.SetBoundary(i, task[i]);
+}
+
+static void
+Print(const char *name, unsigned total, unsigned n, uint64_t start)
+{
+  const double duration = (MonotonicClockUS() - start) / 1000.;
+
+  printf("%s distance=%u time=%.3fms\n", name, total, duration / n);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[STAGES [POINTS [ITERATIONS]]]");
+  const unsigned n_stages = args.IsEmpty()
+    ? 12 : strtoul(args.GetNext(), nullptr, 10);
+  const unsigned n_points = args.IsEmpty()
+    ? 200 : strtoul(args.GetNext(), nullptr, 10);
+  const unsigned n = args.IsEmpty()
+    ? 10 : strtoul(args.GetNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  if (n_stages < 2 || n_stages > TaskDistanceSolver::MAX_STAGES ||
+      n_points == 0 || n == 0)
+    args.UsageError();
+
+  const auto task = MakeTask(n_stages, n_points);
+  const SearchPoint location(GeoVector(50000, Angle::Degrees(200))
+                             .EndPoint(task.front().front().GetLocation()));
+
+  TaskDijkstraMin dijkstra_min;
+  SetTask(dijkstra_min, task);
+
+  auto start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    if (!dijkstra_min.DistanceMin(location))
+      throw std::runtime_error("TaskDijkstraMin failed");
+
+  const unsigned expected_min = GetTotal(dijkstra_min, n_stages, &location);
+  Print("dijkstra min", expected_min, n, start);
+
+  TaskDistanceSolver solver_min(true);
+  SetTask(solver_min, task);
+
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    if (!solver_min.DistanceMin(location))
+      throw std::runtime_error("TaskDistanceSolver failed");
+
+  const unsigned total_min = GetTotal(solver_min, n_stages, &location);
+  Print("layered min", total_min, n, start);
+
+  TaskDijkstraMax dijkstra_max;
+  SetTask(dijkstra_max, task);
+
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    if (!dijkstra_max.DistanceMax())
+      throw std::runtime_error("TaskDijkstraMax failed");
+
+  const unsigned expected_max = GetTotal(dijkstra_max, n_stages, nullptr);
+  Print("dijkstra max", expected_max, n, start);
+
+  TaskDistanceSolver solver_max(false);
+  SetTask(solver_max, task);
+
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    if (!solver_max.DistanceMax())
+      throw std::runtime_error("TaskDistanceSolver failed");
+
+  const unsigned total_max = GetTotal(solver_max, n_stages, nullptr);
+  Print("layered max", total_max, n, start);
+
+  if (total_min != expected_min || total_max != expected_max)
+    throw std::runtime_error("Results differ");
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
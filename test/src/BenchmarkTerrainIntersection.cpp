@@ -0,0 +1,202 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program measures the terrain intersection searches of
+ * RasterTileCache on a map file, and compares them with the previous
+ * implementation which stepped through each pixel.  It runs random
+ * glides at several heights, first with only the overview loaded and
+ * then with all tiles loaded.
+ */
+
+#include "ReferenceIntersection.hpp"
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/Loader.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_QUERIES = 2000;
+
+/**
+ * The maximum length of a glide [pixels].
+ */
+static constexpr int MAX_DISTANCE = 600;
+
+struct Query {
+  SignedRasterLocation origin, destination;
+  int h_origin, slope_fact;
+};
+
+static int
+Random(int min, int max)
+{
+  return min + rand() % (max - min + 1);
+}
+
+static std::vector<Query>
+MakeQueries(const RasterTileCache &rtc, int height)
+{
+  std::vector<Query> queries;
+  while (queries.size() < N_QUERIES) {
+    const SignedRasterLocation origin(Random(0, rtc.GetWidth() - 1),
+                                      Random(0, rtc.GetHeight() - 1));
+    const SignedRasterLocation destination(origin.x + Random(-MAX_DISTANCE,
+                                                             MAX_DISTANCE),
+                                           origin.y + Random(-MAX_DISTANCE,
+                                                             MAX_DISTANCE));
+    const int c_diff = abs(destination.x - origin.x)
+      + abs(destination.y - origin.y);
+    if (c_diff == 0)
+      continue;
+
+    const TerrainHeight h = rtc.GetFieldDirect(origin.x, origin.y).first;
+    if (h.IsInvalid())
+      continue;
+
+    /* lose about one meter per pixel */
+    queries.push_back({origin, destination, h.GetValueOr0() + height,
+                       1 << RASTER_SLOPE_FACT});
+  }
+
+  return queries;
+}
+
+template<typename F>
+static double
+Measure(const std::vector<Query> &queries, F &&f)
+{
+  const auto start = MonotonicClockUS();
+  for (const auto &q : queries)
+    f(q);
+  return double(MonotonicClockUS() - start) / queries.size();
+}
+
+static void
+Run(const RasterTileCache &rtc, const char *name)
+{
+  static constexpr int heights[] = { 100, 300, 1000, 3000 };
+
+  for (const int height : heights) {
+    const auto queries = MakeQueries(rtc, height);
+
+    /* Intersection() */
+
+    std::vector<SignedRasterLocation> results1, results2;
+    const double reference = Measure(queries, [&](const Query &q){
+        results1.push_back(ReferenceIntersection(rtc, q.origin,
+                                                 q.destination,
+                                                 q.h_origin, q.slope_fact,
+                                                 0));
+      });
+    const double optimised = Measure(queries, [&](const Query &q){
+        results2.push_back(rtc.Intersection(q.origin, q.destination,
+                                            q.h_origin, q.slope_fact, 0));
+      });
+
+    printf("%s height=%d Intersection reference=%.2fus new=%.2fus speedup=%.1f%s\n",
+           name, height, reference, optimised,
+           optimised > 0 ? reference / optimised : 0.,
+           results1 == results2 ? "" : " MISMATCH");
+
+    /* FirstIntersection(), climbing from the ground to the given
+       height at the destination */
+
+    struct Result {
+      bool found;
+      RasterLocation location;
+      int h;
+
+      bool operator==(const Result &other) const {
+        return found == other.found &&
+          (!found || (location == other.location && h == other.h));
+      }
+    };
+
+    std::vector<Result> first1, first2;
+    const double first_reference = Measure(queries, [&](const Query &q){
+        Result r{false, RasterLocation(0, 0), 0};
+        r.found = ReferenceFirstIntersection(rtc, q.origin, q.destination,
+                                             q.h_origin - height, q.h_origin,
+                                             q.slope_fact, 32000, 0,
+                                             r.location, r.h, false);
+        first1.push_back(r);
+      });
+    const double first_optimised = Measure(queries, [&](const Query &q){
+        Result r{false, RasterLocation(0, 0), 0};
+        r.found = rtc.FirstIntersection(q.origin, q.destination,
+                                        q.h_origin - height, q.h_origin,
+                                        q.slope_fact, 32000, 0,
+                                        r.location, r.h, false);
+        first2.push_back(r);
+      });
+
+    printf("%s height=%d FirstIntersection reference=%.2fus new=%.2fus speedup=%.1f%s\n",
+           name, height, first_reference, first_optimised,
+           first_optimised > 0 ? first_reference / first_optimised : 0.,
+           first1 == first2 ? "" : " MISMATCH");
+  }
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  NullOperationEnvironment operation;
+  std::unique_ptr<RasterTileCache> rtc(new RasterTileCache());
+  if (!LoadTerrainOverview(archive.get(), *rtc, operation)) {
+    fprintf(stderr, "LoadOverview failed\n");
+    return EXIT_FAILURE;
+  }
+
+  srand(42);
+  Run(*rtc, "overview");
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), *rtc, mutex,
+                       rtc->GetWidth() / 2, rtc->GetHeight() / 2,
+                       std::max(rtc->GetWidth(), rtc->GetHeight()));
+  } while (rtc->IsDirty());
+
+  srand(42);
+  Run(*rtc, "tiles");
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
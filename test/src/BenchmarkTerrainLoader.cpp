@@ -0,0 +1,123 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program loads the terrain from a map file repeatedly, with an
+ * increasing number of tile decoder threads, and reports the tile
+ * decoding throughput.  If a store path is given, it then measures
+ * how fast the tiles can be restored from a #RasterTileStore.
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/RasterTileStore.hpp"
+#include "Terrain/Loader.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <memory>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static AllocatedPath store_path = nullptr;
+
+static void
+Run(Path map_path, unsigned n_threads, RasterTileStore *store=nullptr)
+{
+  ZipArchive archive(map_path);
+
+  NullOperationEnvironment operation;
+  std::unique_ptr<RasterTileCache> rtc(new RasterTileCache());
+  if (!LoadTerrainOverview(archive.get(), *rtc, operation))
+    throw std::runtime_error("LoadOverview failed");
+
+  if (store != nullptr) {
+    if (!store->IsDefined() &&
+        !store->Open(store_path, map_path,
+                     rtc->GetTileWidth(), rtc->GetTileHeight(),
+                     rtc->GetTileCount()))
+      throw std::runtime_error("Failed to open the tile store");
+
+    rtc->SetStore(store);
+  }
+
+  JobScheduler scheduler("Benchmark", n_threads - 1);
+  SharedMutex mutex;
+
+  const auto start = MonotonicClockUS();
+
+  do {
+    UpdateTerrainTiles(map_path, *rtc, mutex, scheduler, n_threads,
+                       rtc->GetWidth() / 2, rtc->GetHeight() / 2, 1000);
+  } while (rtc->IsDirty());
+
+  const double duration = (MonotonicClockUS() - start) / 1000000.;
+  const unsigned n_tiles = rtc->GetActiveTileCount();
+
+  printf("threads=%u tiles=%u time=%.3fs tiles/s=%.1f\n",
+         n_threads, n_tiles, duration,
+         duration > 0 ? n_tiles / duration : 0.);
+
+  if (store != nullptr)
+    printf("store hits=%u misses=%u\n",
+           store->GetHits(), store->GetMisses());
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [MAX_THREADS [STORE_PATH]]");
+  const auto map_path = args.ExpectNextPath();
+
+  unsigned max_threads = GetProcessorCount();
+  if (!args.IsEmpty()) {
+    max_threads = strtoul(args.GetNext(), nullptr, 10);
+    if (max_threads == 0)
+      args.UsageError();
+  }
+
+  if (!args.IsEmpty())
+    store_path = args.ExpectNextPath();
+
+  args.ExpectEnd();
+
+  for (unsigned n = 1; n <= max_threads; ++n)
+    Run(map_path, n);
+
+  if (!store_path.IsNull()) {
+    /* the first run fills the store, the second one restores the
+       tiles from it */
+    RasterTileStore store;
+    Run(map_path, 1, &store);
+    Run(map_path, 1, &store);
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
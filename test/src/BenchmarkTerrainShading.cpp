@@ -0,0 +1,203 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program fills a #HeightMatrix like RunHeightMatrix, and then
+ * measures the portable and the optimised shading kernels used by
+ * #RasterRenderer, verifying that both produce the same output.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/ShadingKernels.hpp"
+#include "Terrain/Loader.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <memory>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+static constexpr unsigned WIDTH = 1280, HEIGHT = 800;
+static constexpr unsigned ITERATIONS = 20;
+
+typedef void (*HeightIndicesFunction)(uint8_t *gcc_restrict heights,
+                                      uint8_t *gcc_restrict contours,
+                                      const TerrainHeight *gcc_restrict src,
+                                      unsigned n,
+                                      unsigned height_scale,
+                                      unsigned contour_height_scale);
+
+typedef void (*SlopeShadingFunction)(int8_t *gcc_restrict dest,
+                                     const TerrainHeight *above,
+                                     const TerrainHeight *src,
+                                     const TerrainHeight *below,
+                                     unsigned n, unsigned column_offset,
+                                     unsigned p31,
+                                     const SlopeShadingParameters &s);
+
+/**
+ * Run the kernels over all inner rows of the matrix, and store the
+ * results in the given buffers.
+ */
+static void
+RunKernels(const HeightMatrix &matrix, unsigned q,
+           const SlopeShadingParameters &s,
+           HeightIndicesFunction height_indices,
+           SlopeShadingFunction slope_shading,
+           uint8_t *heights, uint8_t *contours, int8_t *shades)
+{
+  const unsigned width = matrix.GetWidth();
+
+  for (unsigned y = q; y + q < matrix.GetHeight(); ++y) {
+    const TerrainHeight *src = matrix.GetRow(y);
+
+    height_indices(heights, contours, src, width, 4, 7);
+    slope_shading(shades + q, matrix.GetRow(y - q) + q, src + q,
+                  matrix.GetRow(y + q) + q,
+                  width - 2 * q, q, 2 * q, s);
+
+    heights += width;
+    contours += width;
+    shades += width;
+  }
+}
+
+static double
+Measure(const HeightMatrix &matrix, unsigned q,
+        const SlopeShadingParameters &s,
+        HeightIndicesFunction height_indices,
+        SlopeShadingFunction slope_shading,
+        uint8_t *heights, uint8_t *contours, int8_t *shades)
+{
+  const auto start = MonotonicClockUS();
+
+  for (unsigned i = 0; i < ITERATIONS; ++i)
+    RunKernels(matrix, q, s, height_indices, slope_shading,
+               heights, contours, shades);
+
+  return (MonotonicClockUS() - start) / 1000. / ITERATIONS;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [QUANTISATION]");
+  const auto map_path = args.ExpectNextPath();
+
+  unsigned q = 1;
+  if (!args.IsEmpty()) {
+    q = strtoul(args.GetNext(), nullptr, 10);
+    if (q == 0 || q > 25)
+      args.UsageError();
+  }
+
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  NullOperationEnvironment operation;
+  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(),
+                           operation)) {
+    fprintf(stderr, "failed to load map\n");
+    return EXIT_FAILURE;
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  double radius = 50000;
+  WindowProjection projection;
+  projection.SetScreenSize({WIDTH, HEIGHT});
+  projection.SetScaleFromRadius(radius);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(WIDTH / 2, HEIGHT / 2);
+  projection.UpdateScreenBounds();
+
+  HeightMatrix matrix;
+#ifdef ENABLE_OPENGL
+  matrix.Fill(map, projection.GetScreenBounds(),
+              projection.GetScreenWidth(), projection.GetScreenHeight(),
+              true);
+#else
+  matrix.Fill(map, projection, 1, true);
+#endif
+
+  SlopeShadingParameters s;
+  s.sx = -148;
+  s.sy = 148;
+  s.sz = 104;
+  s.contrast = 64;
+  s.height_slope_factor = std::min(250u, 8192u / (q * q));
+
+  const size_t size = matrix.GetWidth() * matrix.GetHeight();
+  std::unique_ptr<uint8_t[]> heights1(new uint8_t[size]()),
+    contours1(new uint8_t[size]()),
+    heights2(new uint8_t[size]()),
+    contours2(new uint8_t[size]());
+  std::unique_ptr<int8_t[]> shades1(new int8_t[size]()),
+    shades2(new int8_t[size]());
+
+  const double portable = Measure(matrix, q, s,
+                                  PortableCalculateHeightIndices,
+                                  PortableCalculateSlopeShading,
+                                  heights1.get(), contours1.get(),
+                                  shades1.get());
+  const double optimised = Measure(matrix, q, s,
+                                   CalculateHeightIndices,
+                                   CalculateSlopeShading,
+                                   heights2.get(), contours2.get(),
+                                   shades2.get());
+
+  printf("matrix=%ux%u portable=%.3fms optimised=%.3fms speedup=%.2f\n",
+         matrix.GetWidth(), matrix.GetHeight(), portable, optimised,
+         optimised > 0 ? portable / optimised : 0.);
+
+  if (memcmp(heights1.get(), heights2.get(), size) != 0 ||
+      memcmp(contours1.get(), contours2.get(), size) != 0 ||
+      memcmp(shades1.get(), shades2.get(), size) != 0) {
+    fprintf(stderr, "Output mismatch\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program loads a waypoint file with ReadWaypointFile(), and
+ * then with #ParallelWaypointReader with an increasing number of
+ * threads, and reports the time needed to build the #Waypoints
+ * database.
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/ParallelWaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Thread/JobScheduler.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <stdexcept>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void
+Print(const char *name, unsigned n_threads, const Waypoints &way_points,
+      uint64_t start)
+{
+  const double duration = (MonotonicClockUS() - start) / 1000000.;
+
+  printf("%s threads=%u waypoints=%u time=%.3fs\n",
+         name, n_threads, way_points.size(), duration);
+}
+
+/**
+ * Returns all waypoints, indexed by their id.
+ */
+static std::vector<WaypointPtr>
+GetById(const Waypoints &way_points)
+{
+  std::vector<WaypointPtr> result(way_points.size() + 1);
+  for (const auto &wp : way_points)
+    if (wp->id < result.size())
+      result[wp->id] = wp;
+  return result;
+}
+
+/**
+ * Check whether the parallel reader has produced the same waypoints
+ * with the same ids.
+ */
+static bool
+IsEqual(const Waypoints &a, const Waypoints &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  const auto x = GetById(a), y = GetById(b);
+  for (unsigned id = 1; id < x.size(); ++id)
+    if (x[id] == nullptr || y[id] == nullptr ||
+        x[id]->name != y[id]->name || x[id]->location != y[id]->location)
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [MAX_THREADS]");
+  const auto path = args.ExpectNextPath();
+
+  unsigned max_threads = GetProcessorCount();
+  if (!args.IsEmpty()) {
+    max_threads = strtoul(args.GetNext(), nullptr, 10);
+    if (max_threads == 0)
+      args.UsageError();
+  }
+
+  args.ExpectEnd();
+
+  NullOperationEnvironment operation;
+  const WaypointFactory factory(WaypointOrigin::PRIMARY);
+
+  Waypoints expected;
+  auto start = MonotonicClockUS();
+  if (!ReadWaypointFile(path, expected, factory, operation))
+    throw std::runtime_error("ReadWaypointFile() has failed");
+
+  expected.Optimise();
+  Print("serial", 1, expected, start);
+
+  for (unsigned n = 1; n <= max_threads; ++n) {
+    JobScheduler scheduler("Benchmark", n - 1);
+
+    Waypoints way_points;
+    start = MonotonicClockUS();
+
+    ParallelWaypointReader reader;
+    reader.Add(path, factory);
+    reader.Run(scheduler, way_points, operation);
+    way_points.Optimise();
+
+    Print("parallel", n, way_points, start);
+
+    if (!reader.IsSuccessful(0) || !IsEqual(way_points, expected))
+      throw std::runtime_error("Parallel result differs");
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
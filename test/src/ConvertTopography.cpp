@@ -0,0 +1,94 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program converts the topography of a map file to a pack (see
+ * TopographyPackFormat.hpp), which is what XCSoar stores in its
+ * cache, and prints the size of each layer.
+ */
+
+#include "Topography/TopographyPack.hpp"
+#include "Topography/TopographyPackWriter.hpp"
+#include "OS/Args.hpp"
+#include "OS/Path.hpp"
+#include "IO/ZipArchive.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/NumberParser.hpp"
+#include "Util/PrintException.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "MAPFILE OUTFILE [LAYOUT_SCALE]");
+  const auto map_path = args.ExpectNextPath();
+  const auto out_path = args.ExpectNextPath();
+  const unsigned layout_scale = args.IsEmpty()
+    ? 1 : ParseUnsigned(args.GetNext());
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  NullOperationEnvironment operation;
+  std::vector<uint8_t> buffer;
+
+  {
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+    BuildTopographyPack(archive.get(), reader, layout_scale, buffer,
+                        operation);
+  }
+
+  const size_t size = buffer.size();
+
+  FILE *file = _tfopen(out_path.c_str(), _T("wb"));
+  if (file == nullptr) {
+    fprintf(stderr, "Failed to create output file\n");
+    return EXIT_FAILURE;
+  }
+
+  const bool success = WriteTopographyPack(file, buffer);
+  if (fclose(file) != 0 || !success) {
+    fprintf(stderr, "Failed to write output file\n");
+    return EXIT_FAILURE;
+  }
+
+  TopographyPack pack;
+  if (!pack.Open(out_path, 0, layout_scale)) {
+    fprintf(stderr, "Malformed topography pack\n");
+    return EXIT_FAILURE;
+  }
+
+  for (unsigned i = 0; i < pack.size(); ++i) {
+    const auto &layer = pack[i];
+    printf("%-24s %8u shapes %6u nodes\n",
+           layer.name, layer.n_shapes, layer.n_nodes);
+  }
+
+  printf("%u layers, %lu bytes\n", pack.size(), (unsigned long)size);
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -22,7 +22,6 @@ Copyright_License {
 */
 
 #include "DebugReplayIGC.hpp"
-#include "IO/FileLineReader.hpp"
 #include "IGC/IGCParser.hpp"
 #include "IGC/IGCFix.hpp"
 #include "Units/System.hpp"
@@ -31,8 +30,7 @@ Copyright_License {
 DebugReplay*
 DebugReplayIGC::Create(Path input_file)
 {
-  FileLineReaderA *reader = new FileLineReaderA(input_file);
-  return new DebugReplayIGC(reader);
+  return new DebugReplayIGC(input_file);
 }
 
 bool
@@ -41,10 +39,14 @@ DebugReplayIGC::Next()
   last_basic = computed_basic;
 
   const char *line;
-  while ((line = reader->ReadLine()) != NULL) {
+  size_t length;
+  while (reader.ReadLine(line, length)) {
+    if (length == 0)
+      continue;
+
     if (line[0] == 'B') {
       IGCFix fix;
-      if (IGCParseFix(line, extensions, fix)) {
+      if (IGCParseFix(line, length, extensions, fix)) {
         CopyFromFix(fix);
 
         Compute();
@@ -52,13 +54,12 @@ DebugReplayIGC::Next()
       }
     } else if (line[0] == 'H') {
       BrokenDate date;
-      if (memcmp(line, "HFDTE", 5) == 0 &&
-          IGCParseDateRecord(line, date)) {
+      if (IGCParseDateRecord(line, length, date)) {
         (BrokenDate &)raw_basic.date_time_utc = date;
         raw_basic.time_available.Clear();
       }
     } else if (line[0] == 'I') {
-      IGCParseExtensions(line, extensions);
+      IGCParseExtensions(line, length, extensions);
     }
   }
 
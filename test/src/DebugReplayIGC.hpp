@@ -24,22 +24,36 @@ Copyright_License {
 #ifndef XCSOAR_DEBUG_REPLAY_IGC_HPP
 #define XCSOAR_DEBUG_REPLAY_IGC_HPP
 
-#include "DebugReplayFile.hpp"
+#include "DebugReplay.hpp"
 #include "IGC/IGCExtensions.hpp"
-#include "IO/FileLineReader.hpp"
+#include "IGC/IGCMappedReader.hpp"
 
 struct IGCFix;
 
-class DebugReplayIGC : public DebugReplayFile {
+/**
+ * Replays an IGC file.  The file is mapped into memory, and the
+ * records are parsed in place.
+ */
+class DebugReplayIGC : public DebugReplay {
+  IGCMappedReader reader;
+
   IGCExtensions extensions;
 
 private:
-  DebugReplayIGC(FileLineReaderA *_reader)
-    : DebugReplayFile(_reader) {
+  explicit DebugReplayIGC(Path path)
+    :reader(path) {
     extensions.clear();
   }
 
 public:
+  long Size() const {
+    return reader.GetSize();
+  }
+
+  long Tell() const {
+    return reader.Tell();
+  }
+
   virtual bool Next();
 
   static DebugReplay *Create(Path input_file);
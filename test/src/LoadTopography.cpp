@@ -22,13 +22,13 @@ Copyright_License {
 */
 
 /*
- * This program loads the topography from a map file and exits.  Useful
- * for valgrind and profiling.
+ * This program converts the topography of a map file, loads it and
+ * exits.  Useful for valgrind and profiling.
  */
 
 #include "Topography/TopographyStore.hpp"
-#include "Topography/TopographyFile.hpp"
-#include "Topography/XShape.hpp"
+#include "Topography/TopographyPack.hpp"
+#include "Topography/TopographyPackWriter.hpp"
 #include "OS/Args.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
@@ -38,29 +38,6 @@ Copyright_License {
 #include <stdio.h>
 #include <tchar.h>
 
-#ifdef ENABLE_OPENGL
-
-static void
-TriangulateAll(const TopographyFile &file)
-{
-  const ScopeLock protect(file.mutex);
-
-  const unsigned short *count;
-  for (const XShape &shape : file)
-    if (shape.get_type() == MS_SHAPE_POLYGON)
-      for (unsigned i = 0; i < 4; ++i)
-        shape.GetIndices(i, 1, count);
-}
-
-static void
-TriangulateAll(const TopographyStore &store)
-{
-  for (unsigned i = 0; i < store.size(); ++i)
-    TriangulateAll(store[i]);
-}
-
-#endif
-
 int main(int argc, char **argv)
 try {
   Args args(argc, argv, "PATH");
@@ -69,18 +46,28 @@ try {
 
   ZipArchive archive(path);
 
+  NullOperationEnvironment operation;
+
+  std::vector<uint8_t> buffer;
+
+  {
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+    BuildTopographyPack(archive.get(), reader, 1, buffer, operation);
+  }
+
+  TopographyPack pack;
+  if (!pack.Open(std::move(buffer), 1)) {
+    fprintf(stderr, "Malformed topography pack\n");
+    return EXIT_FAILURE;
+  }
+
   ZipLineReaderA reader(archive.get(), "topology.tpl");
 
   TopographyStore topography;
-  NullOperationEnvironment operation;
-  topography.Load(operation, reader, NULL, archive.get());
+  topography.Load(operation, reader, std::move(pack));
 
   topography.LoadAll();
 
-#ifdef ENABLE_OPENGL
-  TriangulateAll(topography);
-#endif
-
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
   PrintException(e);
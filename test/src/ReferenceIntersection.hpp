@@ -0,0 +1,59 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * The terrain intersection searches as they were before
+ * RasterTileCache learned to skip pixels, stepping through each
+ * pixel on the line.  Used to verify and benchmark the optimised
+ * versions.
+ */
+
+#ifndef XCSOAR_REFERENCE_INTERSECTION_HPP
+#define XCSOAR_REFERENCE_INTERSECTION_HPP
+
+#include "Terrain/RasterLocation.hpp"
+
+class RasterTileCache;
+
+/**
+ * @see RasterTileCache::FirstIntersection()
+ */
+bool
+ReferenceFirstIntersection(const RasterTileCache &rtc,
+                           SignedRasterLocation origin,
+                           SignedRasterLocation destination,
+                           int h_origin, int h_dest,
+                           int slope_fact, int h_ceiling, int h_safety,
+                           RasterLocation &_location, int &h_int,
+                           bool can_climb);
+
+/**
+ * @see RasterTileCache::Intersection()
+ */
+SignedRasterLocation
+ReferenceIntersection(const RasterTileCache &rtc,
+                      SignedRasterLocation origin,
+                      SignedRasterLocation destination,
+                      int h_origin, int slope_fact, int height_floor);
+
+#endif
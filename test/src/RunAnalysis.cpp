@@ -61,6 +61,7 @@ Copyright_License {
 #include "Operation/Operation.hpp"
 #include "Look/Look.hpp"
 #include "OS/Args.hpp"
+#include "Thread/JobScheduler.hpp"
 
 #ifdef WIN32
 #include <shellapi.h>
@@ -110,7 +111,7 @@ LoadFiles(Airspaces &airspace_database)
   terrain = RasterTerrain::OpenTerrain(NULL, operation);
 
   const AtmosphericPressure pressure = AtmosphericPressure::Standard();
-  ReadAirspace(airspace_database, terrain, pressure, operation);
+  ReadAirspace(airspace_database, nullptr, terrain, pressure, operation);
 }
 
 static void
@@ -149,6 +150,8 @@ ParseCommandLine(Args &args)
 static void
 Main()
 {
+  const ScopeGlobalJobScheduler job_scheduler;
+
   const Waypoints way_points;
 
   InterfaceBlackboard blackboard;
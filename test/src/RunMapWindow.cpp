@@ -47,6 +47,7 @@ Copyright_License {
 #include "IO/LineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Thread/Debug.hpp"
+#include "Thread/JobScheduler.hpp"
 
 void
 DeviceBlackboard::SetStartupLocation(const GeoPoint &loc, const double alt) {}
@@ -116,7 +117,7 @@ LoadFiles(PlacesOfInterestSettings &poi_settings,
   NullOperationEnvironment operation;
 
   topography = new TopographyStore();
-  LoadConfiguredTopography(*topography, operation);
+  LoadConfiguredTopography(*topography, nullptr, operation);
 
   terrain = RasterTerrain::OpenTerrain(NULL, operation);
 
@@ -175,6 +176,8 @@ GenerateBlackboard(MapWindow &map, const ComputerSettings &settings_computer,
 void
 Main()
 {
+  const ScopeGlobalJobScheduler job_scheduler;
+
   ComputerSettings settings_computer;
   settings_computer.SetDefaults();
   Profile::Load(Profile::map, settings_computer);
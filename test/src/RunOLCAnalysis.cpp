@@ -25,6 +25,10 @@
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "OS/Clock.hpp"
+#include "Util/Macros.hpp"
+#include "Util/StringAPI.hxx"
 
 #include <assert.h>
 #include <stdio.h>
@@ -61,8 +65,56 @@ static ContestManager sis_at(Contest::SIS_AT,
 static ContestManager olc_netcoupe(Contest::NET_COUPE,
                                    full_trace, triangle_trace, sprint_trace);
 
+struct ExhaustiveContest {
+  const char *name;
+  ContestManager &manager;
+};
+
+static const ExhaustiveContest exhaustive_contests[] = {
+  { "classic", olc_classic },
+  { "fai", olc_fai },
+  { "league", olc_league },
+  { "plus", olc_plus },
+  { "dmst", dmst },
+  { "xcontest", xcontest },
+  { "sis_at", sis_at },
+  { "netcoupe", olc_netcoupe },
+};
+
+/**
+ * Find the final solution of all contests.  The contests are
+ * independent of each other, and they only read the traces, so they
+ * may be solved concurrently.
+ */
+static void
+SolveExhaustive(ThreadPool &pool, bool timing)
+{
+  constexpr unsigned n = ARRAY_SIZE(exhaustive_contests);
+  uint64_t duration[n];
+
+  const auto start = MonotonicClockUS();
+
+  pool.ParallelFor(n, [&duration](unsigned i){
+      const auto contest_start = MonotonicClockUS();
+      exhaustive_contests[i].manager.SolveExhaustive();
+      duration[i] = MonotonicClockUS() - contest_start;
+    });
+
+  const auto total = MonotonicClockUS() - start;
+
+  if (!timing)
+    return;
+
+  putchar('\n');
+  for (unsigned i = 0; i < n; ++i)
+    printf("%-10s %10.1f ms\n", exhaustive_contests[i].name,
+           duration[i] / 1000.);
+  printf("%-10s %10.1f ms (%u threads)\n", "total", total / 1000.,
+         pool.GetConcurrency());
+}
+
 static int
-TestOLC(DebugReplay &replay)
+TestOLC(DebugReplay &replay, ThreadPool &pool, bool timing)
 {
   bool released = false;
 
@@ -94,14 +146,7 @@ TestOLC(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
-  olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
+  SolveExhaustive(pool, timing);
 
   putchar('\n');
 
@@ -155,14 +200,35 @@ TestOLC(DebugReplay &replay)
 
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "DRIVER FILE");
+  Args args(argc, argv,
+            "[options] DRIVER FILE\n"
+            "Options:\n"
+            "  --parallel    Solve the contests concurrently\n"
+            "  --timing      Print the wall-clock time of each contest");
+
+  bool parallel = false, timing = false;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    if (StringIsEqual(arg, "--parallel"))
+      parallel = true;
+    else if (StringIsEqual(arg, "--timing"))
+      timing = true;
+    else
+      args.UsageError();
+  }
+
   DebugReplay *replay = CreateDebugReplay(args);
   if (replay == NULL)
     return EXIT_FAILURE;
 
   args.ExpectEnd();
 
-  int result = TestOLC(*replay);
+  ThreadPool pool("Contest", parallel ? GetProcessorCount() - 1 : 0);
+
+  int result = TestOLC(*replay, pool, timing);
   delete replay;
   return result;
 }
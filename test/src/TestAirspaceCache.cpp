@@ -0,0 +1,199 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceCache.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileCache.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/FileUtil.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+#include <tchar.h>
+
+static constexpr TCHAR source_path[] = _T("output/test/airspace.txt");
+
+/**
+ * Copy the test file, so its modification can be tested.
+ */
+static bool
+CopyFile(Path src, Path dest)
+{
+  FILE *in = _tfopen(src.c_str(), _T("rb"));
+  if (in == nullptr)
+    return false;
+
+  FILE *out = _tfopen(dest.c_str(), _T("wb"));
+  if (out == nullptr) {
+    fclose(in);
+    return false;
+  }
+
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    fwrite(buffer, 1, n, out);
+
+  fclose(in);
+  return fclose(out) == 0;
+}
+
+static bool
+ParseFile(Path path, Airspaces &airspaces)
+{
+  FileLineReader reader(path, Charset::AUTO);
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+
+  if (!parser.Parse(reader, operation))
+    return false;
+
+  airspaces.Optimise();
+  return true;
+}
+
+/**
+ * A summary of one airspace which does not depend on the order of
+ * the tree.
+ */
+struct Summary {
+  tstring name, radio;
+  AirspaceClass type;
+  double base, top;
+  FlatBoundingBox box;
+  std::vector<FlatGeoPoint> points;
+
+  bool operator<(const Summary &other) const {
+    return name < other.name;
+  }
+
+  bool operator==(const Summary &other) const {
+    return name == other.name && radio == other.radio &&
+      type == other.type &&
+      base == other.base && top == other.top &&
+      box.lower_left == other.box.lower_left &&
+      box.upper_right == other.box.upper_right &&
+      points == other.points;
+  }
+};
+
+static std::vector<Summary>
+Summarise(const Airspaces &airspaces)
+{
+  std::vector<Summary> result;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    Summary s;
+    s.name = airspace.GetName();
+    s.radio = airspace.GetRadioText();
+    s.type = airspace.GetType();
+    s.base = airspace.GetBase().altitude;
+    s.top = airspace.GetTop().altitude;
+    s.box = i;
+    for (const auto &p : airspace.GetPoints())
+      s.points.push_back(p.GetFlatLocation());
+
+    result.push_back(std::move(s));
+  }
+
+  std::stable_sort(result.begin(), result.end());
+  return result;
+}
+
+static unsigned
+CountWithinRange(const Airspaces &airspaces, const GeoPoint &location)
+{
+  unsigned n = 0;
+  for (const auto &i : airspaces.QueryWithinRange(location, 100000)) {
+    (void)i;
+    ++n;
+  }
+
+  return n;
+}
+
+int main(int argc, char **argv)
+try {
+  plan_tests(11);
+
+  const Path path(source_path);
+  ok1(CopyFile(Path(_T("test/data/airspace/openair.txt")), path));
+
+  FileCache cache(AllocatedPath(_T("output/test/cache")));
+  cache.Flush(_T("airspace"));
+
+  AirspaceSources sources;
+  sources.emplace_back(path);
+
+  Airspaces parsed;
+  ok1(ParseFile(path, parsed));
+  ok1(SaveAirspaceCache(cache, sources, parsed));
+
+  Airspaces loaded;
+  ok1(LoadAirspaceCache(cache, sources, loaded));
+  ok1(loaded.GetSize() == parsed.GetSize());
+  ok1(Summarise(loaded) == Summarise(parsed));
+
+  const GeoPoint location = parsed.GetProjection().GetCenter();
+  ok1(CountWithinRange(loaded, location) ==
+      CountWithinRange(parsed, location));
+
+  /* a different set of source files invalidates the cache */
+  AirspaceSources other_sources;
+  other_sources.emplace_back(path);
+  other_sources.emplace_back(Path(_T("test/data/AirspaceAus-DAA.txt")));
+
+  Airspaces other;
+  ok1(!LoadAirspaceCache(cache, other_sources, other));
+  ok1(other.IsEmpty());
+
+  /* so does modifying the source file (the failed load above has
+     deleted the cache, so save it again first) */
+  ok1(SaveAirspaceCache(cache, sources, parsed));
+
+  FILE *file = _tfopen(path.c_str(), _T("ab"));
+  if (file != nullptr) {
+    fputs("\n* modified\n", file);
+    fclose(file);
+  }
+
+  Airspaces modified;
+  ok1(!LoadAirspaceCache(cache, sources, modified));
+
+  File::Delete(path);
+
+  return exit_status();
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,211 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Verify that FindAirspaceIntrusions() and VisitAirspaceIntrusions()
+ * give the same results as calling Airspaces::QueryInside() for each
+ * fix of a flight.
+ */
+
+#include "Engine/Airspace/AirspaceIntrusions.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "TestUtil.hpp"
+
+#include <random>
+
+static constexpr unsigned N_AIRSPACES = 500;
+static constexpr unsigned N_FLIGHTS = 10;
+static constexpr unsigned N_FIXES = 3000;
+
+static std::mt19937 rng(42);
+
+static GeoPoint
+RandomPoint()
+{
+  std::uniform_real_distribution<double> lon(6, 8), lat(50, 52);
+  return GeoPoint(Angle::Degrees(lon(rng)), Angle::Degrees(lat(rng)));
+}
+
+static AirspaceAltitude
+RandomAltitude(double min, double max)
+{
+  std::uniform_real_distribution<double> altitude(min, max);
+
+  AirspaceAltitude a;
+  if (rng() % 4 == 0) {
+    a.reference = AltitudeReference::AGL;
+    a.altitude_above_terrain = altitude(rng) / 2;
+  } else {
+    a.reference = AltitudeReference::MSL;
+    a.altitude = altitude(rng);
+  }
+
+  return a;
+}
+
+static AbstractAirspace *
+RandomAirspace()
+{
+  const GeoPoint center = RandomPoint();
+  std::uniform_real_distribution<double> radius(500, 20000);
+
+  AbstractAirspace *as;
+  if (rng() % 3 == 0) {
+    as = new AirspaceCircle(center, radius(rng));
+  } else {
+    std::uniform_int_distribution<unsigned> n_vertices(3, 30);
+    const unsigned n = n_vertices(rng);
+    const double r = radius(rng);
+
+    std::vector<GeoPoint> points;
+    for (unsigned i = 0; i < n; ++i) {
+      const double d = std::uniform_real_distribution<double>(0.3, 1)(rng) * r;
+      points.push_back(GeoVector(d, Angle::FullCircle() * i / n)
+                       .EndPoint(center));
+    }
+
+    as = new AirspacePolygon(points);
+  }
+
+  const AirspaceAltitude base = RandomAltitude(0, 2000);
+  AirspaceAltitude top = RandomAltitude(1000, 4000);
+  as->SetProperties(_T("Test"), AirspaceClass::CLASSD, base, top);
+  return as;
+}
+
+static std::vector<AircraftState>
+RandomFlight()
+{
+  std::vector<AircraftState> fixes;
+
+  AircraftState state;
+  state.Reset();
+  state.location = RandomPoint();
+  state.altitude = 1000;
+  state.altitude_agl = 800;
+  state.track = Angle::Zero();
+
+  std::normal_distribution<double> turn(0, 10), climb(0, 5);
+
+  for (unsigned i = 0; i < N_FIXES; ++i) {
+    state.time = i;
+    state.track = (state.track + Angle::Degrees(turn(rng))).AsBearing();
+    state.location = GeoVector(40, state.track).EndPoint(state.location);
+    state.altitude = std::max(state.altitude + climb(rng), 0.);
+    state.altitude_agl = state.altitude - 200;
+
+    /* occasional gaps in the recording */
+    if (rng() % 500 == 0)
+      state.location = RandomPoint();
+
+    fixes.push_back(state);
+  }
+
+  return fixes;
+}
+
+struct Hit {
+  unsigned fix;
+  const AbstractAirspace *airspace;
+  bool in_last;
+
+  bool operator==(const Hit &other) const {
+    return fix == other.fix && airspace == other.airspace &&
+      in_last == other.in_last;
+  }
+};
+
+/**
+ * The reference implementation: query the tree for each fix.
+ */
+static std::vector<Hit>
+QueryEachFix(const Airspaces &airspaces,
+             const std::vector<AircraftState> &fixes)
+{
+  std::vector<Hit> result;
+  std::vector<const AbstractAirspace *> last;
+
+  for (unsigned i = 0; i < fixes.size(); ++i) {
+    std::vector<const AbstractAirspace *> current;
+    for (const auto &airspace : airspaces.QueryInside(fixes[i])) {
+      const AbstractAirspace *as = &airspace.GetAirspace();
+      const bool in_last =
+        std::find(last.begin(), last.end(), as) != last.end();
+      result.push_back({i, as, in_last});
+      current.push_back(as);
+    }
+
+    last = std::move(current);
+  }
+
+  return result;
+}
+
+static std::vector<Hit>
+VisitIntrusions(const AirspaceIntrusionList &intrusions)
+{
+  std::vector<Hit> result;
+  VisitAirspaceIntrusions(intrusions,
+                          [&result](unsigned fix,
+                                    const AirspaceIntrusion &intrusion){
+                            result.push_back({fix, intrusion.airspace,
+                                  fix > intrusion.begin});
+                          });
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * N_FLIGHTS + 1);
+
+  Airspaces airspaces;
+  for (unsigned i = 0; i < N_AIRSPACES; ++i)
+    airspaces.Add(RandomAirspace());
+  airspaces.Optimise();
+
+  ok1(FindAirspaceIntrusions(airspaces, nullptr, 0).empty());
+
+  ThreadPool pool("Test", 3);
+  const auto parallel = [&pool](unsigned n,
+                                const std::function<void(unsigned)> &f){
+    pool.ParallelFor(n, f);
+  };
+
+  for (unsigned i = 0; i < N_FLIGHTS; ++i) {
+    const auto fixes = RandomFlight();
+    const auto expected = QueryEachFix(airspaces, fixes);
+
+    ok1(VisitIntrusions(FindAirspaceIntrusions(airspaces, fixes.data(),
+                                               fixes.size())) == expected);
+    ok1(VisitIntrusions(FindAirspaceIntrusions(airspaces, fixes.data(),
+                                               fixes.size(),
+                                               parallel)) == expected);
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,244 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Logger/AsyncLogWriter.hpp"
+#include "Thread/Thread.hpp"
+#include "OS/Path.hpp"
+#include "OS/Sleep.h"
+#include "TestUtil.hpp"
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+#include <tchar.h>
+
+static const Path path(_T("output/test/async.log"));
+
+static std::string
+ReadFile()
+{
+  std::string result;
+
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == nullptr)
+    return result;
+
+  char buffer[4096];
+  size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, nbytes);
+
+  fclose(file);
+  return result;
+}
+
+static std::vector<std::string>
+SplitLines(const std::string &s)
+{
+  std::vector<std::string> lines;
+
+  size_t start = 0, end;
+  while ((end = s.find('\n', start)) != s.npos) {
+    lines.emplace_back(s, start, end - start);
+    start = end + 1;
+  }
+
+  return lines;
+}
+
+static void
+TestSingle()
+{
+  AsyncLogWriter writer(path, FileOutputStream::Mode::CREATE_VISIBLE,
+                        AsyncLogWriter::Overflow::WAIT, 0);
+  ok1(writer.WriteLine("foo"));
+  ok1(writer.WriteLine("bar"));
+
+  writer.Flush();
+  ok1(ReadFile() == "foo\nbar\n");
+
+  /* longer lines are truncated */
+  const std::string long_line(1000, 'x');
+  ok1(writer.WriteLine(long_line.c_str()));
+
+  /* raw data is split into several records */
+  std::string raw;
+  for (unsigned i = 0; i < 1000; ++i)
+    raw.push_back('a' + i % 26);
+  writer.Write(raw.data(), raw.size());
+
+  writer.Close();
+
+  const std::string expected = "foo\nbar\n" +
+    std::string(AsyncLogWriter::MAX_RECORD - 1, 'x') + "\n" + raw;
+  ok1(ReadFile() == expected);
+
+  const auto statistics = writer.GetStatistics();
+  ok1(statistics.n_records == 3 + (1000 + AsyncLogWriter::MAX_RECORD - 1) /
+      AsyncLogWriter::MAX_RECORD);
+  ok1(statistics.n_dropped == 0);
+  ok1(statistics.n_bytes == expected.size());
+  ok1(statistics.n_syncs >= 1);
+}
+
+/**
+ * Records must reach the file within a poll interval, even without
+ * Flush() and with fsync() disabled.
+ */
+static void
+TestWriteWithoutFlush()
+{
+  AsyncLogWriter writer(path, FileOutputStream::Mode::CREATE_VISIBLE,
+                        AsyncLogWriter::Overflow::WAIT, 0);
+  ok1(writer.WriteLine("pending"));
+
+  std::string s;
+  for (unsigned i = 0; i < 100 && (s = ReadFile()).empty(); ++i)
+    Sleep(50);
+
+  ok1(s == "pending\n");
+  ok1(writer.GetStatistics().n_syncs == 0);
+
+  writer.Close();
+  ok1(writer.GetStatistics().n_syncs == 1);
+}
+
+static void
+TestAppend()
+{
+  {
+    AsyncLogWriter writer(path, FileOutputStream::Mode::APPEND_OR_CREATE,
+                          AsyncLogWriter::Overflow::WAIT, 0);
+    writer.WriteLine("appended");
+  }
+
+  const std::string s = ReadFile();
+  ok1(s.size() > 9 && s.compare(s.size() - 9, 9, "appended\n") == 0);
+}
+
+/**
+ * Writes numbered lines with a common prefix.
+ */
+class Producer final : public Thread {
+  AsyncLogWriter &writer;
+  const unsigned id, n;
+
+public:
+  unsigned n_written = 0;
+
+  Producer(AsyncLogWriter &_writer, unsigned _id, unsigned _n)
+    :Thread("Producer"), writer(_writer), id(_id), n(_n) {}
+
+protected:
+  void Run() override {
+    char line[64];
+    for (unsigned i = 0; i < n; ++i) {
+      snprintf(line, sizeof(line), "%u:%u:%s", id, i,
+               "lorem ipsum dolor sit amet");
+      if (writer.WriteLine(line))
+        ++n_written;
+    }
+  }
+};
+
+static constexpr unsigned N_PRODUCERS = 4;
+static constexpr unsigned N_LINES = 20000;
+
+/**
+ * Check that each line is complete, and that the lines of each
+ * producer appear in order.
+ *
+ * @return the number of lines, or -1 on error
+ */
+static int
+CheckLines(const std::vector<std::string> &lines, bool complete)
+{
+  int next[N_PRODUCERS];
+  std::fill_n(next, N_PRODUCERS, -1);
+
+  for (const auto &line : lines) {
+    unsigned id, i;
+    char text[64];
+    if (sscanf(line.c_str(), "%u:%u:%63s", &id, &i, text) != 3 ||
+        id >= N_PRODUCERS ||
+        line.compare(line.size() - 26, 26, "lorem ipsum dolor sit amet") != 0 ||
+        int(i) <= next[id] ||
+        (complete && int(i) != next[id] + 1))
+      return -1;
+
+    next[id] = i;
+  }
+
+  return lines.size();
+}
+
+static void
+TestConcurrent(AsyncLogWriter::Overflow overflow)
+{
+  AsyncLogWriter writer(path, FileOutputStream::Mode::CREATE_VISIBLE,
+                        overflow, 100);
+
+  std::vector<std::unique_ptr<Producer>> producers;
+  for (unsigned i = 0; i < N_PRODUCERS; ++i) {
+    producers.emplace_back(new Producer(writer, i, N_LINES));
+    producers.back()->Start();
+  }
+
+  unsigned n_written = 0;
+  for (auto &producer : producers) {
+    producer->Join();
+    n_written += producer->n_written;
+  }
+
+  writer.Close();
+
+  const bool wait = overflow == AsyncLogWriter::Overflow::WAIT;
+  const auto statistics = writer.GetStatistics();
+  const int n_lines = CheckLines(SplitLines(ReadFile()), wait);
+
+  ok1(n_lines >= 0 && unsigned(n_lines) == n_written);
+  ok1(statistics.n_records == n_written);
+  ok1(statistics.n_records + statistics.n_dropped == N_PRODUCERS * N_LINES);
+  ok1(!wait || statistics.n_dropped == 0);
+
+  /* records are batched: each write() covers at least one record */
+  ok1(statistics.n_writes >= 1 &&
+      statistics.n_writes <= statistics.n_records);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(24);
+
+  TestSingle();
+  TestWriteWithoutFlush();
+  TestAppend();
+  TestConcurrent(AsyncLogWriter::Overflow::WAIT);
+  TestConcurrent(AsyncLogWriter::Overflow::DROP);
+
+  return exit_status();
+}
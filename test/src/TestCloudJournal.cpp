@@ -0,0 +1,295 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Cloud/Journal.hpp"
+#include "Cloud/Database.hpp"
+#include "Cloud/Data.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+#include "Util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <memory>
+#include <string>
+
+#include <stdio.h>
+
+static const Path journal_path("output/test/cloud.journal");
+static const Path truncated_path("output/test/cloud-truncated.journal");
+
+static const Path db_path("output/test/cloud.db");
+static const AllocatedPath db_journal_path = db_path + ".journal";
+static const AllocatedPath db_old_journal_path = db_path + ".journal.old";
+static const AllocatedPath db_corrupt_path = db_path + ".corrupt";
+static const AllocatedPath db_corrupt_journal_path =
+  db_journal_path + ".corrupt";
+
+static constexpr uint64_t KEY_A = 0x1111, KEY_B = 0x2222, KEY_C = 0x3333;
+
+static void
+DeleteDatabase()
+{
+  File::Delete(db_path);
+  File::Delete(db_journal_path);
+  File::Delete(db_old_journal_path);
+  File::Delete(db_corrupt_path);
+  File::Delete(db_corrupt_journal_path);
+}
+
+static CloudClient &
+MakeClient(CloudData &data, uint64_t key)
+{
+  const GeoPoint location(Angle::Degrees(7.7), Angle::Degrees(51.2));
+  return data.clients.Make({}, key, location, 1000);
+}
+
+static void
+AddClient(CloudData &data, CloudJournal &journal, uint64_t key)
+{
+  journal.AddClient(MakeClient(data, key));
+}
+
+static void
+SaveSnapshot(Path path, const CloudData &data, uint64_t generation)
+{
+  FileOutputStream fos(path);
+
+  {
+    Serialiser s(fos);
+    data.Save(s, generation);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+/**
+ * Write a journal file with the given generation, which adds the
+ * given client.
+ */
+static void
+WriteJournal(Path path, uint64_t generation, uint64_t key)
+{
+  std::unique_ptr<CloudData> data(new CloudData());
+  CloudJournal journal;
+  journal.Open(path, generation);
+  AddClient(*data, journal, key);
+  journal.Close();
+}
+
+static bool
+CopyTruncated(Path src, Path dest, size_t n_remove)
+{
+  FILE *in = fopen(src.c_str(), "rb");
+  if (in == nullptr)
+    return false;
+
+  std::string buffer;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+    buffer.append(chunk, n);
+  fclose(in);
+
+  if (buffer.size() < n_remove)
+    return false;
+
+  buffer.resize(buffer.size() - n_remove);
+
+  FILE *out = fopen(dest.c_str(), "wb");
+  if (out == nullptr)
+    return false;
+
+  fwrite(buffer.data(), 1, buffer.size(), out);
+  return fclose(out) == 0;
+}
+
+static void
+TestReplay()
+{
+  {
+    std::unique_ptr<CloudData> data(new CloudData());
+    CloudJournal journal;
+    journal.Open(journal_path, 5);
+    AddClient(*data, journal, KEY_A);
+    AddClient(*data, journal, KEY_B);
+    journal.Flush();
+    journal.RemoveClient(KEY_B);
+    journal.AddThermal(CloudThermal(KEY_A,
+                                    AGeoPoint(GeoPoint(Angle::Degrees(7.7),
+                                                       Angle::Degrees(51.2)),
+                                              800),
+                                    AGeoPoint(GeoPoint(Angle::Degrees(7.8),
+                                                       Angle::Degrees(51.2)),
+                                              1500),
+                                    2.5));
+    journal.Close();
+  }
+
+  std::unique_ptr<CloudData> data(new CloudData());
+  ok1(CloudJournal::Replay(journal_path, *data, 0) == 5);
+  ok1(data->clients.Find(KEY_A) != nullptr);
+  ok1(data->clients.Find(KEY_B) == nullptr);
+  ok1(!data->thermals.empty());
+
+  /* an older generation is already contained in the snapshot */
+  std::unique_ptr<CloudData> skipped(new CloudData());
+  ok1(CloudJournal::Replay(journal_path, *skipped, 6) == 5);
+  ok1(skipped->clients.empty());
+}
+
+static void
+TestTruncated()
+{
+  /* a crash while writing the last record (the thermal) */
+  ok1(CopyTruncated(journal_path, truncated_path, 3));
+
+  std::unique_ptr<CloudData> data(new CloudData());
+  ok1(CloudJournal::Replay(truncated_path, *data, 0) == 5);
+  ok1(data->clients.Find(KEY_A) != nullptr);
+  ok1(data->clients.Find(KEY_B) == nullptr);
+  ok1(data->thermals.empty());
+
+  File::Delete(truncated_path);
+}
+
+/**
+ * A crash after the compaction has saved the new snapshot, but before
+ * it has deleted the old journal.
+ */
+static void
+TestCompactionCrash()
+{
+  DeleteDatabase();
+
+  {
+    /* the new snapshot already contains the old journal (generation
+       2), and client B, which that journal adds, has been removed
+       since; replaying the old journal again would resurrect it */
+    std::unique_ptr<CloudData> data(new CloudData());
+    MakeClient(*data, KEY_A);
+    SaveSnapshot(db_path, *data, 3);
+  }
+
+  WriteJournal(db_old_journal_path, 2, KEY_B);
+  WriteJournal(db_journal_path, 3, KEY_C);
+
+  {
+    std::unique_ptr<CloudData> data(new CloudData());
+    CloudDatabase db(db_path);
+    db.Open(*data);
+
+    ok1(data->clients.Find(KEY_A) != nullptr);
+    ok1(data->clients.Find(KEY_B) == nullptr);
+    ok1(data->clients.Find(KEY_C) != nullptr);
+
+    /* the old journal has been merged and deleted */
+    ok1(!File::Exists(db_old_journal_path));
+
+    db.Close();
+  }
+
+  /* everything survives a restart */
+  std::unique_ptr<CloudData> data(new CloudData());
+  CloudDatabase db(db_path);
+  db.Open(*data);
+  ok1(data->clients.Find(KEY_A) != nullptr);
+  ok1(data->clients.Find(KEY_B) == nullptr);
+  ok1(data->clients.Find(KEY_C) != nullptr);
+  db.Close();
+}
+
+static void
+TestCorruptSnapshot()
+{
+  DeleteDatabase();
+
+  FILE *file = fopen(db_path.c_str(), "wb");
+  if (file != nullptr) {
+    fputs("garbage", file);
+    fclose(file);
+  }
+
+  WriteJournal(db_journal_path, 1, KEY_A);
+
+  {
+    std::unique_ptr<CloudData> data(new CloudData());
+    CloudDatabase db(db_path);
+    db.Open(*data);
+
+    /* the snapshot is kept for manual recovery, and the server
+       starts with a fresh one */
+    ok1(File::Exists(db_corrupt_path));
+    ok1(File::Exists(db_corrupt_journal_path));
+    ok1(data->clients.empty());
+    db.Close();
+  }
+
+  {
+    std::unique_ptr<CloudData> data(new CloudData());
+    CloudDatabase db(db_path);
+    db.Open(*data);
+    ok1(File::Exists(db_corrupt_path));
+    db.Close();
+  }
+
+  /* an older copy is never overwritten; startup fails instead */
+  file = fopen(db_path.c_str(), "wb");
+  if (file != nullptr) {
+    fputs("garbage", file);
+    fclose(file);
+  }
+
+  bool failed = false;
+  try {
+    std::unique_ptr<CloudData> data(new CloudData());
+    CloudDatabase db(db_path);
+    db.Open(*data);
+    db.Close();
+  } catch (const std::runtime_error &) {
+    failed = true;
+  }
+
+  ok1(failed);
+
+  DeleteDatabase();
+}
+
+int main(int argc, char **argv)
+try {
+  plan_tests(23);
+
+  TestReplay();
+  TestTruncated();
+  TestCompactionCrash();
+  TestCorruptSnapshot();
+
+  File::Delete(journal_path);
+
+  return exit_status();
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,311 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/JobScheduler.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/Sleep.h"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+class CancelledOperationEnvironment final : public NullOperationEnvironment {
+public:
+  bool IsCancelled() const override {
+    return true;
+  }
+};
+
+static bool
+RunsEachOnce(JobScheduler &scheduler, unsigned n)
+{
+  std::vector<std::atomic<unsigned>> counters(n);
+  for (auto &i : counters)
+    i.store(0);
+
+  scheduler.ParallelFor(n, [&counters](unsigned i){
+      ++counters[i];
+    });
+
+  for (const auto &i : counters)
+    if (i.load() != 1)
+      return false;
+
+  return true;
+}
+
+/**
+ * Returns the maximum number of threads which have been running the
+ * function of one ParallelFor() call at the same time.
+ */
+static unsigned
+MeasureConcurrency(JobScheduler &scheduler, unsigned n,
+                   unsigned max_concurrency)
+{
+  std::atomic<unsigned> running(0), max_running(0);
+
+  scheduler.ParallelFor(n, [&running, &max_running](unsigned){
+      const unsigned r = ++running;
+      unsigned m = max_running.load();
+      while (r > m && !max_running.compare_exchange_weak(m, r)) {}
+
+      Sleep(1);
+      --running;
+    }, JobScheduler::Priority::NORMAL, nullptr, max_concurrency);
+
+  return max_running.load();
+}
+
+static void
+TestParallelFor()
+{
+  JobScheduler serial("Test", 0);
+  ok1(serial.GetConcurrency() == 1);
+  ok1(RunsEachOnce(serial, 0));
+  ok1(RunsEachOnce(serial, 1));
+  ok1(RunsEachOnce(serial, 100));
+
+  JobScheduler scheduler("Test", 3);
+  ok1(scheduler.GetConcurrency() == 4);
+  ok1(RunsEachOnce(scheduler, 0));
+  ok1(RunsEachOnce(scheduler, 1));
+  ok1(RunsEachOnce(scheduler, 3));
+  ok1(RunsEachOnce(scheduler, 10000));
+
+  ok1(MeasureConcurrency(scheduler, 50, 2) <= 2);
+  ok1(MeasureConcurrency(scheduler, 50, 1) == 1);
+}
+
+static void
+TestNested()
+{
+  JobScheduler scheduler("Test", 2);
+
+  std::atomic<unsigned> total(0);
+  scheduler.ParallelFor(8, [&scheduler, &total](unsigned){
+      scheduler.ParallelFor(100, [&total](unsigned i){
+          total += i;
+        });
+    });
+
+  ok1(total.load() == 8 * 4950);
+}
+
+static void
+TestCancel()
+{
+  JobScheduler scheduler("Test", 2);
+
+  CancelledOperationEnvironment env;
+  const CancellationToken cancelled_env(&env);
+  ok1(cancelled_env.IsCancelled());
+
+  std::atomic<unsigned> n(0);
+  scheduler.ParallelFor(100, [&n](unsigned){ ++n; },
+                        JobScheduler::Priority::NORMAL, &cancelled_env);
+  ok1(n.load() == 0);
+
+  NullOperationEnvironment null_env;
+  CancellationToken token(&null_env);
+  ok1(!token.IsCancelled());
+
+  scheduler.ParallelFor(100, [&n](unsigned){ ++n; },
+                        JobScheduler::Priority::NORMAL, &token);
+  ok1(n.load() == 100);
+
+  /* cancel from within the batch; numbers which have been claimed
+     already may still run */
+  n = 0;
+  scheduler.ParallelFor(10000, [&n, &token](unsigned i){
+      if (i == 0)
+        token.Cancel();
+      ++n;
+    }, JobScheduler::Priority::NORMAL, &token);
+  ok1(token.IsCancelled());
+  ok1(n.load() < 10000);
+
+  {
+    JobScheduler serial("Test", 0);
+    serial.Submit([&n](){ n = 42; }, JobScheduler::Priority::NORMAL,
+                  &token);
+  }
+
+  ok1(n.load() != 42);
+}
+
+static void
+TestPriority()
+{
+  Mutex mutex;
+  Cond cond;
+  bool started = false, released = false;
+  std::vector<unsigned> order;
+
+  /* must outlive the scheduler, which runs the queued jobs on
+     destruction */
+  const CancellationToken token;
+
+  {
+    JobScheduler scheduler("Test", 1);
+
+    /* occupy the only worker until all jobs have been queued */
+    scheduler.Submit([&](){
+        const ScopeLock protect(mutex);
+        started = true;
+        cond.broadcast();
+        while (!released)
+          cond.wait(mutex);
+      });
+
+    {
+      const ScopeLock protect(mutex);
+      while (!started)
+        cond.wait(mutex);
+    }
+
+    static constexpr JobScheduler::Priority priorities[] = {
+      JobScheduler::Priority::IDLE,
+      JobScheduler::Priority::NORMAL,
+      JobScheduler::Priority::HIGH,
+      JobScheduler::Priority::IDLE,
+      JobScheduler::Priority::HIGH,
+    };
+
+    for (auto p : priorities)
+      scheduler.Submit([&order, &mutex, p](){
+          const ScopeLock protect(mutex);
+          order.push_back(unsigned(p));
+        }, p, &token);
+
+    const ScopeLock protect(mutex);
+    released = true;
+    cond.broadcast();
+
+    /* the destructor runs the queued jobs */
+  }
+
+  ok1(order.size() == 5);
+  ok1(std::is_sorted(order.begin(), order.end()));
+  ok1(order.front() == unsigned(JobScheduler::Priority::HIGH));
+  ok1(order.back() == unsigned(JobScheduler::Priority::IDLE));
+}
+
+/**
+ * Is the calling thread running at idle OS priority?
+ */
+static bool
+IsIdlePriority()
+{
+#ifdef SCHED_IDLE
+  return sched_getscheduler(0) == SCHED_IDLE;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Submit a job and wait until it has reported whether it runs at idle
+ * OS priority.
+ */
+static bool
+RunsAtIdlePriority(JobScheduler &scheduler, JobScheduler::Priority priority)
+{
+  Mutex mutex;
+  Cond cond;
+  bool done = false, result = false;
+
+  scheduler.Submit([&](){
+      const bool idle = IsIdlePriority();
+      const ScopeLock protect(mutex);
+      result = idle;
+      done = true;
+      cond.broadcast();
+    }, priority);
+
+  const ScopeLock protect(mutex);
+  while (!done)
+    cond.wait(mutex);
+  return result;
+}
+
+static void
+TestIdleWorkers()
+{
+  JobScheduler scheduler("Test", 2, 3);
+  ok1(scheduler.GetConcurrency() == 3);
+  ok1(scheduler.GetConcurrency(JobScheduler::Priority::HIGH) == 3);
+  ok1(scheduler.GetConcurrency(JobScheduler::Priority::IDLE) == 4);
+
+  static constexpr unsigned N = 1000;
+  std::atomic<unsigned> n_idle(0), n_other(0);
+
+  const auto count = [&n_idle, &n_other](unsigned){
+    ++(IsIdlePriority() ? n_idle : n_other);
+  };
+
+  scheduler.ParallelFor(N, count, JobScheduler::Priority::IDLE);
+  ok1(n_idle + n_other == N);
+
+  /* submitted jobs run in a worker of their priority's group */
+#ifdef SCHED_IDLE
+  ok1(RunsAtIdlePriority(scheduler, JobScheduler::Priority::IDLE));
+#else
+  skip(1, "no SCHED_IDLE");
+#endif
+  ok1(!RunsAtIdlePriority(scheduler, JobScheduler::Priority::HIGH));
+
+  n_idle = n_other = 0;
+  scheduler.ParallelFor(N, count, JobScheduler::Priority::HIGH);
+  ok1(n_idle == 0 && n_other == N);
+
+  /* nested jobs of another priority are passed to the other group */
+  n_idle = n_other = 0;
+  scheduler.ParallelFor(4, [&scheduler, &count](unsigned){
+      scheduler.ParallelFor(100, count, JobScheduler::Priority::HIGH);
+    }, JobScheduler::Priority::IDLE);
+  ok1(n_idle + n_other == 400);
+
+  /* a scheduler without idle workers runs IDLE jobs on the others */
+  JobScheduler shared("Test", 2);
+  ok1(shared.GetConcurrency(JobScheduler::Priority::IDLE) == 3);
+  n_idle = n_other = 0;
+  shared.ParallelFor(N, count, JobScheduler::Priority::IDLE);
+  ok1(n_idle == 0 && n_other == N);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(33);
+
+  TestParallelFor();
+  TestNested();
+  TestCancel();
+  TestPriority();
+  TestIdleWorkers();
+
+  return exit_status();
+}
@@ -151,6 +151,7 @@ Run(Path path)
 {
   IGCWriter writer(path);
   Run(writer);
+  writer.Close();
 }
 
 int main(int argc, char **argv)
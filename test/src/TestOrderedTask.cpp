@@ -27,7 +27,13 @@
 #include "Engine/Task/Ordered/Points/StartPoint.hpp"
 #include "Engine/Task/Ordered/Points/FinishPoint.hpp"
 #include "Engine/Task/Ordered/Points/ASTPoint.hpp"
+#include "Engine/Task/Ordered/Points/AATPoint.hpp"
 #include "Engine/Task/ObservationZones/LineSectorZone.hpp"
+#include "Engine/Task/ObservationZones/CylinderZone.hpp"
+#include "Engine/Task/Factory/TaskFactoryType.hpp"
+#include "Geo/GeoVector.hpp"
+
+#include <memory>
 
 #define ACCURACY 500
 
@@ -69,6 +75,8 @@ static const auto wp2 = MakeWaypointPtr(0, 45.3, 50);
 static const auto wp3 = MakeWaypointPtr(0, 46, 50);
 static const auto wp4 = MakeWaypointPtr(1, 46, 50);
 static const auto wp5 = MakeWaypointPtr(0.3, 46, 50);
+static const auto wp6 = MakeWaypointPtr(1.5, 45.5, 50);
+static const auto wp7 = MakeWaypointPtr(1, 45, 50);
 
 static double
 GetSafetyHeight(const TaskPoint &tp)
@@ -407,6 +415,99 @@ TestLowTPFinal()
   CheckTotal(aircraft, stats, tp1, tp2, tp3);
 }
 
+/**
+ * Check that the idle target optimisation of an AAT task is skipped
+ * or warm-started while the aircraft state barely changes, and that
+ * the warm-started targets agree with a search from scratch.
+ */
+static void
+TestTargetOptimisation()
+{
+  OrderedTask task(task_behaviour);
+  task.SetFactory(TaskFactoryType::AAT);
+  task.Append(StartPoint(new LineSectorZone(wp1->location),
+                         WaypointPtr(wp1), task_behaviour,
+                         ordered_task_settings.start_constraints));
+  for (const auto &wp : {wp3, wp4, wp6, wp7})
+    task.Append(AATPoint(new CylinderZone(wp->location, 20000),
+                         WaypointPtr(wp), task_behaviour));
+  task.Append(FinishPoint(new LineSectorZone(wp1->location),
+                          WaypointPtr(wp1), task_behaviour,
+                          ordered_task_settings.finish_constraints, false));
+  task.SetActiveTaskPoint(1);
+  task.UpdateGeometry();
+
+  ok1(task.CheckTask());
+
+  AircraftState aircraft;
+  aircraft.Reset();
+  aircraft.location = wp2->location;
+  aircraft.altitude = 1500;
+
+  const TargetSearchState &search = task.GetTargetSearchState();
+
+  task.Update(aircraft, aircraft, glide_polar);
+  ok1(task.UpdateIdle(aircraft, glide_polar));
+  const unsigned cold = search.GetMinTargetEvaluations();
+  ok1(cold > 0);
+  ok1(search.GetOptTargetEvaluations() > 0);
+
+  /* nothing has changed */
+  const GeoPoint target = ((const AATPoint &)task.GetPoint(1)).GetTarget();
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() == 0);
+  ok1(search.GetOptTargetEvaluations() == 0);
+  ok1(((const AATPoint &)task.GetPoint(1)).GetTarget() == target);
+
+  /* a small move within the tolerance */
+  aircraft.location = GeoVector(50, Angle::Degrees(20))
+    .EndPoint(aircraft.location);
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() == 0);
+
+  /* a larger move starts from the previous solution */
+  aircraft.location = GeoVector(2000, Angle::Degrees(20))
+    .EndPoint(aircraft.location);
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() > 0);
+  ok1(search.GetMinTargetEvaluations() < cold);
+
+  std::unique_ptr<OrderedTask> fresh(task.Clone(task_behaviour));
+  fresh->SetActiveTaskPoint(1);
+  fresh->Update(aircraft, aircraft, glide_polar);
+  fresh->UpdateIdle(aircraft, glide_polar);
+  ok1(fresh->GetTargetSearchState().GetMinTargetEvaluations() > 0);
+
+  for (unsigned i = 1; i < 5; ++i) {
+    const auto &a = (const AATPoint &)task.GetPoint(i);
+    const auto &b = (const AATPoint &)fresh->GetPoint(i);
+    ok1(a.GetTarget().Distance(b.GetTarget()) < ACCURACY);
+  }
+
+  /* a new wind estimate changes the glide solutions */
+  aircraft.wind = SpeedVector(Angle::Degrees(270), 10);
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() > 0);
+
+  /* a slightly different estimate is within the tolerance */
+  aircraft.wind = SpeedVector(Angle::Degrees(271), 10.1);
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() == 0);
+
+  /* moving a target manually forces a new search */
+  auto &ap = (AATPoint &)task.GetPoint(2);
+  ap.SetTarget(ap.GetLocation());
+  task.Update(aircraft, aircraft, glide_polar);
+  task.UpdateIdle(aircraft, glide_polar);
+  ok1(search.GetMinTargetEvaluations() > 0);
+  ok1(ap.GetTarget() != ap.GetLocation());
+}
+
 static void
 TestAll()
 {
@@ -421,7 +522,7 @@ TestAll()
 
 int main(int argc, char **argv)
 {
-  plan_tests(728);
+  plan_tests(728 + 19);
 
   task_behaviour.SetDefaults();
 
@@ -436,5 +537,8 @@ int main(int argc, char **argv)
   glide_polar.SetMC(4);
   TestAll();
 
+  glide_polar.SetMC(2);
+  TestTargetOptimisation();
+
   return exit_status();
 }
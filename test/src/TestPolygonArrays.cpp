@@ -0,0 +1,197 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Verify that the #PolygonArrays kernels give exactly the same results
+ * as PolygonInterior() and FlatRay::DistinctIntersection().  The
+ * vertices are snapped to a coarse grid, to provoke the corner
+ * cases: horizontal edges, points on edges and rays through
+ * vertices.
+ */
+
+#include "Geo/PolygonArrays.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "TestUtil.hpp"
+
+#include <random>
+
+#include <math.h>
+
+static constexpr unsigned N_POLYGONS = 200;
+static constexpr unsigned N_POINTS = 200;
+static constexpr unsigned N_RAYS = 5;
+
+static std::mt19937 rng(42);
+
+/**
+ * Generate a random coordinate on a grid with 0.05 degree spacing.
+ */
+static double
+RandomGrid(double center, double range)
+{
+  std::uniform_int_distribution<int> d(-int(range * 20), int(range * 20));
+  return center + d(rng) / 20.;
+}
+
+static GeoPoint
+RandomPoint()
+{
+  return GeoPoint(Angle::Degrees(RandomGrid(7, 1)),
+                  Angle::Degrees(RandomGrid(51, 1)));
+}
+
+/**
+ * Generate a random closed (and usually self-intersecting) polygon.
+ */
+static SearchPointVector
+RandomPolygon(const FlatProjection &projection)
+{
+  std::uniform_int_distribution<unsigned> n_vertices(3, 40);
+
+  SearchPointVector border;
+  const unsigned n = n_vertices(rng);
+  for (unsigned i = 0; i < n; ++i)
+    border.emplace_back(RandomPoint());
+
+  border.emplace_back(border.front().GetLocation());
+  border.Project(projection);
+  return border;
+}
+
+static bool
+TestInside(const SearchPointVector &border, const PolygonArrays &arrays,
+           const std::vector<GeoPoint> &points)
+{
+  for (const auto &p : points)
+    if (arrays.IsInside(p) != PolygonInterior(p, border.begin(), border.end()))
+      return false;
+
+  return true;
+}
+
+static bool
+TestIntersections(const SearchPointVector &border,
+                  const PolygonArrays &arrays,
+                  const FlatRay *rays, unsigned n_rays)
+{
+  std::vector<PolygonArrays::Intersection> result;
+  arrays.FindIntersections(rays, n_rays, result);
+
+  auto i = result.begin();
+  for (unsigned edge = 0; edge + 1 < border.size(); ++edge) {
+    const FlatRay segment(border[edge].GetFlatLocation(),
+                          border[edge + 1].GetFlatLocation());
+
+    uint32_t expected = 0;
+    for (unsigned r = 0; r < n_rays; ++r)
+      if (rays[r].DistinctIntersection(segment) >= 0)
+        expected |= 1u << r;
+
+    if (expected == 0)
+      continue;
+
+    if (i == result.end() || i->edge != edge || i->rays != expected)
+      return false;
+
+    ++i;
+  }
+
+  return i == result.end();
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * N_POLYGONS + 2);
+
+  const FlatProjection projection(GeoPoint(Angle::Degrees(7),
+                                           Angle::Degrees(51)));
+
+  /* a square, with points on its border and vertices */
+  {
+    SearchPointVector border;
+    border.emplace_back(GeoPoint(Angle::Degrees(7), Angle::Degrees(51)));
+    border.emplace_back(GeoPoint(Angle::Degrees(8), Angle::Degrees(51)));
+    border.emplace_back(GeoPoint(Angle::Degrees(8), Angle::Degrees(52)));
+    border.emplace_back(GeoPoint(Angle::Degrees(7), Angle::Degrees(52)));
+    border.emplace_back(border.front().GetLocation());
+    border.Project(projection);
+
+    PolygonArrays arrays;
+    arrays.Update(border);
+
+    std::vector<GeoPoint> points;
+    for (double lon = 6.5; lon <= 8.5; lon += 0.25)
+      for (double lat = 50.5; lat <= 52.5; lat += 0.25)
+        points.emplace_back(Angle::Degrees(lon), Angle::Degrees(lat));
+
+    ok1(TestInside(border, arrays, points));
+
+    const FlatGeoPoint a = projection.ProjectInteger(points.front());
+    FlatRay rays[N_RAYS];
+    for (unsigned i = 0; i < N_RAYS; ++i)
+      rays[i] = FlatRay(a, projection.ProjectInteger(points[points.size() - 1 - i * 7]));
+    ok1(TestIntersections(border, arrays, rays, N_RAYS));
+  }
+
+  for (unsigned i = 0; i < N_POLYGONS; ++i) {
+    const SearchPointVector border = RandomPolygon(projection);
+
+    PolygonArrays arrays;
+    arrays.Update(border);
+
+    std::vector<GeoPoint> points;
+    for (unsigned j = 0; j < N_POINTS; ++j)
+      points.push_back(RandomPoint());
+
+    /* the vertices themselves */
+    for (const auto &j : border)
+      points.push_back(j.GetLocation());
+
+    ok1(TestInside(border, arrays, points));
+
+    /* several rays starting at the same point, like the airspace
+       warning predictions */
+    bool intersections_ok = true;
+    for (unsigned j = 0; j < 20; ++j) {
+      const FlatGeoPoint start = projection.ProjectInteger(points[j]);
+
+      FlatRay rays[N_RAYS];
+      for (unsigned r = 0; r < N_RAYS; ++r)
+        rays[r] = FlatRay(start,
+                          r == 0
+                          /* through a vertex */
+                          ? border[j % border.size()].GetFlatLocation()
+                          : projection.ProjectInteger(points[20 + j * N_RAYS + r]));
+
+      if (!TestIntersections(border, arrays, rays, N_RAYS))
+        intersections_ok = false;
+    }
+
+    ok1(intersections_ok);
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,209 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Topography/ProjectedShapeCache.hpp"
+#include "Geo/GeoVector.hpp"
+#include "TestUtil.hpp"
+
+#include <stdlib.h>
+
+static constexpr unsigned N_POINTS = 64;
+
+static Projection
+MakeProjection(GeoPoint location, Angle angle = Angle::Degrees(30),
+               double scale = 0.01)
+{
+  Projection projection;
+  projection.SetScale(scale);
+  projection.SetScreenOrigin(320, 240);
+  projection.SetScreenAngle(angle);
+  projection.SetGeoLocation(location);
+  return projection;
+}
+
+/**
+ * Returns a point of a grid which covers the given bounds.
+ */
+static GeoPoint
+GetGridPoint(const GeoBounds &bounds, unsigned i)
+{
+  const double x = (i % 8) / 7., y = (i / 8) / 7.;
+  return GeoPoint(bounds.GetWest() + (bounds.GetEast() - bounds.GetWest()) * x,
+                  bounds.GetSouth() + (bounds.GetNorth() - bounds.GetSouth()) * y);
+}
+
+static void
+Fill(ProjectedShapeCache &cache, const Projection &projection,
+     const GeoBounds &bounds)
+{
+  cache.Begin(projection, bounds, 1);
+
+  /* one shape with all grid points */
+  cache.BeginPart();
+  for (unsigned i = 0; i < N_POINTS; ++i)
+    cache.AddPoint(projection.GeoToScreen(GetGridPoint(bounds, i)));
+  cache.EndPart(2);
+  cache.EndShape();
+
+  /* one shape without parts */
+  cache.EndShape();
+}
+
+/**
+ * Verify that the translated points are close to the projected
+ * ones.
+ */
+static bool
+CheckTranslation(const ProjectedShapeCache &cache, const Projection &current,
+                 const GeoBounds &bounds, PixelPoint offset)
+{
+  const auto parts = cache.GetParts(0);
+  if (parts.size != 1)
+    return false;
+
+  const auto points = cache.GetPoints(parts[0]);
+  if (points.size != N_POINTS)
+    return false;
+
+  for (unsigned i = 0; i < N_POINTS; ++i) {
+    const PixelPoint expected = current.GeoToScreen(GetGridPoint(bounds, i));
+    const PixelPoint actual = points[i] + offset;
+
+    /* one pixel for the latitude dependent longitude scale, one for
+       rounding */
+    if (abs(actual.x - expected.x) > 2 || abs(actual.y - expected.y) > 2)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+TestTranslation(const GeoPoint center, bool equator=false)
+{
+  const auto projection = MakeProjection(center);
+  const GeoBounds bounds(GeoPoint(center.longitude - Angle::Degrees(0.3),
+                                  center.latitude + Angle::Degrees(0.2)),
+                         GeoPoint(center.longitude + Angle::Degrees(0.3),
+                                  center.latitude - Angle::Degrees(0.2)));
+
+  ProjectedShapeCache cache;
+  PixelPoint offset;
+  ok1(!cache.IsTranslation(projection, 1, offset));
+
+  Fill(cache, projection, bounds);
+
+  ok1(cache.GetParts(1).IsEmpty());
+
+  /* the same projection */
+  ok1(cache.IsTranslation(projection, 1, offset));
+  ok1(offset.x == 0 && offset.y == 0);
+  ok1(CheckTranslation(cache, projection, bounds, offset));
+
+  /* pan by a few hundred meters */
+  for (unsigned i = 0; i < 8; ++i) {
+    const Angle bearing = Angle::Degrees(45 * i);
+    const auto panned = MakeProjection(GeoVector(300, bearing).EndPoint(center));
+    ok1(cache.IsTranslation(panned, 1, offset));
+    ok1(CheckTranslation(cache, panned, bounds, offset));
+  }
+
+  /* the screen origin moves */
+  auto moved = projection;
+  moved.SetScreenOrigin(100, 400);
+  ok1(cache.IsTranslation(moved, 1, offset));
+  ok1(offset.x == -220 && offset.y == 160);
+  ok1(CheckTranslation(cache, moved, bounds, offset));
+
+  /* panning far along the latitude is not a translation, except
+     near the equator */
+  const auto far = MakeProjection(GeoVector(100000, Angle::Degrees(90))
+                                  .EndPoint(center));
+  ok1(cache.IsTranslation(far, 1, offset) == equator);
+
+  /* zooming, rotating and another thinning level */
+  ok1(!cache.IsTranslation(MakeProjection(center, Angle::Degrees(30), 0.02),
+                           1, offset));
+  ok1(!cache.IsTranslation(MakeProjection(center, Angle::Degrees(31)),
+                           1, offset));
+  ok1(!cache.IsTranslation(projection, 2, offset));
+
+  cache.Clear();
+  ok1(!cache.IsTranslation(projection, 1, offset));
+}
+
+static void
+TestEndPart()
+{
+  const auto projection = MakeProjection(GeoPoint(Angle::Degrees(7),
+                                                  Angle::Degrees(51)));
+
+  ProjectedShapeCache cache;
+  cache.Begin(projection, GeoBounds(projection.GetGeoLocation()), 0);
+
+  /* points which are too close to their predecessor are omitted */
+  cache.BeginPart();
+  cache.AddPointIfDistant(PixelPoint(0, 0));
+  cache.AddPointIfDistant(PixelPoint(3, 3));
+  cache.AddPointIfDistant(PixelPoint(4, 4));
+  cache.AddPoint(PixelPoint(5, 5));
+  cache.EndPart(2);
+
+  /* a degenerate polygon ring is discarded */
+  cache.BeginPart();
+  cache.AddPoint(PixelPoint(10, 10));
+  cache.AddPoint(PixelPoint(20, 10));
+  cache.EndPart(3);
+
+  cache.BeginPart();
+  cache.AddPoint(PixelPoint(10, 10));
+  cache.AddPoint(PixelPoint(20, 10));
+  cache.AddPoint(PixelPoint(20, 20));
+  cache.EndPart(3);
+  cache.EndShape();
+
+  const auto parts = cache.GetParts(0);
+  ok1(parts.size == 2);
+
+  const auto a = cache.GetPoints(parts[0]);
+  ok1(a.size == 3);
+  ok1(a[0] == PixelPoint(0, 0) && a[1] == PixelPoint(4, 4) &&
+      a[2] == PixelPoint(5, 5));
+
+  const auto b = cache.GetPoints(parts[1]);
+  ok1(b.size == 3);
+  ok1(b[0] == PixelPoint(10, 10) && b[2] == PixelPoint(20, 20));
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(3 * 29 + 5);
+
+  TestTranslation(GeoPoint(Angle::Degrees(7), Angle::Degrees(51)));
+  TestTranslation(GeoPoint(Angle::Degrees(-70), Angle::Degrees(-33)));
+  TestTranslation(GeoPoint(Angle::Degrees(37), Angle::Degrees(0.1)), true);
+  TestEndPart();
+
+  return exit_status();
+}
@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Task/PathSolvers/TaskDistanceSolver.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMin.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+#include <stdlib.h>
+
+static std::vector<SearchPointVector>
+MakeRandomTask(unsigned n_stages)
+{
+  std::vector<SearchPointVector> task(n_stages);
+
+  GeoPoint center(Angle::Degrees(7.7), Angle::Degrees(51.0));
+  for (auto &stage : task) {
+    const unsigned n_points = 1 + rand() % 40;
+    for (unsigned i = 0; i < n_points; ++i) {
+      const GeoVector v(rand() % 30000, Angle::Degrees(rand() % 360));
+      stage.emplace_back(v.EndPoint(center));
+    }
+
+    center = GeoVector(20000 + rand() % 100000,
+                       Angle::Degrees(rand() % 360)).EndPoint(center);
+  }
+
+  return task;
+}
+
+template<typename S>
+static void
+SetTask(S &solver, const std::vector<SearchPointVector> &task)
+{
+  solver.SetTaskSize(task.size());
+  for (unsigned i = 0; i < task.size(); ++i)
+    solver.SetBoundary(i, task[i]);
+}
+
+/**
+ * Sum up the distances of a solution in the same way the solvers do.
+ * Different solvers may pick different paths with the same total.
+ */
+template<typename S>
+static unsigned
+GetTotal(const S &solver, unsigned n_stages, const SearchPoint &location)
+{
+  unsigned total = location.IsValid()
+    ? (unsigned)solver.GetSolution(0).GetLocation().Distance(location.GetLocation())
+    : 0;
+
+  for (unsigned stage = 1; stage < n_stages; ++stage)
+    total += (unsigned)solver.GetSolution(stage - 1).GetLocation()
+      .Distance(solver.GetSolution(stage).GetLocation());
+
+  return total;
+}
+
+static void
+TestMin(const std::vector<SearchPointVector> &task,
+        const SearchPoint &location)
+{
+  TaskDijkstraMin dijkstra;
+  SetTask(dijkstra, task);
+
+  TaskDistanceSolver solver(true);
+  SetTask(solver, task);
+
+  ok1(dijkstra.DistanceMin(location));
+  ok1(solver.DistanceMin(location));
+  ok1(GetTotal(solver, task.size(), location) ==
+      GetTotal(dijkstra, task.size(), location));
+}
+
+static void
+TestMax(const std::vector<SearchPointVector> &task)
+{
+  TaskDijkstraMax dijkstra;
+  SetTask(dijkstra, task);
+
+  TaskDistanceSolver solver(false);
+  SetTask(solver, task);
+
+  ok1(dijkstra.DistanceMax());
+  ok1(solver.DistanceMax());
+  ok1(GetTotal(solver, task.size(), SearchPoint::Invalid()) ==
+      GetTotal(dijkstra, task.size(), SearchPoint::Invalid()));
+}
+
+static void
+TestEmptyStage()
+{
+  auto task = MakeRandomTask(3);
+  task[1].clear();
+
+  TaskDistanceSolver solver(false);
+  SetTask(solver, task);
+  ok1(!solver.DistanceMax());
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(20 * 9 + 1);
+
+  for (unsigned i = 0; i < 20; ++i) {
+    const auto task = MakeRandomTask(2 + i % 10);
+    const SearchPoint location(GeoVector(50000, Angle::Degrees(i * 17))
+                               .EndPoint(task.front().front().GetLocation()));
+
+    TestMin(task, location);
+    TestMin(task, SearchPoint::Invalid());
+    TestMax(task);
+  }
+
+  TestEmptyStage();
+
+  return exit_status();
+}
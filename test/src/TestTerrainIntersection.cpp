@@ -0,0 +1,280 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Verify that the terrain intersection searches of RasterTileCache,
+ * which skip pixels using RasterLineWalk and HeightPyramid, give
+ * exactly the same results as stepping through each pixel.
+ */
+
+#include "ReferenceIntersection.hpp"
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/RasterLineWalk.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <math.h>
+#include <stdlib.h>
+
+extern "C" {
+#include "tap.h"
+}
+
+static constexpr unsigned WIDTH = 700, HEIGHT = 530;
+static constexpr unsigned TILE_SIZE = 256;
+static constexpr unsigned N_QUERIES = 20000;
+
+static int
+Random(int min, int max)
+{
+  return min + rand() % (max - min + 1);
+}
+
+/**
+ * A map of random hills with some water, some invalid pixels and a
+ * mix of loaded and unloaded tiles.
+ */
+class SyntheticTileCache : public RasterTileCache {
+  struct Hill {
+    double x, y, radius, height;
+  };
+
+  Hill hills[24];
+
+public:
+  SyntheticTileCache() {
+    for (auto &hill : hills)
+      hill = {double(Random(0, WIDTH)), double(Random(0, HEIGHT)),
+              double(Random(5, 120)), double(Random(50, 2500))};
+
+    const unsigned columns = (WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+    const unsigned rows = (HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+    SetSize(WIDTH, HEIGHT, TILE_SIZE, TILE_SIZE, columns, rows);
+
+    for (unsigned row = 0; row < rows; ++row) {
+      for (unsigned column = 0; column < columns; ++column) {
+        const unsigned x0 = column * TILE_SIZE, y0 = row * TILE_SIZE;
+        const unsigned x1 = std::min(x0 + TILE_SIZE, WIDTH);
+        const unsigned y1 = std::min(y0 + TILE_SIZE, HEIGHT);
+
+        RasterTile &tile = tiles.Get(column, row);
+        tile.Set(x0, y0, x1, y1);
+
+        if ((column + row) % 2 == 0)
+          continue;
+
+        RasterBuffer buffer(x1 - x0, y1 - y0);
+        TerrainHeight *p = buffer.GetData();
+        for (unsigned y = y0; y < y1; ++y)
+          for (unsigned x = x0; x < x1; ++x)
+            *p++ = Generate(x, y);
+
+        tile.Install(std::move(buffer));
+      }
+    }
+
+    /* the overview is sampled from the full resolution map, just
+       like PutOverviewTile() does */
+    TerrainHeight *p = overview.GetData();
+    for (unsigned y = 0; y < overview.GetHeight(); ++y)
+      for (unsigned x = 0; x < overview.GetWidth(); ++x)
+        *p++ = Generate(x << RasterTraits::OVERVIEW_BITS,
+                        y << RasterTraits::OVERVIEW_BITS);
+
+    FinishOverview();
+  }
+
+private:
+  TerrainHeight Generate(unsigned x, unsigned y) const {
+    /* a lake and a hole in the data */
+    if (x >= 400 && x < 470 && y >= 60 && y < 100)
+      return TerrainHeight(-31000);
+    if (x >= 90 && x < 96 && y >= 300 && y < 303)
+      return TerrainHeight::Invalid();
+
+    double h = 0;
+    for (const auto &hill : hills) {
+      const double dx = (x - hill.x) / hill.radius;
+      const double dy = (y - hill.y) / hill.radius;
+      h += hill.height * exp(-(dx * dx + dy * dy));
+    }
+
+    /* some rough spikes */
+    if ((x * 7919 + y * 104729) % 97 == 0)
+      h += 800;
+
+    return TerrainHeight(int16_t(h));
+  }
+};
+
+static SignedRasterLocation
+RandomLocation()
+{
+  /* mostly inside the map, sometimes beyond its edges */
+  return SignedRasterLocation(Random(-50, WIDTH + 50),
+                              Random(-50, HEIGHT + 50));
+}
+
+static SignedRasterLocation
+RandomInside()
+{
+  return SignedRasterLocation(Random(0, WIDTH - 1), Random(0, HEIGHT - 1));
+}
+
+static int
+ManhattanDistance(SignedRasterLocation a, SignedRasterLocation b)
+{
+  return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+/**
+ * Pick the arguments like RasterMap::FirstIntersection() does.
+ */
+static bool
+TestFirstIntersection(const RasterTileCache &rtc)
+{
+  const SignedRasterLocation origin = Random(0, 9) == 0
+    ? RandomLocation() : RandomInside();
+  const SignedRasterLocation destination = RandomLocation();
+  const int c_diff = ManhattanDistance(origin, destination);
+  if (c_diff == 0)
+    return true;
+
+  const int h_origin = Random(0, 3500);
+  const int h_destination = Random(0, 3500);
+  const int h_virt = Random(0, 1500);
+  const int h_ceiling = Random(0, 3) == 0 ? Random(500, 4000) : 32000;
+  const int h_safety = Random(0, 300);
+  const bool can_climb = h_destination < h_virt;
+
+  const int slope_fact = (h_virt << RASTER_SLOPE_FACT) / c_diff;
+  const int vh_origin = std::max(h_origin,
+                                 h_destination
+                                 - ((c_diff * slope_fact) >> RASTER_SLOPE_FACT));
+
+  RasterLocation location1(0, 0), location2(0, 0);
+  int h1 = 0, h2 = 0;
+  const bool result1 =
+    rtc.FirstIntersection(origin, destination, vh_origin, h_destination,
+                          slope_fact, h_ceiling, h_safety,
+                          location1, h1, can_climb);
+  const bool result2 =
+    ReferenceFirstIntersection(rtc, origin, destination,
+                               vh_origin, h_destination,
+                               slope_fact, h_ceiling, h_safety,
+                               location2, h2, can_climb);
+
+  return result1 == result2 &&
+    (!result1 || (location1 == location2 && h1 == h2));
+}
+
+/**
+ * Pick the arguments like RasterMap::Intersection() does.
+ */
+static bool
+TestIntersection(const RasterTileCache &rtc)
+{
+  const SignedRasterLocation origin = Random(0, 9) == 0
+    ? RandomLocation() : RandomInside();
+  const SignedRasterLocation destination = RandomLocation();
+  const int c_diff = ManhattanDistance(origin, destination);
+  if (c_diff == 0)
+    return true;
+
+  const int h_origin = Random(0, 4000);
+  const int h_glide = Random(0, 4000);
+  const int height_floor = Random(0, 1) ? 0 : Random(0, 2000);
+
+  const int slope_fact = (h_glide << RASTER_SLOPE_FACT) / c_diff;
+
+  const auto result1 = rtc.Intersection(origin, destination,
+                                        h_origin, slope_fact, height_floor);
+  const auto result2 = ReferenceIntersection(rtc, origin, destination,
+                                             h_origin, slope_fact,
+                                             height_floor);
+  return result1 == result2;
+}
+
+/**
+ * Compare RasterLineWalk::Advance() with single iterations.
+ */
+static bool
+TestLineWalk()
+{
+  const SignedRasterLocation origin(Random(-1000, 1000), Random(-1000, 1000));
+  const SignedRasterLocation destination(Random(-1000, 1000),
+                                         Random(-1000, 1000));
+
+  RasterLineWalk fast(origin, destination), slow(origin, destination);
+  const unsigned end = fast.GetLastIteration() + 50;
+
+  while (fast.GetIteration() < end) {
+    const unsigned min_steps = Random(0, 300);
+    const unsigned max_iteration =
+      std::min(end, fast.GetIteration() + Random(1, 400));
+
+    const unsigned steps = fast.Advance(min_steps, max_iteration);
+
+    unsigned slow_steps = 0;
+    do {
+      slow_steps += slow.Step();
+    } while (slow_steps < min_steps && slow.GetIteration() < max_iteration);
+
+    if (steps != slow_steps || fast.GetLocation() != slow.GetLocation() ||
+        fast.GetTotalSteps() != slow.GetTotalSteps() ||
+        fast.GetIteration() != slow.GetIteration())
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(3);
+
+  srand(42);
+
+  std::unique_ptr<SyntheticTileCache> rtc(new SyntheticTileCache());
+
+  unsigned n_failed = 0;
+  for (unsigned i = 0; i < N_QUERIES; ++i)
+    if (!TestFirstIntersection(*rtc))
+      ++n_failed;
+  ok(n_failed == 0, "FirstIntersection (%u failed)", n_failed);
+
+  n_failed = 0;
+  for (unsigned i = 0; i < N_QUERIES; ++i)
+    if (!TestIntersection(*rtc))
+      ++n_failed;
+  ok(n_failed == 0, "Intersection (%u failed)", n_failed);
+
+  n_failed = 0;
+  for (unsigned i = 0; i < 1000; ++i)
+    if (!TestLineWalk())
+      ++n_failed;
+  ok(n_failed == 0, "RasterLineWalk (%u failed)", n_failed);
+
+  return exit_status();
+}
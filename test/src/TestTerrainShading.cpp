@@ -0,0 +1,135 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Verify that the optimised terrain shading kernels give the same
+ * results as the portable ones.
+ */
+
+#include "Terrain/ShadingKernels.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "tap.h"
+}
+
+static constexpr unsigned WIDTH = 203;
+static constexpr unsigned N_ROUNDS = 100;
+
+static int
+Random(int min, int max)
+{
+  return min + rand() % (max - min + 1);
+}
+
+/**
+ * Fill a row with a random terrain profile, with occasional special
+ * values and extreme jumps.
+ */
+static void
+FillRow(TerrainHeight *row)
+{
+  int h = Random(-100, 3000);
+  for (unsigned i = 0; i < WIDTH; ++i) {
+    h = std::max(-500, std::min(9000, h + Random(-80, 80)));
+
+    const int r = Random(0, 99);
+    if (r == 0)
+      row[i] = TerrainHeight::Invalid();
+    else if (r == 1)
+      row[i] = TerrainHeight(Random(-32000, -30000));
+    else if (r == 2)
+      row[i] = TerrainHeight(Random(-29999, 32767));
+    else
+      row[i] = TerrainHeight(h);
+  }
+}
+
+static bool
+TestHeightIndices(const TerrainHeight *src,
+                  unsigned height_scale, unsigned contour_height_scale)
+{
+  uint8_t heights1[WIDTH], contours1[WIDTH];
+  uint8_t heights2[WIDTH], contours2[WIDTH];
+
+  CalculateHeightIndices(heights1, contours1, src, WIDTH,
+                         height_scale, contour_height_scale);
+  PortableCalculateHeightIndices(heights2, contours2, src, WIDTH,
+                                 height_scale, contour_height_scale);
+
+  /* results for special values are undefined */
+  for (unsigned i = 0; i < WIDTH; ++i)
+    if (!src[i].IsSpecial() &&
+        (heights1[i] != heights2[i] || contours1[i] != contours2[i]))
+      return false;
+
+  return true;
+}
+
+static bool
+TestSlopeShading(const TerrainHeight *above, const TerrainHeight *src,
+                 const TerrainHeight *below)
+{
+  const unsigned q = Random(1, 25);
+  const unsigned p31 = Random(1, 2 * q);
+
+  SlopeShadingParameters s;
+  s.sx = Random(-255, 255);
+  s.sy = Random(-255, 255);
+  s.sz = Random(0, 255);
+  s.contrast = Random(0, 255);
+  s.height_slope_factor = Random(1, 8192 / (q * q));
+
+  const unsigned n = WIDTH - 2 * q;
+
+  int8_t result1[WIDTH], result2[WIDTH];
+  CalculateSlopeShading(result1, above + q, src + q, below + q,
+                        n, q, p31, s);
+  PortableCalculateSlopeShading(result2, above + q, src + q, below + q,
+                                n, q, p31, s);
+
+  return memcmp(result1, result2, n) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * N_ROUNDS);
+
+  srand(42);
+
+  TerrainHeight above[WIDTH], src[WIDTH], below[WIDTH];
+
+  for (unsigned i = 0; i < N_ROUNDS; ++i) {
+    FillRow(above);
+    FillRow(src);
+    FillRow(below);
+
+    ok1(TestHeightIndices(src, Random(0, 8), Random(0, 16)));
+    ok1(TestSlopeShading(above, src, below));
+  }
+
+  return exit_status();
+}
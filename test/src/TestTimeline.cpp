@@ -0,0 +1,181 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/Timeline.hpp"
+#include "Thread/Thread.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+
+#include <string.h>
+
+static constexpr unsigned CAPACITY = TimelineBuffer::CAPACITY;
+
+/**
+ * Are the spans consecutive, and does each one carry the values
+ * written by Fill()?
+ */
+static bool
+IsConsistent(const std::vector<TimelineSpan> &spans)
+{
+  for (size_t i = 0; i < spans.size(); ++i) {
+    const TimelineSpan &span = spans[i];
+    if (span.duration != span.start % 7 ||
+        strcmp(span.name, span.start % 2 ? "odd" : "even") != 0)
+      return false;
+
+    if (i > 0 && span.start != spans[i - 1].start + 1)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+Fill(TimelineBuffer &buffer, uint64_t begin, uint64_t end)
+{
+  for (uint64_t i = begin; i != end; ++i)
+    buffer.Push(i % 2 ? "odd" : "even", i, i + i % 7);
+}
+
+static void
+TestBuffer()
+{
+  TimelineBuffer buffer("Test", 42);
+  ok1(strcmp(buffer.GetThreadName(), "Test") == 0);
+  ok1(buffer.GetThreadId() == 42);
+
+  std::vector<TimelineSpan> spans;
+  buffer.Snapshot(spans);
+  ok1(spans.empty());
+
+  Fill(buffer, 0, 10);
+  buffer.Snapshot(spans);
+  ok1(spans.size() == 10);
+  ok1(spans.front().start == 0);
+  ok1(IsConsistent(spans));
+
+  /* wrap around; only the newest spans are kept */
+  Fill(buffer, 10, 3 * CAPACITY + 5);
+  spans.clear();
+  buffer.Snapshot(spans);
+  ok1(spans.size() == CAPACITY - 1);
+  ok1(spans.back().start == 3 * CAPACITY + 4);
+  ok1(IsConsistent(spans));
+}
+
+class WriterThread final : public Thread {
+  TimelineBuffer &buffer;
+
+  std::atomic<bool> stop;
+
+public:
+  explicit WriterThread(TimelineBuffer &_buffer)
+    :Thread("TimelineWriter"), buffer(_buffer), stop(false) {}
+
+  void Stop() {
+    stop = true;
+    Join();
+  }
+
+protected:
+  void Run() override {
+    uint64_t i = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      Fill(buffer, i, i + 100);
+      i += 100;
+    }
+  }
+};
+
+static void
+TestConcurrent()
+{
+  TimelineBuffer buffer("Test", 1);
+  WriterThread writer(buffer);
+  writer.Start();
+
+  bool consistent = true;
+  std::vector<TimelineSpan> spans;
+  for (unsigned i = 0; i < 2000; ++i) {
+    spans.clear();
+    buffer.Snapshot(spans);
+    if (!IsConsistent(spans))
+      consistent = false;
+  }
+
+  writer.Stop();
+
+  ok1(consistent);
+}
+
+class SpanThread final : public Thread {
+public:
+  SpanThread():Thread("SpanThread") {}
+
+protected:
+  void Run() override {
+    const ScopeTimelineSpan span("SpanThread::Run");
+  }
+};
+
+static void
+TestSnapshot()
+{
+  {
+    const ScopeTimelineSpan span("TestSnapshot");
+  }
+
+  SpanThread thread;
+  thread.Start();
+  thread.Join();
+
+  const auto threads = SnapshotTimeline();
+  ok1(threads.size() == 2);
+
+  const TimelineThread *main_thread = nullptr, *span_thread = nullptr;
+  for (const auto &i : threads) {
+    if (strcmp(i.name, "Main") == 0)
+      main_thread = &i;
+    else if (strcmp(i.name, "SpanThread") == 0)
+      span_thread = &i;
+  }
+
+  ok1(main_thread != nullptr && span_thread != nullptr &&
+      main_thread->id != span_thread->id);
+  ok1(main_thread != nullptr && main_thread->spans.size() == 1 &&
+      strcmp(main_thread->spans.front().name, "TestSnapshot") == 0);
+  ok1(span_thread != nullptr && span_thread->spans.size() == 1 &&
+      strcmp(span_thread->spans.front().name, "SpanThread::Run") == 0);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(14);
+
+  TestBuffer();
+  TestConcurrent();
+  TestSnapshot();
+
+  return exit_status();
+}
@@ -0,0 +1,370 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Convert the topography of a map file to a pack and compare it with
+ * the shapefiles; verify the R-tree queries and the shape list of
+ * TopographyFile against a linear search.
+ */
+
+#include "Topography/TopographyPack.hpp"
+#include "Topography/TopographyPackWriter.hpp"
+#include "Topography/TopographyConfig.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/XShape.hpp"
+#include "Topography/Convert.hpp"
+#include "Topography/shapelib/mapserver.h"
+#include "Topography/shapelib/mapshape.h"
+#include "Projection/WindowProjection.hpp"
+#include "IO/ZipArchive.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "OS/Path.hpp"
+#include "OS/FileUtil.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/ScopeExit.hxx"
+#include "Util/PrintException.hxx"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "tap.h"
+}
+
+static constexpr unsigned N_QUERIES = 2000;
+
+static const TCHAR *const pack_path = _T("output/test/topography.pack");
+
+static bool
+EqualPoints(const TopographyPackLayer &layer,
+            const TopographyPackLayer::Point &a, const pointObj &b)
+{
+  const GeoPoint location(Angle::Degrees(b.x), Angle::Degrees(b.y));
+
+#ifdef ENABLE_OPENGL
+  const GeoPoint relative = location - layer.center;
+  return a.x == ShapeScalar(relative.longitude.Native()) &&
+    a.y == ShapeScalar(relative.latitude.Native());
+#else
+  return a == location;
+#endif
+}
+
+/**
+ * Compare the shape with the next pack shape, after skipping the
+ * shapes the writer is expected to discard.
+ */
+static bool
+CompareShape(const TopographyPackLayer &layer, unsigned &next,
+             const shapeObj &shape)
+{
+  const int min_points = shape.type == MS_SHAPE_POINT
+    ? 1
+    : (shape.type == MS_SHAPE_LINE
+       ? 2
+       : (shape.type == MS_SHAPE_POLYGON ? 3 : -1));
+  if (min_points < 0 || !ImportRect(shape.bounds).Check())
+    return true;
+
+  bool empty = true;
+  for (int l = 0; l < shape.numlines; ++l)
+    if (shape.line[l].numpoints >= min_points)
+      empty = false;
+
+  if (empty)
+    return true;
+
+  if (next >= layer.n_shapes)
+    return false;
+
+  const XShape xshape(layer, next++);
+  if (xshape.get_type() != shape.type)
+    return false;
+
+  const auto *points = xshape.GetPoints();
+  auto line = xshape.GetLines().begin();
+  for (int l = 0; l < shape.numlines; ++l) {
+    if (shape.line[l].numpoints < min_points)
+      continue;
+
+    if (line == xshape.GetLines().end() ||
+        *line != unsigned(shape.line[l].numpoints))
+      return false;
+
+    for (int i = 0; i < shape.line[l].numpoints; ++i)
+      if (!EqualPoints(layer, *points++, shape.line[l].point[i]))
+        return false;
+
+    ++line;
+  }
+
+  return line == xshape.GetLines().end();
+}
+
+/**
+ * Compare all shapes of the layer with the shapefile.
+ */
+static bool
+CompareLayer(zzip_dir *dir, const TopographyPackLayer &layer)
+{
+  char name[TopographyPackFormat::NAME_SIZE + 4];
+  strcpy(name, layer.name);
+  strcat(name, ".shp");
+
+  shapefileObj file;
+  if (msShapefileOpen(&file, "rb", dir, name, 0) == -1)
+    return false;
+
+  AtScopeExit(&file) { msShapefileClose(&file); };
+
+  unsigned next = 0;
+  for (int i = 0; i < file.numshapes; ++i) {
+    shapeObj shape;
+    msInitShape(&shape);
+    AtScopeExit(&shape) { msFreeShape(&shape); };
+    msSHPReadShape(file.hSHP, i, &shape);
+
+    if (!CompareShape(layer, next, shape))
+      return false;
+  }
+
+  return next == layer.n_shapes;
+}
+
+static GeoBounds
+GetLayerBounds(const TopographyPackLayer &layer)
+{
+  GeoBounds bounds = layer.shapes[0].bounds;
+  for (unsigned i = 1; i < layer.n_shapes; ++i) {
+    bounds.Extend(layer.shapes[i].bounds.GetNorthWest());
+    bounds.Extend(layer.shapes[i].bounds.GetSouthEast());
+  }
+
+  return bounds;
+}
+
+static GeoPoint
+RandomPoint(const GeoBounds &bounds)
+{
+  /* a bit beyond the layer's bounds */
+  const double x = rand() / double(RAND_MAX) * 1.2 - 0.1;
+  const double y = rand() / double(RAND_MAX) * 1.2 - 0.1;
+  return GeoPoint(bounds.GetWest() + bounds.GetWidth() * x,
+                  bounds.GetSouth() + bounds.GetHeight() * y);
+}
+
+static std::vector<unsigned>
+LinearSearch(const TopographyPackLayer &layer, const GeoBounds &bounds)
+{
+  std::vector<unsigned> result;
+  for (unsigned i = 0; i < layer.n_shapes; ++i)
+    if (bounds.Overlaps(layer.shapes[i].bounds))
+      result.push_back(i);
+  return result;
+}
+
+static bool
+TestQueries(const TopographyPackLayer &layer)
+{
+  const GeoBounds layer_bounds = GetLayerBounds(layer);
+
+  std::vector<unsigned> found;
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    GeoBounds bounds(RandomPoint(layer_bounds));
+    bounds.Extend(RandomPoint(layer_bounds));
+
+    found.clear();
+    layer.VisitShapes(bounds, [&found](unsigned i){
+        found.push_back(i);
+      });
+    std::sort(found.begin(), found.end());
+
+    if (found != LinearSearch(layer, bounds))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Pan over the layer and verify the shape list after each
+ * TopographyFile::Update() call.
+ */
+static bool
+TestPanning(const TopographyPackLayer &layer)
+{
+  TopographyFile file(layer, 1e6, 1e6, 0, COLOR_BLACK);
+
+  const GeoBounds layer_bounds = GetLayerBounds(layer);
+
+  WindowProjection projection;
+  projection.SetScreenSize({640, 480});
+  projection.SetScreenOrigin(320, 240);
+  projection.SetScaleFromRadius(5000);
+
+  unsigned total_visible = 0;
+  for (unsigned step = 0; step <= 50; ++step) {
+    const double f = step / 50.;
+    projection.SetGeoLocation(GeoPoint(layer_bounds.GetWest()
+                                       + layer_bounds.GetWidth() * f,
+                                       layer_bounds.GetSouth()
+                                       + layer_bounds.GetHeight() * f));
+    projection.UpdateScreenBounds();
+
+    file.Update(projection);
+
+    /* every shape on the screen must be listed, in file order */
+    const GeoBounds screen = projection.GetScreenBounds();
+    const ScopeLock protect(file.mutex);
+    const XShape *previous = nullptr;
+    unsigned n_visible = 0;
+    for (const XShape &shape : file) {
+      if (previous != nullptr && &shape.get_bounds() <= &previous->get_bounds())
+        return false;
+
+      previous = &shape;
+      if (screen.Overlaps(shape.get_bounds()))
+        ++n_visible;
+    }
+
+    if (n_visible != LinearSearch(layer, screen).size())
+      return false;
+
+    total_visible += n_visible;
+  }
+
+  return total_visible > 0;
+}
+
+static void
+TestLayers(zzip_dir *dir, const TopographyPack &pack)
+{
+  for (unsigned i = 0; i < pack.size(); ++i) {
+    const TopographyPackLayer &layer = pack[i];
+    ok(CompareLayer(dir, layer), "shapes of %s", layer.name);
+    ok(TestQueries(layer), "queries of %s", layer.name);
+    ok(TestPanning(layer), "panning over %s", layer.name);
+  }
+}
+
+/**
+ * Count the layers "topology.tpl" asks for.
+ */
+static unsigned
+CountLayers(zzip_dir *dir)
+{
+  ZipLineReaderA reader(dir, "topology.tpl");
+
+  unsigned n = 0;
+  char *line;
+  TopographyFileConfig config;
+  while ((line = reader.ReadLine()) != nullptr)
+    if (ParseTopographyLine(line, config))
+      ++n;
+
+  return n;
+}
+
+static bool
+WritePack(const std::vector<uint8_t> &buffer, long &offset)
+{
+  Directory::Create(Path(_T("output/test")));
+
+  FILE *file = _tfopen(pack_path, _T("wb"));
+  if (file == nullptr)
+    return false;
+
+  /* a misaligned prefix, like the header of FileCache */
+  static constexpr char prefix[20] = "prefix";
+  bool success = fwrite(prefix, 1, sizeof(prefix), file) == sizeof(prefix);
+  offset = ftell(file);
+  success = success && WriteTopographyPack(file, buffer);
+  return fclose(file) == 0 && success;
+}
+
+static bool
+EqualShapes(const TopographyPack &a, const TopographyPack &b)
+{
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (strcmp(a[i].name, b[i].name) != 0 ||
+        a[i].n_shapes != b[i].n_shapes ||
+        memcmp(a[i].shapes, b[i].shapes,
+               a[i].n_shapes * sizeof(a[i].shapes[0])) != 0)
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+try {
+  ZipArchive archive(Path(_T("test/data/benalla9.xcm")));
+
+  NullOperationEnvironment operation;
+  std::vector<uint8_t> buffer;
+
+  {
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+    BuildTopographyPack(archive.get(), reader, 2, buffer, operation);
+  }
+
+  const unsigned n_layers = CountLayers(archive.get());
+
+  plan_tests(8 + 3 * n_layers);
+
+  long offset;
+  ok1(WritePack(buffer, offset));
+
+  /* a truncated pack is rejected */
+  {
+    std::vector<uint8_t> truncated(buffer.begin(),
+                                   buffer.begin() + buffer.size() / 2);
+    TopographyPack pack;
+    ok1(!pack.Open(std::move(truncated), 2));
+  }
+
+  {
+    TopographyPack pack;
+    ok1(!pack.Open(std::vector<uint8_t>(buffer), 1));
+  }
+
+  TopographyPack pack;
+  ok1(pack.Open(std::move(buffer), 2));
+  ok1(pack.size() == n_layers);
+  TestLayers(archive.get(), pack);
+
+  /* the mapped file has the same contents */
+  TopographyPack mapped;
+  ok1(mapped.Open(Path(pack_path), offset, 2));
+  ok1(mapped.size() == pack.size());
+  ok1(EqualShapes(pack, mapped));
+
+  File::Delete(Path(pack_path));
+
+  return exit_status();
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -22,6 +22,7 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/ParallelWaypointReader.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Units/System.hpp"
@@ -31,6 +32,7 @@
 #include "Util/StringAPI.hxx"
 #include "Util/ExtractParameters.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/JobScheduler.hpp"
 
 #include <vector>
 
@@ -426,6 +428,111 @@ TestCompeGPS_UTM(wp_vector org_wp)
   }
 }
 
+/**
+ * Are both lists equal, including the waypoint ids?
+ */
+static bool
+IsEqual(const Waypoints &a, const Waypoints &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned id = 1; id <= a.size(); ++id) {
+    const auto x = a.LookupId(id), y = b.LookupId(id);
+    if (x == nullptr || y == nullptr ||
+        x->name != y->name || x->comment != y->comment ||
+        x->location != y->location ||
+        x->elevation != y->elevation ||
+        x->type != y->type || x->origin != y->origin ||
+        x->flags.home != y->flags.home ||
+        x->flags.turn_point != y->flags.turn_point)
+      return false;
+  }
+
+  return true;
+}
+
+static constexpr const TCHAR *waypoint_files[] = {
+  _T("test/data/waypoints.dat"),
+  _T("test/data/waypoints.cup"),
+  _T("test/data/waypoints.wpz"),
+  _T("test/data/waypoints_geo.wpt"),
+  _T("test/data/waypoints_utm.wpt"),
+  _T("test/data/waypoints_ozi.wpt"),
+  _T("test/data/waypoints_compe_geo.wpt"),
+  _T("test/data/waypoints_compe_utm.wpt"),
+};
+
+/**
+ * Compare ParallelWaypointReader with ReadWaypointFile(), with chunks
+ * small enough to split the test files.
+ */
+static void
+TestParallel()
+{
+  JobScheduler scheduler("Test", 2);
+  NullOperationEnvironment operation;
+
+  for (const auto path : waypoint_files) {
+    Waypoints expected;
+    ReadWaypointFile(Path(path), expected,
+                     WaypointFactory(WaypointOrigin::PRIMARY), operation);
+    expected.Optimise();
+
+    for (unsigned chunk_lines = 1; chunk_lines <= 4; ++chunk_lines) {
+      ParallelWaypointReader reader(chunk_lines);
+      reader.Add(Path(path), WaypointFactory(WaypointOrigin::PRIMARY));
+
+      Waypoints way_points;
+      reader.Run(scheduler, way_points, operation);
+      way_points.Optimise();
+
+      ok1(reader.IsSuccessful(0));
+      ok1(IsEqual(way_points, expected));
+    }
+  }
+
+  /* all files at once, and one which doesn't exist */
+  Waypoints expected;
+  ParallelWaypointReader reader(3);
+  unsigned origin = 0;
+  for (const auto path : waypoint_files) {
+    const WaypointFactory factory(WaypointOrigin(origin++ % 4));
+    ReadWaypointFile(Path(path), expected, factory, operation);
+    reader.Add(Path(path), factory);
+  }
+
+  const unsigned missing =
+    reader.Add(Path(_T("test/data/does_not_exist.cup")),
+               WaypointFactory(WaypointOrigin::NONE));
+
+  expected.Optimise();
+
+  Waypoints way_points;
+  reader.Run(scheduler, way_points, operation);
+  way_points.Optimise();
+
+  ok1(IsEqual(way_points, expected));
+  ok1(!reader.IsSuccessful(missing));
+
+  /* a cancelled operation adds nothing */
+  class CancelledOperationEnvironment final : public NullOperationEnvironment {
+  public:
+    bool IsCancelled() const override {
+      return true;
+    }
+  } cancelled;
+
+  ParallelWaypointReader cancelled_reader(3);
+  cancelled_reader.Add(Path(waypoint_files[0]),
+                       WaypointFactory(WaypointOrigin::PRIMARY));
+
+  Waypoints none;
+  cancelled_reader.Run(scheduler, none, cancelled);
+  ok1(none.IsEmpty());
+  ok1(!cancelled_reader.IsSuccessful(0));
+}
+
 static wp_vector
 CreateOriginalWaypoints()
 {
@@ -523,7 +630,7 @@ int main(int argc, char **argv)
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(307);
+  plan_tests(375);
 
   TestExtractParameters();
 
@@ -535,6 +642,7 @@ int main(int argc, char **argv)
   TestOzi(org_wp);
   TestCompeGPS(org_wp);
   TestCompeGPS_UTM(org_wp);
+  TestParallel();
 
   return exit_status();
 }
@@ -35,9 +35,13 @@
 #include "Geo/SpeedVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
+#include "Thread/ThreadPool.hpp"
 
 #include <zzip/zzip.h>
 
+#include <vector>
+
 #include <string.h>
 
 static void
@@ -101,6 +105,129 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
   //  printf("# pixel size %g\n", (double)pd);
 }
 
+/**
+ * A set of aircraft positions around the map center, and the
+ * terrain reach calculated for a grid of destinations around each
+ * of them.
+ */
+struct ReachBenchmark {
+  std::vector<AGeoPoint> origins, destinations;
+
+  RoutePlannerConfig config;
+
+  explicit ReachBenchmark(const RasterMap &map) {
+    config.SetDefaults();
+    /* only the turning reach builds a tree of fans */
+    config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+    const GeoPoint center = map.GetMapCenter();
+    for (int i = -2; i <= 2; ++i) {
+      for (int j = -2; j <= 2; ++j) {
+        const GeoPoint p(center.longitude + Angle::Degrees(0.1 * i),
+                         center.latitude + Angle::Degrees(0.1 * j));
+        origins.emplace_back(p, map.GetHeight(p).GetValueOr0() + 1000);
+      }
+    }
+
+    for (int i = -10; i <= 10; ++i) {
+      for (int j = -10; j <= 10; ++j) {
+        const GeoPoint p(center.longitude + Angle::Degrees(0.04 * i),
+                         center.latitude + Angle::Degrees(0.04 * j));
+        destinations.emplace_back(p, map.GetHeight(p).GetValueOr0());
+      }
+    }
+  }
+
+  /**
+   * Solve the reach for all origins, and append the arrival heights
+   * to the vector.
+   *
+   * @return the average duration of one solution [ms]
+   */
+  double Run(TerrainRoute &route, std::vector<int> &arrivals) const {
+    uint64_t duration = 0;
+    for (const auto &origin : origins) {
+      const auto start = MonotonicClockUS();
+      route.SolveReachTerrain(origin, config, INT_MAX);
+      duration += MonotonicClockUS() - start;
+
+      for (const auto &destination : destinations) {
+        ReachResult reach;
+        route.FindPositiveArrival(destination, reach);
+        arrivals.push_back(reach.IsReachableTerrain() ? reach.terrain : 0);
+      }
+    }
+
+    return duration / 1000. / origins.size();
+  }
+};
+
+static void
+InitRoute(TerrainRoute &route, const RasterMap &map,
+          const RoutePlannerConfig &config)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  GlidePolar polar(1);
+  route.UpdatePolar(settings, config, polar, polar, SpeedVector::Zero(), 0);
+  route.SetTerrain(&map);
+}
+
+/**
+ * Measure how the reach calculation scales with the number of
+ * threads, and how the time budget limits it.
+ */
+static void
+benchmark_reach(const RasterMap &map)
+{
+  const ReachBenchmark benchmark(map);
+
+  std::vector<int> reference;
+  double serial;
+  {
+    TerrainRoute route;
+    InitRoute(route, map, benchmark.config);
+    serial = benchmark.Run(route, reference);
+  }
+
+  printf("serial: %.2f ms/solution\n", serial);
+
+  const unsigned max_threads = std::max(GetProcessorCount(), 4u);
+  for (unsigned n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+    ThreadPool pool("Reach", n_threads - 1);
+
+    TerrainRoute route;
+    InitRoute(route, map, benchmark.config);
+    route.SetReachParallel([&pool](unsigned n,
+                                   const std::function<void(unsigned)> &f){
+        pool.ParallelFor(n, f);
+      });
+
+    std::vector<int> arrivals;
+    const double ms = benchmark.Run(route, arrivals);
+    printf("threads=%u: %.2f ms/solution, speedup %.2f%s\n",
+           n_threads, ms, serial / ms,
+           arrivals == reference ? "" : " MISMATCH");
+  }
+
+  for (unsigned budget : {100, 300, 1000, 10000}) {
+    TerrainRoute route;
+    InitRoute(route, map, benchmark.config);
+    route.SetReachTimeBudget(std::chrono::microseconds(budget));
+
+    std::vector<int> arrivals;
+    const double ms = benchmark.Run(route, arrivals);
+
+    unsigned same = 0;
+    for (unsigned i = 0; i < arrivals.size(); ++i)
+      if (arrivals[i] == reference[i])
+        ++same;
+
+    printf("budget=%uus: %.2f ms/solution, %.1f%% of arrivals unchanged\n",
+           budget, ms, 100. * same / arrivals.size());
+  }
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
@@ -135,6 +262,11 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
+  if (argc > 2 && strcmp(argv[2], "--benchmark") == 0) {
+    benchmark_reach(map);
+    return EXIT_SUCCESS;
+  }
+
   plan_tests(8);
   test_reach(map, 0, 0.1, 0);
   test_reach(map, 0, 0.1, 750);
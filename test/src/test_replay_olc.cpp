@@ -6,6 +6,7 @@
 #include "Computer/Settings.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
 #include "IO/FileLineReader.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
@@ -188,7 +189,13 @@ test_replay(const Contest olc_type,
     do_print = (++print_counter % output_skip ==0) && verbose;
   };
 
+  const auto start = MonotonicClockUS();
   contest_manager.SolveExhaustive();
+  const auto duration = MonotonicClockUS() - start;
+
+  std::cout << "# Exhaustive solve " << duration / 1000. << " ms, "
+            << contest_manager.GetTriangleIterations()
+            << " triangle iterations\n";
 
   if (verbose) {
     PrintDistanceCounts();
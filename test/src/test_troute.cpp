@@ -35,9 +35,13 @@
 #include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/Clock.hpp"
 
 #include <zzip/zzip.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <string.h>
 
 static void
@@ -106,13 +110,100 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
   // route.UpdatePolar(polar, wind);
 }
 
+static bool
+operator==(const AGeoPoint &a, const AGeoPoint &b)
+{
+  return a.longitude == b.longitude && a.latitude == b.latitude &&
+    a.altitude == b.altitude;
+}
+
+static unsigned
+Percentile(std::vector<unsigned> &v, double p)
+{
+  auto i = v.begin() + std::min(v.size() - 1, size_t(v.size() * p));
+  std::nth_element(v.begin(), i, v.end());
+  return *i;
+}
+
+/**
+ * Simulate an aircraft gliding towards the map center, and solve the
+ * route after each step, once with a planner which keeps its link
+ * cache from the previous steps and once with a new one.  Both must
+ * find the same route.
+ */
+static void
+test_replan(const RasterMap &map, double mc, unsigned n_steps)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::TERRAIN;
+
+  const GlidePolar polar(mc);
+  const SpeedVector wind(Angle::Degrees(0), 0);
+
+  TerrainRoute warm;
+  warm.UpdatePolar(settings, config, polar, polar, wind);
+  warm.SetTerrain(&map);
+
+  const GeoPoint target(map.GetMapCenter());
+  /* arriving below the safety height makes the planner search for
+     detours */
+  const int h_target = map.GetHeight(target).GetValueOr0();
+
+  std::vector<unsigned> warm_us, cold_us;
+  bool identical = true;
+
+  for (unsigned k = 0; k < 8; ++k) {
+    const Angle bearing = Angle::FullCircle() * k / 8;
+
+    for (unsigned step = 0; step < n_steps; ++step) {
+      const double distance = 20000 - 300 * step;
+      const AGeoPoint aircraft(GeoVector(distance, bearing).EndPoint(target),
+                               h_target + int(distance / 40));
+
+      auto start = MonotonicClockUS();
+      warm.Solve(AGeoPoint(target, h_target), aircraft, config);
+      warm_us.push_back(MonotonicClockUS() - start);
+
+      TerrainRoute cold;
+      cold.UpdatePolar(settings, config, polar, polar, wind);
+      cold.SetTerrain(&map);
+
+      start = MonotonicClockUS();
+      cold.Solve(AGeoPoint(target, h_target), aircraft, config);
+      cold_us.push_back(MonotonicClockUS() - start);
+
+      if (warm.GetSolution() != cold.GetSolution())
+        identical = false;
+    }
+  }
+
+  const unsigned long hits = warm.GetLinkCache().GetHits();
+  const unsigned long misses = warm.GetLinkCache().GetMisses();
+
+  char buffer[80];
+  sprintf(buffer, "terrain route replan, mc=%g", mc);
+  ok(identical, buffer, 0);
+
+  printf("# link cache: %lu hits, %lu misses (%.1f%% hit rate)\n",
+         hits, misses, hits + misses > 0 ? 100. * hits / (hits + misses) : 0.);
+  printf("# solve time with cache [us]: p50=%u p90=%u p99=%u\n",
+         Percentile(warm_us, 0.5), Percentile(warm_us, 0.9),
+         Percentile(warm_us, 0.99));
+  printf("# solve time without cache [us]: p50=%u p90=%u p99=%u\n",
+         Percentile(cold_us, 0.5), Percentile(cold_us, 0.9),
+         Percentile(cold_us, 0.99));
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
-  if ((argc<2) || !strlen(argv[0])) {
+  if ((argc<2) || !strlen(argv[1])) {
     map_path = hc_path;
   } else {
-    map_path = argv[0];
+    map_path = argv[1];
   }
 
   ZZIP_DIR *dir = zzip_dir_open(map_path, nullptr);
@@ -141,10 +232,12 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(16*3);
+  plan_tests(16*3 + 2);
   test_troute(map, 0, 0.1, 10000);
   test_troute(map, 0, 0, 10000);
   test_troute(map, 5.0, 1, 10000);
+  test_replan(map, 0, 40);
+  test_replan(map, 1, 40);
 
   return exit_status();
 }